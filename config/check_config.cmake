@@ -28,7 +28,10 @@ tfm_invalid_config(TFM_ISOLATION_LEVEL EQUAL 3 AND NOT TFM_PLATFORM IN_LIST TFM_
 tfm_invalid_config(TFM_ISOLATION_LEVEL GREATER 1 AND NOT TFM_PSA_API)
 
 tfm_invalid_config(TFM_MULTI_CORE_TOPOLOGY AND NOT TFM_PSA_API)
+tfm_invalid_config(TFM_SPM_TRACE AND NOT TFM_PSA_API)
 tfm_invalid_config(TFM_MULTI_CORE_MULTI_CLIENT_CALL AND NOT TFM_MULTI_CORE_TOPOLOGY)
+tfm_invalid_config(TFM_MULTI_CORE_NOTIFY_COALESCE AND NOT TFM_MULTI_CORE_TOPOLOGY)
+tfm_invalid_config(TFM_MULTI_CORE_MAILBOX_PROFILING AND NOT TFM_MULTI_CORE_TOPOLOGY)
 
 tfm_invalid_config(TEST_S  AND TEST_PSA_API)
 tfm_invalid_config(TEST_NS AND TEST_PSA_API)
@@ -27,6 +27,7 @@ set(TFM_EXTRA_MANIFEST_LIST_PATH        ""          CACHE PATH      "Path to ext
 set(TFM_EXTRA_GENERATED_FILE_LIST_PATH  ""          CACHE PATH      "Path to extra generated file list. Appended to stardard TFM generated file list.")
 
 set(TFM_SPM_LOG_LEVEL                   2           CACHE STRING    "Set default SPM log level as INFO level")
+set(TFM_SPM_TRACE                       OFF         CACHE BOOL      "Whether to record SPM events into a trace ring buffer in RAM")
 
 ########################## BL2 #################################################
 
@@ -61,6 +62,8 @@ set(MCUBOOT_NS_IMAGE_MIN_VER            0.0.0+0     CACHE STRING    "Minimum ver
 
 set(TFM_MULTI_CORE_TOPOLOGY             OFF         CACHE BOOL      "Whether to build for a dual-cpu architecture")
 set(TFM_MULTI_CORE_MULTI_CLIENT_CALL    OFF         CACHE BOOL      "Whether to enable multiple PSA client calls feature")
+set(TFM_MULTI_CORE_NOTIFY_COALESCE      OFF         CACHE BOOL      "Whether to batch SPE mailbox replies into fewer notifications to NSPE")
+set(TFM_MULTI_CORE_MAILBOX_PROFILING    OFF         CACHE BOOL      "Whether to collect mailbox latency histograms, queue full counts and per-SID call counts")
 
 set(DEBUG_AUTHENTICATION                CHIP_DEFAULT CACHE STRING   "Debug authentication setting. [CHIP_DEFAULT, NONE, NS_ONLY, FULL")
 set(SECURE_UART1                        OFF         CACHE BOOL      "Enable secure UART1")
@@ -82,22 +85,45 @@ set(PS_ENCRYPTION                       ON          CACHE BOOL      "Enable encr
 set(PS_RAM_FS                           OFF         CACHE BOOL      "Enable emulated RAM FS for platforms that don't have flash for Protected Storage partition")
 set(PS_ROLLBACK_PROTECTION              ON          CACHE BOOL      "Enable rollback protection for Protected Storage partition")
 set(PS_VALIDATE_METADATA_FROM_FLASH     ON          CACHE BOOL      "Validate filesystem metadata every time it is read from flash")
+set(PS_OBJECT_TABLE_INDEX               OFF         CACHE BOOL      "Keep a hash index of the object table to look up objects without scanning it")
 set(PS_MAX_ASSET_SIZE                   "2048"      CACHE STRING    "The maximum asset size to be stored in the Protected Storage area")
 set(PS_NUM_ASSETS                       "10"        CACHE STRING    "The maximum number of assets to be stored in the Protected Storage area")
 set(PS_CRYPTO_AEAD_ALG                  PSA_ALG_GCM CACHE STRING    "The AEAD algorithm to use for authenticated encryption in Protected Storage")
+set(PS_AEAD_SEGMENT_SIZE                ""          CACHE STRING    "Size of the segments in which Protected Storage objects are encrypted (objects are encrypted in one segment if not set)")
 
 set(TFM_PARTITION_INTERNAL_TRUSTED_STORAGE ON       CACHE BOOL      "Enable Internal Trusted Storage partition")
 set(ITS_CREATE_FLASH_LAYOUT             ON          CACHE BOOL      "Create flash FS if it doesn't exist for Internal Trusted Storage partition")
 set(ITS_RAM_FS                          OFF         CACHE BOOL      "Enable emulated RAM FS for platforms that don't have flash for Internal Trusted Storage partition")
+set(ITS_RAM_FS_STATS                    OFF         CACHE BOOL      "Collect access statistics (bytes read/programmed, per-block erase counts) in the emulated RAM FS")
+set(ITS_RAM_FS_PROGRAM_LATENCY          ""          CACHE STRING    "Simulated program latency of the emulated RAM FS, in busy-wait iterations per program unit (no latency if not set)")
+set(ITS_RAM_FS_ERASE_LATENCY            ""          CACHE STRING    "Simulated block erase latency of the emulated RAM FS, in busy-wait iterations (no latency if not set)")
 set(ITS_VALIDATE_METADATA_FROM_FLASH    ON          CACHE BOOL      "Validate filesystem metadata every time it is read from flash")
+set(ITS_FILE_INDEX                      OFF         CACHE BOOL      "Keep a RAM index of the file metadata table to look up files without scanning it in flash")
+set(ITS_METADATA_CACHE                  OFF         CACHE BOOL      "Enable batches of ITS updates committed with a single metadata block swap, using a RAM metadata cache")
+set(ITS_METADATA_CACHE_SIZE             ""          CACHE STRING    "Size of the ITS metadata cache used by batches of updates (defaults to 1024 if not set)")
+set(ITS_WEAR_LEVELING                   OFF         CACHE BOOL      "Track data block erase counts in the ITS metadata and allocate files to the least worn blocks. Changes the filesystem layout")
+set(ITS_APPEND_IN_PLACE                 OFF         CACHE BOOL      "Write data appended to ITS files directly in erased flash, without copying the data block. Requires flash that allows programming bytes that read as erased")
 set(ITS_MAX_ASSET_SIZE                  "512"       CACHE STRING    "The maximum asset size to be stored in the Internal Trusted Storage area")
 set(ITS_NUM_ASSETS                      "10"        CACHE STRING    "The maximum number of assets to be stored in the Internal Trusted Storage area")
 set(ITS_BUF_SIZE                        ""          CACHE STRING    "Size of the ITS internal data transfer buffer (defaults to ITS_MAX_ASSET_SIZE if not set)")
+set(ITS_FS_AREA_BLOCKS                  ""          CACHE STRING    "List of the number of flash blocks of each area the ITS flash area is divided into, each holding a separate filesystem for a subset of the clients. The entries must add up to the blocks of the ITS flash area (defaults to one area if not set)")
+set(ITS_FS_AREA_NUM_ASSETS              ""          CACHE STRING    "List of the maximum number of assets of each ITS area, with one entry per entry of ITS_FS_AREA_BLOCKS, each at most ITS_NUM_ASSETS (defaults to ITS_NUM_ASSETS for each area if not set)")
+set(ITS_FS_AREA_CLIENTS                 ""          CACHE STRING    "List of <client ID>:<area index> entries assigning ITS clients to the areas of ITS_FS_AREA_BLOCKS (all clients use ITS_FS_AREA_DEFAULT if not set)")
+set(ITS_FS_AREA_DEFAULT                 ""          CACHE STRING    "Index of the ITS area of the clients not listed in ITS_FS_AREA_CLIENTS (defaults to the first area if not set)")
 
 set(TFM_PARTITION_CRYPTO                ON          CACHE BOOL      "Enable Crypto partition")
 # CRYPTO_ENGINE_BUF_SIZE needs to be >8KB for EC signing by attest module.
 set(CRYPTO_ENGINE_BUF_SIZE              0x2080      CACHE STRING    "Heap size for the crypto backend")
-set(CRYPTO_CONC_OPER_NUM                8           CACHE STRING    "The max number of concurrent operations that can be active (allocated) at any time in Crypto")
+set(CRYPTO_CONC_OPER_NUM                8           CACHE STRING    "The max number of concurrent operations that can be active (allocated) at any time in Crypto. The contexts not reserved for a type below are shared by all the operation types")
+set(CRYPTO_CIPHER_OPER_NUM              ""          CACHE STRING    "The number of contexts of CRYPTO_CONC_OPER_NUM reserved for cipher operations in Crypto (none if not set)")
+set(CRYPTO_MAC_OPER_NUM                 ""          CACHE STRING    "The number of contexts of CRYPTO_CONC_OPER_NUM reserved for MAC operations in Crypto (none if not set)")
+set(CRYPTO_HASH_OPER_NUM                ""          CACHE STRING    "The number of contexts of CRYPTO_CONC_OPER_NUM reserved for hash operations in Crypto (none if not set)")
+set(CRYPTO_KEY_DERIVATION_OPER_NUM      ""          CACHE STRING    "The number of contexts of CRYPTO_CONC_OPER_NUM reserved for key derivation operations in Crypto (none if not set)")
+set(CRYPTO_S_CLIENT_OPER_QUOTA          ""          CACHE STRING    "The max number of concurrent operations of each type a secure partition can hold in Crypto (no quota if not set)")
+set(CRYPTO_NS_CLIENT_OPER_QUOTA         ""          CACHE STRING    "The max number of concurrent operations of each type a non-secure client can hold in Crypto (no quota if not set)")
+set(CRYPTO_OPER_RECLAIM_AGE             ""          CACHE STRING    "Number of Crypto operation calls after which an idle operation can be reclaimed when no context is free (never reclaimed if not set)")
+set(CRYPTO_OPER_STATS_LOG              OFF         CACHE BOOL      "Log the utilization counters of a type of Crypto operations when an allocation of that type fails or reclaims an idle operation")
+set(CRYPTO_MAX_KEY_HANDLES              16          CACHE STRING    "The max number of key handles that can be open at any time in Crypto")
 set(CRYPTO_KEY_MODULE_DISABLED          FALSE       CACHE BOOL      "Disable PSA Crypto Key module")
 set(CRYPTO_AEAD_MODULE_DISABLED         FALSE       CACHE BOOL      "Disable PSA Crypto AEAD module")
 set(CRYPTO_MAC_MODULE_DISABLED          FALSE       CACHE BOOL      "Disable PSA Crypto MAC module")
@@ -106,6 +132,7 @@ set(CRYPTO_CIPHER_MODULE_DISABLED       FALSE       CACHE BOOL      "Disable PSA
 set(CRYPTO_GENERATOR_MODULE_DISABLED    FALSE       CACHE BOOL      "Disable PSA Crypto Key Derivation module")
 set(CRYPTO_ASYMMETRIC_MODULE_DISABLED   FALSE       CACHE BOOL      "Disable PSA Crypto Asymmetric key module")
 set(CRYPTO_IOVEC_BUFFER_SIZE            5120        CACHE STRING    "Default size of the internal scratch buffer used for PSA FF IOVec allocations")
+set(CRYPTO_IOVEC_ZERO_COPY              OFF         CACHE BOOL      "Read the bulk data inputs of Crypto requests in place when the Crypto partition can access them, instead of copying them")
 
 set(TFM_PARTITION_INITIAL_ATTESTATION   ON          CACHE BOOL      "Enable Initial Attestation partition")
 set(SYMMETRIC_INITIAL_ATTESTATION       OFF         CACHE BOOL      "Use symmetric crypto for inital attestation")
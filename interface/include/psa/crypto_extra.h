@@ -57,6 +57,76 @@ extern "C" {
 
 /**@}*/
 
+/** \defgroup batch Batched multipart updates
+ * @{
+ */
+
+/** The entry is a psa_hash_update() on \c operation.hash */
+#define PSA_BATCH_HASH_UPDATE                        ((uint32_t)1)
+/** The entry is a psa_mac_update() on \c operation.mac */
+#define PSA_BATCH_MAC_UPDATE                         ((uint32_t)2)
+/** The entry is a psa_cipher_update() on \c operation.cipher */
+#define PSA_BATCH_CIPHER_UPDATE                      ((uint32_t)3)
+
+/** One update of a batch run by psa_batch_update(). */
+typedef struct psa_batch_entry_s {
+    uint32_t type;                        /**< PSA_BATCH_xxx_UPDATE */
+    union {
+        psa_hash_operation_t *hash;
+        psa_mac_operation_t *mac;
+        psa_cipher_operation_t *cipher;
+    } operation;                          /**< The operation to update */
+    size_t input_length;                  /**< Length of the entry input */
+    size_t output_size;                   /**< Size of the entry output, only
+                                           *   used by cipher updates
+                                           */
+    size_t output_length;                 /**< On return, the length of the
+                                           *   entry output
+                                           */
+    psa_status_t status;                  /**< On return, the status of the
+                                           *   entry
+                                           */
+} psa_batch_entry_t;
+
+/** Run several multipart updates in as few service calls as possible.
+ *
+ * The entries are run in order, each one behaving as the corresponding
+ * psa_hash_update(), psa_mac_update() or psa_cipher_update() call. The inputs
+ * of the entries are taken back to back from \p input, and each cipher entry
+ * writes its output at the start of the next \c output_size bytes of
+ * \p output. The batch stops at the first entry that fails: the operation of
+ * that entry is aborted as it would be by the single update call, and the
+ * entries after it are left untouched with their status set to
+ * #PSA_ERROR_BAD_STATE.
+ *
+ * The entries may be sent to the service in several requests, each of at most
+ * TFM_CRYPTO_BATCH_MAX_ENTRIES entries and TFM_CRYPTO_BATCH_MAX_PAYLOAD bytes
+ * of input and output.
+ *
+ * \param[in,out] entries       The updates to run.
+ * \param entry_count           Number of elements in \p entries.
+ * \param[in] input             Buffer holding the inputs of all the entries.
+ * \param input_length          Size of the \p input buffer in bytes.
+ * \param[out] output           Buffer receiving the outputs of the cipher
+ *                              entries.
+ * \param output_size           Size of the \p output buffer in bytes.
+ *
+ * \retval #PSA_SUCCESS
+ *         Success. All the entries have been run.
+ * \retval #PSA_ERROR_INVALID_ARGUMENT
+ *         An entry has an unknown type, or the entries need more input or
+ *         output than provided. No entry has been run.
+ * \return The status of the first entry that failed.
+ */
+psa_status_t psa_batch_update(psa_batch_entry_t *entries,
+                              size_t entry_count,
+                              const uint8_t *input,
+                              size_t input_length,
+                              uint8_t *output,
+                              size_t output_size);
+
+/**@}*/
+
 #ifdef __cplusplus
 }
 #endif
@@ -260,6 +260,37 @@ void psa_eoi(psa_signal_t irq_signal);
  */
 void psa_panic(void);
 
+/**
+ * \brief Get the address of the remaining data of a client input vector, so
+ *        that it can be read in place instead of being copied with
+ *        \ref psa_read. This is a TF-M extension.
+ *
+ * \note The data stays in client memory, and the client may be able to change
+ *       it while it is read. Only data which the RoT Service handles as an
+ *       opaque stream should be read in place.
+ *
+ * \param[in] msg_handle        Handle for the client's message.
+ * \param[in] invec_idx         Index of the input vector. Must be less than
+ *                              \ref PSA_MAX_IOVEC.
+ *
+ * \retval !NULL                Address of the remaining data of the input
+ *                              vector. Its size is the in_size of the vector
+ *                              in the message, less any data already read or
+ *                              skipped. The address is valid until the
+ *                              message is replied to.
+ * \retval NULL                 There was no remaining data in this input
+ *                              vector, or the Secure Partition cannot access
+ *                              it. The data must be read with \ref psa_read.
+ * \retval "PROGRAMMER ERROR"   The call is invalid, one or more of the
+ *                              following are true:
+ * \arg                           msg_handle is invalid.
+ * \arg                           msg_handle does not refer to a
+ *                                \ref PSA_IPC_CALL message.
+ * \arg                           invec_idx is equal to or greater than
+ *                                \ref PSA_MAX_IOVEC.
+ */
+const void *tfm_map_invec(psa_handle_t msg_handle, uint32_t invec_idx);
+
 #ifdef __cplusplus
 }
 #endif
@@ -51,6 +51,52 @@ struct tfm_crypto_pack_iovec {
                                                 */
 };
 
+/**
+ * \brief Maximum number of entries sent to the service in a single batch
+ *        update request. Longer batches are split by the client interface.
+ */
+#define TFM_CRYPTO_BATCH_MAX_ENTRIES (8u)
+
+/**
+ * \brief Maximum number of bytes of input and output, together, sent to the
+ *        service in a single batch update request. In IPC mode, the service
+ *        copies the whole request into its scratch buffer, so this must leave
+ *        room there for the entries and results. The client interface starts
+ *        a new request before this is exceeded.
+ */
+#ifndef TFM_CRYPTO_BATCH_MAX_PAYLOAD
+#define TFM_CRYPTO_BATCH_MAX_PAYLOAD (4096u)
+#endif
+
+/**
+ * \brief Structure describing one entry of a batch update request. The input
+ *        and output of the entries are laid out back to back, in entry order,
+ *        in the single input and output buffers of the request.
+ */
+struct tfm_crypto_batch_entry {
+    uint32_t sfn_id;       /*!< TFM_CRYPTO_HASH_UPDATE_SID,
+                            *   TFM_CRYPTO_MAC_UPDATE_SID or
+                            *   TFM_CRYPTO_CIPHER_UPDATE_SID
+                            */
+    uint32_t op_handle;    /*!< Frontend context handle of the operation */
+    uint32_t input_length; /*!< Length of the entry input */
+    uint32_t output_size;  /*!< Space reserved for the entry output. It must
+                            *   be zero for hash and MAC updates
+                            */
+};
+
+/**
+ * \brief Structure returned for each entry of a batch update request
+ */
+struct tfm_crypto_batch_result {
+    uint32_t op_handle;     /*!< Frontend context handle after the update */
+    psa_status_t status;    /*!< Status of the update, or PSA_ERROR_BAD_STATE
+                             *   if it was not run because an earlier entry
+                             *   failed
+                             */
+    uint32_t output_length; /*!< Length of the output written for the entry */
+};
+
 /**
  * \brief Define a progressive numerical value for each SID which can be used
  *        when dispatching the requests to the service
@@ -120,6 +166,7 @@ enum {
     TFM_CRYPTO_GENERATE_KEY_SID,
     TFM_CRYPTO_SET_KEY_DOMAIN_PARAMETERS_SID,
     TFM_CRYPTO_GET_KEY_DOMAIN_PARAMETERS_SID,
+    TFM_CRYPTO_BATCH_UPDATE_SID,
     TFM_CRYPTO_SID_MAX,
 };
 
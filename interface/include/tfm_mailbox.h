@@ -43,13 +43,16 @@ extern "C" {
 #endif
 
 /*
- * The number of slots should be no more than the number of bits in
- * mailbox_queue_status_t.
- * Here the value is hardcoded. A better way is to define a sizeof() to
- * calculate the bits in mailbox_queue_status_t and dump it with pragma message.
+ * Slot indexes are stored in uint8_t, with NUM_MAILBOX_QUEUE_SLOT as the
+ * invalid index.
  */
-#if (NUM_MAILBOX_QUEUE_SLOT > 32)
-#error "Error: Invalid NUM_MAILBOX_QUEUE_SLOT. The value should be no more than 32"
+#if (NUM_MAILBOX_QUEUE_SLOT > 128)
+#error "Error: Invalid NUM_MAILBOX_QUEUE_SLOT. The value should be no more than 128"
+#endif
+
+/* The mailbox rings index their entries with a mask of the position */
+#if ((NUM_MAILBOX_QUEUE_SLOT & (NUM_MAILBOX_QUEUE_SLOT - 1)) != 0)
+#error "Error: Invalid NUM_MAILBOX_QUEUE_SLOT. The value should be a power of 2"
 #endif
 #else /* TFM_MULTI_CORE_MULTI_CLIENT_CALL */
 /* Force the number of mailbox queue slots as 1. */
@@ -131,6 +134,47 @@ struct mailbox_reply_t {
     int32_t return_val;
 };
 
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+/* The number of buckets in a mailbox latency histogram */
+#define MAILBOX_LATENCY_NR_BUCKETS          16
+
+/* The number of RoT Services whose calls are counted separately */
+#ifndef MAILBOX_PROFILING_NR_SID
+#define MAILBOX_PROFILING_NR_SID            16
+#endif
+
+/*
+ * Timestamps of the stages of a mailbox message, in ticks of the time base
+ * shared by NSPE and SPE.
+ */
+struct mailbox_msg_timestamps_t {
+    uint32_t enqueue;                       /* NSPE submitted the message */
+    uint32_t pickup;                        /* SPE fetched the message */
+    uint32_t reply;                         /* SPE replied the message */
+    uint32_t sid;                           /* SID of the RoT Service called,
+                                             * or 0 if unknown
+                                             */
+};
+
+/*
+ * A histogram of latencies in ticks. Bucket 0 counts the latencies below 2
+ * ticks and bucket N counts the latencies in [2^N, 2^(N+1)) ticks. The last
+ * bucket also counts all the longer latencies.
+ */
+struct mailbox_latency_hist_t {
+    uint32_t buckets[MAILBOX_LATENCY_NR_BUCKETS];
+    uint32_t count;                         /* Number of latencies recorded */
+    uint32_t max;                           /* Longest latency recorded */
+    uint64_t total;                         /* Sum of latencies recorded */
+};
+
+/* The number of calls to a single RoT Service */
+struct mailbox_sid_stats_t {
+    uint32_t sid;                           /* 0 if the entry is unused */
+    uint32_t nr_calls;
+};
+#endif
+
 /* A single slot structure in NSPE mailbox queue */
 struct ns_mailbox_slot_t {
     struct mailbox_msg_t   msg;
@@ -138,23 +182,71 @@ struct ns_mailbox_slot_t {
     const void             *owner;          /* Handle of the owner task of this
                                              * slot
                                              */
-    bool                   is_woken;        /* Indicate that owner task has been
+    volatile bool          is_woken;        /* Indicate that owner task has been
                                              * or should be woken up, after the
                                              * replied is received.
                                              */
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+    struct mailbox_msg_timestamps_t ts;     /* Written by NSPE and SPE along
+                                             * the stages of the message
+                                             */
+#endif
 };
 
-typedef uint32_t   mailbox_queue_status_t;
+/*
+ * The number of entries in a mailbox ring.
+ * A ring holds at most NUM_MAILBOX_QUEUE_SLOT slot indexes. The extra entries
+ * ensure that the entry a producer reuses has always been released by its
+ * previous consumer, even while the peer core is still consuming the next
+ * ones.
+ */
+#define MAILBOX_RING_SIZE                   (2 * NUM_MAILBOX_QUEUE_SLOT)
+
+/* A single entry of a mailbox ring */
+struct mailbox_ring_entry_t {
+    volatile uint32_t seq;                  /* Position of the ring this entry
+                                             * can next be produced (seq equal
+                                             * to the position) or consumed
+                                             * (seq one past the position) at.
+                                             */
+    volatile uint32_t slot_idx;             /* Index of a mailbox queue slot */
+};
 
-/* NSPE mailbox queue */
+/*
+ * A bounded ring of mailbox queue slot indexes.
+ *
+ * Each slot index is in at most one ring at any time. The producer and the
+ * consumer positions are each only modified by a single core, so no exclusive
+ * access is required across the cores. A ring reports full or empty only when
+ * it is, as long as no operation stops between claiming a position and
+ * releasing its entry. NSPE ensures this by masking local interrupts during
+ * its ring operations, and SPE ring operations run in SPM handler mode.
+ */
+struct mailbox_ring_t {
+    volatile uint32_t           enqueue_pos; /* Next position to produce at */
+    volatile uint32_t           dequeue_pos; /* Next position to consume at */
+    struct mailbox_ring_entry_t entries[MAILBOX_RING_SIZE];
+};
+
+/*
+ * NSPE mailbox queue
+ *
+ * Each non-secure core owns a mailbox queue and its rings. Slots move from
+ * free_ring to pend_ring when a PSA client call is submitted, from pend_ring
+ * to reply_ring when SPE returns the result, and back to free_ring once the
+ * result is read.
+ */
 struct ns_mailbox_queue_t {
-    mailbox_queue_status_t   empty_slots;       /* Bitmask of empty slots */
-    mailbox_queue_status_t   pend_slots;        /* Bitmask of slots pending
-                                                 * for SPE handling
+    struct mailbox_ring_t    free_ring;         /* Empty slots. Only accessed
+                                                 * by NSPE.
+                                                 */
+    struct mailbox_ring_t    pend_ring;         /* Slots pending for SPE
+                                                 * handling. Produced by NSPE
+                                                 * and consumed by SPE.
                                                  */
-    mailbox_queue_status_t   replied_slots;     /* Bitmask of active slots
-                                                 * containing PSA client call
-                                                 * return result
+    struct mailbox_ring_t    reply_ring;        /* Slots containing PSA client
+                                                 * call return result. Produced
+                                                 * by SPE and consumed by NSPE.
                                                  */
 
     struct ns_mailbox_slot_t queue[NUM_MAILBOX_QUEUE_SLOT];
@@ -173,6 +265,66 @@ struct ns_mailbox_queue_t {
 #endif
 };
 
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+/**
+ * \brief Record a latency into a mailbox latency histogram.
+ *
+ * \param[in,out] hist           The histogram
+ * \param[in] latency            The latency in ticks
+ */
+static inline void mailbox_latency_hist_add(struct mailbox_latency_hist_t *hist,
+                                            uint32_t latency)
+{
+    uint32_t bucket = 0;
+
+    while ((bucket < MAILBOX_LATENCY_NR_BUCKETS - 1) &&
+           ((latency >> (bucket + 1)) != 0)) {
+        bucket++;
+    }
+
+    hist->buckets[bucket]++;
+    hist->count++;
+    hist->total += latency;
+    if (latency > hist->max) {
+        hist->max = latency;
+    }
+}
+
+/**
+ * \brief Count a call to a RoT Service in a table of per-SID statistics.
+ *
+ * \param[in,out] table          The table of \ref MAILBOX_PROFILING_NR_SID
+ *                               entries
+ * \param[in] sid                The SID of the RoT Service. Calls with a 0
+ *                               SID are not counted.
+ *
+ * \retval true                  The call is counted.
+ * \retval false                 The table is full or the SID is invalid.
+ */
+static inline bool mailbox_sid_stats_add(struct mailbox_sid_stats_t *table,
+                                         uint32_t sid)
+{
+    uint32_t i;
+
+    if (sid == 0) {
+        return false;
+    }
+
+    for (i = 0; i < MAILBOX_PROFILING_NR_SID; i++) {
+        if (table[i].sid == 0) {
+            table[i].sid = sid;
+        }
+
+        if (table[i].sid == sid) {
+            table[i].nr_calls++;
+            return true;
+        }
+    }
+
+    return false;
+}
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -34,6 +34,33 @@ struct ns_mailbox_stats_res_t {
 };
 #endif
 
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+/**
+ * \brief The profiling statistics of NSPE mailbox
+ *
+ * Latencies are measured in ticks of the time base shared by NSPE and SPE.
+ */
+struct ns_mailbox_profile_t {
+    uint32_t since;                     /* Timestamp when the statistics were
+                                         * last reset
+                                         */
+    struct mailbox_latency_hist_t pickup;   /* From NSPE enqueue to SPE pickup */
+    struct mailbox_latency_hist_t service;  /* From SPE pickup to SPE reply */
+    struct mailbox_latency_hist_t wakeup;   /* From SPE reply to NSPE wakeup */
+    struct mailbox_latency_hist_t total;    /* From NSPE enqueue to NSPE
+                                             * wakeup
+                                             */
+    uint32_t nr_queue_full;             /* The number of PSA client calls
+                                         * rejected as NSPE mailbox queue is
+                                         * full.
+                                         */
+    uint32_t nr_other_calls;            /* The number of PSA client calls not
+                                         * counted in sids.
+                                         */
+    struct mailbox_sid_stats_t sids[MAILBOX_PROFILING_NR_SID];
+};
+#endif
+
 /**
  * \brief Prepare and send PSA client request to SPE via mailbox.
  *
@@ -229,6 +256,39 @@ void tfm_ns_mailbox_tx_stats_init(void);
 void tfm_ns_mailbox_stats_avg_slot(struct ns_mailbox_stats_res_t *stats_res);
 #endif
 
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+/**
+ * \brief Clear the profiling statistics of NSPE mailbox.
+ *
+ * \note This function is only available when mailbox profiling is enabled.
+ */
+void tfm_ns_mailbox_profile_reset(void);
+
+/**
+ * \brief Read the profiling statistics of NSPE mailbox.
+ *
+ * \note This function is only available when mailbox profiling is enabled.
+ *
+ * \param[out] profile          The buffer to be written with
+ *                              \ref ns_mailbox_profile_t.
+ *
+ * \retval MAILBOX_SUCCESS      Operation succeeded.
+ * \retval Other return code    Operation failed with an error code.
+ */
+int32_t tfm_ns_mailbox_profile_get(struct ns_mailbox_profile_t *profile);
+
+/**
+ * \brief Read the current timestamp of the time base shared by NSPE and SPE.
+ *
+ * \note This function is implemented by platform specific timer driver. The
+ *       same time base must be read by \ref tfm_mailbox_hal_get_timestamp in
+ *       SPE.
+ *
+ * \return The current timestamp in ticks.
+ */
+uint32_t tfm_ns_mailbox_hal_get_timestamp(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
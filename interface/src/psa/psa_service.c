@@ -46,6 +46,14 @@ size_t psa_read(psa_handle_t msg_handle, uint32_t invec_idx,
                    : : "I" (TFM_SVC_PSA_READ));
 }
 
+__attribute__((naked))
+const void *tfm_map_invec(psa_handle_t msg_handle, uint32_t invec_idx)
+{
+    __ASM volatile("SVC %0           \n"
+                   "BX LR            \n"
+                   : : "I" (TFM_SVC_MAP_INVEC));
+}
+
 __attribute__((naked))
 size_t psa_skip(psa_handle_t msg_handle, uint32_t invec_idx, size_t num_bytes)
 {
@@ -1499,3 +1499,135 @@ psa_status_t psa_aead_update(psa_aead_operation_t *operation,
 
     return status;
 }
+
+static uint32_t *tfm_crypto_batch_entry_handle(
+                                            const psa_batch_entry_t *entry,
+                                            uint32_t *sfn_id)
+{
+    switch (entry->type) {
+    case PSA_BATCH_HASH_UPDATE:
+        *sfn_id = TFM_CRYPTO_HASH_UPDATE_SID;
+        return &entry->operation.hash->handle;
+    case PSA_BATCH_MAC_UPDATE:
+        *sfn_id = TFM_CRYPTO_MAC_UPDATE_SID;
+        return &entry->operation.mac->handle;
+    case PSA_BATCH_CIPHER_UPDATE:
+        *sfn_id = TFM_CRYPTO_CIPHER_UPDATE_SID;
+        return &entry->operation.cipher->handle;
+    default:
+        *sfn_id = TFM_CRYPTO_SID_INVALID;
+        return NULL;
+    }
+}
+
+psa_status_t psa_batch_update(psa_batch_entry_t *entries,
+                              size_t entry_count,
+                              const uint8_t *input,
+                              size_t input_length,
+                              uint8_t *output,
+                              size_t output_size)
+{
+    psa_status_t status = PSA_SUCCESS;
+    struct tfm_crypto_batch_entry batch[TFM_CRYPTO_BATCH_MAX_ENTRIES];
+    struct tfm_crypto_batch_result results[TFM_CRYPTO_BATCH_MAX_ENTRIES];
+    size_t input_used = 0, output_used = 0;
+    size_t nr_entries, i;
+    uint32_t *handle;
+    uint32_t sfn_id;
+    struct tfm_crypto_pack_iovec iov = {
+        .sfn_id = TFM_CRYPTO_BATCH_UPDATE_SID,
+    };
+
+    psa_invec in_vec[] = {
+        {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
+        {.base = batch, .len = 0},
+        {.base = NULL, .len = 0},
+    };
+
+    psa_outvec out_vec[] = {
+        {.base = results, .len = 0},
+        {.base = NULL, .len = 0},
+    };
+
+    /* Check the whole batch before running any of it */
+    for (i = 0; i < entry_count; i++) {
+        if ((tfm_crypto_batch_entry_handle(&entries[i], &sfn_id) == NULL) ||
+            (entries[i].input_length > input_length - input_used)) {
+            return PSA_ERROR_INVALID_ARGUMENT;
+        }
+        input_used += entries[i].input_length;
+
+        if (sfn_id == TFM_CRYPTO_CIPHER_UPDATE_SID) {
+            if (entries[i].output_size > output_size - output_used) {
+                return PSA_ERROR_INVALID_ARGUMENT;
+            }
+            output_used += entries[i].output_size;
+        }
+    }
+
+    for (i = 0; i < entry_count; i++) {
+        entries[i].output_length = 0;
+        entries[i].status = PSA_ERROR_BAD_STATE;
+    }
+
+    /*
+     * Send the entries to the service in groups of at most
+     * TFM_CRYPTO_BATCH_MAX_ENTRIES entries and TFM_CRYPTO_BATCH_MAX_PAYLOAD
+     * bytes of input and output. An entry above the payload limit is sent in
+     * a group of its own, as the single update call would send it.
+     */
+    while ((entry_count > 0) && (status == PSA_SUCCESS)) {
+        input_used = 0;
+        output_used = 0;
+
+        for (i = 0; (i < entry_count) && (i < TFM_CRYPTO_BATCH_MAX_ENTRIES);
+             i++) {
+            handle = tfm_crypto_batch_entry_handle(&entries[i], &sfn_id);
+
+            batch[i].sfn_id = sfn_id;
+            batch[i].op_handle = *handle;
+            batch[i].input_length = (uint32_t)entries[i].input_length;
+            batch[i].output_size = (sfn_id == TFM_CRYPTO_CIPHER_UPDATE_SID) ?
+                                   (uint32_t)entries[i].output_size : 0;
+
+            if ((i > 0) &&
+                (input_used + output_used + batch[i].input_length +
+                 batch[i].output_size > TFM_CRYPTO_BATCH_MAX_PAYLOAD)) {
+                break;
+            }
+
+            /* Kept as is if the service fails before running the entry */
+            results[i].op_handle = *handle;
+            results[i].status = PSA_ERROR_BAD_STATE;
+            results[i].output_length = 0;
+
+            input_used += batch[i].input_length;
+            output_used += batch[i].output_size;
+        }
+        nr_entries = i;
+
+        in_vec[1].len = nr_entries * sizeof(struct tfm_crypto_batch_entry);
+        in_vec[2].base = input;
+        in_vec[2].len = input_used;
+        out_vec[0].len = nr_entries * sizeof(struct tfm_crypto_batch_result);
+        out_vec[1].base = output;
+        out_vec[1].len = output_used;
+
+        status = API_DISPATCH(tfm_crypto_batch_update,
+                              TFM_CRYPTO_BATCH_UPDATE);
+
+        for (i = 0; i < nr_entries; i++) {
+            *tfm_crypto_batch_entry_handle(&entries[i], &sfn_id) =
+                                                        results[i].op_handle;
+            entries[i].output_length = results[i].output_length;
+            entries[i].status = results[i].status;
+        }
+
+        entries += nr_entries;
+        entry_count -= nr_entries;
+        input += input_used;
+        output += output_used;
+    }
+
+    return status;
+}
@@ -13,22 +13,14 @@
 
 #define ARRAY_SIZE(arr) (sizeof(arr)/sizeof(arr[0]))
 
-#define PSA_CONNECT(service)                                    \
-    psa_handle_t ipc_handle;                                    \
-    ipc_handle = psa_connect(service##_SID, service##_VERSION); \
-    if (!PSA_HANDLE_IS_VALID(ipc_handle)) {                     \
-        return PSA_ERROR_GENERIC_ERROR;                         \
-    }                                                           \
-
-#define PSA_CLOSE() psa_close(ipc_handle)
-
+/* TFM_CRYPTO is a stateless service, so no connection is needed */
 #define API_DISPATCH(sfn_name, sfn_id)                          \
-    psa_call(ipc_handle, PSA_IPC_CALL,                          \
+    psa_call(TFM_CRYPTO_HANDLE, PSA_IPC_CALL,                   \
         in_vec, ARRAY_SIZE(in_vec),                             \
         out_vec, ARRAY_SIZE(out_vec))
 
 #define API_DISPATCH_NO_OUTVEC(sfn_name, sfn_id)                \
-    psa_call(ipc_handle, PSA_IPC_CALL,                          \
+    psa_call(TFM_CRYPTO_HANDLE, PSA_IPC_CALL,                   \
         in_vec, ARRAY_SIZE(in_vec),                             \
         (psa_outvec *)NULL, 0)
 
@@ -58,13 +50,9 @@ psa_status_t psa_open_key(psa_key_id_t id,
         {.base = handle, .len = sizeof(psa_key_handle_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_open_key,
                           TFM_CRYPTO_OPEN_KEY);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
@@ -83,13 +71,9 @@ psa_status_t psa_close_key(psa_key_handle_t handle)
         {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH_NO_OUTVEC(tfm_crypto_close_key,
                                     TFM_CRYPTO_CLOSE_KEY);;
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
@@ -115,12 +99,8 @@ psa_status_t psa_import_key(const psa_key_attributes_t *attributes,
         {.base = handle, .len = sizeof(psa_key_handle_t)}
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_import_key,
                           TFM_CRYPTO_IMPORT_KEY);
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
@@ -139,12 +119,8 @@ psa_status_t psa_destroy_key(psa_key_handle_t handle)
         {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH_NO_OUTVEC(tfm_crypto_destroy_key,
                                     TFM_CRYPTO_DESTROY_KEY);
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
@@ -167,12 +143,8 @@ psa_status_t psa_get_key_attributes(psa_key_handle_t handle,
         {.base = attributes, .len = sizeof(psa_key_attributes_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_get_key_attributes,
                           TFM_CRYPTO_GET_KEY_ATTRIBUTES);
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
@@ -192,16 +164,8 @@ void psa_reset_key_attributes(psa_key_attributes_t *attributes)
         {.base = attributes, .len = sizeof(psa_key_attributes_t)},
     };
 
-    psa_handle_t ipc_handle;
-    ipc_handle = psa_connect(TFM_CRYPTO_SID, TFM_CRYPTO_VERSION);
-    if (!PSA_HANDLE_IS_VALID(ipc_handle)) {
-        return;
-    }
-
     (void)API_DISPATCH(tfm_crypto_reset_key_attributes,
                           TFM_CRYPTO_RESET_KEY_ATTRIBUTES);
-    PSA_CLOSE();
-
     return;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
@@ -226,15 +190,11 @@ psa_status_t psa_export_key(psa_key_handle_t handle,
         {.base = data, .len = data_size}
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_export_key,
                           TFM_CRYPTO_EXPORT_KEY);
 
     *data_length = out_vec[0].len;
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
@@ -260,15 +220,11 @@ psa_status_t psa_export_public_key(psa_key_handle_t handle,
         {.base = data, .len = data_size}
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_export_public_key,
                           TFM_CRYPTO_EXPORT_PUBLIC_KEY);
 
     *data_length = out_vec[0].len;
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
@@ -296,13 +252,9 @@ psa_status_t psa_copy_key(psa_key_handle_t source_handle,
         {.base = target_handle, .len = sizeof(psa_key_handle_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_copy_key,
                           TFM_CRYPTO_COPY_KEY);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
@@ -329,15 +281,11 @@ psa_status_t psa_cipher_generate_iv(psa_cipher_operation_t *operation,
         {.base = iv, .len = iv_size},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_cipher_generate_iv,
                           TFM_CRYPTO_CIPHER_GENERATE_IV);
 
     *iv_length = out_vec[1].len;
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_CIPHER_MODULE_DISABLED */
 }
@@ -363,13 +311,9 @@ psa_status_t psa_cipher_set_iv(psa_cipher_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_cipher_set_iv,
                           TFM_CRYPTO_CIPHER_SET_IV);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_CIPHER_MODULE_DISABLED */
 }
@@ -396,13 +340,9 @@ psa_status_t psa_cipher_encrypt_setup(psa_cipher_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_cipher_encrypt_setup,
                           TFM_CRYPTO_CIPHER_ENCRYPT_SETUP);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_CIPHER_MODULE_DISABLED */
 }
@@ -429,13 +369,9 @@ psa_status_t psa_cipher_decrypt_setup(psa_cipher_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_cipher_decrypt_setup,
                           TFM_CRYPTO_CIPHER_DECRYPT_SETUP);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_CIPHER_MODULE_DISABLED */
 }
@@ -465,15 +401,11 @@ psa_status_t psa_cipher_update(psa_cipher_operation_t *operation,
         {.base = output, .len = output_size}
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_cipher_update,
                           TFM_CRYPTO_CIPHER_UPDATE);
 
     *output_length = out_vec[1].len;
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_CIPHER_MODULE_DISABLED */
 }
@@ -496,13 +428,9 @@ psa_status_t psa_cipher_abort(psa_cipher_operation_t *operation)
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_cipher_abort,
                           TFM_CRYPTO_CIPHER_ABORT);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_CIPHER_MODULE_DISABLED */
 }
@@ -529,15 +457,11 @@ psa_status_t psa_cipher_finish(psa_cipher_operation_t *operation,
         {.base = output, .len = output_size},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_cipher_finish,
                           TFM_CRYPTO_CIPHER_FINISH);
 
     *output_length = out_vec[1].len;
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_CIPHER_MODULE_DISABLED */
 }
@@ -562,13 +486,9 @@ psa_status_t psa_hash_setup(psa_hash_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_hash_setup,
                           TFM_CRYPTO_HASH_SETUP);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_HASH_MODULE_DISABLED */
 }
@@ -594,13 +514,9 @@ psa_status_t psa_hash_update(psa_hash_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_hash_update,
                           TFM_CRYPTO_HASH_UPDATE);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_HASH_MODULE_DISABLED */
 }
@@ -627,15 +543,11 @@ psa_status_t psa_hash_finish(psa_hash_operation_t *operation,
         {.base = hash, .len = hash_size},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_hash_finish,
                           TFM_CRYPTO_HASH_FINISH);
 
     *hash_length = out_vec[1].len;
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_HASH_MODULE_DISABLED */
 }
@@ -661,13 +573,9 @@ psa_status_t psa_hash_verify(psa_hash_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_hash_verify,
                           TFM_CRYPTO_HASH_VERIFY);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_HASH_MODULE_DISABLED */
 }
@@ -690,13 +598,9 @@ psa_status_t psa_hash_abort(psa_hash_operation_t *operation)
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_hash_abort,
                           TFM_CRYPTO_HASH_ABORT);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_HASH_MODULE_DISABLED */
 }
@@ -724,13 +628,9 @@ psa_status_t psa_hash_clone(const psa_hash_operation_t *source_operation,
         return PSA_ERROR_BAD_STATE;
     }
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_hash_clone,
                           TFM_CRYPTO_HASH_CLONE);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_HASH_MODULE_DISABLED */
 }
@@ -760,15 +660,11 @@ psa_status_t psa_hash_compute(psa_algorithm_t alg,
         {.base = hash, .len = hash_size}
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_hash_compute,
                           TFM_CRYPTO_HASH_COMPUTE);
 
     *hash_length = out_vec[0].len;
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_HASH_MODULE_DISABLED */
 }
@@ -794,13 +690,9 @@ psa_status_t psa_hash_compare(psa_algorithm_t alg,
         {.base = hash, .len = hash_length},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH_NO_OUTVEC(tfm_crypto_hash_compare,
                           TFM_CRYPTO_HASH_COMPARE);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_HASH_MODULE_DISABLED */
 }
@@ -829,13 +721,9 @@ psa_status_t psa_mac_sign_setup(psa_mac_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_mac_sign_setup,
                           TFM_CRYPTO_MAC_SIGN_SETUP);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_MAC_MODULE_DISABLED */
 }
@@ -862,13 +750,9 @@ psa_status_t psa_mac_verify_setup(psa_mac_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_mac_verify_setup,
                           TFM_CRYPTO_MAC_VERIFY_SETUP);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_MAC_MODULE_DISABLED */
 }
@@ -894,13 +778,9 @@ psa_status_t psa_mac_update(psa_mac_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_mac_update,
                           TFM_CRYPTO_MAC_UPDATE);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_MAC_MODULE_DISABLED */
 }
@@ -927,15 +807,11 @@ psa_status_t psa_mac_sign_finish(psa_mac_operation_t *operation,
         {.base = mac, .len = mac_size},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_mac_sign_finish,
                           TFM_CRYPTO_MAC_SIGN_FINISH);
 
     *mac_length = out_vec[1].len;
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_MAC_MODULE_DISABLED */
 }
@@ -961,13 +837,9 @@ psa_status_t psa_mac_verify_finish(psa_mac_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_mac_verify_finish,
                           TFM_CRYPTO_MAC_VERIFY_FINISH);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_MAC_MODULE_DISABLED */
 }
@@ -990,13 +862,9 @@ psa_status_t psa_mac_abort(psa_mac_operation_t *operation)
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_mac_abort,
                           TFM_CRYPTO_MAC_ABORT);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_MAC_MODULE_DISABLED */
 }
@@ -1049,19 +917,15 @@ psa_status_t psa_aead_encrypt(psa_key_handle_t handle,
         }
     }
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     size_t in_len = ARRAY_SIZE(in_vec);
     if (additional_data == NULL) {
         in_len--;
     }
-    status = psa_call(ipc_handle, PSA_IPC_CALL, in_vec, in_len,
+    status = psa_call(TFM_CRYPTO_HANDLE, PSA_IPC_CALL, in_vec, in_len,
                       out_vec, ARRAY_SIZE(out_vec));
 
     *ciphertext_length = out_vec[0].len;
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_AEAD_MODULE_DISABLED */
 }
@@ -1114,19 +978,15 @@ psa_status_t psa_aead_decrypt(psa_key_handle_t handle,
         }
     }
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     size_t in_len = ARRAY_SIZE(in_vec);
     if (additional_data == NULL) {
         in_len--;
     }
-    status = psa_call(ipc_handle, PSA_IPC_CALL, in_vec, in_len,
+    status = psa_call(TFM_CRYPTO_HANDLE, PSA_IPC_CALL, in_vec, in_len,
                       out_vec, ARRAY_SIZE(out_vec));
 
     *plaintext_length = out_vec[0].len;
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_AEAD_MODULE_DISABLED */
 }
@@ -1168,15 +1028,11 @@ psa_status_t psa_sign_hash(psa_key_handle_t handle,
         {.base = signature, .len = signature_size},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_sign_hash,
                           TFM_CRYPTO_SIGN_HASH);
 
     *signature_length = out_vec[0].len;
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_ASYMMETRIC_MODULE_DISABLED */
 }
@@ -1214,13 +1070,9 @@ psa_status_t psa_verify_hash(psa_key_handle_t handle,
         {.base = signature, .len = signature_length}
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH_NO_OUTVEC(tfm_crypto_verify_hash,
                                     TFM_CRYPTO_VERIFY_HASH);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_ASYMMETRIC_MODULE_DISABLED */
 }
@@ -1260,19 +1112,15 @@ psa_status_t psa_asymmetric_encrypt(psa_key_handle_t handle,
         {.base = output, .len = output_size},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     size_t in_len = ARRAY_SIZE(in_vec);
     if (salt == NULL) {
         in_len--;
     }
-    status = psa_call(ipc_handle, PSA_IPC_CALL, in_vec, in_len,
+    status = psa_call(TFM_CRYPTO_HANDLE, PSA_IPC_CALL, in_vec, in_len,
                       out_vec, ARRAY_SIZE(out_vec));
 
     *output_length = out_vec[0].len;
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_ASYMMETRIC_MODULE_DISABLED */
 }
@@ -1312,19 +1160,15 @@ psa_status_t psa_asymmetric_decrypt(psa_key_handle_t handle,
         {.base = output, .len = output_size},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     size_t in_len = ARRAY_SIZE(in_vec);
     if (salt == NULL) {
         in_len--;
     }
-    status = psa_call(ipc_handle, PSA_IPC_CALL, in_vec, in_len,
+    status = psa_call(TFM_CRYPTO_HANDLE, PSA_IPC_CALL, in_vec, in_len,
                       out_vec, ARRAY_SIZE(out_vec));
 
     *output_length = out_vec[0].len;
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_ASYMMETRIC_MODULE_DISABLED */
 }
@@ -1350,13 +1194,9 @@ psa_status_t psa_key_derivation_get_capacity(
         {.base = capacity, .len = sizeof(size_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_key_derivation_get_capacity,
                           TFM_CRYPTO_KEY_DERIVATION_GET_CAPACITY);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1383,13 +1223,9 @@ psa_status_t psa_key_derivation_output_bytes(
         {.base = output, .len = output_length},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_key_derivation_output_bytes,
                           TFM_CRYPTO_KEY_DERIVATION_OUTPUT_BYTES);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1414,13 +1250,9 @@ psa_status_t psa_key_derivation_input_key(
         {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH_NO_OUTVEC(tfm_crypto_key_derivation_input_key,
                                     TFM_CRYPTO_KEY_DERIVATION_INPUT_KEY);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1445,13 +1277,9 @@ psa_status_t psa_key_derivation_abort(
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_key_derivation_abort,
                           TFM_CRYPTO_KEY_DERIVATION_ABORT);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1479,13 +1307,9 @@ psa_status_t psa_key_derivation_key_agreement(
         {.base = peer_key, .len = peer_key_length},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH_NO_OUTVEC(tfm_crypto_key_derivation_key_agreement,
                                     TFM_CRYPTO_KEY_DERIVATION_KEY_AGREEMENT);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1513,13 +1337,9 @@ psa_status_t psa_generate_random(uint8_t *output,
         return PSA_SUCCESS;
     }
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_generate_random,
                           TFM_CRYPTO_GENERATE_RANDOM);
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1544,12 +1364,8 @@ psa_status_t psa_generate_key(const psa_key_attributes_t *attributes,
         {.base = handle, .len = sizeof(psa_key_handle_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_generate_key,
                           TFM_CRYPTO_GENERATE_KEY);
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1714,15 +1530,11 @@ psa_status_t psa_raw_key_agreement(psa_algorithm_t alg,
         {.base = output, .len = output_size},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_raw_key_agreement,
                           TFM_CRYPTO_RAW_KEY_AGREEMENT);
 
     *output_length = out_vec[0].len;
 
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1747,12 +1559,8 @@ psa_status_t psa_key_derivation_setup(psa_key_derivation_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_key_derivation_setup,
                           TFM_CRYPTO_KEY_DERIVATION_SETUP);
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1775,12 +1583,8 @@ psa_status_t psa_key_derivation_set_capacity(
         {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH_NO_OUTVEC(tfm_crypto_key_derivation_set_capacity,
                                     TFM_CRYPTO_KEY_DERIVATION_SET_CAPACITY);
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1806,12 +1610,8 @@ psa_status_t psa_key_derivation_input_bytes(
         {.base = data, .len = data_length},
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH_NO_OUTVEC(tfm_crypto_key_derivation_input_bytes,
                                     TFM_CRYPTO_KEY_DERIVATION_INPUT_BYTES);
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1839,12 +1639,8 @@ psa_status_t psa_key_derivation_output_key(
         {.base = handle, .len = sizeof(psa_key_handle_t)}
     };
 
-    PSA_CONNECT(TFM_CRYPTO);
-
     status = API_DISPATCH(tfm_crypto_key_derivation_output_key,
                           TFM_CRYPTO_KEY_DERIVATION_OUTPUT_KEY);
-    PSA_CLOSE();
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1918,3 +1714,135 @@ psa_status_t psa_aead_update(psa_aead_operation_t *operation,
 
     return status;
 }
+
+static uint32_t *tfm_crypto_batch_entry_handle(
+                                            const psa_batch_entry_t *entry,
+                                            uint32_t *sfn_id)
+{
+    switch (entry->type) {
+    case PSA_BATCH_HASH_UPDATE:
+        *sfn_id = TFM_CRYPTO_HASH_UPDATE_SID;
+        return &entry->operation.hash->handle;
+    case PSA_BATCH_MAC_UPDATE:
+        *sfn_id = TFM_CRYPTO_MAC_UPDATE_SID;
+        return &entry->operation.mac->handle;
+    case PSA_BATCH_CIPHER_UPDATE:
+        *sfn_id = TFM_CRYPTO_CIPHER_UPDATE_SID;
+        return &entry->operation.cipher->handle;
+    default:
+        *sfn_id = TFM_CRYPTO_SID_INVALID;
+        return NULL;
+    }
+}
+
+psa_status_t psa_batch_update(psa_batch_entry_t *entries,
+                              size_t entry_count,
+                              const uint8_t *input,
+                              size_t input_length,
+                              uint8_t *output,
+                              size_t output_size)
+{
+    psa_status_t status = PSA_SUCCESS;
+    struct tfm_crypto_batch_entry batch[TFM_CRYPTO_BATCH_MAX_ENTRIES];
+    struct tfm_crypto_batch_result results[TFM_CRYPTO_BATCH_MAX_ENTRIES];
+    size_t input_used = 0, output_used = 0;
+    size_t nr_entries, i;
+    uint32_t *handle;
+    uint32_t sfn_id;
+    struct tfm_crypto_pack_iovec iov = {
+        .sfn_id = TFM_CRYPTO_BATCH_UPDATE_SID,
+    };
+
+    psa_invec in_vec[] = {
+        {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
+        {.base = batch, .len = 0},
+        {.base = NULL, .len = 0},
+    };
+
+    psa_outvec out_vec[] = {
+        {.base = results, .len = 0},
+        {.base = NULL, .len = 0},
+    };
+
+    /* Check the whole batch before running any of it */
+    for (i = 0; i < entry_count; i++) {
+        if ((tfm_crypto_batch_entry_handle(&entries[i], &sfn_id) == NULL) ||
+            (entries[i].input_length > input_length - input_used)) {
+            return PSA_ERROR_INVALID_ARGUMENT;
+        }
+        input_used += entries[i].input_length;
+
+        if (sfn_id == TFM_CRYPTO_CIPHER_UPDATE_SID) {
+            if (entries[i].output_size > output_size - output_used) {
+                return PSA_ERROR_INVALID_ARGUMENT;
+            }
+            output_used += entries[i].output_size;
+        }
+    }
+
+    for (i = 0; i < entry_count; i++) {
+        entries[i].output_length = 0;
+        entries[i].status = PSA_ERROR_BAD_STATE;
+    }
+
+    /*
+     * Send the entries to the service in groups of at most
+     * TFM_CRYPTO_BATCH_MAX_ENTRIES entries and TFM_CRYPTO_BATCH_MAX_PAYLOAD
+     * bytes of input and output. An entry above the payload limit is sent in
+     * a group of its own, as the single update call would send it.
+     */
+    while ((entry_count > 0) && (status == PSA_SUCCESS)) {
+        input_used = 0;
+        output_used = 0;
+
+        for (i = 0; (i < entry_count) && (i < TFM_CRYPTO_BATCH_MAX_ENTRIES);
+             i++) {
+            handle = tfm_crypto_batch_entry_handle(&entries[i], &sfn_id);
+
+            batch[i].sfn_id = sfn_id;
+            batch[i].op_handle = *handle;
+            batch[i].input_length = (uint32_t)entries[i].input_length;
+            batch[i].output_size = (sfn_id == TFM_CRYPTO_CIPHER_UPDATE_SID) ?
+                                   (uint32_t)entries[i].output_size : 0;
+
+            if ((i > 0) &&
+                (input_used + output_used + batch[i].input_length +
+                 batch[i].output_size > TFM_CRYPTO_BATCH_MAX_PAYLOAD)) {
+                break;
+            }
+
+            /* Kept as is if the service fails before running the entry */
+            results[i].op_handle = *handle;
+            results[i].status = PSA_ERROR_BAD_STATE;
+            results[i].output_length = 0;
+
+            input_used += batch[i].input_length;
+            output_used += batch[i].output_size;
+        }
+        nr_entries = i;
+
+        in_vec[1].len = nr_entries * sizeof(struct tfm_crypto_batch_entry);
+        in_vec[2].base = input;
+        in_vec[2].len = input_used;
+        out_vec[0].len = nr_entries * sizeof(struct tfm_crypto_batch_result);
+        out_vec[1].base = output;
+        out_vec[1].len = output_used;
+
+        status = API_DISPATCH(tfm_crypto_batch_update,
+                              TFM_CRYPTO_BATCH_UPDATE);
+
+        for (i = 0; i < nr_entries; i++) {
+            *tfm_crypto_batch_entry_handle(&entries[i], &sfn_id) =
+                                                        results[i].op_handle;
+            entries[i].output_length = results[i].output_length;
+            entries[i].status = results[i].status;
+        }
+
+        entries += nr_entries;
+        entry_count -= nr_entries;
+        input += input_used;
+        output += output_used;
+    }
+
+    return status;
+}
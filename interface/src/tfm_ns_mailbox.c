@@ -14,25 +14,97 @@
 /* The pointer to NSPE mailbox queue */
 static struct ns_mailbox_queue_t *mailbox_queue_ptr = NULL;
 
-static inline void clear_queue_slot_empty(uint8_t idx)
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+static struct ns_mailbox_profile_t ns_mailbox_profile;
+#endif
+
+static void mailbox_ring_init(struct mailbox_ring_t *ring)
 {
-    if (idx < NUM_MAILBOX_QUEUE_SLOT) {
-        mailbox_queue_ptr->empty_slots &= ~(1 << idx);
+    uint32_t i;
+
+    ring->enqueue_pos = 0;
+    ring->dequeue_pos = 0;
+
+    for (i = 0; i < MAILBOX_RING_SIZE; i++) {
+        ring->entries[i].seq = i;
     }
 }
 
-static inline void set_queue_slot_empty(uint8_t idx)
+/*
+ * Several non-secure tasks and ISRs can enqueue, and SPE can consume the ring
+ * at the same time. Local interrupts are masked for the few instructions
+ * between claiming a position and publishing its entry. Otherwise a preempted
+ * task would hold the entry, and the ring would look full or empty to every
+ * other task until it resumes. The ring positions of a mailbox queue are only
+ * modified by its own non-secure core, so no exclusive access is required.
+ */
+static bool mailbox_ring_enqueue(struct mailbox_ring_t *ring, uint8_t idx)
 {
-    if (idx < NUM_MAILBOX_QUEUE_SLOT) {
-        mailbox_queue_ptr->empty_slots |= (1 << idx);
+    struct mailbox_ring_entry_t *entry;
+    uint32_t primask = __get_PRIMASK();
+    uint32_t pos;
+
+    __disable_irq();
+
+    pos = ring->enqueue_pos;
+    entry = &ring->entries[pos & (MAILBOX_RING_SIZE - 1)];
+    if (entry->seq != pos) {
+        /*
+         * The ring is full. It holds at most NUM_MAILBOX_QUEUE_SLOT indexes,
+         * so this only happens if the ring is corrupted.
+         */
+        __set_PRIMASK(primask);
+        return false;
     }
+
+    ring->enqueue_pos = pos + 1;
+    entry->slot_idx = idx;
+    /* The slot index must be visible before the entry is published */
+    __DMB();
+    entry->seq = pos + 1;
+
+    __set_PRIMASK(primask);
+
+    return true;
 }
 
-static inline void set_queue_slot_pend(uint8_t idx)
+/*
+ * Several non-secure tasks and ISRs can dequeue, and SPE can produce into the
+ * ring at the same time. Local interrupts are masked for the same reason as in
+ * mailbox_ring_enqueue().
+ */
+static bool mailbox_ring_dequeue(struct mailbox_ring_t *ring, uint8_t *idx)
 {
-    if (idx < NUM_MAILBOX_QUEUE_SLOT) {
-        mailbox_queue_ptr->pend_slots |= (1 << idx);
+    struct mailbox_ring_entry_t *entry;
+    uint32_t primask = __get_PRIMASK();
+    uint32_t pos, slot_idx;
+
+    __disable_irq();
+
+    pos = ring->dequeue_pos;
+    entry = &ring->entries[pos & (MAILBOX_RING_SIZE - 1)];
+    if (entry->seq != pos + 1) {
+        /* The ring is empty */
+        __set_PRIMASK(primask);
+        return false;
+    }
+
+    ring->dequeue_pos = pos + 1;
+    __DMB();
+    slot_idx = entry->slot_idx;
+    /* The slot index must be read before the entry is released */
+    __DMB();
+    entry->seq = pos + MAILBOX_RING_SIZE;
+
+    __set_PRIMASK(primask);
+
+    if (slot_idx >= NUM_MAILBOX_QUEUE_SLOT) {
+        return false;
     }
+
+    *idx = (uint8_t)slot_idx;
+
+    return true;
 }
 
 static inline int32_t get_mailbox_msg_handle(uint8_t idx,
@@ -59,13 +131,6 @@ static inline int32_t get_mailbox_msg_idx(mailbox_msg_handle_t handle,
     return MAILBOX_SUCCESS;
 }
 
-static inline void clear_queue_slot_replied(uint8_t idx)
-{
-    if (idx < NUM_MAILBOX_QUEUE_SLOT) {
-        mailbox_queue_ptr->replied_slots &= ~(1 << idx);
-    }
-}
-
 static inline void set_queue_slot_woken(uint8_t idx)
 {
     if (idx < NUM_MAILBOX_QUEUE_SLOT) {
@@ -89,30 +154,15 @@ static inline void clear_queue_slot_woken(uint8_t idx)
     }
 }
 
-static uint8_t acquire_empty_slot(const struct ns_mailbox_queue_t *queue)
+static uint8_t acquire_empty_slot(struct ns_mailbox_queue_t *queue)
 {
     uint8_t idx;
-    mailbox_queue_status_t status;
 
-    tfm_ns_mailbox_hal_enter_critical();
-    status = queue->empty_slots;
-
-    if (!status) {
+    if (!mailbox_ring_dequeue(&queue->free_ring, &idx)) {
         /* No empty slot */
-        tfm_ns_mailbox_hal_exit_critical();
         return NUM_MAILBOX_QUEUE_SLOT;
     }
 
-    for (idx = 0; idx < NUM_MAILBOX_QUEUE_SLOT; idx++) {
-        if (status & (1 << idx)) {
-            break;
-        }
-    }
-
-    clear_queue_slot_empty(idx);
-
-    tfm_ns_mailbox_hal_exit_critical();
-
     return idx;
 }
 
@@ -123,7 +173,7 @@ static void set_msg_owner(uint8_t idx, const void *owner)
     }
 }
 
-#ifdef TFM_MULTI_CORE_TEST
+#if defined(TFM_MULTI_CORE_TEST) || defined(TFM_MULTI_CORE_MAILBOX_PROFILING)
 /*
  * When NSPE mailbox only covers a single non-secure core, spinlock is only
  * required to disable IRQ.
@@ -137,7 +187,9 @@ static inline void ns_mailbox_spin_unlock(void)
 {
     __enable_irq();
 }
+#endif
 
+#ifdef TFM_MULTI_CORE_TEST
 void tfm_ns_mailbox_tx_stats_init(void)
 {
     if (!mailbox_queue_ptr) {
@@ -150,24 +202,18 @@ void tfm_ns_mailbox_tx_stats_init(void)
 
 static void mailbox_tx_stats_update(struct ns_mailbox_queue_t *ns_queue)
 {
-    mailbox_queue_status_t empty_status;
-    uint8_t idx, nr_empty = 0;
+    uint32_t nr_empty;
 
     if (!ns_queue) {
         return;
     }
 
-    tfm_ns_mailbox_hal_enter_critical();
     /* Count the number of used slots when this tx arrives */
-    empty_status = ns_queue->empty_slots;
-    tfm_ns_mailbox_hal_exit_critical();
-
-    if (empty_status) {
-        for (idx = 0; idx < NUM_MAILBOX_QUEUE_SLOT; idx++) {
-            if (empty_status & (0x1UL << idx)) {
-                nr_empty++;
-            }
-        }
+    nr_empty = ns_queue->free_ring.enqueue_pos -
+               ns_queue->free_ring.dequeue_pos;
+    if (nr_empty > NUM_MAILBOX_QUEUE_SLOT) {
+        /* The positions changed while being read */
+        nr_empty = NUM_MAILBOX_QUEUE_SLOT;
     }
 
     ns_mailbox_spin_lock();
@@ -193,6 +239,54 @@ void tfm_ns_mailbox_stats_avg_slot(struct ns_mailbox_stats_res_t *stats_res)
 }
 #endif
 
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+void tfm_ns_mailbox_profile_reset(void)
+{
+    ns_mailbox_spin_lock();
+    memset(&ns_mailbox_profile, 0, sizeof(ns_mailbox_profile));
+    ns_mailbox_profile.since = tfm_ns_mailbox_hal_get_timestamp();
+    ns_mailbox_spin_unlock();
+}
+
+int32_t tfm_ns_mailbox_profile_get(struct ns_mailbox_profile_t *profile)
+{
+    if (!profile) {
+        return MAILBOX_INVAL_PARAMS;
+    }
+
+    ns_mailbox_spin_lock();
+    memcpy(profile, &ns_mailbox_profile, sizeof(*profile));
+    ns_mailbox_spin_unlock();
+
+    return MAILBOX_SUCCESS;
+}
+
+static void mailbox_profile_queue_full(void)
+{
+    ns_mailbox_spin_lock();
+    ns_mailbox_profile.nr_queue_full++;
+    ns_mailbox_spin_unlock();
+}
+
+/* Record the stages of a replied message, when its owner task is woken up */
+static void mailbox_profile_rx(const struct mailbox_msg_timestamps_t *ts)
+{
+    uint32_t wakeup = tfm_ns_mailbox_hal_get_timestamp();
+
+    ns_mailbox_spin_lock();
+    mailbox_latency_hist_add(&ns_mailbox_profile.pickup,
+                             ts->pickup - ts->enqueue);
+    mailbox_latency_hist_add(&ns_mailbox_profile.service,
+                             ts->reply - ts->pickup);
+    mailbox_latency_hist_add(&ns_mailbox_profile.wakeup, wakeup - ts->reply);
+    mailbox_latency_hist_add(&ns_mailbox_profile.total, wakeup - ts->enqueue);
+    if (!mailbox_sid_stats_add(ns_mailbox_profile.sids, ts->sid)) {
+        ns_mailbox_profile.nr_other_calls++;
+    }
+    ns_mailbox_spin_unlock();
+}
+#endif
+
 mailbox_msg_handle_t tfm_ns_mailbox_tx_client_req(uint32_t call_type,
                                        const struct psa_client_params_t *params,
                                        int32_t client_id)
@@ -212,6 +306,9 @@ mailbox_msg_handle_t tfm_ns_mailbox_tx_client_req(uint32_t call_type,
 
     idx = acquire_empty_slot(mailbox_queue_ptr);
     if (idx >= NUM_MAILBOX_QUEUE_SLOT) {
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+        mailbox_profile_queue_full();
+#endif
         return MAILBOX_QUEUE_FULL;
     }
 
@@ -235,9 +332,27 @@ mailbox_msg_handle_t tfm_ns_mailbox_tx_client_req(uint32_t call_type,
 
     get_mailbox_msg_handle(idx, &handle);
 
-    tfm_ns_mailbox_hal_enter_critical();
-    set_queue_slot_pend(idx);
-    tfm_ns_mailbox_hal_exit_critical();
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+    memset(&mailbox_queue_ptr->queue[idx].ts, 0,
+           sizeof(mailbox_queue_ptr->queue[idx].ts));
+    mailbox_queue_ptr->queue[idx].ts.enqueue =
+                                            tfm_ns_mailbox_hal_get_timestamp();
+#endif
+
+    /* The message must be complete before SPE can fetch the slot */
+    __DMB();
+    if (!mailbox_ring_enqueue(&mailbox_queue_ptr->pend_ring, idx)) {
+        /* pend_ring can only be full if it is corrupted */
+        set_msg_owner(idx, NULL);
+        if (!mailbox_ring_enqueue(&mailbox_queue_ptr->free_ring, idx)) {
+            /* free_ring is corrupted too. Leave the slot out of use. */
+            return MAILBOX_QUEUE_FULL;
+        }
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+        mailbox_profile_queue_full();
+#endif
+        return MAILBOX_QUEUE_FULL;
+    }
 
     tfm_ns_mailbox_hal_notify_peer();
 
@@ -265,18 +380,22 @@ int32_t tfm_ns_mailbox_rx_client_reply(mailbox_msg_handle_t handle,
 
     *reply = mailbox_queue_ptr->queue[idx].reply.return_val;
 
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+    mailbox_profile_rx(&mailbox_queue_ptr->queue[idx].ts);
+#endif
+
     /* Clear up the owner field */
     set_msg_owner(idx, NULL);
 
-    tfm_ns_mailbox_hal_enter_critical();
-    clear_queue_slot_replied(idx);
     clear_queue_slot_woken(idx);
     /*
-     * Make sure that the empty flag is set after all the other status flags are
+     * Make sure that the slot is released after all the other status flags are
      * re-initialized.
      */
-    set_queue_slot_empty(idx);
-    tfm_ns_mailbox_hal_exit_critical();
+    __DMB();
+    if (!mailbox_ring_enqueue(&mailbox_queue_ptr->free_ring, idx)) {
+        return MAILBOX_QUEUE_FULL;
+    }
 
     return MAILBOX_SUCCESS;
 }
@@ -285,7 +404,9 @@ bool tfm_ns_mailbox_is_msg_replied(mailbox_msg_handle_t handle)
 {
     uint8_t idx;
     int32_t ret;
-    mailbox_queue_status_t status;
+#ifndef TFM_MULTI_CORE_MULTI_CLIENT_CALL
+    uint8_t replied;
+#endif
 
     if (!mailbox_queue_ptr) {
         return false;
@@ -300,50 +421,40 @@ bool tfm_ns_mailbox_is_msg_replied(mailbox_msg_handle_t handle)
         return false;
     }
 
-    tfm_ns_mailbox_hal_enter_critical();
-    status = mailbox_queue_ptr->replied_slots;
-    tfm_ns_mailbox_hal_exit_critical();
-
-    if (status & (1 << idx)) {
-        return true;
+#ifndef TFM_MULTI_CORE_MULTI_CLIENT_CALL
+    /*
+     * Without the reply IRQ handler, fetch the replied slots here. Otherwise
+     * the IRQ handler fetches them and wakes up the owner tasks.
+     */
+    while (mailbox_ring_dequeue(&mailbox_queue_ptr->reply_ring, &replied)) {
+        set_queue_slot_woken(replied);
     }
+#endif
 
-    return false;
+    return is_queue_slot_woken(idx);
 }
 
 mailbox_msg_handle_t tfm_ns_mailbox_fetch_reply_msg_isr(void)
 {
     uint8_t idx;
     mailbox_msg_handle_t handle;
-    mailbox_queue_status_t replied_status;
 
     if (!mailbox_queue_ptr) {
         return MAILBOX_MSG_NULL_HANDLE;
     }
 
-    tfm_ns_mailbox_hal_enter_critical_isr();
-    replied_status = mailbox_queue_ptr->replied_slots;
-    tfm_ns_mailbox_hal_exit_critical_isr();
-
-    if (!replied_status) {
+    /* Fetch the earliest replied message */
+    if (!mailbox_ring_dequeue(&mailbox_queue_ptr->reply_ring, &idx)) {
         return MAILBOX_MSG_NULL_HANDLE;
     }
 
-    for (idx = 0; idx < NUM_MAILBOX_QUEUE_SLOT; idx++) {
-        /* Find the first replied message in queue */
-        if (replied_status & (0x1UL << idx)) {
-            tfm_ns_mailbox_hal_enter_critical_isr();
-            clear_queue_slot_replied(idx);
-            set_queue_slot_woken(idx);
-            tfm_ns_mailbox_hal_exit_critical_isr();
+    set_queue_slot_woken(idx);
 
-            if (get_mailbox_msg_handle(idx, &handle) == MAILBOX_SUCCESS) {
-                return handle;
-            }
-       }
+    if (get_mailbox_msg_handle(idx, &handle) != MAILBOX_SUCCESS) {
+        return MAILBOX_MSG_NULL_HANDLE;
     }
 
-    return MAILBOX_MSG_NULL_HANDLE;
+    return handle;
 }
 
 const void *tfm_ns_mailbox_get_msg_owner(mailbox_msg_handle_t handle)
@@ -364,6 +475,7 @@ const void *tfm_ns_mailbox_get_msg_owner(mailbox_msg_handle_t handle)
 int32_t tfm_ns_mailbox_init(struct ns_mailbox_queue_t *queue)
 {
     int32_t ret;
+    uint8_t idx;
 
     if (!queue) {
         return MAILBOX_INVAL_PARAMS;
@@ -376,11 +488,16 @@ int32_t tfm_ns_mailbox_init(struct ns_mailbox_queue_t *queue)
 
     memset(queue, 0, sizeof(*queue));
 
-    /* Initialize empty bitmask */
-    queue->empty_slots =
-            (mailbox_queue_status_t)((1UL << (NUM_MAILBOX_QUEUE_SLOT - 1)) - 1);
-    queue->empty_slots +=
-            (mailbox_queue_status_t)(1UL << (NUM_MAILBOX_QUEUE_SLOT - 1));
+    mailbox_ring_init(&queue->free_ring);
+    mailbox_ring_init(&queue->pend_ring);
+    mailbox_ring_init(&queue->reply_ring);
+
+    /* All the slots are empty */
+    for (idx = 0; idx < NUM_MAILBOX_QUEUE_SLOT; idx++) {
+        if (!mailbox_ring_enqueue(&queue->free_ring, idx)) {
+            return MAILBOX_INIT_ERROR;
+        }
+    }
 
     mailbox_queue_ptr = queue;
 
@@ -391,6 +508,10 @@ int32_t tfm_ns_mailbox_init(struct ns_mailbox_queue_t *queue)
     tfm_ns_mailbox_tx_stats_init();
 #endif
 
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+    tfm_ns_mailbox_profile_reset();
+#endif
+
     return ret;
 }
 
@@ -421,12 +542,9 @@ int32_t tfm_ns_mailbox_wait_reply(mailbox_msg_handle_t handle)
          * Check the completed flag to make sure that the current thread is
          * woken up by reply event, rather than other events.
          */
-        tfm_ns_mailbox_hal_enter_critical();
         if (is_queue_slot_woken(idx)) {
-            tfm_ns_mailbox_hal_exit_critical();
             break;
         }
-        tfm_ns_mailbox_hal_exit_critical();
     }
 
     return MAILBOX_SUCCESS;
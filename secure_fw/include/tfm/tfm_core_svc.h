@@ -41,6 +41,7 @@ typedef enum {
     TFM_SVC_PSA_CLEAR,
     TFM_SVC_PSA_PANIC,
     TFM_SVC_PSA_LIFECYCLE,
+    TFM_SVC_MAP_INVEC,
 #endif
     TFM_SVC_PLATFORM_BASE = 50 /* leave room for additional Core handlers */
 } tfm_svc_number_t;
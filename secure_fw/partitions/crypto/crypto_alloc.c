@@ -5,79 +5,623 @@
  *
  */
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 #include "tfm_mbedcrypto_include.h"
 
+#include "tfm_api.h"
 #include "tfm_crypto_api.h"
 #include "tfm_crypto_defs.h"
 #include "tfm_memory_utils.h"
 
+#ifdef TFM_CRYPTO_OPER_STATS_LOG
+#include "log/tfm_log.h"
+#endif
+
 /**
  * \def TFM_CRYPTO_CONC_OPER_NUM
  *
- * \brief This is the default value for the maximum number of concurrent
- *        operations that can be active (allocated) at any time, supported
- *        by the implementation
+ * \brief This is the default value for the total number of concurrent
+ *        operations that can be active (allocated) at any time, supported by
+ *        the implementation. The contexts which are not reserved for a type
+ *        are shared by all the types.
  */
 #ifndef TFM_CRYPTO_CONC_OPER_NUM
 #define TFM_CRYPTO_CONC_OPER_NUM (8)
 #endif
 
+/**
+ * \def TFM_CRYPTO_CIPHER_OPER_NUM
+ *
+ * \brief Number of contexts reserved for cipher operations
+ */
+#ifndef TFM_CRYPTO_CIPHER_OPER_NUM
+#define TFM_CRYPTO_CIPHER_OPER_NUM (0)
+#endif
+
+/**
+ * \def TFM_CRYPTO_MAC_OPER_NUM
+ *
+ * \brief Number of contexts reserved for MAC operations
+ */
+#ifndef TFM_CRYPTO_MAC_OPER_NUM
+#define TFM_CRYPTO_MAC_OPER_NUM (0)
+#endif
+
+/**
+ * \def TFM_CRYPTO_HASH_OPER_NUM
+ *
+ * \brief Number of contexts reserved for hash operations
+ */
+#ifndef TFM_CRYPTO_HASH_OPER_NUM
+#define TFM_CRYPTO_HASH_OPER_NUM (0)
+#endif
+
+/**
+ * \def TFM_CRYPTO_KEY_DERIVATION_OPER_NUM
+ *
+ * \brief Number of contexts reserved for key derivation operations
+ */
+#ifndef TFM_CRYPTO_KEY_DERIVATION_OPER_NUM
+#define TFM_CRYPTO_KEY_DERIVATION_OPER_NUM (0)
+#endif
+
+/*
+ * A reserved context only takes the size of its own type. The rest of
+ * TFM_CRYPTO_CONC_OPER_NUM are shared contexts, sized for the largest type,
+ * which an operation of any type borrows when the contexts reserved for its
+ * type are all in use. With no context reserved, as by default, every type can
+ * use all the TFM_CRYPTO_CONC_OPER_NUM contexts.
+ */
+#define TFM_CRYPTO_SHARED_OPER_NUM (TFM_CRYPTO_CONC_OPER_NUM -            \
+                                    TFM_CRYPTO_CIPHER_OPER_NUM -          \
+                                    TFM_CRYPTO_MAC_OPER_NUM -             \
+                                    TFM_CRYPTO_HASH_OPER_NUM -            \
+                                    TFM_CRYPTO_KEY_DERIVATION_OPER_NUM)
+
+/**
+ * \def TFM_CRYPTO_S_CLIENT_OPER_QUOTA
+ *
+ * \brief Maximum number of concurrent operations of each type that a secure
+ *        partition can hold. 0 means no quota.
+ */
+#ifndef TFM_CRYPTO_S_CLIENT_OPER_QUOTA
+#define TFM_CRYPTO_S_CLIENT_OPER_QUOTA (0)
+#endif
+
+/**
+ * \def TFM_CRYPTO_NS_CLIENT_OPER_QUOTA
+ *
+ * \brief Maximum number of concurrent operations of each type that a
+ *        non-secure client can hold. 0 means no quota.
+ */
+#ifndef TFM_CRYPTO_NS_CLIENT_OPER_QUOTA
+#define TFM_CRYPTO_NS_CLIENT_OPER_QUOTA (0)
+#endif
+
+/**
+ * \def TFM_CRYPTO_OPER_RECLAIM_AGE
+ *
+ * \brief Number of calls to the operations of a type after which a context of
+ *        that type which has not been used is considered abandoned. When no
+ *        context is free, the allocation reclaims the abandoned context of the
+ *        requesting client idle for the longest time. The contexts of other
+ *        clients are never reclaimed. 0 means contexts are never reclaimed.
+ */
+#ifndef TFM_CRYPTO_OPER_RECLAIM_AGE
+#define TFM_CRYPTO_OPER_RECLAIM_AGE (0)
+#endif
+
+/*
+ * The quotas of specific clients can be set by defining
+ * TFM_CRYPTO_CLIENT_OPER_QUOTAS as a list of {client ID, quota} initializers.
+ * They override the default quota of secure partitions or non-secure clients.
+ */
+#ifdef TFM_CRYPTO_CLIENT_OPER_QUOTAS
+static const struct {
+    int32_t client_id;
+    uint32_t quota;
+} client_quota[] = {
+    TFM_CRYPTO_CLIENT_OPER_QUOTAS
+};
+#endif
+
+/*
+ * An operation handle encodes the operation type, whether the context is a
+ * shared one, the index of the context in its pool and the generation of the
+ * context. The generation is incremented each time the context is released, so
+ * that a stale handle does not refer to a context allocated again later. The
+ * type is never TFM_CRYPTO_OPERATION_NONE, so a valid handle is never
+ * TFM_CRYPTO_INVALID_HANDLE.
+ */
+#define HANDLE_INDEX_MASK    (0xFFu)
+#define HANDLE_GEN_SHIFT     (8)
+#define HANDLE_GEN_MASK      (0xFFFFu)
+#define HANDLE_TYPE_SHIFT    (24)
+#define HANDLE_TYPE_MASK     (0x7Fu)
+#define HANDLE_SHARED        (0x80000000u)
+
+#define HANDLE_MAKE(type, shared, index, gen)                               \
+    (((uint32_t)(type) << HANDLE_TYPE_SHIFT) |                              \
+     ((shared) ? HANDLE_SHARED : 0u) |                                      \
+     ((uint32_t)(gen) << HANDLE_GEN_SHIFT) | (uint32_t)(index))
+#define HANDLE_TYPE(handle)  (((handle) >> HANDLE_TYPE_SHIFT) & HANDLE_TYPE_MASK)
+#define HANDLE_GEN(handle)   (((handle) >> HANDLE_GEN_SHIFT) & HANDLE_GEN_MASK)
+#define HANDLE_INDEX(handle) ((handle) & HANDLE_INDEX_MASK)
+
+#if (TFM_CRYPTO_SHARED_OPER_NUM < 0)
+#error "The reserved contexts must not exceed TFM_CRYPTO_CONC_OPER_NUM"
+#endif
+
+#if (TFM_CRYPTO_CIPHER_OPER_NUM > 255) ||                       \
+    (TFM_CRYPTO_MAC_OPER_NUM > 255) ||                          \
+    (TFM_CRYPTO_HASH_OPER_NUM > 255) ||                         \
+    (TFM_CRYPTO_KEY_DERIVATION_OPER_NUM > 255) ||               \
+    (TFM_CRYPTO_SHARED_OPER_NUM > 255)
+#error "The number of reserved or shared operation contexts must be below 256"
+#endif
+
+#if (TFM_CRYPTO_SHARED_OPER_NUM == 0) &&                                      \
+    ((!defined(TFM_CRYPTO_CIPHER_MODULE_DISABLED) &&                          \
+      (TFM_CRYPTO_CIPHER_OPER_NUM == 0)) ||                                   \
+     (!defined(TFM_CRYPTO_MAC_MODULE_DISABLED) &&                             \
+      (TFM_CRYPTO_MAC_OPER_NUM == 0)) ||                                      \
+     (!defined(TFM_CRYPTO_HASH_MODULE_DISABLED) &&                            \
+      (TFM_CRYPTO_HASH_OPER_NUM == 0)) ||                                     \
+     (!defined(TFM_CRYPTO_GENERATOR_MODULE_DISABLED) &&                       \
+      (TFM_CRYPTO_KEY_DERIVATION_OPER_NUM == 0)))
+#error "An enabled operation type has neither reserved nor shared contexts"
+#endif
+
 struct tfm_crypto_operation_s {
-    uint32_t in_use;                /*!< Indicates if the operation is in use */
     int32_t owner;                  /*!< Indicates an ID of the owner of
                                      *   the context
                                      */
-    enum tfm_crypto_operation_type type; /*!< Type of the operation */
-    union {
-        psa_cipher_operation_t cipher;    /*!< Cipher operation context */
-        psa_mac_operation_t mac;          /*!< MAC operation context */
-        psa_hash_operation_t hash;        /*!< Hash operation context */
-        psa_key_derivation_operation_t key_deriv; /*!< Key derivation operation context */
-    } operation;
+    uint32_t last_used;             /*!< Clock of the operation type when the
+                                     *   context was last allocated or looked
+                                     *   up
+                                     */
+    uint16_t generation;            /*!< Generation of the context, part of
+                                     *   its handle
+                                     */
+    uint8_t in_use;                 /*!< Indicates if the operation is in use */
+    uint8_t next_free;              /*!< Index of the next free context */
+    uint8_t type;                   /*!< Type of the operation using the
+                                     *   context
+                                     */
 };
 
-static struct tfm_crypto_operation_s operation[TFM_CRYPTO_CONC_OPER_NUM] ={{0}};
+/* A pool of contexts, either reserved for one operation type or shared */
+struct tfm_crypto_operation_pool_s {
+    uint8_t *ctx;                   /*!< Array of the backend contexts */
+    size_t ctx_size;                /*!< Size of a backend context */
+    struct tfm_crypto_operation_s *operation; /*!< Array of the contexts
+                                               *   allocation data
+                                               */
+    uint8_t num;                    /*!< Number of contexts in the pool */
+    uint8_t free_head;              /*!< Index of the first free context, or
+                                     *   num if none is free
+                                     */
+};
+
+#define OPERATION_POOL(ctx_array, operation_array)                          \
+    {(uint8_t *)(ctx_array), sizeof((ctx_array)[0]), (operation_array),     \
+     sizeof(operation_array) / sizeof((operation_array)[0]), 0}
+
+#if !defined(TFM_CRYPTO_CIPHER_MODULE_DISABLED) && \
+    (TFM_CRYPTO_CIPHER_OPER_NUM > 0)
+#define CIPHER_POOL
+static psa_cipher_operation_t cipher_ctx[TFM_CRYPTO_CIPHER_OPER_NUM];
+static struct tfm_crypto_operation_s
+                                 cipher_operation[TFM_CRYPTO_CIPHER_OPER_NUM];
+#endif
+#if !defined(TFM_CRYPTO_MAC_MODULE_DISABLED) && (TFM_CRYPTO_MAC_OPER_NUM > 0)
+#define MAC_POOL
+static psa_mac_operation_t mac_ctx[TFM_CRYPTO_MAC_OPER_NUM];
+static struct tfm_crypto_operation_s mac_operation[TFM_CRYPTO_MAC_OPER_NUM];
+#endif
+#if !defined(TFM_CRYPTO_HASH_MODULE_DISABLED) && (TFM_CRYPTO_HASH_OPER_NUM > 0)
+#define HASH_POOL
+static psa_hash_operation_t hash_ctx[TFM_CRYPTO_HASH_OPER_NUM];
+static struct tfm_crypto_operation_s hash_operation[TFM_CRYPTO_HASH_OPER_NUM];
+#endif
+#if !defined(TFM_CRYPTO_GENERATOR_MODULE_DISABLED) && \
+    (TFM_CRYPTO_KEY_DERIVATION_OPER_NUM > 0)
+#define KEY_DERIV_POOL
+static psa_key_derivation_operation_t
+                            key_deriv_ctx[TFM_CRYPTO_KEY_DERIVATION_OPER_NUM];
+static struct tfm_crypto_operation_s
+                      key_deriv_operation[TFM_CRYPTO_KEY_DERIVATION_OPER_NUM];
+#endif
+
+/* The pools of reserved contexts, indexed by operation type */
+static struct tfm_crypto_operation_pool_s
+                            pool[TFM_CRYPTO_KEY_DERIVATION_OPERATION + 1] = {
+#ifdef CIPHER_POOL
+    [TFM_CRYPTO_CIPHER_OPERATION] = OPERATION_POOL(cipher_ctx,
+                                                   cipher_operation),
+#endif
+#ifdef MAC_POOL
+    [TFM_CRYPTO_MAC_OPERATION] = OPERATION_POOL(mac_ctx, mac_operation),
+#endif
+#ifdef HASH_POOL
+    [TFM_CRYPTO_HASH_OPERATION] = OPERATION_POOL(hash_ctx, hash_operation),
+#endif
+#ifdef KEY_DERIV_POOL
+    [TFM_CRYPTO_KEY_DERIVATION_OPERATION] = OPERATION_POOL(key_deriv_ctx,
+                                                       key_deriv_operation),
+#endif
+};
+
+#define NUM_POOLS (sizeof(pool) / sizeof(pool[0]))
+
+#if TFM_CRYPTO_SHARED_OPER_NUM > 0
+/* A shared context holds the backend context of any type */
+union tfm_crypto_shared_ctx_u {
+    psa_cipher_operation_t cipher;
+    psa_mac_operation_t mac;
+    psa_hash_operation_t hash;
+    psa_key_derivation_operation_t key_deriv;
+};
+
+static union tfm_crypto_shared_ctx_u shared_ctx[TFM_CRYPTO_SHARED_OPER_NUM];
+static struct tfm_crypto_operation_s
+                                 shared_operation[TFM_CRYPTO_SHARED_OPER_NUM];
+
+static struct tfm_crypto_operation_pool_s shared_pool =
+                                OPERATION_POOL(shared_ctx, shared_operation);
+#else
+static struct tfm_crypto_operation_pool_s shared_pool;
+#endif
+
+/* The operation types of the enabled modules */
+static const bool type_enabled[NUM_POOLS] = {
+#ifndef TFM_CRYPTO_CIPHER_MODULE_DISABLED
+    [TFM_CRYPTO_CIPHER_OPERATION] = true,
+#endif
+#ifndef TFM_CRYPTO_MAC_MODULE_DISABLED
+    [TFM_CRYPTO_MAC_OPERATION] = true,
+#endif
+#ifndef TFM_CRYPTO_HASH_MODULE_DISABLED
+    [TFM_CRYPTO_HASH_OPERATION] = true,
+#endif
+#ifndef TFM_CRYPTO_GENERATOR_MODULE_DISABLED
+    [TFM_CRYPTO_KEY_DERIVATION_OPERATION] = true,
+#endif
+};
+
+/* Incremented on each allocation or lookup of an operation type */
+static uint32_t type_clock[NUM_POOLS];
+
+/* The utilization counters of each operation type */
+static struct tfm_crypto_operation_stats_t type_stats[NUM_POOLS];
+
+/*
+ * \brief Function used to find the context referred to by a handle
+ *
+ * \param[in]  handle       Handle of the context
+ * \param[in]  partition_id ID of the caller, which must own the context
+ * \param[out] index        Index of the context in its pool
+ *
+ * \return The pool of the context, or NULL if the handle does not refer to a
+ *         context in use owned by the caller
+ *
+ */
+static struct tfm_crypto_operation_pool_s *get_pool(uint32_t handle,
+                                                    int32_t partition_id,
+                                                    uint32_t *index)
+{
+    struct tfm_crypto_operation_pool_s *p;
+    struct tfm_crypto_operation_s *op;
+    uint32_t type = HANDLE_TYPE(handle);
+
+    if ((type == TFM_CRYPTO_OPERATION_NONE) || (type >= NUM_POOLS)) {
+        return NULL;
+    }
+
+    p = (handle & HANDLE_SHARED) ? &shared_pool : &pool[type];
+    *index = HANDLE_INDEX(handle);
+    if (*index >= p->num) {
+        return NULL;
+    }
+
+    /* A shared context is only valid for the type it was allocated for */
+    op = &p->operation[*index];
+    if ((op->in_use != TFM_CRYPTO_IN_USE) ||
+        (op->type != type) ||
+        (op->generation != HANDLE_GEN(handle)) ||
+        (op->owner != partition_id)) {
+        return NULL;
+    }
+
+    return p;
+}
+
+/*
+ * \brief Function used to get the quota of a client
+ *
+ * \param[in] client_id ID of the client
+ *
+ * \return The maximum number of concurrent operations of each type the client
+ *         can hold, or 0 if the client has no quota
+ *
+ */
+static uint32_t get_client_quota(int32_t client_id)
+{
+#ifdef TFM_CRYPTO_CLIENT_OPER_QUOTAS
+    uint32_t i;
+
+    for (i = 0; i < sizeof(client_quota) / sizeof(client_quota[0]); i++) {
+        if (client_quota[i].client_id == client_id) {
+            return client_quota[i].quota;
+        }
+    }
+#endif
+
+    if (TFM_CLIENT_ID_IS_NS(client_id)) {
+        return TFM_CRYPTO_NS_CLIENT_OPER_QUOTA;
+    }
+
+    return TFM_CRYPTO_S_CLIENT_OPER_QUOTA;
+}
+
+/*
+ * \brief Function used to count the contexts of a type held by a client in a
+ *        pool
+ *
+ * \param[in] p         Pool of the contexts
+ * \param[in] type      Type of the operations
+ * \param[in] client_id ID of the client
+ *
+ * \return The number of contexts
+ *
+ */
+static uint32_t count_client_operations(
+                                    const struct tfm_crypto_operation_pool_s *p,
+                                    uint32_t type, int32_t client_id)
+{
+    uint32_t i, count = 0;
+
+    for (i = 0; i < p->num; i++) {
+        if ((p->operation[i].in_use == TFM_CRYPTO_IN_USE) &&
+            (p->operation[i].type == type) &&
+            (p->operation[i].owner == client_id)) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/*
+ * \brief Function used to check whether a client has reached its quota of
+ *        contexts of a type
+ *
+ * \param[in] type      Type of the operations
+ * \param[in] client_id ID of the client
+ *
+ * \return true if the client cannot allocate another context of the type
+ *
+ */
+static bool is_client_over_quota(uint32_t type, int32_t client_id)
+{
+    uint32_t quota = get_client_quota(client_id);
+
+    if ((quota == 0) || (quota >= type_stats[type].num)) {
+        return false;
+    }
+
+    return (count_client_operations(&pool[type], type, client_id) +
+            count_client_operations(&shared_pool, type, client_id)) >= quota;
+}
+
+/*
+ * \brief Function used to take a context from the free list of a pool
+ *
+ * \param[in] p         Pool of the contexts
+ * \param[in] type      Type of the operation
+ * \param[in] client_id ID of the client which owns the context
+ *
+ * \return The index of the context in the pool, or the number of contexts of
+ *         the pool if none is free
+ *
+ */
+static uint32_t take_operation(struct tfm_crypto_operation_pool_s *p,
+                               uint32_t type, int32_t client_id)
+{
+    struct tfm_crypto_operation_s *op;
+    uint32_t index = p->free_head;
+
+    if (index >= p->num) {
+        return p->num;
+    }
+
+    op = &p->operation[index];
+    p->free_head = op->next_free;
+
+    op->in_use = TFM_CRYPTO_IN_USE;
+    op->type = (uint8_t)type;
+    op->owner = client_id;
+    op->last_used = ++type_clock[type];
+
+    return index;
+}
+
+/*
+ * \brief Function used to put a context back to the free list of its pool
+ *
+ * \param[in] p     Pool of the context
+ * \param[in] index Index of the context in the pool
+ *
+ * \return None
+ *
+ */
+static void free_operation(struct tfm_crypto_operation_pool_s *p,
+                           uint32_t index)
+{
+    struct tfm_crypto_operation_s *op = &p->operation[index];
+
+    /* Clear the contents of the backend context */
+    (void)tfm_memset(&p->ctx[index * p->ctx_size], 0, p->ctx_size);
+
+    type_stats[op->type].in_use--;
+
+    op->in_use = TFM_CRYPTO_NOT_IN_USE;
+    op->type = TFM_CRYPTO_OPERATION_NONE;
+    op->owner = 0;
+    op->generation = (op->generation + 1) & HANDLE_GEN_MASK;
+    op->next_free = p->free_head;
+    p->free_head = index;
+}
 
+#ifdef TFM_CRYPTO_OPER_STATS_LOG
 /*
- * \brief Function used to clear the memory associated to a backend context
+ * \brief Function used to log the utilization counters of an operation type,
+ *        when an allocation of the type fails or reclaims a context
  *
- * \param[in] index Numerical index in the database of the backend contexts
+ * \param[in] type Type of the operations
  *
  * \return None
  *
  */
-static void memset_operation_context(uint32_t index)
+static void log_operation_stats(uint32_t type)
 {
-    uint32_t mem_size;
+    struct tfm_crypto_operation_stats_t stats;
+
+    if (tfm_crypto_operation_get_stats((enum tfm_crypto_operation_type)type,
+                                       &stats) != PSA_SUCCESS) {
+        return;
+    }
 
-    uint8_t *mem_ptr = (uint8_t *) &(operation[index].operation);
+    LOG_MSG("[Crypto] Operation type %u: %u/%u in use, peak %u, "
+            "%u allocated, %u borrowed, %u exhausted, %u over quota, "
+            "%u reclaimed\r\n",
+            type, stats.in_use, stats.num, stats.peak_in_use, stats.nr_alloc,
+            stats.nr_borrowed, stats.nr_exhausted, stats.nr_over_quota,
+            stats.nr_reclaimed);
+}
+#define LOG_OPERATION_STATS(type) log_operation_stats(type)
+#else
+#define LOG_OPERATION_STATS(type)
+#endif /* TFM_CRYPTO_OPER_STATS_LOG */
 
-    switch(operation[index].type) {
+#if TFM_CRYPTO_OPER_RECLAIM_AGE != 0
+/*
+ * \brief Function used to abort the backend operation of a context
+ *
+ * \param[in] type Type of the operation
+ * \param[in] ctx  Backend context
+ *
+ * \return None
+ *
+ */
+static void abort_operation(uint32_t type, void *ctx)
+{
+    switch (type) {
+#ifndef TFM_CRYPTO_CIPHER_MODULE_DISABLED
     case TFM_CRYPTO_CIPHER_OPERATION:
-        mem_size = sizeof(psa_cipher_operation_t);
+        (void)psa_cipher_abort((psa_cipher_operation_t *)ctx);
         break;
+#endif
+#ifndef TFM_CRYPTO_MAC_MODULE_DISABLED
     case TFM_CRYPTO_MAC_OPERATION:
-        mem_size = sizeof(psa_mac_operation_t);
+        (void)psa_mac_abort((psa_mac_operation_t *)ctx);
         break;
+#endif
+#ifndef TFM_CRYPTO_HASH_MODULE_DISABLED
     case TFM_CRYPTO_HASH_OPERATION:
-        mem_size = sizeof(psa_hash_operation_t);
+        (void)psa_hash_abort((psa_hash_operation_t *)ctx);
         break;
+#endif
+#ifndef TFM_CRYPTO_GENERATOR_MODULE_DISABLED
     case TFM_CRYPTO_KEY_DERIVATION_OPERATION:
-        mem_size = sizeof(psa_key_derivation_operation_t);
+        (void)psa_key_derivation_abort(
+                                    (psa_key_derivation_operation_t *)ctx);
         break;
-    case TFM_CRYPTO_OPERATION_NONE:
+#endif
     default:
-        mem_size = 0;
         break;
     }
+}
 
-    /* Clear the contents of the backend context */
-    (void)tfm_memset(mem_ptr, 0, mem_size);
+/*
+ * \brief Function used to find the context of a type held by a client in a
+ *        pool which has been idle for the longest time, if it has been idle
+ *        for at least TFM_CRYPTO_OPER_RECLAIM_AGE calls
+ *
+ * \param[in]     p          Pool of the contexts
+ * \param[in]     type       Type of the operations
+ * \param[in]     client_id  ID of the client
+ * \param[in,out] victim_age Age of the oldest context found so far, updated
+ *                           if an older one is found in the pool
+ *
+ * \return The index of the context, or the number of contexts of the pool if
+ *         no older context is found
+ *
+ */
+static uint32_t find_idle_operation(const struct tfm_crypto_operation_pool_s *p,
+                                    uint32_t type, int32_t client_id,
+                                    uint32_t *victim_age)
+{
+    uint32_t i, age, victim = p->num;
+
+    for (i = 0; i < p->num; i++) {
+        if ((p->operation[i].in_use != TFM_CRYPTO_IN_USE) ||
+            (p->operation[i].type != type) ||
+            (p->operation[i].owner != client_id)) {
+            continue;
+        }
+
+        age = type_clock[type] - p->operation[i].last_used;
+        if ((age >= TFM_CRYPTO_OPER_RECLAIM_AGE) && (age >= *victim_age)) {
+            victim = i;
+            *victim_age = age;
+        }
+    }
+
+    return victim;
 }
 
+/*
+ * \brief Function used to reclaim the context of a type held by a client which
+ *        has been idle for the longest time, if it has been idle for at least
+ *        TFM_CRYPTO_OPER_RECLAIM_AGE calls. The backend operation is aborted,
+ *        and the handle held by the client becomes stale. Only the contexts of
+ *        the requesting client are reclaimed, so that a client cannot
+ *        invalidate the operations of another client.
+ *
+ * \param[in] type      Type of the operations
+ * \param[in] client_id ID of the client requesting a context
+ *
+ * \return None
+ *
+ */
+static void reclaim_operation(uint32_t type, int32_t client_id)
+{
+    struct tfm_crypto_operation_pool_s *p = &pool[type];
+    uint32_t victim, shared_victim, victim_age = 0;
+
+    victim = find_idle_operation(p, type, client_id, &victim_age);
+    shared_victim = find_idle_operation(&shared_pool, type, client_id,
+                                        &victim_age);
+    if (shared_victim < shared_pool.num) {
+        p = &shared_pool;
+        victim = shared_victim;
+    }
+
+    if (victim >= p->num) {
+        return;
+    }
+
+    abort_operation(type, &p->ctx[victim * p->ctx_size]);
+    free_operation(p, victim);
+    type_stats[type].nr_reclaimed++;
+    LOG_OPERATION_STATS(type);
+}
+#endif
+
 /*!
  * \defgroup public Public functions
  *
@@ -86,8 +630,35 @@ static void memset_operation_context(uint32_t index)
 /*!@{*/
 psa_status_t tfm_crypto_init_alloc(void)
 {
-    /* Clear the contents of the local contexts */
-    (void)tfm_memset(operation, 0, sizeof(operation));
+    struct tfm_crypto_operation_pool_s *p;
+    uint32_t i, j;
+
+    for (i = 0; i <= NUM_POOLS; i++) {
+        p = (i < NUM_POOLS) ? &pool[i] : &shared_pool;
+        if (p->num == 0) {
+            continue;
+        }
+
+        /* Clear the contents of the local contexts */
+        (void)tfm_memset(p->ctx, 0, p->num * p->ctx_size);
+        (void)tfm_memset(p->operation, 0, p->num * sizeof(p->operation[0]));
+
+        /* Chain all the contexts in the free list */
+        for (j = 0; j < p->num; j++) {
+            p->operation[j].in_use = TFM_CRYPTO_NOT_IN_USE;
+            p->operation[j].next_free = j + 1;
+        }
+        p->free_head = 0;
+    }
+
+    for (i = 0; i < NUM_POOLS; i++) {
+        type_clock[i] = 0;
+        (void)tfm_memset(&type_stats[i], 0, sizeof(type_stats[i]));
+        if (type_enabled[i]) {
+            type_stats[i].num = pool[i].num + shared_pool.num;
+        }
+    }
+
     return PSA_SUCCESS;
 }
 
@@ -95,7 +666,8 @@ psa_status_t tfm_crypto_operation_alloc(enum tfm_crypto_operation_type type,
                                         uint32_t *handle,
                                         void **ctx)
 {
-    uint32_t i = 0;
+    struct tfm_crypto_operation_pool_s *p;
+    uint32_t index;
     int32_t partition_id = 0;
     psa_status_t status;
 
@@ -115,23 +687,53 @@ psa_status_t tfm_crypto_operation_alloc(enum tfm_crypto_operation_type type,
     }
     *ctx = NULL;
 
-    for (i=0; i<TFM_CRYPTO_CONC_OPER_NUM; i++) {
-        if (operation[i].in_use == TFM_CRYPTO_NOT_IN_USE) {
-            operation[i].in_use = TFM_CRYPTO_IN_USE;
-            operation[i].owner = partition_id;
-            operation[i].type = type;
-            *handle = i + 1;
-            *ctx = (void *) &(operation[i].operation);
-            return PSA_SUCCESS;
+    if ((type == TFM_CRYPTO_OPERATION_NONE) ||
+        ((uint32_t)type >= NUM_POOLS) || !type_enabled[type]) {
+        return PSA_ERROR_NOT_PERMITTED;
+    }
+
+    if (is_client_over_quota(type, partition_id)) {
+        type_stats[type].nr_over_quota++;
+        LOG_OPERATION_STATS(type);
+        return PSA_ERROR_NOT_PERMITTED;
+    }
+
+#if TFM_CRYPTO_OPER_RECLAIM_AGE != 0
+    if ((pool[type].free_head >= pool[type].num) &&
+        (shared_pool.free_head >= shared_pool.num)) {
+        reclaim_operation(type, partition_id);
+    }
+#endif
+
+    /* Use a reserved context first, then borrow a shared one */
+    p = &pool[type];
+    index = take_operation(p, type, partition_id);
+    if (index >= p->num) {
+        p = &shared_pool;
+        index = take_operation(p, type, partition_id);
+        if (index >= p->num) {
+            type_stats[type].nr_exhausted++;
+            LOG_OPERATION_STATS(type);
+            return PSA_ERROR_NOT_PERMITTED;
         }
+        type_stats[type].nr_borrowed++;
+    }
+
+    type_stats[type].nr_alloc++;
+    if (++type_stats[type].in_use > type_stats[type].peak_in_use) {
+        type_stats[type].peak_in_use = type_stats[type].in_use;
     }
+    *handle = HANDLE_MAKE(type, p == &shared_pool, index,
+                          p->operation[index].generation);
+    *ctx = (void *)&p->ctx[index * p->ctx_size];
 
-    return PSA_ERROR_NOT_PERMITTED;
+    return PSA_SUCCESS;
 }
 
 psa_status_t tfm_crypto_operation_release(uint32_t *handle)
 {
-    uint32_t h_val = *handle;
+    struct tfm_crypto_operation_pool_s *p;
+    uint32_t index;
     int32_t partition_id = 0;
     psa_status_t status;
 
@@ -140,26 +742,24 @@ psa_status_t tfm_crypto_operation_release(uint32_t *handle)
         return status;
     }
 
-    if ( (h_val != TFM_CRYPTO_INVALID_HANDLE) &&
-         (h_val <= TFM_CRYPTO_CONC_OPER_NUM) &&
-         (operation[h_val - 1].in_use == TFM_CRYPTO_IN_USE) &&
-         (operation[h_val - 1].owner == partition_id)) {
-
-        memset_operation_context(h_val - 1);
-        operation[h_val - 1].in_use = TFM_CRYPTO_NOT_IN_USE;
-        operation[h_val - 1].type = TFM_CRYPTO_OPERATION_NONE;
-        operation[h_val - 1].owner = 0;
-        *handle = TFM_CRYPTO_INVALID_HANDLE;
-        return PSA_SUCCESS;
+    p = get_pool(*handle, partition_id, &index);
+    if (p == NULL) {
+        return PSA_ERROR_INVALID_ARGUMENT;
     }
 
-    return PSA_ERROR_INVALID_ARGUMENT;
+    free_operation(p, index);
+
+    *handle = TFM_CRYPTO_INVALID_HANDLE;
+
+    return PSA_SUCCESS;
 }
 
 psa_status_t tfm_crypto_operation_lookup(enum tfm_crypto_operation_type type,
                                          uint32_t handle,
                                          void **ctx)
 {
+    struct tfm_crypto_operation_pool_s *p;
+    uint32_t index;
     int32_t partition_id = 0;
     psa_status_t status;
 
@@ -168,16 +768,32 @@ psa_status_t tfm_crypto_operation_lookup(enum tfm_crypto_operation_type type,
         return status;
     }
 
-    if ( (handle != TFM_CRYPTO_INVALID_HANDLE) &&
-         (handle <= TFM_CRYPTO_CONC_OPER_NUM) &&
-         (operation[handle - 1].in_use == TFM_CRYPTO_IN_USE) &&
-         (operation[handle - 1].type == type) &&
-         (operation[handle - 1].owner == partition_id)) {
+    if (HANDLE_TYPE(handle) != (uint32_t)type) {
+        return PSA_ERROR_BAD_STATE;
+    }
 
-        *ctx = (void *) &(operation[handle - 1].operation);
-        return PSA_SUCCESS;
+    p = get_pool(handle, partition_id, &index);
+    if (p == NULL) {
+        return PSA_ERROR_BAD_STATE;
     }
 
-    return PSA_ERROR_BAD_STATE;
+    p->operation[index].last_used = ++type_clock[type];
+    *ctx = (void *)&p->ctx[index * p->ctx_size];
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t tfm_crypto_operation_get_stats(
+                                    enum tfm_crypto_operation_type type,
+                                    struct tfm_crypto_operation_stats_t *stats)
+{
+    if ((type == TFM_CRYPTO_OPERATION_NONE) || ((uint32_t)type >= NUM_POOLS) ||
+        (stats == NULL)) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    *stats = type_stats[type];
+
+    return PSA_SUCCESS;
 }
 /*!@}*/
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tfm_mbedcrypto_include.h"
+
+#include "tfm_crypto_api.h"
+#include "tfm_crypto_defs.h"
+#include "tfm_crypto_private.h"
+
+/**
+ * \brief Run one entry of a batch through the handler of the single update
+ *        request, so that both paths apply the same checks.
+ */
+static psa_status_t tfm_crypto_batch_run_entry(
+                                    const struct tfm_crypto_batch_entry *entry,
+                                    const uint8_t *input,
+                                    uint8_t *output,
+                                    struct tfm_crypto_batch_result *result)
+{
+    psa_status_t status;
+    struct tfm_crypto_pack_iovec iov = {
+        .sfn_id = entry->sfn_id,
+        .op_handle = entry->op_handle,
+    };
+    psa_invec in_vec[] = {
+        {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
+        {.base = input, .len = entry->input_length},
+    };
+    psa_outvec out_vec[] = {
+        {.base = &result->op_handle, .len = sizeof(uint32_t)},
+        {.base = output, .len = entry->output_size},
+    };
+
+    switch (entry->sfn_id) {
+    case TFM_CRYPTO_HASH_UPDATE_SID:
+        status = tfm_crypto_hash_update(in_vec, 2, out_vec, 1);
+        break;
+    case TFM_CRYPTO_MAC_UPDATE_SID:
+        status = tfm_crypto_mac_update(in_vec, 2, out_vec, 1);
+        break;
+    case TFM_CRYPTO_CIPHER_UPDATE_SID:
+        status = tfm_crypto_cipher_update(in_vec, 2, out_vec, 2);
+        result->output_length = out_vec[1].len;
+        break;
+    default:
+        status = PSA_ERROR_NOT_SUPPORTED;
+        break;
+    }
+
+    result->status = status;
+
+    return status;
+}
+
+/*!
+ * \defgroup public Public functions
+ *
+ */
+
+/*!@{*/
+psa_status_t tfm_crypto_batch_update(psa_invec in_vec[],
+                                     size_t in_len,
+                                     psa_outvec out_vec[],
+                                     size_t out_len)
+{
+    psa_status_t status = PSA_SUCCESS;
+    const struct tfm_crypto_batch_entry *entries;
+    struct tfm_crypto_batch_result *results;
+    const uint8_t *input = NULL;
+    uint8_t *output = NULL;
+    size_t input_size = 0, output_size = 0;
+    size_t nr_entries, i;
+    size_t input_offset = 0, output_offset = 0;
+
+    CRYPTO_IN_OUT_LEN_VALIDATE(in_len, 2, 3, out_len, 1, 2);
+
+    if ((in_vec[0].len != sizeof(struct tfm_crypto_pack_iovec)) ||
+        (in_vec[1].len == 0) ||
+        ((in_vec[1].len % sizeof(struct tfm_crypto_batch_entry)) != 0)) {
+        return PSA_ERROR_PROGRAMMER_ERROR;
+    }
+    nr_entries = in_vec[1].len / sizeof(struct tfm_crypto_batch_entry);
+    if (out_vec[0].len != nr_entries * sizeof(struct tfm_crypto_batch_result)) {
+        return PSA_ERROR_PROGRAMMER_ERROR;
+    }
+
+    entries = in_vec[1].base;
+    results = out_vec[0].base;
+    if (in_len > 2) {
+        input = in_vec[2].base;
+        input_size = in_vec[2].len;
+    }
+    if (out_len > 1) {
+        output = out_vec[1].base;
+        output_size = out_vec[1].len;
+    }
+
+    /* Entries not reached because an earlier one failed are left untouched */
+    for (i = 0; i < nr_entries; i++) {
+        results[i].op_handle = entries[i].op_handle;
+        results[i].status = PSA_ERROR_BAD_STATE;
+        results[i].output_length = 0;
+    }
+
+    for (i = 0; (i < nr_entries) && (status == PSA_SUCCESS); i++) {
+        if ((entries[i].input_length > input_size - input_offset) ||
+            (entries[i].output_size > output_size - output_offset)) {
+            status = PSA_ERROR_PROGRAMMER_ERROR;
+            break;
+        }
+
+        status = tfm_crypto_batch_run_entry(
+                            &entries[i],
+                            (input != NULL) ? &input[input_offset] : NULL,
+                            (output != NULL) ? &output[output_offset] : NULL,
+                            &results[i]);
+
+        input_offset += entries[i].input_length;
+        output_offset += entries[i].output_size;
+    }
+
+    if (out_len > 1) {
+        out_vec[1].len = output_offset;
+    }
+
+    return status;
+}
+/*!@}*/
@@ -59,6 +59,15 @@ LIST_TFM_CRYPTO_UNIFORM_SIGNATURE_API
 #error TFM_CRYPTO_IOVEC_BUFFER_SIZE is not defined
 #endif
 
+/*
+ * Besides its payload, a batch update request copies up to
+ * TFM_CRYPTO_BATCH_MAX_ENTRIES entries and results into the scratch, each
+ * vector aligned. 512 bytes leaves room for them.
+ */
+#if (TFM_CRYPTO_IOVEC_BUFFER_SIZE < (TFM_CRYPTO_BATCH_MAX_PAYLOAD + 512))
+#error TFM_CRYPTO_IOVEC_BUFFER_SIZE is too small for TFM_CRYPTO_BATCH_MAX_PAYLOAD
+#endif
+
 /**
  * \brief Internal scratch used for IOVec allocations
  *
@@ -109,6 +118,34 @@ static psa_status_t tfm_crypto_clear_scratch(void)
     return PSA_SUCCESS;
 }
 
+#ifdef TFM_CRYPTO_IOVEC_ZERO_COPY
+/**
+ * \brief Returns the mask of the input vectors of a request which can be read
+ *        in place from the client memory. Only the vectors holding data that
+ *        the backend streams through are listed. Vectors holding structures or
+ *        lengths are always copied, so that the client cannot change them while
+ *        they are in use.
+ */
+static uint32_t tfm_crypto_in_place_invecs(uint32_t sfn_id)
+{
+    switch (sfn_id) {
+    case TFM_CRYPTO_HASH_COMPUTE_SID:
+    case TFM_CRYPTO_HASH_COMPARE_SID:
+    case TFM_CRYPTO_HASH_UPDATE_SID:
+    case TFM_CRYPTO_MAC_UPDATE_SID:
+    case TFM_CRYPTO_CIPHER_UPDATE_SID:
+        return (1u << 1);
+    case TFM_CRYPTO_AEAD_ENCRYPT_SID:
+    case TFM_CRYPTO_AEAD_DECRYPT_SID:
+        return (1u << 1) | (1u << 2);
+    case TFM_CRYPTO_BATCH_UPDATE_SID:
+        return (1u << 2);
+    default:
+        return 0;
+    }
+}
+#endif /* TFM_CRYPTO_IOVEC_ZERO_COPY */
+
 static psa_status_t tfm_crypto_call_sfn(psa_msg_t *msg,
                                         struct tfm_crypto_pack_iovec *iov,
                                         const uint32_t sfn_id)
@@ -118,6 +155,9 @@ static psa_status_t tfm_crypto_call_sfn(psa_msg_t *msg,
     psa_invec in_vec[PSA_MAX_IOVEC] = { {NULL, 0} };
     psa_outvec out_vec[PSA_MAX_IOVEC] = { {NULL, 0} };
     void *alloc_buf_ptr = NULL;
+#ifdef TFM_CRYPTO_IOVEC_ZERO_COPY
+    uint32_t in_place = tfm_crypto_in_place_invecs(sfn_id);
+#endif
 
     /* Check the number of in_vec filled */
     while ((in_len > 0) && (msg->in_size[in_len - 1] == 0)) {
@@ -134,6 +174,16 @@ static psa_status_t tfm_crypto_call_sfn(psa_msg_t *msg,
 
     /* Alloc/read from the second element as the first is read when parsing */
     for (i = 1; i < in_len; i++) {
+#ifdef TFM_CRYPTO_IOVEC_ZERO_COPY
+        /* Use the client data in place if the partition can read it */
+        if ((in_place & (1u << i)) != 0) {
+            in_vec[i].base = tfm_map_invec(msg->handle, i);
+            if (in_vec[i].base != NULL) {
+                in_vec[i].len = msg->in_size[i];
+                continue;
+            }
+        }
+#endif
         /* Allocate necessary space in the internal scratch */
         status = tfm_crypto_alloc_scratch(msg->in_size[i], &alloc_buf_ptr);
         if (status != PSA_SUCCESS) {
@@ -13,21 +13,6 @@
 #include "tfm_crypto_api.h"
 #include "tfm_crypto_defs.h"
 #include "tfm_crypto_private.h"
-#include <stdbool.h>
-
-#ifndef TFM_CRYPTO_MAX_KEY_HANDLES
-#define TFM_CRYPTO_MAX_KEY_HANDLES (16)
-#endif
-struct tfm_crypto_handle_owner_s {
-    int32_t owner;           /*!< Owner of the allocated handle */
-    psa_key_handle_t handle; /*!< Allocated handle */
-    uint8_t in_use;          /*!< Flag to indicate if this in use */
-};
-
-#ifndef TFM_CRYPTO_KEY_MODULE_DISABLED
-static struct tfm_crypto_handle_owner_s
-                                 handle_owner[TFM_CRYPTO_MAX_KEY_HANDLES] = {0};
-#endif
 
 /*!
  * \defgroup public Public functions
@@ -83,78 +68,6 @@ psa_status_t tfm_crypto_key_attributes_to_client(
     return PSA_SUCCESS;
 }
 
-psa_status_t tfm_crypto_check_handle_owner(psa_key_handle_t handle,
-                                           uint32_t *index)
-{
-#ifdef TFM_CRYPTO_KEY_MODULE_DISABLED
-    return PSA_ERROR_NOT_SUPPORTED;
-#else
-    int32_t partition_id = 0;
-    uint32_t i = 0;
-    psa_status_t status;
-
-    status = tfm_crypto_get_caller_id(&partition_id);
-    if (status != PSA_SUCCESS) {
-        return status;
-    }
-
-    for (i = 0; i < TFM_CRYPTO_MAX_KEY_HANDLES; i++) {
-        if (handle_owner[i].in_use && handle_owner[i].handle == handle) {
-            if (handle_owner[i].owner == partition_id) {
-                if (index != NULL) {
-                    *index = i;
-                }
-                return PSA_SUCCESS;
-            } else {
-                return PSA_ERROR_NOT_PERMITTED;
-            }
-        }
-    }
-
-    return PSA_ERROR_INVALID_HANDLE;
-#endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
-}
-
-psa_status_t tfm_crypto_check_key_storage(uint32_t *index)
-{
-#ifdef TFM_CRYPTO_KEY_MODULE_DISABLED
-    return PSA_ERROR_NOT_SUPPORTED;
-#else
-    uint32_t i;
-
-    for (i = 0; i < TFM_CRYPTO_MAX_KEY_HANDLES; i++) {
-        if (handle_owner[i].in_use == TFM_CRYPTO_NOT_IN_USE) {
-            *index = i;
-            return PSA_SUCCESS;
-        }
-    }
-
-    return PSA_ERROR_INSUFFICIENT_MEMORY;
-#endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
-}
-
-psa_status_t tfm_crypto_set_key_storage(uint32_t index,
-                                        psa_key_handle_t key_handle)
-{
-#ifdef TFM_CRYPTO_KEY_MODULE_DISABLED
-    return PSA_ERROR_NOT_SUPPORTED;
-#else
-    psa_status_t status;
-    int32_t partition_id;
-
-    status = tfm_crypto_get_caller_id(&partition_id);
-    if (status != PSA_SUCCESS) {
-        return status;
-    }
-
-    handle_owner[index].owner = partition_id;
-    handle_owner[index].handle = key_handle;
-    handle_owner[index].in_use = TFM_CRYPTO_IN_USE;
-
-    return PSA_SUCCESS;
-#endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
-}
-
 psa_status_t tfm_crypto_set_key_domain_parameters(psa_invec in_vec[],
                                    size_t in_len,
                                    psa_outvec out_vec[],
@@ -203,19 +116,11 @@ psa_status_t tfm_crypto_import_key(psa_invec in_vec[],
     psa_key_handle_t *key_handle = out_vec[0].base;
     psa_status_t status;
     psa_key_attributes_t key_attributes = PSA_KEY_ATTRIBUTES_INIT;
-    uint32_t i = 0;
     int32_t partition_id = 0;
-    bool empty_found = false;
-
-    for (i = 0; i < TFM_CRYPTO_MAX_KEY_HANDLES; i++) {
-        if (handle_owner[i].in_use == TFM_CRYPTO_NOT_IN_USE) {
-            empty_found = true;
-            break;
-        }
-    }
 
-    if (!empty_found) {
-        return PSA_ERROR_INSUFFICIENT_MEMORY;
+    status = tfm_crypto_check_key_storage();
+    if (status != PSA_SUCCESS) {
+        return status;
     }
 
     status = tfm_crypto_get_caller_id(&partition_id);
@@ -233,9 +138,7 @@ psa_status_t tfm_crypto_import_key(psa_invec in_vec[],
     status = psa_import_key(&key_attributes, data, data_length, key_handle);
 
     if (status == PSA_SUCCESS) {
-        handle_owner[i].owner = partition_id;
-        handle_owner[i].handle = *key_handle;
-        handle_owner[i].in_use = TFM_CRYPTO_IN_USE;
+        status = tfm_crypto_set_key_storage(*key_handle);
     }
 
     return status;
@@ -264,16 +167,10 @@ psa_status_t tfm_crypto_open_key(psa_invec in_vec[],
     psa_status_t status;
     psa_key_id_t id;
     int32_t partition_id;
-    uint32_t i;
-
-    for (i = 0; i < TFM_CRYPTO_MAX_KEY_HANDLES; i++) {
-        if (handle_owner[i].in_use == TFM_CRYPTO_NOT_IN_USE) {
-            break;
-        }
-    }
 
-    if (i == TFM_CRYPTO_MAX_KEY_HANDLES) {
-        return PSA_ERROR_INSUFFICIENT_MEMORY;
+    status = tfm_crypto_check_key_storage();
+    if (status != PSA_SUCCESS) {
+        return status;
     }
 
     status = tfm_crypto_get_caller_id(&partition_id);
@@ -287,9 +184,7 @@ psa_status_t tfm_crypto_open_key(psa_invec in_vec[],
     status = psa_open_key(id, key_handle);
 
     if (status == PSA_SUCCESS) {
-        handle_owner[i].owner = partition_id;
-        handle_owner[i].handle = *key_handle;
-        handle_owner[i].in_use = TFM_CRYPTO_IN_USE;
+        status = tfm_crypto_set_key_storage(*key_handle);
     }
 
     return status;
@@ -324,9 +219,7 @@ psa_status_t tfm_crypto_close_key(psa_invec in_vec[],
     status = psa_close_key(key);
 
     if (status == PSA_SUCCESS) {
-        handle_owner[index].owner = 0;
-        handle_owner[index].handle = 0;
-        handle_owner[index].in_use = TFM_CRYPTO_NOT_IN_USE;
+        status = tfm_crypto_release_key_storage(index);
     }
 
     return status;
@@ -361,9 +254,7 @@ psa_status_t tfm_crypto_destroy_key(psa_invec in_vec[],
     status = psa_destroy_key(key);
 
     if (status == PSA_SUCCESS) {
-        handle_owner[index].owner = 0;
-        handle_owner[index].handle = 0;
-        handle_owner[index].in_use = TFM_CRYPTO_NOT_IN_USE;
+        status = tfm_crypto_release_key_storage(index);
     }
 
     return status;
@@ -519,19 +410,11 @@ psa_status_t tfm_crypto_copy_key(psa_invec in_vec[],
     const struct psa_client_key_attributes_s *client_key_attr = in_vec[1].base;
     psa_status_t status;
     psa_key_attributes_t key_attributes = PSA_KEY_ATTRIBUTES_INIT;
-    uint32_t i = 0;
     int32_t partition_id = 0;
-    bool empty_found = false;
 
-    for (i = 0; i < TFM_CRYPTO_MAX_KEY_HANDLES; i++) {
-        if (handle_owner[i].in_use == TFM_CRYPTO_NOT_IN_USE) {
-            empty_found = true;
-            break;
-        }
-    }
-
-    if (!empty_found) {
-        return PSA_ERROR_INSUFFICIENT_MEMORY;
+    status = tfm_crypto_check_key_storage();
+    if (status != PSA_SUCCESS) {
+        return status;
     }
 
     status = tfm_crypto_get_caller_id(&partition_id);
@@ -549,9 +432,7 @@ psa_status_t tfm_crypto_copy_key(psa_invec in_vec[],
     status = psa_copy_key(source_handle, &key_attributes, target_handle);
 
     if (status == PSA_SUCCESS) {
-        handle_owner[i].owner = partition_id;
-        handle_owner[i].handle = *target_handle;
-        handle_owner[i].in_use = TFM_CRYPTO_IN_USE;
+        status = tfm_crypto_set_key_storage(*target_handle);
     }
 
     return status;
@@ -578,19 +459,11 @@ psa_status_t tfm_crypto_generate_key(psa_invec in_vec[],
     const struct psa_client_key_attributes_s *client_key_attr = in_vec[1].base;
     psa_status_t status;
     psa_key_attributes_t key_attributes = PSA_KEY_ATTRIBUTES_INIT;
-    uint32_t i = 0;
     int32_t partition_id = 0;
-    bool empty_found = false;
 
-    for (i = 0; i < TFM_CRYPTO_MAX_KEY_HANDLES; i++) {
-        if (handle_owner[i].in_use == TFM_CRYPTO_NOT_IN_USE) {
-            empty_found = true;
-            break;
-        }
-    }
-
-    if (!empty_found) {
-        return PSA_ERROR_INSUFFICIENT_MEMORY;
+    status = tfm_crypto_check_key_storage();
+    if (status != PSA_SUCCESS) {
+        return status;
     }
 
     status = tfm_crypto_get_caller_id(&partition_id);
@@ -608,9 +481,7 @@ psa_status_t tfm_crypto_generate_key(psa_invec in_vec[],
     status = psa_generate_key(&key_attributes, key_handle);
 
     if (status == PSA_SUCCESS) {
-        handle_owner[i].owner = partition_id;
-        handle_owner[i].handle = *key_handle;
-        handle_owner[i].in_use = TFM_CRYPTO_IN_USE;
+        status = tfm_crypto_set_key_storage(*key_handle);
     }
 
     return status;
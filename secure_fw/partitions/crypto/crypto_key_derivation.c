@@ -381,7 +381,6 @@ psa_status_t tfm_crypto_key_derivation_output_key(psa_invec in_vec[],
     psa_key_handle_t *key_handle = out_vec[0].base;
     psa_key_attributes_t key_attributes = PSA_KEY_ATTRIBUTES_INIT;
     int32_t partition_id;
-    uint32_t index;
 
     /* Look up the corresponding operation context */
     status = tfm_crypto_operation_lookup(TFM_CRYPTO_KEY_DERIVATION_OPERATION,
@@ -391,7 +390,7 @@ psa_status_t tfm_crypto_key_derivation_output_key(psa_invec in_vec[],
         return status;
     }
 
-    status = tfm_crypto_check_key_storage(&index);
+    status = tfm_crypto_check_key_storage();
     if (status != PSA_SUCCESS) {
         return status;
     }
@@ -416,7 +415,7 @@ psa_status_t tfm_crypto_key_derivation_output_key(psa_invec in_vec[],
                                                key_handle);
     }
     if (status == PSA_SUCCESS) {
-        status = tfm_crypto_set_key_storage(index, *key_handle);
+        status = tfm_crypto_set_key_storage(*key_handle);
     }
 
     return status;
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tfm_crypto_api.h"
+#include "tfm_crypto_defs.h"
+
+#ifndef TFM_CRYPTO_MAX_KEY_HANDLES
+#define TFM_CRYPTO_MAX_KEY_HANDLES (16)
+#endif
+
+/*
+ * The owners of the key handles are kept in an open addressing hash table
+ * keyed by the handle, with linear probing. The table has twice as many
+ * entries as the maximum number of handles, so a lookup stays short and
+ * always ends on a free entry.
+ */
+#define TFM_CRYPTO_KEY_HANDLE_TABLE_SIZE (2 * TFM_CRYPTO_MAX_KEY_HANDLES)
+
+struct tfm_crypto_handle_owner_s {
+    int32_t owner;           /*!< Owner of the allocated handle */
+    psa_key_handle_t handle; /*!< Allocated handle */
+    uint8_t in_use;          /*!< Flag to indicate if this in use */
+};
+
+#ifndef TFM_CRYPTO_KEY_MODULE_DISABLED
+static struct tfm_crypto_handle_owner_s
+                           handle_owner[TFM_CRYPTO_KEY_HANDLE_TABLE_SIZE] = {0};
+static uint32_t nr_handles = 0;
+
+/*
+ * The backend hands out the key handles in sequence, so they are spread over
+ * the table by their value alone.
+ */
+static uint32_t handle_owner_home(psa_key_handle_t handle)
+{
+    return (uint32_t)handle % TFM_CRYPTO_KEY_HANDLE_TABLE_SIZE;
+}
+
+static uint32_t handle_owner_next(uint32_t index)
+{
+    return (index + 1 == TFM_CRYPTO_KEY_HANDLE_TABLE_SIZE) ? 0 : index + 1;
+}
+
+/* Returns the index of the entry of the handle, or the free entry for it */
+static uint32_t handle_owner_find(psa_key_handle_t handle)
+{
+    uint32_t i = handle_owner_home(handle);
+
+    while (handle_owner[i].in_use && handle_owner[i].handle != handle) {
+        i = handle_owner_next(i);
+    }
+
+    return i;
+}
+
+static void handle_owner_insert(psa_key_handle_t handle, int32_t owner)
+{
+    uint32_t i = handle_owner_find(handle);
+
+    if (handle_owner[i].in_use == TFM_CRYPTO_NOT_IN_USE) {
+        nr_handles++;
+    }
+
+    handle_owner[i].owner = owner;
+    handle_owner[i].handle = handle;
+    handle_owner[i].in_use = TFM_CRYPTO_IN_USE;
+}
+
+/*
+ * Free an entry by moving back the following entries of its probe sequence,
+ * so that lookups never need to skip over deleted entries.
+ */
+static void handle_owner_remove(uint32_t index)
+{
+    uint32_t i = index, j = index, home;
+
+    for (j = handle_owner_next(j); handle_owner[j].in_use;
+         j = handle_owner_next(j)) {
+        home = handle_owner_home(handle_owner[j].handle);
+
+        /* The entry can move to i if its home is not cyclically in (i, j] */
+        if ((i <= j) ? ((home <= i) || (home > j))
+                     : ((home <= i) && (home > j))) {
+            handle_owner[i] = handle_owner[j];
+            i = j;
+        }
+    }
+
+    handle_owner[i].owner = 0;
+    handle_owner[i].handle = 0;
+    handle_owner[i].in_use = TFM_CRYPTO_NOT_IN_USE;
+    nr_handles--;
+}
+#endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
+
+/*!
+ * \defgroup public Public functions
+ *
+ */
+/*!@{*/
+psa_status_t tfm_crypto_check_handle_owner(psa_key_handle_t handle,
+                                           uint32_t *index)
+{
+#ifdef TFM_CRYPTO_KEY_MODULE_DISABLED
+    return PSA_ERROR_NOT_SUPPORTED;
+#else
+    int32_t partition_id = 0;
+    uint32_t i = 0;
+    psa_status_t status;
+
+    status = tfm_crypto_get_caller_id(&partition_id);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    i = handle_owner_find(handle);
+    if (handle_owner[i].in_use == TFM_CRYPTO_NOT_IN_USE) {
+        return PSA_ERROR_INVALID_HANDLE;
+    }
+
+    if (handle_owner[i].owner != partition_id) {
+        return PSA_ERROR_NOT_PERMITTED;
+    }
+
+    if (index != NULL) {
+        *index = i;
+    }
+
+    return PSA_SUCCESS;
+#endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
+}
+
+psa_status_t tfm_crypto_check_key_storage(void)
+{
+#ifdef TFM_CRYPTO_KEY_MODULE_DISABLED
+    return PSA_ERROR_NOT_SUPPORTED;
+#else
+    if (nr_handles >= TFM_CRYPTO_MAX_KEY_HANDLES) {
+        return PSA_ERROR_INSUFFICIENT_MEMORY;
+    }
+
+    return PSA_SUCCESS;
+#endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
+}
+
+psa_status_t tfm_crypto_set_key_storage(psa_key_handle_t key_handle)
+{
+#ifdef TFM_CRYPTO_KEY_MODULE_DISABLED
+    return PSA_ERROR_NOT_SUPPORTED;
+#else
+    psa_status_t status;
+    int32_t partition_id;
+
+    status = tfm_crypto_get_caller_id(&partition_id);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    handle_owner_insert(key_handle, partition_id);
+
+    return PSA_SUCCESS;
+#endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
+}
+
+psa_status_t tfm_crypto_release_key_storage(uint32_t index)
+{
+#ifdef TFM_CRYPTO_KEY_MODULE_DISABLED
+    return PSA_ERROR_NOT_SUPPORTED;
+#else
+    if ((index >= TFM_CRYPTO_KEY_HANDLE_TABLE_SIZE) ||
+        (handle_owner[index].in_use == TFM_CRYPTO_NOT_IN_USE)) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    handle_owner_remove(index);
+
+    return PSA_SUCCESS;
+#endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
+}
+/*!@}*/
@@ -111,26 +111,33 @@ psa_status_t tfm_crypto_check_handle_owner(psa_key_handle_t handle,
                                            uint32_t *index);
 
 /**
- * \brief Checks that there is enough local storage in RAM to keep another key,
- *        and returns the index of the storage to use.
+ * \brief Checks that there is enough local storage in RAM to keep another key
  *
- * \param[out] index  Index of the local storage to use
+ * \return Return values as described in \ref psa_status_t
+ */
+psa_status_t tfm_crypto_check_key_storage(void);
+
+/**
+ * \brief Stores a key handle requested by the calling partition, with the
+ *        calling partition as its owner. The storage must have been checked
+ *        with \ref tfm_crypto_check_key_storage before the key was created.
+ *
+ * \param[in] key_handle  Key handle to store
  *
  * \return Return values as described in \ref psa_status_t
  */
-psa_status_t tfm_crypto_check_key_storage(uint32_t *index);
+psa_status_t tfm_crypto_set_key_storage(psa_key_handle_t key_handle);
 
 /**
- * \brief Sets the index of the local storage in use with a key requested by the
- *        calling partition, and stores the corresponding key_handle.
+ * \brief Releases the local storage of a key handle, once the key has been
+ *        closed or destroyed
  *
- * \param[in] index       Index of the local storage to use
- * \param[in] key_handle  Corresponding key handle to associate
+ * \param[in] index  Internal index of the handle, as returned by
+ *                   \ref tfm_crypto_check_handle_owner
  *
  * \return Return values as described in \ref psa_status_t
  */
-psa_status_t tfm_crypto_set_key_storage(uint32_t index,
-                                        psa_key_handle_t key_handle);
+psa_status_t tfm_crypto_release_key_storage(uint32_t index);
 /**
  * \brief Allocate an operation context in the backend
  *
@@ -165,6 +172,41 @@ psa_status_t tfm_crypto_operation_lookup(enum tfm_crypto_operation_type type,
                                          uint32_t handle,
                                          void **ctx);
 
+/**
+ * \brief Utilization counters of the operation contexts of one type
+ */
+struct tfm_crypto_operation_stats_t {
+    uint32_t num;             /*!< Number of contexts the type can use,
+                               *   reserved and shared
+                               */
+    uint32_t in_use;          /*!< Number of contexts currently allocated */
+    uint32_t peak_in_use;     /*!< Highest number of contexts allocated */
+    uint32_t nr_alloc;        /*!< Number of successful allocations */
+    uint32_t nr_exhausted;    /*!< Allocations failed as no context was free */
+    uint32_t nr_over_quota;   /*!< Allocations failed as the client reached
+                               *   its quota
+                               */
+    uint32_t nr_reclaimed;    /*!< Idle contexts reclaimed for other
+                               *   allocations
+                               */
+    uint32_t nr_borrowed;     /*!< Allocations served by a shared context, as
+                               *   the contexts reserved for the type were
+                               *   all in use
+                               */
+};
+
+/**
+ * \brief Get the utilization counters of the operation contexts of a type
+ *
+ * \param[in]  type   Type of the operation contexts
+ * \param[out] stats  Pointer to hold the counters
+ *
+ * \return Return values as described in \ref psa_status_t
+ */
+psa_status_t tfm_crypto_operation_get_stats(
+                                    enum tfm_crypto_operation_type type,
+                                    struct tfm_crypto_operation_stats_t *stats);
+
 #define LIST_TFM_CRYPTO_UNIFORM_SIGNATURE_API \
     X(tfm_crypto_get_key_attributes)          \
     X(tfm_crypto_reset_key_attributes)        \
@@ -230,6 +272,7 @@ psa_status_t tfm_crypto_operation_lookup(enum tfm_crypto_operation_type type,
     X(tfm_crypto_generate_key)                \
     X(tfm_crypto_set_key_domain_parameters)   \
     X(tfm_crypto_get_key_domain_parameters)   \
+    X(tfm_crypto_batch_update)                \
 
 #define X(api_name) UNIFORM_SIGNATURE_API(api_name);
 LIST_TFM_CRYPTO_UNIFORM_SIGNATURE_API
@@ -17,22 +17,14 @@
 #ifdef TFM_PSA_API
 #include "psa/client.h"
 
-#define PSA_CONNECT(service)                                    \
-    psa_handle_t ipc_handle;                                    \
-    ipc_handle = psa_connect(service##_SID, service##_VERSION); \
-    if (!PSA_HANDLE_IS_VALID(ipc_handle)) {                     \
-        return PSA_ERROR_GENERIC_ERROR;                         \
-    }                                                           \
-
-#define PSA_CLOSE() psa_close(ipc_handle)
-
+/* TFM_CRYPTO is a stateless service, so no connection is needed */
 #define API_DISPATCH(sfn_name, sfn_id)                         \
-    psa_call(ipc_handle, PSA_IPC_CALL,                         \
+    psa_call(TFM_CRYPTO_HANDLE, PSA_IPC_CALL,                  \
         in_vec, ARRAY_SIZE(in_vec),                            \
         out_vec, ARRAY_SIZE(out_vec))
 
 #define API_DISPATCH_NO_OUTVEC(sfn_name, sfn_id)               \
-    psa_call(ipc_handle, PSA_IPC_CALL,                         \
+    psa_call(TFM_CRYPTO_HANDLE, PSA_IPC_CALL,                  \
         in_vec, ARRAY_SIZE(in_vec),                            \
         (psa_outvec *)NULL, 0)
 #else
@@ -76,17 +68,9 @@ psa_status_t psa_open_key(psa_key_id_t id,
         {.base = handle, .len = sizeof(psa_key_handle_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_open_key,
                           TFM_CRYPTO_OPEN_KEY);
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
@@ -106,17 +90,9 @@ psa_status_t psa_close_key(psa_key_handle_t handle)
         {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH_NO_OUTVEC(tfm_crypto_close_key,
                                     TFM_CRYPTO_CLOSE_KEY);;
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
@@ -143,16 +119,8 @@ psa_status_t psa_import_key(const psa_key_attributes_t *attributes,
         {.base = handle, .len = sizeof(psa_key_handle_t)}
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_import_key,
                           TFM_CRYPTO_IMPORT_KEY);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
@@ -172,16 +140,8 @@ psa_status_t psa_destroy_key(psa_key_handle_t handle)
         {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH_NO_OUTVEC(tfm_crypto_destroy_key,
                                     TFM_CRYPTO_DESTROY_KEY);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
@@ -205,16 +165,8 @@ psa_status_t psa_get_key_attributes(psa_key_handle_t handle,
         {.base = attributes, .len = sizeof(psa_key_attributes_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_get_key_attributes,
                           TFM_CRYPTO_GET_KEY_ATTRIBUTES);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
@@ -234,20 +186,8 @@ void psa_reset_key_attributes(psa_key_attributes_t *attributes)
         {.base = attributes, .len = sizeof(psa_key_attributes_t)},
     };
 
-#ifdef TFM_PSA_API
-    psa_handle_t ipc_handle;
-    ipc_handle = psa_connect(TFM_CRYPTO_SID, TFM_CRYPTO_VERSION);
-    if (!PSA_HANDLE_IS_VALID(ipc_handle)) {
-        return;
-    }
-#endif
-
     (void)API_DISPATCH(tfm_crypto_reset_key_attributes,
                           TFM_CRYPTO_RESET_KEY_ATTRIBUTES);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
@@ -273,19 +213,11 @@ psa_status_t psa_export_key(psa_key_handle_t handle,
         {.base = data, .len = data_size}
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_export_key,
                           TFM_CRYPTO_EXPORT_KEY);
 
     *data_length = out_vec[0].len;
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
@@ -312,19 +244,11 @@ psa_status_t psa_export_public_key(psa_key_handle_t handle,
         {.base = data, .len = data_size}
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_export_public_key,
                           TFM_CRYPTO_EXPORT_PUBLIC_KEY);
 
     *data_length = out_vec[0].len;
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
@@ -352,16 +276,8 @@ psa_status_t psa_copy_key(psa_key_handle_t source_handle,
         {.base = target_handle, .len = sizeof(psa_key_handle_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_copy_key,
                           TFM_CRYPTO_COPY_KEY);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
@@ -389,19 +305,11 @@ psa_status_t psa_cipher_generate_iv(psa_cipher_operation_t *operation,
         {.base = iv, .len = iv_size},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_cipher_generate_iv,
                           TFM_CRYPTO_CIPHER_GENERATE_IV);
 
     *iv_length = out_vec[1].len;
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_CIPHER_MODULE_DISABLED */
 }
@@ -428,16 +336,8 @@ psa_status_t psa_cipher_set_iv(psa_cipher_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_cipher_set_iv,
                           TFM_CRYPTO_CIPHER_SET_IV);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_CIPHER_MODULE_DISABLED */
 }
@@ -465,16 +365,8 @@ psa_status_t psa_cipher_encrypt_setup(psa_cipher_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_cipher_encrypt_setup,
                           TFM_CRYPTO_CIPHER_ENCRYPT_SETUP);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_CIPHER_MODULE_DISABLED */
 }
@@ -502,16 +394,8 @@ psa_status_t psa_cipher_decrypt_setup(psa_cipher_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_cipher_decrypt_setup,
                           TFM_CRYPTO_CIPHER_DECRYPT_SETUP);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_CIPHER_MODULE_DISABLED */
 }
@@ -542,19 +426,11 @@ psa_status_t psa_cipher_update(psa_cipher_operation_t *operation,
         {.base = output, .len = output_size}
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_cipher_update,
                           TFM_CRYPTO_CIPHER_UPDATE);
 
     *output_length = out_vec[1].len;
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_CIPHER_MODULE_DISABLED */
 }
@@ -578,16 +454,8 @@ psa_status_t psa_cipher_abort(psa_cipher_operation_t *operation)
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_cipher_abort,
                           TFM_CRYPTO_CIPHER_ABORT);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_CIPHER_MODULE_DISABLED */
 }
@@ -615,19 +483,11 @@ psa_status_t psa_cipher_finish(psa_cipher_operation_t *operation,
         {.base = output, .len = output_size},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_cipher_finish,
                           TFM_CRYPTO_CIPHER_FINISH);
 
     *output_length = out_vec[1].len;
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_CIPHER_MODULE_DISABLED */
 }
@@ -653,17 +513,9 @@ psa_status_t psa_hash_setup(psa_hash_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_hash_setup,
                           TFM_CRYPTO_HASH_SETUP);
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_HASH_MODULE_DISABLED */
 }
@@ -690,17 +542,9 @@ psa_status_t psa_hash_update(psa_hash_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_hash_update,
                           TFM_CRYPTO_HASH_UPDATE);
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_HASH_MODULE_DISABLED */
 }
@@ -728,19 +572,11 @@ psa_status_t psa_hash_finish(psa_hash_operation_t *operation,
         {.base = hash, .len = hash_size},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_hash_finish,
                           TFM_CRYPTO_HASH_FINISH);
 
     *hash_length = out_vec[1].len;
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_HASH_MODULE_DISABLED */
 }
@@ -767,16 +603,8 @@ psa_status_t psa_hash_verify(psa_hash_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_hash_verify,
                           TFM_CRYPTO_HASH_VERIFY);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_HASH_MODULE_DISABLED */
 }
@@ -800,16 +628,8 @@ psa_status_t psa_hash_abort(psa_hash_operation_t *operation)
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_hash_abort,
                           TFM_CRYPTO_HASH_ABORT);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_HASH_MODULE_DISABLED */
 }
@@ -838,16 +658,8 @@ psa_status_t psa_hash_clone(const psa_hash_operation_t *source_operation,
         return PSA_ERROR_BAD_STATE;
     }
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_hash_clone,
                           TFM_CRYPTO_HASH_CLONE);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_HASH_MODULE_DISABLED */
 }
@@ -878,19 +690,11 @@ psa_status_t psa_hash_compute(psa_algorithm_t alg,
         {.base = hash, .len = hash_size}
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_hash_compute,
                           TFM_CRYPTO_HASH_COMPUTE);
 
     *hash_length = out_vec[0].len;
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_HASH_MODULE_DISABLED */
 }
@@ -917,17 +721,9 @@ psa_status_t psa_hash_compare(psa_algorithm_t alg,
         {.base = hash, .len = hash_length},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH_NO_OUTVEC(tfm_crypto_hash_compare,
                           TFM_CRYPTO_HASH_COMPARE);
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_HASH_MODULE_DISABLED */
 }
@@ -955,16 +751,8 @@ psa_status_t psa_mac_sign_setup(psa_mac_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_mac_sign_setup,
                           TFM_CRYPTO_MAC_SIGN_SETUP);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_MAC_MODULE_DISABLED */
 }
@@ -992,16 +780,8 @@ psa_status_t psa_mac_verify_setup(psa_mac_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_mac_verify_setup,
                           TFM_CRYPTO_MAC_VERIFY_SETUP);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_MAC_MODULE_DISABLED */
 }
@@ -1028,16 +808,8 @@ psa_status_t psa_mac_update(psa_mac_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_mac_update,
                           TFM_CRYPTO_MAC_UPDATE);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_MAC_MODULE_DISABLED */
 }
@@ -1065,19 +837,11 @@ psa_status_t psa_mac_sign_finish(psa_mac_operation_t *operation,
         {.base = mac, .len = mac_size},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_mac_sign_finish,
                           TFM_CRYPTO_MAC_SIGN_FINISH);
 
     *mac_length = out_vec[1].len;
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_MAC_MODULE_DISABLED */
 }
@@ -1104,17 +868,9 @@ psa_status_t psa_mac_verify_finish(psa_mac_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_mac_verify_finish,
                           TFM_CRYPTO_MAC_VERIFY_FINISH);
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_MAC_MODULE_DISABLED */
 }
@@ -1138,16 +894,8 @@ psa_status_t psa_mac_abort(psa_mac_operation_t *operation)
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_mac_abort,
                           TFM_CRYPTO_MAC_ABORT);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_MAC_MODULE_DISABLED */
 }
@@ -1201,16 +949,12 @@ psa_status_t psa_aead_encrypt(psa_key_handle_t handle,
         }
     }
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
 #ifdef TFM_PSA_API
     size_t in_len = ARRAY_SIZE(in_vec);
     if (additional_data == NULL) {
         in_len--;
     }
-    status = psa_call(ipc_handle, PSA_IPC_CALL, in_vec, in_len,
+    status = psa_call(TFM_CRYPTO_HANDLE, PSA_IPC_CALL, in_vec, in_len,
                       out_vec, ARRAY_SIZE(out_vec));
 #else
     status = API_DISPATCH(tfm_crypto_aead_encrypt,
@@ -1219,10 +963,6 @@ psa_status_t psa_aead_encrypt(psa_key_handle_t handle,
 
     *ciphertext_length = out_vec[0].len;
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_AEAD_MODULE_DISABLED */
 }
@@ -1276,16 +1016,12 @@ psa_status_t psa_aead_decrypt(psa_key_handle_t handle,
         }
     }
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
 #ifdef TFM_PSA_API
     size_t in_len = ARRAY_SIZE(in_vec);
     if (additional_data == NULL) {
         in_len--;
     }
-    status = psa_call(ipc_handle, PSA_IPC_CALL, in_vec, in_len,
+    status = psa_call(TFM_CRYPTO_HANDLE, PSA_IPC_CALL, in_vec, in_len,
                       out_vec, ARRAY_SIZE(out_vec));
 #else
     status = API_DISPATCH(tfm_crypto_aead_decrypt,
@@ -1294,10 +1030,6 @@ psa_status_t psa_aead_decrypt(psa_key_handle_t handle,
 
     *plaintext_length = out_vec[0].len;
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_AEAD_MODULE_DISABLED */
 }
@@ -1340,19 +1072,11 @@ psa_status_t psa_sign_hash(psa_key_handle_t handle,
     psa_outvec out_vec[] = {
         {.base = signature, .len = signature_size},
     };
-
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
     status = API_DISPATCH(tfm_crypto_sign_hash,
                           TFM_CRYPTO_SIGN_HASH);
 
     *signature_length = out_vec[0].len;
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_ASYMMETRIC_MODULE_DISABLED */
 }
@@ -1392,16 +1116,8 @@ psa_status_t psa_verify_hash(psa_key_handle_t handle,
         {.base = signature, .len = signature_length}
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH_NO_OUTVEC(tfm_crypto_verify_hash,
                                     TFM_CRYPTO_VERIFY_HASH);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_ASYMMETRIC_MODULE_DISABLED */
 }
@@ -1442,16 +1158,12 @@ psa_status_t psa_asymmetric_encrypt(psa_key_handle_t handle,
         {.base = output, .len = output_size},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
 #ifdef TFM_PSA_API
     size_t in_len = ARRAY_SIZE(in_vec);
     if (salt == NULL) {
         in_len--;
     }
-    status = psa_call(ipc_handle, PSA_IPC_CALL, in_vec, in_len,
+    status = psa_call(TFM_CRYPTO_HANDLE, PSA_IPC_CALL, in_vec, in_len,
                       out_vec, ARRAY_SIZE(out_vec));
 #else
     status = API_DISPATCH(tfm_crypto_asymmetric_encrypt,
@@ -1460,10 +1172,6 @@ psa_status_t psa_asymmetric_encrypt(psa_key_handle_t handle,
 
     *output_length = out_vec[0].len;
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_ASYMMETRIC_MODULE_DISABLED */
 }
@@ -1504,16 +1212,12 @@ psa_status_t psa_asymmetric_decrypt(psa_key_handle_t handle,
         {.base = output, .len = output_size},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
 #ifdef TFM_PSA_API
     size_t in_len = ARRAY_SIZE(in_vec);
     if (salt == NULL) {
         in_len--;
     }
-    status = psa_call(ipc_handle, PSA_IPC_CALL, in_vec, in_len,
+    status = psa_call(TFM_CRYPTO_HANDLE, PSA_IPC_CALL, in_vec, in_len,
                       out_vec, ARRAY_SIZE(out_vec));
 #else
     status = API_DISPATCH(tfm_crypto_asymmetric_decrypt,
@@ -1522,10 +1226,6 @@ psa_status_t psa_asymmetric_decrypt(psa_key_handle_t handle,
 
     *output_length = out_vec[0].len;
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_ASYMMETRIC_MODULE_DISABLED */
 }
@@ -1552,16 +1252,8 @@ psa_status_t psa_key_derivation_get_capacity(
         {.base = capacity, .len = sizeof(size_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_key_derivation_get_capacity,
                           TFM_CRYPTO_KEY_DERIVATION_GET_CAPACITY);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1589,16 +1281,8 @@ psa_status_t psa_key_derivation_output_bytes(
         {.base = output, .len = output_length},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_key_derivation_output_bytes,
                           TFM_CRYPTO_KEY_DERIVATION_OUTPUT_BYTES);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1624,16 +1308,8 @@ psa_status_t psa_key_derivation_input_key(
         {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH_NO_OUTVEC(tfm_crypto_key_derivation_input_key,
                                     TFM_CRYPTO_KEY_DERIVATION_INPUT_KEY);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1658,16 +1334,8 @@ psa_status_t psa_key_derivation_abort(psa_key_derivation_operation_t *operation)
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_key_derivation_abort,
                           TFM_CRYPTO_KEY_DERIVATION_ABORT);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1700,17 +1368,9 @@ psa_status_t psa_key_derivation_key_agreement(
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_key_derivation_key_agreement,
                           TFM_CRYPTO_KEY_DERIVATION_KEY_AGREEMENT);
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1739,17 +1399,9 @@ psa_status_t psa_generate_random(uint8_t *output,
         return PSA_SUCCESS;
     }
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_generate_random,
                           TFM_CRYPTO_GENERATE_RANDOM);
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1775,16 +1427,8 @@ psa_status_t psa_generate_key(const psa_key_attributes_t *attributes,
         {.base = handle, .len = sizeof(psa_key_handle_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_generate_key,
                           TFM_CRYPTO_GENERATE_KEY);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1959,19 +1603,11 @@ psa_status_t psa_raw_key_agreement(psa_algorithm_t alg,
     psa_outvec out_vec[] = {
         {.base = output, .len = output_size},
     };
-
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
     status = API_DISPATCH(tfm_crypto_raw_key_agreement,
                           TFM_CRYPTO_RAW_KEY_AGREEMENT);
 
     *output_length = out_vec[0].len;
 
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -1997,16 +1633,8 @@ psa_status_t psa_key_derivation_setup(psa_key_derivation_operation_t *operation,
         {.base = &(operation->handle), .len = sizeof(uint32_t)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_key_derivation_setup,
                           TFM_CRYPTO_KEY_DERIVATION_SETUP);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -2030,16 +1658,8 @@ psa_status_t psa_key_derivation_set_capacity(
         {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH_NO_OUTVEC(tfm_crypto_key_derivation_set_capacity,
                                     TFM_CRYPTO_KEY_DERIVATION_SET_CAPACITY);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -2066,16 +1686,8 @@ psa_status_t psa_key_derivation_input_bytes(
         {.base = data, .len = data_length},
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH_NO_OUTVEC(tfm_crypto_key_derivation_input_bytes,
                                     TFM_CRYPTO_KEY_DERIVATION_INPUT_BYTES);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -2104,16 +1716,8 @@ psa_status_t psa_key_derivation_output_key(
         {.base = handle, .len = sizeof(psa_key_handle_t)}
     };
 
-#ifdef TFM_PSA_API
-    PSA_CONNECT(TFM_CRYPTO);
-#endif
-
     status = API_DISPATCH(tfm_crypto_key_derivation_output_key,
                           TFM_CRYPTO_KEY_DERIVATION_OUTPUT_KEY);
-#ifdef TFM_PSA_API
-    PSA_CLOSE();
-#endif
-
     return status;
 #endif /* TFM_CRYPTO_GENERATOR_MODULE_DISABLED */
 }
@@ -2193,3 +1797,137 @@ psa_status_t psa_aead_update(psa_aead_operation_t *operation,
 
     return status;
 }
+
+__attribute__((section("SFN")))
+static uint32_t *tfm_crypto_batch_entry_handle(
+                                            const psa_batch_entry_t *entry,
+                                            uint32_t *sfn_id)
+{
+    switch (entry->type) {
+    case PSA_BATCH_HASH_UPDATE:
+        *sfn_id = TFM_CRYPTO_HASH_UPDATE_SID;
+        return &entry->operation.hash->handle;
+    case PSA_BATCH_MAC_UPDATE:
+        *sfn_id = TFM_CRYPTO_MAC_UPDATE_SID;
+        return &entry->operation.mac->handle;
+    case PSA_BATCH_CIPHER_UPDATE:
+        *sfn_id = TFM_CRYPTO_CIPHER_UPDATE_SID;
+        return &entry->operation.cipher->handle;
+    default:
+        *sfn_id = TFM_CRYPTO_SID_INVALID;
+        return NULL;
+    }
+}
+
+__attribute__((section("SFN")))
+psa_status_t psa_batch_update(psa_batch_entry_t *entries,
+                              size_t entry_count,
+                              const uint8_t *input,
+                              size_t input_length,
+                              uint8_t *output,
+                              size_t output_size)
+{
+    psa_status_t status = PSA_SUCCESS;
+    struct tfm_crypto_batch_entry batch[TFM_CRYPTO_BATCH_MAX_ENTRIES];
+    struct tfm_crypto_batch_result results[TFM_CRYPTO_BATCH_MAX_ENTRIES];
+    size_t input_used = 0, output_used = 0;
+    size_t nr_entries, i;
+    uint32_t *handle;
+    uint32_t sfn_id;
+    struct tfm_crypto_pack_iovec iov = {
+        .sfn_id = TFM_CRYPTO_BATCH_UPDATE_SID,
+    };
+
+    psa_invec in_vec[] = {
+        {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
+        {.base = batch, .len = 0},
+        {.base = NULL, .len = 0},
+    };
+
+    psa_outvec out_vec[] = {
+        {.base = results, .len = 0},
+        {.base = NULL, .len = 0},
+    };
+
+    /* Check the whole batch before running any of it */
+    for (i = 0; i < entry_count; i++) {
+        if ((tfm_crypto_batch_entry_handle(&entries[i], &sfn_id) == NULL) ||
+            (entries[i].input_length > input_length - input_used)) {
+            return PSA_ERROR_INVALID_ARGUMENT;
+        }
+        input_used += entries[i].input_length;
+
+        if (sfn_id == TFM_CRYPTO_CIPHER_UPDATE_SID) {
+            if (entries[i].output_size > output_size - output_used) {
+                return PSA_ERROR_INVALID_ARGUMENT;
+            }
+            output_used += entries[i].output_size;
+        }
+    }
+
+    for (i = 0; i < entry_count; i++) {
+        entries[i].output_length = 0;
+        entries[i].status = PSA_ERROR_BAD_STATE;
+    }
+
+    /*
+     * Send the entries to the service in groups of at most
+     * TFM_CRYPTO_BATCH_MAX_ENTRIES entries and TFM_CRYPTO_BATCH_MAX_PAYLOAD
+     * bytes of input and output. An entry above the payload limit is sent in
+     * a group of its own, as the single update call would send it.
+     */
+    while ((entry_count > 0) && (status == PSA_SUCCESS)) {
+        input_used = 0;
+        output_used = 0;
+
+        for (i = 0; (i < entry_count) && (i < TFM_CRYPTO_BATCH_MAX_ENTRIES);
+             i++) {
+            handle = tfm_crypto_batch_entry_handle(&entries[i], &sfn_id);
+
+            batch[i].sfn_id = sfn_id;
+            batch[i].op_handle = *handle;
+            batch[i].input_length = (uint32_t)entries[i].input_length;
+            batch[i].output_size = (sfn_id == TFM_CRYPTO_CIPHER_UPDATE_SID) ?
+                                   (uint32_t)entries[i].output_size : 0;
+
+            if ((i > 0) &&
+                (input_used + output_used + batch[i].input_length +
+                 batch[i].output_size > TFM_CRYPTO_BATCH_MAX_PAYLOAD)) {
+                break;
+            }
+
+            /* Kept as is if the service fails before running the entry */
+            results[i].op_handle = *handle;
+            results[i].status = PSA_ERROR_BAD_STATE;
+            results[i].output_length = 0;
+
+            input_used += batch[i].input_length;
+            output_used += batch[i].output_size;
+        }
+        nr_entries = i;
+
+        in_vec[1].len = nr_entries * sizeof(struct tfm_crypto_batch_entry);
+        in_vec[2].base = input;
+        in_vec[2].len = input_used;
+        out_vec[0].len = nr_entries * sizeof(struct tfm_crypto_batch_result);
+        out_vec[1].base = output;
+        out_vec[1].len = output_used;
+
+        status = API_DISPATCH(tfm_crypto_batch_update,
+                              TFM_CRYPTO_BATCH_UPDATE);
+
+        for (i = 0; i < nr_entries; i++) {
+            *tfm_crypto_batch_entry_handle(&entries[i], &sfn_id) =
+                                                        results[i].op_handle;
+            entries[i].output_length = results[i].output_length;
+            entries[i].status = results[i].status;
+        }
+
+        entries += nr_entries;
+        entry_count -= nr_entries;
+        input += input_used;
+        output += output_used;
+    }
+
+    return status;
+}
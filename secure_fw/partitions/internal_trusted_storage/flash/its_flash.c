@@ -53,6 +53,48 @@ const struct its_flash_info_t *its_flash_get_info(enum its_flash_id_t id)
     return ret;
 }
 
+psa_status_t its_flash_get_area_info(enum its_flash_id_t id,
+                                     uint32_t first_block,
+                                     uint32_t num_blocks,
+                                     uint32_t max_num_files,
+                                     struct its_flash_info_t *area_info)
+{
+    const struct its_flash_info_t *info = its_flash_get_info(id);
+    size_t area_offset;
+
+    if (info == NULL || num_blocks > info->num_blocks ||
+        first_block > info->num_blocks - num_blocks ||
+        max_num_files > info->max_num_files) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    area_offset = (size_t)first_block * info->block_size;
+
+    *area_info = *info;
+    area_info->num_blocks = num_blocks;
+    area_info->max_num_files = max_num_files;
+    area_info->fs_info.flash_area_size = (size_t)num_blocks * info->block_size;
+
+    /* The emulated RAM FS addresses its buffer directly, so offset the device
+     * buffer rather than the flash area address.
+     */
+#ifdef ITS_RAM_FS
+    if (id == ITS_FLASH_ID_INTERNAL) {
+        area_info->flash_dev = (uint8_t *)info->flash_dev + area_offset;
+    } else
+#endif
+#ifdef PS_RAM_FS
+    if (id == ITS_FLASH_ID_EXTERNAL) {
+        area_info->flash_dev = (uint8_t *)info->flash_dev + area_offset;
+    } else
+#endif
+    {
+        area_info->fs_info.flash_area_addr += area_offset;
+    }
+
+    return its_flash_fs_validate_params(area_info);
+}
+
 psa_status_t its_flash_block_to_block_move(const struct its_flash_info_t *info,
                                            uint32_t dst_block,
                                            size_t dst_offset,
@@ -94,3 +136,39 @@ psa_status_t its_flash_block_to_block_move(const struct its_flash_info_t *info,
 
     return PSA_SUCCESS;
 }
+
+psa_status_t its_flash_region_is_erased(const struct its_flash_info_t *info,
+                                        uint32_t block_id, size_t offset,
+                                        size_t size, bool *is_erased)
+{
+    psa_status_t status;
+    size_t bytes_to_check;
+    size_t i;
+    uint8_t block_data_copy[ITS_MAX_BLOCK_DATA_COPY];
+
+    *is_erased = false;
+
+    while (size > 0) {
+        /* Calculates the number of bytes to check */
+        bytes_to_check = ITS_UTILS_MIN(size, ITS_MAX_BLOCK_DATA_COPY);
+
+        status = info->read(info, block_id, block_data_copy, offset,
+                            bytes_to_check);
+        if (status != PSA_SUCCESS) {
+            return status;
+        }
+
+        for (i = 0; i < bytes_to_check; i++) {
+            if (block_data_copy[i] != info->erase_val) {
+                return PSA_SUCCESS;
+            }
+        }
+
+        offset += bytes_to_check;
+        size -= bytes_to_check;
+    }
+
+    *is_erased = true;
+
+    return PSA_SUCCESS;
+}
@@ -9,6 +9,7 @@
 #ifndef __ITS_FLASH_H__
 #define __ITS_FLASH_H__
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -179,6 +180,29 @@ struct its_flash_info_t {
  */
 const struct its_flash_info_t *its_flash_get_info(enum its_flash_id_t id);
 
+/**
+ * \brief Gets the flash info for an area of the provided flash device, which
+ *        can hold its own filesystem.
+ *
+ * \param[in]  id             Identifier of the flash device.
+ * \param[in]  first_block    First block of the device used by the area.
+ * \param[in]  num_blocks     Number of blocks of the area.
+ * \param[in]  max_num_files  Maximum number of files stored in the area. It
+ *                            must not exceed the maximum of the device.
+ * \param[out] area_info      Flash info struct to fill in for the area. It
+ *                            must remain allocated while any filesystem uses
+ *                            it.
+ *
+ * \return Returns PSA_SUCCESS if the area is compatible with the filesystem.
+ *         Otherwise, it returns an error code as specified in
+ *         \ref psa_status_t
+ */
+psa_status_t its_flash_get_area_info(enum its_flash_id_t id,
+                                     uint32_t first_block,
+                                     uint32_t num_blocks,
+                                     uint32_t max_num_files,
+                                     struct its_flash_info_t *area_info);
+
 /**
  * \brief Moves data from source block ID to destination block ID.
  *
@@ -206,6 +230,26 @@ psa_status_t its_flash_block_to_block_move(const struct its_flash_info_t *info,
                                            size_t src_offset,
                                            size_t size);
 
+/**
+ * \brief Checks if a flash region is in the erased state.
+ *
+ * \param[in]  info       Flash device information
+ * \param[in]  block_id   Block ID
+ * \param[in]  offset     Offset position from the init of the block
+ * \param[in]  size       Number of bytes to check
+ * \param[out] is_erased  Set to true if all the bytes of the region have the
+ *                        erase value of the device, false otherwise
+ *
+ * \note This function assumes all input values are valid. That is, the address
+ *       range, based on block_id, offset and size, is a valid range in flash.
+ *
+ * \return Returns PSA_SUCCESS if the function is executed correctly. Otherwise,
+ *         it returns PSA_ERROR_STORAGE_FAILURE.
+ */
+psa_status_t its_flash_region_is_erased(const struct its_flash_info_t *info,
+                                        uint32_t block_id, size_t offset,
+                                        size_t size, bool *is_erased);
+
 #ifdef __cplusplus
 }
 #endif
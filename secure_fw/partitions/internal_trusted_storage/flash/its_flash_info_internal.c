@@ -75,6 +75,17 @@
 /* Calculate the block layout */
 #define FLASH_INFO_BLOCK_SIZE (ITS_SECTOR_SIZE * ITS_SECTORS_PER_BLOCK)
 
+/* The ITS filesystem areas must cover exactly the blocks of the ITS flash
+ * area, so that no block is left unused.
+ */
+#if defined(ITS_FS_AREA_TOTAL_BLOCKS) && defined(ITS_FLASH_AREA_SIZE)
+#if ((ITS_FLASH_AREA_SIZE % FLASH_INFO_BLOCK_SIZE) != 0)
+#error "ITS_FLASH_AREA_SIZE must be a whole number of ITS blocks"
+#elif ((ITS_FLASH_AREA_SIZE / FLASH_INFO_BLOCK_SIZE) != ITS_FS_AREA_TOTAL_BLOCKS)
+#error "ITS_FS_AREA_BLOCKS must add up to the blocks of the ITS flash area"
+#endif
+#endif
+
 /* Maximum file size */
 #define FLASH_INFO_MAX_FILE_SIZE ITS_UTILS_ALIGN(ITS_MAX_ASSET_SIZE, \
                                                  ITS_FLASH_ALIGNMENT)
@@ -8,6 +8,78 @@
 #include "its_flash_ram.h"
 #include "tfm_memory_utils.h"
 
+/* Simulated latency of a program operation, in busy-wait iterations per
+ * program unit.
+ */
+#ifndef ITS_RAM_FS_PROGRAM_LATENCY
+#define ITS_RAM_FS_PROGRAM_LATENCY 0
+#endif
+
+/* Simulated latency of a block erase operation, in busy-wait iterations */
+#ifndef ITS_RAM_FS_ERASE_LATENCY
+#define ITS_RAM_FS_ERASE_LATENCY 0
+#endif
+
+#ifdef ITS_RAM_FS_STATS
+#ifdef ITS_NUM_FS_AREAS
+/* One emulated device for each ITS filesystem area and one for PS */
+#define ITS_RAM_FS_STATS_MAX_DEVICES (ITS_NUM_FS_AREAS + 1)
+#else
+/* One emulated device for ITS and one for PS */
+#define ITS_RAM_FS_STATS_MAX_DEVICES 2
+#endif
+
+static struct {
+    const void *flash_dev;
+    struct its_flash_ram_stats_t stats;
+} ram_stats[ITS_RAM_FS_STATS_MAX_DEVICES];
+
+/**
+ * \brief Gets the statistics entry of the given flash device, allocating one
+ *        on first use.
+ *
+ * \param[in] info  Flash device information
+ *
+ * \returns Returns a pointer to the statistics entry, or NULL if all entries
+ *          are in use by other devices.
+ */
+static struct its_flash_ram_stats_t *get_stats(
+                                          const struct its_flash_info_t *info)
+{
+    uint32_t i;
+
+    for (i = 0; i < ITS_RAM_FS_STATS_MAX_DEVICES; i++) {
+        if (ram_stats[i].flash_dev == info->flash_dev) {
+            return &ram_stats[i].stats;
+        }
+    }
+
+    for (i = 0; i < ITS_RAM_FS_STATS_MAX_DEVICES; i++) {
+        if (ram_stats[i].flash_dev == NULL) {
+            ram_stats[i].flash_dev = info->flash_dev;
+            return &ram_stats[i].stats;
+        }
+    }
+
+    return NULL;
+}
+#endif /* ITS_RAM_FS_STATS */
+
+#if (ITS_RAM_FS_PROGRAM_LATENCY != 0) || (ITS_RAM_FS_ERASE_LATENCY != 0)
+/**
+ * \brief Busy-waits to simulate the latency of a flash operation.
+ *
+ * \param[in] iterations  Number of iterations to wait
+ */
+static void simulate_latency(uint32_t iterations)
+{
+    volatile uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+    }
+}
+#endif
+
 /**
  * \brief Gets physical address of the given block ID.
  *
@@ -35,9 +107,18 @@ psa_status_t its_flash_ram_read(const struct its_flash_info_t *info,
                                 size_t size)
 {
     uint32_t idx = get_phys_address(info, block_id, offset);
+#ifdef ITS_RAM_FS_STATS
+    struct its_flash_ram_stats_t *stats = get_stats(info);
+#endif
 
     (void)tfm_memcpy(buff, (uint8_t *)info->flash_dev + idx, size);
 
+#ifdef ITS_RAM_FS_STATS
+    if (stats) {
+        stats->read_bytes += size;
+    }
+#endif
+
     return PSA_SUCCESS;
 }
 
@@ -46,9 +127,24 @@ psa_status_t its_flash_ram_write(const struct its_flash_info_t *info,
                                  size_t offset, size_t size)
 {
     uint32_t idx = get_phys_address(info, block_id, offset);
+#ifdef ITS_RAM_FS_STATS
+    struct its_flash_ram_stats_t *stats = get_stats(info);
+#endif
 
     (void)tfm_memcpy((uint8_t *)info->flash_dev + idx, buff, size);
 
+#if (ITS_RAM_FS_PROGRAM_LATENCY != 0)
+    simulate_latency(ITS_RAM_FS_PROGRAM_LATENCY *
+                     ((size + info->program_unit - 1) / info->program_unit));
+#endif
+
+#ifdef ITS_RAM_FS_STATS
+    if (stats) {
+        stats->program_bytes += size;
+        stats->program_count++;
+    }
+#endif
+
     return PSA_SUCCESS;
 }
 
@@ -65,9 +161,50 @@ psa_status_t its_flash_ram_erase(const struct its_flash_info_t *info,
                                  uint32_t block_id)
 {
     uint32_t idx = get_phys_address(info, block_id, 0);
+#ifdef ITS_RAM_FS_STATS
+    struct its_flash_ram_stats_t *stats = get_stats(info);
+#endif
 
     (void)tfm_memset((uint8_t *)info->flash_dev + idx, info->erase_val,
                      info->block_size);
 
+#if (ITS_RAM_FS_ERASE_LATENCY != 0)
+    simulate_latency(ITS_RAM_FS_ERASE_LATENCY);
+#endif
+
+#ifdef ITS_RAM_FS_STATS
+    if (stats) {
+        stats->erase_count++;
+        if (block_id < ITS_RAM_FS_STATS_MAX_BLOCKS) {
+            stats->block_erase_count[block_id]++;
+        }
+    }
+#endif
+
     return PSA_SUCCESS;
 }
+
+#ifdef ITS_RAM_FS_STATS
+psa_status_t its_flash_ram_get_stats(const struct its_flash_info_t *info,
+                                     struct its_flash_ram_stats_t *stats)
+{
+    struct its_flash_ram_stats_t *dev_stats = get_stats(info);
+
+    if (!dev_stats) {
+        return PSA_ERROR_DOES_NOT_EXIST;
+    }
+
+    (void)tfm_memcpy(stats, dev_stats, sizeof(*stats));
+
+    return PSA_SUCCESS;
+}
+
+void its_flash_ram_reset_stats(const struct its_flash_info_t *info)
+{
+    struct its_flash_ram_stats_t *dev_stats = get_stats(info);
+
+    if (dev_stats) {
+        (void)tfm_memset(dev_stats, 0, sizeof(*dev_stats));
+    }
+}
+#endif /* ITS_RAM_FS_STATS */
@@ -14,6 +14,31 @@
 
 #include "its_flash.h"
 
+#ifdef ITS_RAM_FS_STATS
+#ifndef ITS_RAM_FS_STATS_MAX_BLOCKS
+#define ITS_RAM_FS_STATS_MAX_BLOCKS 32
+#endif
+
+/**
+ * \struct its_flash_ram_stats_t
+ *
+ * \brief Access statistics collected for an emulated flash device.
+ *
+ * \note Erases of blocks with an ID greater than or equal to
+ *       ITS_RAM_FS_STATS_MAX_BLOCKS are only accounted in \ref erase_count.
+ */
+struct its_flash_ram_stats_t {
+    uint32_t read_bytes;      /**< Number of bytes read */
+    uint32_t program_bytes;   /**< Number of bytes programmed */
+    uint32_t program_count;   /**< Number of program operations */
+    uint32_t erase_count;     /**< Number of block erase operations */
+    uint32_t block_erase_count[ITS_RAM_FS_STATS_MAX_BLOCKS]; /**< Number of
+                                                             *   erases of each
+                                                             *   block
+                                                             */
+};
+#endif /* ITS_RAM_FS_STATS */
+
 /**
  * \brief Initialize the Flash Interface.
  */
@@ -43,3 +68,25 @@ psa_status_t its_flash_ram_flush(const struct its_flash_info_t *info);
  */
 psa_status_t its_flash_ram_erase(const struct its_flash_info_t *info,
                                  uint32_t block_id);
+
+#ifdef ITS_RAM_FS_STATS
+/**
+ * \brief Gets the access statistics of an emulated flash device.
+ *
+ * \param[in]  info   Flash device information
+ * \param[out] stats  Pointer to the structure to store the statistics
+ *
+ * \return Returns PSA_SUCCESS if the statistics are copied. Otherwise, it
+ *         returns PSA_ERROR_DOES_NOT_EXIST if no statistics are available for
+ *         the device.
+ */
+psa_status_t its_flash_ram_get_stats(const struct its_flash_info_t *info,
+                                     struct its_flash_ram_stats_t *stats);
+
+/**
+ * \brief Resets the access statistics of an emulated flash device.
+ *
+ * \param[in] info  Flash device information
+ */
+void its_flash_ram_reset_stats(const struct its_flash_info_t *info);
+#endif /* ITS_RAM_FS_STATS */
@@ -28,7 +28,8 @@ static psa_status_t its_flash_fs_file_write_aligned_data(
                                       const struct its_file_meta_t *file_meta,
                                       size_t offset,
                                       size_t size,
-                                      const uint8_t *data)
+                                      const uint8_t *data,
+                                      bool *in_place)
 {
 #if (ITS_FLASH_MAX_ALIGNMENT != 1)
     /* Check that the offset is aligned with the flash program unit */
@@ -52,7 +53,7 @@ static psa_status_t its_flash_fs_file_write_aligned_data(
     }
 
     return its_flash_fs_dblock_write_file(fs_ctx, block_meta, file_meta, offset,
-                                          size, data);
+                                          size, data, in_place);
 }
 
 psa_status_t its_flash_fs_prepare(struct its_flash_fs_ctx_t *fs_ctx,
@@ -151,12 +152,17 @@ psa_status_t its_flash_fs_file_write(struct its_flash_fs_ctx_t *fs_ctx,
 {
     struct its_block_meta_t block_meta;
     struct its_file_meta_t file_meta;
+    struct its_file_meta_t old_file_meta;
     uint32_t cur_phys_block;
     psa_status_t err;
     uint32_t idx;
     uint32_t old_idx = ITS_METADATA_INVALID_INDEX;
     uint32_t new_idx = ITS_METADATA_INVALID_INDEX;
     bool use_spare;
+    bool in_place = false;
+#ifdef ITS_METADATA_CACHE
+    struct its_block_meta_t cur_block_meta;
+#endif
 
     /* Do not permit the user to pass filesystem-internal flags */
     if (flags & ITS_FLASH_FS_INTERNAL_FLAGS_MASK) {
@@ -185,20 +191,10 @@ psa_status_t its_flash_fs_file_write(struct its_flash_fs_ctx_t *fs_ctx,
                 file_meta.cur_size = 0;
                 file_meta.flags = flags;
                 new_idx = old_idx;
-            } else {
-                /* Mark the existing file to be deleted in this block update. It
-                 * will be deleted in a second block update, and if there is a
-                 * power failure before that block update completes, then
-                 * deletion will be re-attempted based on this flag.
-                 */
-                file_meta.flags |= ITS_FLASH_FS_FLAG_DELETE;
-                err = its_flash_fs_mblock_update_scratch_file_meta(fs_ctx,
-                                                                   old_idx,
-                                                                   &file_meta);
-                if (err != PSA_SUCCESS) {
-                    return PSA_ERROR_GENERIC_ERROR;
-                }
             }
+            /* Otherwise, a new file is reserved and the existing file is
+             * marked to be deleted once the new file data has been written.
+             */
         } else {
             /* Write to existing file */
             new_idx = old_idx;
@@ -238,11 +234,33 @@ psa_status_t its_flash_fs_file_write(struct its_flash_fs_ctx_t *fs_ctx,
         }
     }
 
+#ifdef ITS_METADATA_CACHE
+    /* If the batch can not take the new data without copying the block
+     * again, then commit the batch first.
+     */
+    if ((data_size != 0) && its_flash_fs_mblock_batch_is_open(fs_ctx) &&
+        !its_flash_fs_mblock_batch_can_write(fs_ctx, file_meta.lblock,
+                                             file_meta.data_idx + offset)) {
+        err = its_flash_fs_mblock_batch_commit(fs_ctx);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        /* Logical block 0 has moved to the new active metadata block */
+        err = its_flash_fs_mblock_read_block_metadata(fs_ctx, file_meta.lblock,
+                                                      &cur_block_meta);
+        if (err != PSA_SUCCESS) {
+            return PSA_ERROR_GENERIC_ERROR;
+        }
+        block_meta.phy_id = cur_block_meta.phy_id;
+    }
+#endif
+
     if (data_size != 0) {
         /* Write the content into scratch data block */
         err = its_flash_fs_file_write_aligned_data(fs_ctx, &block_meta,
                                                    &file_meta, offset,
-                                                   data_size, data);
+                                                   data_size, data, &in_place);
         if (err != PSA_SUCCESS) {
             return PSA_ERROR_GENERIC_ERROR;
         }
@@ -253,15 +271,43 @@ psa_status_t its_flash_fs_file_write(struct its_flash_fs_ctx_t *fs_ctx,
             file_meta.cur_size = offset + data_size;
         }
 
-        cur_phys_block = block_meta.phy_id;
+        /* Data written in place stays in the same block */
+        if (!in_place) {
+            cur_phys_block = block_meta.phy_id;
+
+            /* Cur scratch block become the active datablock */
+            block_meta.phy_id =
+                its_flash_fs_mblock_cur_data_scratch_id(fs_ctx,
+                                                        file_meta.lblock);
+
+            /* Swap the scratch data block */
+            its_flash_fs_mblock_set_data_scratch(fs_ctx, cur_phys_block,
+                                                 file_meta.lblock);
+#ifdef ITS_WEAR_LEVELING
+            its_flash_fs_mblock_swap_erase_count(fs_ctx, &block_meta,
+                                                 file_meta.lblock);
+#endif
+        }
+    }
 
-        /* Cur scratch block become the active datablock */
-        block_meta.phy_id =
-            its_flash_fs_mblock_cur_data_scratch_id(fs_ctx, file_meta.lblock);
+    if (old_idx != ITS_METADATA_INVALID_INDEX && old_idx != new_idx) {
+        /* Mark the existing file to be deleted in this block update. It will be
+         * deleted in a second block update, and if there is a power failure
+         * before that block update completes, then deletion will be
+         * re-attempted based on this flag.
+         */
+        err = its_flash_fs_mblock_read_file_meta(fs_ctx, old_idx,
+                                                 &old_file_meta);
+        if (err != PSA_SUCCESS) {
+            return PSA_ERROR_GENERIC_ERROR;
+        }
 
-        /* Swap the scratch data block */
-        its_flash_fs_mblock_set_data_scratch(fs_ctx, cur_phys_block,
-                                             file_meta.lblock);
+        old_file_meta.flags |= ITS_FLASH_FS_FLAG_DELETE;
+        err = its_flash_fs_mblock_update_scratch_file_meta(fs_ctx, old_idx,
+                                                           &old_file_meta);
+        if (err != PSA_SUCCESS) {
+            return PSA_ERROR_GENERIC_ERROR;
+        }
     }
 
     /* Update block metadata in scratch metadata block */
@@ -351,6 +397,27 @@ static psa_status_t its_flash_fs_delete_idx(struct its_flash_fs_ctx_t *fs_ctx,
     uint32_t idx;
     struct its_file_meta_t file_meta;
 
+#ifdef ITS_METADATA_CACHE
+    if (its_flash_fs_mblock_batch_is_open(fs_ctx)) {
+        /* Compacting a block rewrites data that the batch may have written in
+         * place, so the deletion is done in its own block update between two
+         * batches.
+         */
+        err = its_flash_fs_mblock_batch_end(fs_ctx);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        err = its_flash_fs_delete_idx(fs_ctx, del_file_idx);
+        if (err != PSA_SUCCESS) {
+            (void)its_flash_fs_mblock_batch_begin(fs_ctx);
+            return err;
+        }
+
+        return its_flash_fs_mblock_batch_begin(fs_ctx);
+    }
+#endif
+
     err = its_flash_fs_mblock_read_file_meta(fs_ctx, del_file_idx, &file_meta);
     if (err != PSA_SUCCESS) {
         return err;
@@ -466,6 +533,18 @@ psa_status_t its_flash_fs_file_delete(struct its_flash_fs_ctx_t *fs_ctx,
     return its_flash_fs_delete_idx(fs_ctx, del_file_idx);
 }
 
+#ifdef ITS_METADATA_CACHE
+psa_status_t its_flash_fs_batch_begin(struct its_flash_fs_ctx_t *fs_ctx)
+{
+    return its_flash_fs_mblock_batch_begin(fs_ctx);
+}
+
+psa_status_t its_flash_fs_batch_end(struct its_flash_fs_ctx_t *fs_ctx)
+{
+    return its_flash_fs_mblock_batch_end(fs_ctx);
+}
+#endif /* ITS_METADATA_CACHE */
+
 psa_status_t its_flash_fs_file_read(struct its_flash_fs_ctx_t *fs_ctx,
                                     const uint8_t *fid,
                                     size_t size,
@@ -570,6 +649,13 @@ psa_status_t its_flash_fs_validate_params(const struct its_flash_info_t *info)
         ret = PSA_ERROR_STORAGE_FAILURE;
     }
 
+#ifdef ITS_FILE_INDEX
+    /* The file index must be large enough for all files */
+    if (info->max_num_files > ITS_FILE_INDEX_MAX_FILES) {
+        ret = PSA_ERROR_STORAGE_FAILURE;
+    }
+#endif
+
     /* Metadata must fit in a flash block */
     if (its_flash_fs_all_metadata_size(info) > info->block_size) {
         ret = PSA_ERROR_STORAGE_FAILURE;
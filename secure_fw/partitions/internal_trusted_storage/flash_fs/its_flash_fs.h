@@ -165,6 +165,32 @@ psa_status_t its_flash_fs_file_read(its_flash_fs_ctx_t *fs_ctx,
 psa_status_t its_flash_fs_file_delete(its_flash_fs_ctx_t *fs_ctx,
                                       const uint8_t *fid);
 
+#ifdef ITS_METADATA_CACHE
+/**
+ * \brief Starts a batch of filesystem updates.
+ *
+ * Until the batch is ended, file writes and deletes update a RAM copy of the
+ * metadata and are committed together with a single metadata block swap. The
+ * batch is committed atomically: a power failure before the batch is ended
+ * loses every update made since the batch started, or since the filesystem
+ * last had to commit the batch early.
+ *
+ * \param[in,out] fs_ctx  Filesystem context
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+psa_status_t its_flash_fs_batch_begin(its_flash_fs_ctx_t *fs_ctx);
+
+/**
+ * \brief Commits the updates of the batch and ends it.
+ *
+ * \param[in,out] fs_ctx  Filesystem context
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+psa_status_t its_flash_fs_batch_end(its_flash_fs_ctx_t *fs_ctx);
+#endif /* ITS_METADATA_CACHE */
+
 /**
  * \brief Validates the configuration of the flash filesystem.
  *
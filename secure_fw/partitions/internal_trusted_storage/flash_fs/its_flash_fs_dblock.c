@@ -54,6 +54,7 @@ psa_status_t its_flash_fs_dblock_compact_block(
 
     /* Save scratch data block physical IDs */
     scratch_id = its_flash_fs_mblock_cur_data_scratch_id(fs_ctx, lblock);
+    its_flash_fs_mblock_use_data_scratch(fs_ctx, lblock);
 
     /* Check if there are bytes to be compacted */
     if (size > 0) {
@@ -90,6 +91,9 @@ psa_status_t its_flash_fs_dblock_compact_block(
 
     /* Set scratch block ID as the one which contains the new data block */
     block_meta.phy_id = scratch_id;
+#ifdef ITS_WEAR_LEVELING
+    its_flash_fs_mblock_swap_erase_count(fs_ctx, &block_meta, lblock);
+#endif
 
     /* Update block metadata in scratch metadata block */
     err = its_flash_fs_mblock_update_scratch_block_meta(fs_ctx, lblock,
@@ -97,6 +101,9 @@ psa_status_t its_flash_fs_dblock_compact_block(
     if (err != PSA_SUCCESS) {
         /* Swap back the data block as there was an issue in the process */
         its_flash_fs_mblock_set_data_scratch(fs_ctx, scratch_id, lblock);
+#ifdef ITS_WEAR_LEVELING
+        its_flash_fs_mblock_swap_erase_count(fs_ctx, &block_meta, lblock);
+#endif
         return err;
     }
 
@@ -132,25 +139,122 @@ psa_status_t its_flash_fs_dblock_read_file(
                                     size);
 }
 
+#if defined(ITS_METADATA_CACHE) || defined(ITS_APPEND_IN_PLACE)
+/**
+ * \brief Writes file data directly in the current physical block of a logical
+ *        block, in an area that has not been programmed since it was erased.
+ *
+ * \param[in,out] fs_ctx      Filesystem context
+ * \param[in]     block_meta  Block metadata
+ * \param[in]     lblock      Logical block number
+ * \param[in]     pos         Position of the data in the block
+ * \param[in]     size        Size of the data
+ * \param[in]     data        Pointer to the data
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_dblock_write_in_place(
+                                      struct its_flash_fs_ctx_t *fs_ctx,
+                                      const struct its_block_meta_t *block_meta,
+                                      uint32_t lblock,
+                                      size_t pos,
+                                      size_t size,
+                                      const uint8_t *data)
+{
+    psa_status_t err;
+
+    err = fs_ctx->flash_info->write(fs_ctx->flash_info, block_meta->phy_id,
+                                    data, pos, size);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    /* Logical data block 0 is flushed at the end of the metadata block
+     * update.
+     */
+    if (lblock != ITS_LOGICAL_DBLOCK0) {
+        err = fs_ctx->flash_info->flush(fs_ctx->flash_info);
+    }
+
+    return err;
+}
+
+#endif /* ITS_METADATA_CACHE || ITS_APPEND_IN_PLACE */
+
 psa_status_t its_flash_fs_dblock_write_file(
                                       struct its_flash_fs_ctx_t *fs_ctx,
                                       const struct its_block_meta_t *block_meta,
                                       const struct its_file_meta_t *file_meta,
                                       size_t offset,
                                       size_t size,
-                                      const uint8_t *data)
+                                      const uint8_t *data,
+                                      bool *in_place)
 {
     psa_status_t err;
     uint32_t scratch_id;
     size_t pos;
     size_t num_bytes;
-
-    scratch_id = its_flash_fs_mblock_cur_data_scratch_id(fs_ctx,
-                                                         file_meta->lblock);
+#ifdef ITS_METADATA_CACHE
+    size_t written_end;
+#endif
+#ifdef ITS_APPEND_IN_PLACE
+    bool is_erased;
+#endif
 
     /* Calculate the position of the new file data in the block */
     pos = file_meta->data_idx + offset;
 
+#ifdef ITS_METADATA_CACHE
+    if (its_flash_fs_mblock_batch_in_place(fs_ctx, file_meta->lblock)) {
+        /* The block has already been copied by this batch and the area being
+         * written has not been programmed since, so the new data is written
+         * directly in the block.
+         */
+        err = its_dblock_write_in_place(fs_ctx, block_meta, file_meta->lblock,
+                                        pos, size, data);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        its_flash_fs_mblock_batch_set_written(fs_ctx, file_meta->lblock,
+                                              pos + size);
+        *in_place = true;
+        return PSA_SUCCESS;
+    }
+
+    written_end = pos + size;
+#endif
+
+#ifdef ITS_APPEND_IN_PLACE
+    /* Data appended to a file in a dedicated data block is written directly
+     * after the current end of the file, if that area is still erased. The
+     * new data is not part of the file until the file metadata is updated,
+     * and an area programmed by an update interrupted by a power failure is
+     * no longer seen as erased.
+     */
+    if ((file_meta->lblock != ITS_LOGICAL_DBLOCK0) &&
+        (offset == file_meta->cur_size)) {
+        err = its_flash_region_is_erased(fs_ctx->flash_info, block_meta->phy_id,
+                                         pos, size, &is_erased);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        if (is_erased) {
+            *in_place = true;
+            return its_dblock_write_in_place(fs_ctx, block_meta,
+                                             file_meta->lblock, pos, size,
+                                             data);
+        }
+    }
+#endif
+
+    *in_place = false;
+
+    scratch_id = its_flash_fs_mblock_cur_data_scratch_id(fs_ctx,
+                                                         file_meta->lblock);
+    its_flash_fs_mblock_use_data_scratch(fs_ctx, file_meta->lblock);
+
     /* Move data up to the new file data position */
     err = its_flash_block_to_block_move(fs_ctx->flash_info,
                                         scratch_id,
@@ -182,6 +286,19 @@ psa_status_t its_flash_fs_dblock_write_file(
         return err;
     }
 
+#ifdef ITS_METADATA_CACHE
+    if (its_flash_fs_mblock_batch_is_open(fs_ctx)) {
+        /* Record how much of the scratch block has been programmed, so that
+         * later writes in the batch can append to it in place.
+         */
+        if (num_bytes > 0) {
+            written_end = ITS_UTILS_MAX(written_end, pos + num_bytes);
+        }
+        its_flash_fs_mblock_batch_set_written(fs_ctx, file_meta->lblock,
+                                              written_end);
+    }
+#endif
+
     /* Commit data block modifications to flash, unless the data is in logical
      * data block 0, in which case it will be flushed at the end of the metadata
      * block update.
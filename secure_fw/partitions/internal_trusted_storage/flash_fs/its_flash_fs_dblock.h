@@ -8,12 +8,19 @@
 #ifndef __ITS_FLASH_FS_DBLOCK_H__
 #define __ITS_FLASH_FS_DBLOCK_H__
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 #include "psa/error.h"
 #include "its_flash_fs_mblock.h"
 
+#ifdef ITS_APPEND_IN_PLACE
+#if (ITS_FLASH_PROGRAM_UNIT > 16) || (PS_FLASH_PROGRAM_UNIT > 16)
+#error "ITS_APPEND_IN_PLACE requires flash devices that can be programmed in place"
+#endif
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -70,6 +77,9 @@ psa_status_t its_flash_fs_dblock_read_file(
  * \param[in]     size        Size of the incoming data
  * \param[in]     data        Pointer to data buffer to copy in the scratch data
  *                            block
+ * \param[out]    in_place    Set to true if the data was written directly in
+ *                            the current physical block of the logical block,
+ *                            instead of the scratch data block
  *
  * \return Returns error code as specified in \ref psa_status_t
  */
@@ -79,7 +89,8 @@ psa_status_t its_flash_fs_dblock_write_file(
                                       const struct its_file_meta_t *file_meta,
                                       size_t offset,
                                       size_t size,
-                                      const uint8_t *data);
+                                      const uint8_t *data,
+                                      bool *in_place);
 
 #ifdef __cplusplus
 }
@@ -130,6 +130,59 @@ static size_t its_mblock_file_meta_offset(struct its_flash_fs_ctx_t *fs_ctx,
            + (idx * ITS_FILE_METADATA_SIZE);
 }
 
+/**
+ * \brief Reads metadata from the active metadata block, or from the metadata
+ *        cache if a batch is open.
+ *
+ * \param[in,out] fs_ctx  Filesystem context
+ * \param[out]    buf     Buffer to store the metadata
+ * \param[in]     pos     Offset in the metadata block
+ * \param[in]     size    Number of bytes to read
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_mblock_read_active(struct its_flash_fs_ctx_t *fs_ctx,
+                                           uint8_t *buf, size_t pos,
+                                           size_t size)
+{
+#ifdef ITS_METADATA_CACHE
+    if (fs_ctx->batch.open) {
+        (void)tfm_memcpy(buf, &fs_ctx->batch.cache[pos], size);
+        return PSA_SUCCESS;
+    }
+#endif
+
+    return fs_ctx->flash_info->read(fs_ctx->flash_info,
+                                    fs_ctx->active_metablock, buf, pos, size);
+}
+
+/**
+ * \brief Writes metadata to the scratch metadata block, or to the metadata
+ *        cache if a batch is open.
+ *
+ * \param[in,out] fs_ctx  Filesystem context
+ * \param[in]     buf     Buffer containing the metadata
+ * \param[in]     pos     Offset in the metadata block
+ * \param[in]     size    Number of bytes to write
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_mblock_write_scratch(struct its_flash_fs_ctx_t *fs_ctx,
+                                             const uint8_t *buf, size_t pos,
+                                             size_t size)
+{
+#ifdef ITS_METADATA_CACHE
+    if (fs_ctx->batch.open) {
+        (void)tfm_memcpy(&fs_ctx->batch.cache[pos], buf, size);
+        fs_ctx->batch.dirty = true;
+        return PSA_SUCCESS;
+    }
+#endif
+
+    return fs_ctx->flash_info->write(fs_ctx->flash_info,
+                                     fs_ctx->scratch_metablock, buf, pos, size);
+}
+
 /**
  * \brief Swaps metablocks. Scratch becomes active and active becomes scratch.
  *
@@ -306,6 +359,161 @@ static inline psa_status_t its_mblock_validate_block_meta(
 }
 #endif /* ITS_VALIDATE_METADATA_FROM_FLASH */
 
+#ifdef ITS_FILE_INDEX
+#define ITS_FILE_INDEX_BIT_IS_SET(bitmap, idx) \
+    (((bitmap)[(idx) / 32] & (1U << ((idx) % 32))) != 0)
+#define ITS_FILE_INDEX_SET_BIT(bitmap, idx) \
+    ((bitmap)[(idx) / 32] |= (1U << ((idx) % 32)))
+#define ITS_FILE_INDEX_CLEAR_BIT(bitmap, idx) \
+    ((bitmap)[(idx) / 32] &= ~(1U << ((idx) % 32)))
+
+/**
+ * \brief Computes the hash of a file ID (32-bit FNV-1a).
+ *
+ * \param[in] fid  File ID
+ *
+ * \return Hash of the file ID
+ */
+static uint32_t its_file_index_hash(const uint8_t *fid)
+{
+    uint32_t hash = 2166136261U;
+    uint32_t i;
+
+    for (i = 0; i < ITS_FILE_ID_SIZE; i++) {
+        hash = (hash ^ fid[i]) * 16777619U;
+    }
+
+    return hash;
+}
+
+/**
+ * \brief Inserts a file metadata entry index in the hash table.
+ *
+ * \param[in,out] index  File index
+ * \param[in]     idx    File metadata entry index, with its hash already set
+ */
+static void its_file_index_insert(struct its_file_index_t *index, uint32_t idx)
+{
+    uint32_t slot = index->hash[idx] % ITS_FILE_INDEX_NUM_SLOTS;
+
+    /* The table has twice as many slots as entries, so an empty slot is
+     * always found.
+     */
+    while (index->slots[slot] != 0) {
+        slot = (slot + 1) % ITS_FILE_INDEX_NUM_SLOTS;
+    }
+
+    index->slots[slot] = (uint16_t)(idx + 1);
+}
+
+/**
+ * \brief Removes a file metadata entry index from the hash table.
+ *
+ * \param[in,out] index  File index
+ * \param[in]     idx    File metadata entry index
+ */
+static void its_file_index_remove(struct its_file_index_t *index, uint32_t idx)
+{
+    uint32_t hole;
+    uint32_t home;
+    uint32_t slot = index->hash[idx] % ITS_FILE_INDEX_NUM_SLOTS;
+    uint32_t i;
+
+    for (i = 0; index->slots[slot] != (uint16_t)(idx + 1); i++) {
+        if (i == ITS_FILE_INDEX_NUM_SLOTS) {
+            return;
+        }
+        slot = (slot + 1) % ITS_FILE_INDEX_NUM_SLOTS;
+    }
+
+    /* Shift back the following entries of the probe sequence which would not
+     * be reachable anymore from their home slot through the emptied slot.
+     */
+    hole = slot;
+    slot = (slot + 1) % ITS_FILE_INDEX_NUM_SLOTS;
+    while (index->slots[slot] != 0) {
+        home = index->hash[index->slots[slot] - 1] % ITS_FILE_INDEX_NUM_SLOTS;
+        if ((hole <= slot) ? ((home <= hole) || (home > slot))
+                           : ((home <= hole) && (home > slot))) {
+            index->slots[hole] = index->slots[slot];
+            hole = slot;
+        }
+        slot = (slot + 1) % ITS_FILE_INDEX_NUM_SLOTS;
+    }
+
+    index->slots[hole] = 0;
+}
+
+/**
+ * \brief Builds the file index from the active metadata block.
+ *
+ * \param[in,out] fs_ctx  Filesystem context
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_file_index_build(struct its_flash_fs_ctx_t *fs_ctx)
+{
+    struct its_file_index_t *index = &fs_ctx->file_index;
+    struct its_file_meta_t tmp_metadata;
+    psa_status_t err;
+    uint32_t i;
+
+    (void)tfm_memset(index, 0, sizeof(*index));
+
+    for (i = 0; i < fs_ctx->flash_info->max_num_files; i++) {
+        err = its_flash_fs_mblock_read_file_meta(fs_ctx, i, &tmp_metadata);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        if (its_utils_validate_fid(tmp_metadata.id) == PSA_SUCCESS) {
+            index->hash[i] = its_file_index_hash(tmp_metadata.id);
+            ITS_FILE_INDEX_SET_BIT(index->used, i);
+            its_file_index_insert(index, i);
+        }
+    }
+
+    return PSA_SUCCESS;
+}
+
+/**
+ * \brief Applies the entries updated in the scratch metadata block to the file
+ *        index, once the scratch metadata block has become active.
+ *
+ * \param[in,out] fs_ctx  Filesystem context
+ */
+static void its_file_index_commit(struct its_flash_fs_ctx_t *fs_ctx)
+{
+    struct its_file_index_t *index = &fs_ctx->file_index;
+    uint32_t i;
+
+    for (i = 0; i < fs_ctx->flash_info->max_num_files; i++) {
+        if (index->dirty[i / 32] == 0) {
+            /* Skip to the next bitmap word */
+            i |= 31;
+            continue;
+        }
+
+        if (!ITS_FILE_INDEX_BIT_IS_SET(index->dirty, i)) {
+            continue;
+        }
+
+        if (ITS_FILE_INDEX_BIT_IS_SET(index->used, i)) {
+            its_file_index_remove(index, i);
+            ITS_FILE_INDEX_CLEAR_BIT(index->used, i);
+        }
+
+        if (ITS_FILE_INDEX_BIT_IS_SET(index->pending_used, i)) {
+            index->hash[i] = index->pending_hash[i];
+            ITS_FILE_INDEX_SET_BIT(index->used, i);
+            its_file_index_insert(index, i);
+        }
+
+        ITS_FILE_INDEX_CLEAR_BIT(index->dirty, i);
+    }
+}
+#endif /* ITS_FILE_INDEX */
+
 /**
  * \brief Gets a free file metadata table entry.
  *
@@ -318,6 +526,30 @@ static inline psa_status_t its_mblock_validate_block_meta(
 static uint32_t its_get_free_file_index(struct its_flash_fs_ctx_t *fs_ctx,
                                         bool use_spare)
 {
+#ifdef ITS_FILE_INDEX
+    const uint32_t *used = fs_ctx->file_index.used;
+    uint32_t i;
+
+    for (i = 0; i < fs_ctx->flash_info->max_num_files; i++) {
+        if (used[i / 32] == UINT32_MAX) {
+            /* Skip to the next bitmap word */
+            i |= 31;
+            continue;
+        }
+
+        if (!ITS_FILE_INDEX_BIT_IS_SET(used, i)) {
+            if (!use_spare) {
+                /* Keep the first free file index as a spare */
+                use_spare = true;
+                continue;
+            }
+            /* Found */
+            return i;
+        }
+    }
+
+    return ITS_METADATA_INVALID_INDEX;
+#else
     psa_status_t err;
     uint32_t i;
     struct its_file_meta_t tmp_metadata;
@@ -345,6 +577,7 @@ static uint32_t its_get_free_file_index(struct its_flash_fs_ctx_t *fs_ctx,
     }
 
     return ITS_METADATA_INVALID_INDEX;
+#endif /* ITS_FILE_INDEX */
 }
 
 /**
@@ -376,10 +609,22 @@ static psa_status_t its_mblock_erase_scratch_blocks(
      * that all data is stored in the metadata block.
      */
     if (fs_ctx->flash_info->num_blocks > 2) {
+        /* The scratch data block is still erased if it was not used */
+        if (!fs_ctx->scratch_dblock_used) {
+            return PSA_SUCCESS;
+        }
+
         scratch_datablock =
             its_flash_fs_mblock_cur_data_scratch_id(fs_ctx,
                                                     (ITS_LOGICAL_DBLOCK0 + 1));
         err = fs_ctx->flash_info->erase(fs_ctx->flash_info, scratch_datablock);
+        if (err == PSA_SUCCESS) {
+            fs_ctx->scratch_dblock_used = false;
+#ifdef ITS_WEAR_LEVELING
+            /* The erase count is written with the next metadata block header */
+            fs_ctx->meta_block_header.scratch_erase_count++;
+#endif
+        }
     }
 
     return err;
@@ -404,10 +649,8 @@ static psa_status_t its_mblock_update_scratch_block_meta(
 
     /* Calculate the position */
     pos = its_mblock_block_meta_offset(lblock);
-    return fs_ctx->flash_info->write(fs_ctx->flash_info,
-                                     fs_ctx->scratch_metablock,
-                                     (const uint8_t *)block_meta, pos,
-                                     ITS_BLOCK_METADATA_SIZE);
+    return its_mblock_write_scratch(fs_ctx, (const uint8_t *)block_meta, pos,
+                                    ITS_BLOCK_METADATA_SIZE);
 }
 
 /**
@@ -429,6 +672,13 @@ static psa_status_t its_mblock_copy_remaining_block_meta(
     uint32_t scratch_block;
     size_t size;
 
+#ifdef ITS_METADATA_CACHE
+    if (fs_ctx->batch.open) {
+        /* The cache already holds the metadata of all blocks */
+        return PSA_SUCCESS;
+    }
+#endif
+
     scratch_block = fs_ctx->scratch_metablock;
     meta_block = fs_ctx->active_metablock;
 
@@ -628,7 +878,65 @@ static psa_status_t its_mblock_reserve_file(struct its_flash_fs_ctx_t *fs_ctx,
 {
     psa_status_t err;
     uint32_t i;
+#ifdef ITS_WEAR_LEVELING
+    struct its_block_meta_t cand_meta;
+    uint32_t lblock = ITS_BLOCK_INVALID_ID;
+
+    /* Logical block 0 is rewritten with every metadata block update anyway,
+     * so use it first.
+     */
+    err = its_flash_fs_mblock_read_block_metadata(fs_ctx, ITS_LOGICAL_DBLOCK0,
+                                                  block_meta);
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    if (block_meta->free_size >= size) {
+        lblock = ITS_LOGICAL_DBLOCK0;
+    }
+
+    /* Otherwise, use the least worn dedicated data block that fits the file,
+     * and among the blocks with a similar erase count, the one with the
+     * least free space.
+     */
+    for (i = ITS_LOGICAL_DBLOCK0 + 1;
+         (lblock != ITS_LOGICAL_DBLOCK0) && (i < its_num_active_dblocks(fs_ctx));
+         i++) {
+        err = its_flash_fs_mblock_read_block_metadata(fs_ctx, i, &cand_meta);
+        if (err != PSA_SUCCESS) {
+            return PSA_ERROR_GENERIC_ERROR;
+        }
+
+        if (cand_meta.free_size < size) {
+            continue;
+        }
 
+        if ((lblock == ITS_BLOCK_INVALID_ID) ||
+            (cand_meta.erase_count + ITS_WEAR_LEVELING_THRESHOLD <
+             block_meta->erase_count) ||
+            ((cand_meta.erase_count <
+              block_meta->erase_count + ITS_WEAR_LEVELING_THRESHOLD) &&
+             (cand_meta.free_size < block_meta->free_size))) {
+            lblock = i;
+            *block_meta = cand_meta;
+        }
+    }
+
+    if (lblock != ITS_BLOCK_INVALID_ID) {
+        /* Set file metadata */
+        file_meta->lblock = lblock;
+        file_meta->data_idx = fs_ctx->flash_info->block_size
+                              - block_meta->free_size;
+        file_meta->max_size = size;
+        tfm_memcpy(file_meta->id, fid, ITS_FILE_ID_SIZE);
+        file_meta->cur_size = 0;
+        file_meta->flags = flags;
+
+        /* Update block metadata */
+        block_meta->free_size -= size;
+        return PSA_SUCCESS;
+    }
+#else
     for (i = 0; i < its_num_active_dblocks(fs_ctx); i++) {
         err = its_flash_fs_mblock_read_block_metadata(fs_ctx, i, block_meta);
         if (err != PSA_SUCCESS) {
@@ -650,6 +958,7 @@ static psa_status_t its_mblock_reserve_file(struct its_flash_fs_ctx_t *fs_ctx,
             return PSA_SUCCESS;
         }
     }
+#endif /* ITS_WEAR_LEVELING */
 
     /* No block has large enough space to fit the requested file */
     return PSA_ERROR_INSUFFICIENT_STORAGE;
@@ -721,6 +1030,22 @@ psa_status_t its_flash_fs_mblock_cp_file_meta(struct its_flash_fs_ctx_t *fs_ctx,
     size_t pos_start = its_mblock_file_meta_offset(fs_ctx, idx_start);
     size_t pos_end = its_mblock_file_meta_offset(fs_ctx, idx_end);
 
+#ifdef ITS_FILE_INDEX
+    uint32_t i;
+
+    /* The copied entries are unchanged by this update */
+    for (i = idx_start; i < idx_end; i++) {
+        ITS_FILE_INDEX_CLEAR_BIT(fs_ctx->file_index.dirty, i);
+    }
+#endif
+
+#ifdef ITS_METADATA_CACHE
+    if (fs_ctx->batch.open) {
+        /* The cache already holds the unchanged entries */
+        return PSA_SUCCESS;
+    }
+#endif
+
     /* Copy all data between the two positions from the scratch metadata block
      * to the active metadata block.
      */
@@ -749,7 +1074,36 @@ psa_status_t its_flash_fs_mblock_get_file_idx(struct its_flash_fs_ctx_t *fs_ctx,
     psa_status_t err;
     uint32_t i;
     struct its_file_meta_t tmp_metadata;
+#ifdef ITS_FILE_INDEX
+    const struct its_file_index_t *index = &fs_ctx->file_index;
+    uint32_t hash = its_file_index_hash(fid);
+    uint32_t slot = hash % ITS_FILE_INDEX_NUM_SLOTS;
+    uint32_t probes;
+
+    for (probes = 0; probes < ITS_FILE_INDEX_NUM_SLOTS; probes++) {
+        if (index->slots[slot] == 0) {
+            /* End of the probe sequence */
+            break;
+        }
+
+        i = index->slots[slot] - 1;
+        if (index->hash[i] == hash) {
+            /* Confirm the match against the file metadata in flash */
+            err = its_flash_fs_mblock_read_file_meta(fs_ctx, i, &tmp_metadata);
+            if (err != PSA_SUCCESS) {
+                return PSA_ERROR_GENERIC_ERROR;
+            }
 
+            if (!tfm_memcmp(tmp_metadata.id, fid, ITS_FILE_ID_SIZE)) {
+                /* Found */
+                *idx = i;
+                return PSA_SUCCESS;
+            }
+        }
+
+        slot = (slot + 1) % ITS_FILE_INDEX_NUM_SLOTS;
+    }
+#else
     for (i = 0; i < fs_ctx->flash_info->max_num_files; i++) {
         err = its_flash_fs_mblock_read_file_meta(fs_ctx, i, &tmp_metadata);
         if (err != PSA_SUCCESS) {
@@ -763,6 +1117,7 @@ psa_status_t its_flash_fs_mblock_get_file_idx(struct its_flash_fs_ctx_t *fs_ctx,
             return PSA_SUCCESS;
         }
     }
+#endif /* ITS_FILE_INDEX */
 
     return PSA_ERROR_DOES_NOT_EXIST;
 }
@@ -796,6 +1151,14 @@ psa_status_t its_flash_fs_mblock_init(struct its_flash_fs_ctx_t *fs_ctx)
 {
     psa_status_t err;
 
+    /* The scratch data block may have been programmed before a power failure */
+    fs_ctx->scratch_dblock_used = true;
+
+#ifdef ITS_METADATA_CACHE
+    /* Any batch is discarded */
+    fs_ctx->batch.open = false;
+#endif
+
     /* Initialize Flash Interface */
     err = fs_ctx->flash_info->init(fs_ctx->flash_info);
     if (err != PSA_SUCCESS) {
@@ -812,6 +1175,13 @@ psa_status_t its_flash_fs_mblock_init(struct its_flash_fs_ctx_t *fs_ctx)
         return PSA_ERROR_GENERIC_ERROR;
     }
 
+#ifdef ITS_FILE_INDEX
+    err = its_file_index_build(fs_ctx);
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+#endif
+
     /* Erase the other scratch metadata block */
     return its_mblock_erase_scratch_blocks(fs_ctx);
 }
@@ -821,6 +1191,16 @@ psa_status_t its_flash_fs_mblock_meta_update_finalize(
 {
     psa_status_t err;
 
+#ifdef ITS_METADATA_CACHE
+    if (fs_ctx->batch.open) {
+        /* The update is committed with the rest of the batch */
+#ifdef ITS_FILE_INDEX
+        its_file_index_commit(fs_ctx);
+#endif
+        return PSA_SUCCESS;
+    }
+#endif
+
     /* Write the metadata block header to flash */
     err = its_mblock_write_scratch_meta_header(fs_ctx);
     if (err != PSA_SUCCESS) {
@@ -836,12 +1216,24 @@ psa_status_t its_flash_fs_mblock_meta_update_finalize(
     /* Update the running context */
     its_mblock_swap_metablocks(fs_ctx);
 
+#ifdef ITS_FILE_INDEX
+    /* The updated file metadata entries are now active */
+    its_file_index_commit(fs_ctx);
+#endif
+
     /* Erase meta block and current scratch block */
     return its_mblock_erase_scratch_blocks(fs_ctx);
 }
 
-psa_status_t its_flash_fs_mblock_migrate_lb0_data_to_scratch(
-                                              struct its_flash_fs_ctx_t *fs_ctx)
+/**
+ * \brief Copies the files data area of logical block 0 from the active to the
+ *        scratch metadata block.
+ *
+ * \param[in,out] fs_ctx  Filesystem context
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_mblock_copy_lb0_data(struct its_flash_fs_ctx_t *fs_ctx)
 {
     struct its_block_meta_t block_meta;
     size_t data_size;
@@ -865,6 +1257,19 @@ psa_status_t its_flash_fs_mblock_migrate_lb0_data_to_scratch(
                                          data_size);
 }
 
+psa_status_t its_flash_fs_mblock_migrate_lb0_data_to_scratch(
+                                              struct its_flash_fs_ctx_t *fs_ctx)
+{
+#ifdef ITS_METADATA_CACHE
+    if (fs_ctx->batch.open) {
+        /* Logical block 0 data is migrated when the batch is committed */
+        return PSA_SUCCESS;
+    }
+#endif
+
+    return its_mblock_copy_lb0_data(fs_ctx);
+}
+
 psa_status_t its_flash_fs_mblock_read_file_meta(
                                               struct its_flash_fs_ctx_t *fs_ctx,
                                               uint32_t idx,
@@ -874,9 +1279,8 @@ psa_status_t its_flash_fs_mblock_read_file_meta(
     size_t offset;
 
     offset = its_mblock_file_meta_offset(fs_ctx, idx);
-    err = fs_ctx->flash_info->read(fs_ctx->flash_info, fs_ctx->active_metablock,
-                                   (uint8_t *)file_meta, offset,
-                                   ITS_FILE_METADATA_SIZE);
+    err = its_mblock_read_active(fs_ctx, (uint8_t *)file_meta, offset,
+                                 ITS_FILE_METADATA_SIZE);
 
 #ifdef ITS_VALIDATE_METADATA_FROM_FLASH
     if (err == PSA_SUCCESS) {
@@ -896,9 +1300,8 @@ psa_status_t its_flash_fs_mblock_read_block_metadata(
     size_t pos;
 
     pos = its_mblock_block_meta_offset(lblock);
-    err = fs_ctx->flash_info->read(fs_ctx->flash_info, fs_ctx->active_metablock,
-                                   (uint8_t *)block_meta, pos,
-                                   ITS_BLOCK_METADATA_SIZE);
+    err = its_mblock_read_active(fs_ctx, (uint8_t *)block_meta, pos,
+                                 ITS_BLOCK_METADATA_SIZE);
 
 #ifdef ITS_VALIDATE_METADATA_FROM_FLASH
     if (err == PSA_SUCCESS) {
@@ -942,6 +1345,19 @@ psa_status_t its_flash_fs_mblock_reset_metablock(
     uint32_t metablock_to_erase_first = ITS_METADATA_BLOCK0;
     struct its_file_meta_t file_metadata;
 
+#ifdef ITS_METADATA_CACHE
+    /* Any batch is discarded */
+    fs_ctx->batch.open = false;
+#endif
+
+    fs_ctx->scratch_dblock_used = true;
+
+#ifdef ITS_WEAR_LEVELING
+    /* Erase counts restart from zero */
+    fs_ctx->meta_block_header.scratch_erase_count = 0;
+    block_meta.erase_count = 0;
+#endif
+
     /* Erase both metadata blocks. If at least one metadata block is valid,
      * ensure that the active metadata block is erased last to prevent rollback
      * in the case of a power failure between the two erases.
@@ -1040,6 +1456,11 @@ psa_status_t its_flash_fs_mblock_reset_metablock(
     /* Swap active and scratch metablocks */
     its_mblock_swap_metablocks(fs_ctx);
 
+#ifdef ITS_FILE_INDEX
+    /* All file metadata entries are now free */
+    (void)tfm_memset(&fs_ctx->file_index, 0, sizeof(fs_ctx->file_index));
+#endif
+
     return PSA_SUCCESS;
 }
 
@@ -1051,6 +1472,30 @@ void its_flash_fs_mblock_set_data_scratch(struct its_flash_fs_ctx_t *fs_ctx,
     }
 }
 
+void its_flash_fs_mblock_use_data_scratch(struct its_flash_fs_ctx_t *fs_ctx,
+                                          uint32_t lblock)
+{
+    if (lblock != ITS_LOGICAL_DBLOCK0) {
+        fs_ctx->scratch_dblock_used = true;
+    }
+}
+
+#ifdef ITS_WEAR_LEVELING
+
+void its_flash_fs_mblock_swap_erase_count(struct its_flash_fs_ctx_t *fs_ctx,
+                                          struct its_block_meta_t *block_meta,
+                                          uint32_t lblock)
+{
+    uint32_t erase_count;
+
+    if (lblock != ITS_LOGICAL_DBLOCK0) {
+        erase_count = block_meta->erase_count;
+        block_meta->erase_count = fs_ctx->meta_block_header.scratch_erase_count;
+        fs_ctx->meta_block_header.scratch_erase_count = erase_count;
+    }
+}
+#endif /* ITS_WEAR_LEVELING */
+
 psa_status_t its_flash_fs_mblock_update_scratch_block_meta(
                                             struct its_flash_fs_ctx_t *fs_ctx,
                                             uint32_t lblock,
@@ -1064,6 +1509,14 @@ psa_status_t its_flash_fs_mblock_update_scratch_block_meta(
      */
     if (lblock == ITS_LOGICAL_DBLOCK0) {
         block_meta->phy_id = fs_ctx->scratch_metablock;
+#ifdef ITS_METADATA_CACHE
+        /* In a batch, logical block 0 stays in the active metadata block
+         * until its data is copied to the scratch metadata block.
+         */
+        if (fs_ctx->batch.open && !fs_ctx->batch.lb0_copied) {
+            block_meta->phy_id = fs_ctx->active_metablock;
+        }
+#endif
     }
 
     err = its_mblock_update_scratch_block_meta(fs_ctx, lblock, block_meta);
@@ -1080,11 +1533,207 @@ psa_status_t its_flash_fs_mblock_update_scratch_file_meta(
                                         const struct its_file_meta_t *file_meta)
 {
     size_t pos;
+#ifdef ITS_FILE_INDEX
+    struct its_file_index_t *index = &fs_ctx->file_index;
+
+    /* Record the update, to be applied to the index when the scratch metadata
+     * block becomes active.
+     */
+    ITS_FILE_INDEX_SET_BIT(index->dirty, idx);
+    if (its_utils_validate_fid(file_meta->id) == PSA_SUCCESS) {
+        index->pending_hash[idx] = its_file_index_hash(file_meta->id);
+        ITS_FILE_INDEX_SET_BIT(index->pending_used, idx);
+    } else {
+        ITS_FILE_INDEX_CLEAR_BIT(index->pending_used, idx);
+    }
+#endif
 
     /* Calculate the position */
     pos = its_mblock_file_meta_offset(fs_ctx, idx);
-    return fs_ctx->flash_info->write(fs_ctx->flash_info,
-                                     fs_ctx->scratch_metablock,
-                                     (const uint8_t *)file_meta, pos,
-                                     ITS_FILE_METADATA_SIZE);
+    return its_mblock_write_scratch(fs_ctx, (const uint8_t *)file_meta, pos,
+                                    ITS_FILE_METADATA_SIZE);
+}
+
+#ifdef ITS_METADATA_CACHE
+psa_status_t its_flash_fs_mblock_batch_begin(struct its_flash_fs_ctx_t *fs_ctx)
+{
+    struct its_mblock_batch_t *batch = &fs_ctx->batch;
+    size_t meta_size;
+    psa_status_t err;
+
+    if (batch->open) {
+        return PSA_ERROR_BAD_STATE;
+    }
+
+    /* The metadata of all blocks and files must fit in the cache */
+    meta_size = its_mblock_file_meta_offset(fs_ctx,
+                                            fs_ctx->flash_info->max_num_files);
+    if (meta_size > sizeof(batch->cache)) {
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+
+    err = fs_ctx->flash_info->read(fs_ctx->flash_info, fs_ctx->active_metablock,
+                                   batch->cache, 0, meta_size);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    batch->dirty = false;
+    batch->lb0_copied = false;
+    batch->lb0_end = 0;
+    batch->dblock = ITS_BLOCK_INVALID_ID;
+    batch->dblock_end = 0;
+    batch->open = true;
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t its_flash_fs_mblock_batch_commit(
+                                              struct its_flash_fs_ctx_t *fs_ctx)
+{
+    struct its_mblock_batch_t *batch = &fs_ctx->batch;
+    struct its_block_meta_t block_meta;
+    size_t meta_size;
+    psa_status_t err;
+
+    if (!batch->open) {
+        return PSA_ERROR_BAD_STATE;
+    }
+
+    if (!batch->dirty) {
+        return PSA_SUCCESS;
+    }
+
+    /* After the swap, logical block 0 is stored in the current scratch
+     * metadata block.
+     */
+    err = its_flash_fs_mblock_read_block_metadata(fs_ctx, ITS_LOGICAL_DBLOCK0,
+                                                  &block_meta);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    block_meta.phy_id = fs_ctx->scratch_metablock;
+    err = its_mblock_write_scratch(fs_ctx, (const uint8_t *)&block_meta,
+                                   its_mblock_block_meta_offset(
+                                                          ITS_LOGICAL_DBLOCK0),
+                                   ITS_BLOCK_METADATA_SIZE);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    /* Write the block and file metadata of the whole batch */
+    meta_size = its_mblock_file_meta_offset(fs_ctx,
+                                            fs_ctx->flash_info->max_num_files);
+    err = fs_ctx->flash_info->write(fs_ctx->flash_info,
+                                    fs_ctx->scratch_metablock,
+                                    &batch->cache[ITS_BLOCK_META_HEADER_SIZE],
+                                    ITS_BLOCK_META_HEADER_SIZE,
+                                    meta_size - ITS_BLOCK_META_HEADER_SIZE);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    /* Copy the data of logical block 0, unless the batch already has */
+    if (!batch->lb0_copied) {
+        err = its_mblock_copy_lb0_data(fs_ctx);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+    }
+
+    /* Write the metadata block header, which commits the batch */
+    err = its_mblock_write_scratch_meta_header(fs_ctx);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    err = fs_ctx->flash_info->flush(fs_ctx->flash_info);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    its_mblock_swap_metablocks(fs_ctx);
+
+    batch->dirty = false;
+    batch->lb0_copied = false;
+    batch->lb0_end = 0;
+    batch->dblock = ITS_BLOCK_INVALID_ID;
+    batch->dblock_end = 0;
+
+    /* Erase the previous metadata block and the data block replaced by the
+     * batch.
+     */
+    return its_mblock_erase_scratch_blocks(fs_ctx);
+}
+
+psa_status_t its_flash_fs_mblock_batch_end(struct its_flash_fs_ctx_t *fs_ctx)
+{
+    psa_status_t err;
+
+    err = its_flash_fs_mblock_batch_commit(fs_ctx);
+    if (err == PSA_SUCCESS) {
+        fs_ctx->batch.open = false;
+    }
+
+    return err;
+}
+
+bool its_flash_fs_mblock_batch_is_open(const struct its_flash_fs_ctx_t *fs_ctx)
+{
+    return fs_ctx->batch.open;
+}
+
+bool its_flash_fs_mblock_batch_can_write(
+                                        const struct its_flash_fs_ctx_t *fs_ctx,
+                                        uint32_t lblock, size_t pos)
+{
+    const struct its_mblock_batch_t *batch = &fs_ctx->batch;
+
+    if (lblock == ITS_LOGICAL_DBLOCK0) {
+        /* Logical block 0 is copied to the scratch metadata block on its
+         * first write, after which only its unprogrammed area can be written.
+         */
+        return !batch->lb0_copied || (pos >= batch->lb0_end);
+    }
+
+    /* There is only one scratch data block, so only one dedicated data block
+     * can be updated by a batch.
+     */
+    if (batch->dblock == ITS_BLOCK_INVALID_ID) {
+        return true;
+    }
+
+    return (batch->dblock == lblock) && (pos >= batch->dblock_end);
+}
+
+bool its_flash_fs_mblock_batch_in_place(const struct its_flash_fs_ctx_t *fs_ctx,
+                                        uint32_t lblock)
+{
+    const struct its_mblock_batch_t *batch = &fs_ctx->batch;
+
+    if (!batch->open) {
+        return false;
+    }
+
+    if (lblock == ITS_LOGICAL_DBLOCK0) {
+        return batch->lb0_copied;
+    }
+
+    return batch->dblock == lblock;
+}
+
+void its_flash_fs_mblock_batch_set_written(struct its_flash_fs_ctx_t *fs_ctx,
+                                           uint32_t lblock, size_t end)
+{
+    struct its_mblock_batch_t *batch = &fs_ctx->batch;
+
+    if (lblock == ITS_LOGICAL_DBLOCK0) {
+        batch->lb0_copied = true;
+        batch->lb0_end = ITS_UTILS_MAX(batch->lb0_end, end);
+    } else {
+        batch->dblock = lblock;
+        batch->dblock_end = ITS_UTILS_MAX(batch->dblock_end, end);
+    }
 }
+#endif /* ITS_METADATA_CACHE */
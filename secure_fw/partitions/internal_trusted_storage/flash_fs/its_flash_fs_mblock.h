@@ -23,9 +23,29 @@ extern "C" {
 /*!
  * \def ITS_SUPPORTED_VERSION
  *
- * \brief Defines the supported version.
+ * \brief Defines the supported version. The metadata layout with erase counts
+ *        is a different version, so that a filesystem created with the other
+ *        layout is not misinterpreted.
  */
+#ifdef ITS_WEAR_LEVELING
+#define ITS_SUPPORTED_VERSION  0x02
+#else
 #define ITS_SUPPORTED_VERSION  0x01
+#endif
+
+#ifdef ITS_WEAR_LEVELING
+/*!
+ * \def ITS_WEAR_LEVELING_THRESHOLD
+ *
+ * \brief Maximum difference of erase count between two data blocks for them
+ *        to be considered equally worn when allocating a file. Among equally
+ *        worn blocks, the one with the least free space that fits the file is
+ *        used, to keep large free areas available.
+ */
+#ifndef ITS_WEAR_LEVELING_THRESHOLD
+#define ITS_WEAR_LEVELING_THRESHOLD 16
+#endif
+#endif /* ITS_WEAR_LEVELING */
 
 /*!
  * \def ITS_METADATA_INVALID_INDEX
@@ -52,12 +72,22 @@ extern "C" {
  * \note This structure is programmed to flash, so its size must be padded
  *       to a multiple of the maximum required flash program unit.
  */
+#ifdef ITS_WEAR_LEVELING
 #define _T1 \
     uint32_t scratch_dblock;    /*!< Physical block ID of the data \
                                  *   section's scratch block \
                                  */ \
+    uint32_t scratch_erase_count; /*!< Erase count of the scratch block */ \
     uint8_t fs_version;         /*!< ITS system version */ \
     uint8_t active_swap_count;  /*!< Physical block ID of the data */
+#else
+#define _T1 \
+    uint32_t scratch_dblock;    /*!< Physical block ID of the data \
+                                 *   section's scratch block \
+                                 */ \
+    uint8_t fs_version;         /*!< ITS system version */ \
+    uint8_t active_swap_count;  /*!< Physical block ID of the data */
+#endif
 
 struct its_metadata_block_header_t {
     _T1
@@ -76,6 +106,17 @@ struct its_metadata_block_header_t {
  * \note This structure is programmed to flash, so its size must be padded
  *       to a multiple of the maximum required flash program unit.
  */
+#ifdef ITS_WEAR_LEVELING
+#define _T2 \
+    uint32_t phy_id;    /*!< Physical ID of this logical block */ \
+    size_t data_start;  /*!< Offset from the beginning of the block to the \
+                         *   location where the data starts \
+                         */ \
+    size_t free_size;   /*!< Number of bytes free at end of block (set during \
+                         *   block compaction for gap reuse) \
+                         */ \
+    uint32_t erase_count; /*!< Erase count of the physical block */
+#else
 #define _T2 \
     uint32_t phy_id;    /*!< Physical ID of this logical block */ \
     size_t data_start;  /*!< Offset from the beginning of the block to the \
@@ -84,6 +125,7 @@ struct its_metadata_block_header_t {
     size_t free_size;   /*!< Number of bytes free at end of block (set during \
                          *   block compaction for gap reuse) \
                          */
+#endif
 
 struct its_block_meta_t {
     _T2
@@ -123,6 +165,100 @@ struct its_file_meta_t {
 };
 #undef _T3
 
+#ifdef ITS_FILE_INDEX
+/*!
+ * \def ITS_FILE_INDEX_MAX_FILES
+ *
+ * \brief Maximum number of files of a filesystem context that can be indexed.
+ *        Defaults to the larger of the ITS and PS file table sizes.
+ */
+#ifndef ITS_FILE_INDEX_MAX_FILES
+#define ITS_FILE_INDEX_MAX_FILES ITS_UTILS_MAX(ITS_NUM_ASSETS + 1, \
+                                               PS_NUM_ASSETS + 3)
+#endif
+
+/* Number of hash table slots, keeping the load factor at or below 50% */
+#define ITS_FILE_INDEX_NUM_SLOTS     (2 * ITS_FILE_INDEX_MAX_FILES)
+
+/* Number of words in a bitmap with one bit per file metadata entry */
+#define ITS_FILE_INDEX_BITMAP_WORDS  ((ITS_FILE_INDEX_MAX_FILES + 31) / 32)
+
+/*!
+ * \struct its_file_index_t
+ *
+ * \brief RAM index of the file metadata table. Maps the hash of each file ID
+ *        in use to its file metadata entry index, and tracks the free entries.
+ *        It reflects the active metadata block, while updates written to the
+ *        scratch metadata block are recorded as pending until the metadata
+ *        blocks are swapped.
+ */
+struct its_file_index_t {
+    uint16_t slots[ITS_FILE_INDEX_NUM_SLOTS];   /*!< Open-addressing hash
+                                                 *   table of file metadata
+                                                 *   entry index plus one, or 0
+                                                 *   if the slot is empty
+                                                 */
+    uint32_t hash[ITS_FILE_INDEX_MAX_FILES];    /*!< File ID hash of each
+                                                 *   entry in use
+                                                 */
+    uint32_t used[ITS_FILE_INDEX_BITMAP_WORDS]; /*!< Entries in use */
+    uint32_t pending_hash[ITS_FILE_INDEX_MAX_FILES]; /*!< File ID hash of each
+                                                      *   updated entry
+                                                      */
+    uint32_t pending_used[ITS_FILE_INDEX_BITMAP_WORDS]; /*!< Updated entries
+                                                         *   in use
+                                                         */
+    uint32_t dirty[ITS_FILE_INDEX_BITMAP_WORDS]; /*!< Entries updated in the
+                                                  *   scratch metadata block
+                                                  */
+};
+#endif /* ITS_FILE_INDEX */
+
+#ifdef ITS_METADATA_CACHE
+#if (ITS_FLASH_PROGRAM_UNIT > 16) || (PS_FLASH_PROGRAM_UNIT > 16)
+#error "ITS_METADATA_CACHE requires flash devices that can be programmed in place"
+#endif
+
+/*!
+ * \def ITS_METADATA_CACHE_SIZE
+ *
+ * \brief Size of the RAM metadata cache used by a batch of updates. Batches
+ *        can not be opened on a filesystem whose metadata does not fit.
+ */
+#ifndef ITS_METADATA_CACHE_SIZE
+#define ITS_METADATA_CACHE_SIZE 1024
+#endif
+
+/*!
+ * \struct its_mblock_batch_t
+ *
+ * \brief State of a batch of metadata updates. While a batch is open, the
+ *        block and file metadata are read from and written to a RAM copy of
+ *        the metadata block, and are only committed to flash, with a single
+ *        metadata block swap, when the batch is committed. Until then, the
+ *        data of the updated logical blocks is kept in the scratch blocks, and
+ *        the blocks referenced by the active metadata block are only written
+ *        in areas that are still erased.
+ */
+struct its_mblock_batch_t {
+    bool open;            /*!< A batch is open */
+    bool dirty;           /*!< The cache holds uncommitted updates */
+    bool lb0_copied;      /*!< Logical block 0 data has been copied to the
+                           *   scratch metadata block
+                           */
+    size_t lb0_end;       /*!< End of the programmed area of the copy of
+                           *   logical block 0
+                           */
+    uint32_t dblock;      /*!< Dedicated logical block copied to the scratch
+                           *   data block, or ITS_BLOCK_INVALID_ID
+                           */
+    size_t dblock_end;    /*!< End of the programmed area of the copy of the
+                           *   dedicated logical block
+                           */
+    uint8_t cache[ITS_METADATA_CACHE_SIZE]; /*!< Copy of the metadata block */
+};
+#endif /* ITS_METADATA_CACHE */
+
 /**
  * \struct its_flash_fs_ctx_t
  *
@@ -135,6 +271,15 @@ struct its_flash_fs_ctx_t {
                                                            */
     uint32_t active_metablock;  /**< Active metadata block */
     uint32_t scratch_metablock; /**< Scratch metadata block */
+    bool scratch_dblock_used;   /**< The scratch data block has been
+                                 *   programmed since it was last erased
+                                 */
+#ifdef ITS_FILE_INDEX
+    struct its_file_index_t file_index; /**< File metadata table index */
+#endif
+#ifdef ITS_METADATA_CACHE
+    struct its_mblock_batch_t batch;    /**< Batch of metadata updates */
+#endif
 };
 
 /**
@@ -172,6 +317,33 @@ uint32_t its_flash_fs_mblock_cur_data_scratch_id(
                                               struct its_flash_fs_ctx_t *fs_ctx,
                                               uint32_t lblock);
 
+/**
+ * \brief Records that the scratch data block is about to be programmed, so
+ *        that it is erased at the end of the metadata block update. The
+ *        scratch data block is not erased by updates that do not use it.
+ *
+ * \param[in,out] fs_ctx  Filesystem context
+ * \param[in]     lblock  Logical block number
+ */
+void its_flash_fs_mblock_use_data_scratch(struct its_flash_fs_ctx_t *fs_ctx,
+                                          uint32_t lblock);
+
+#ifdef ITS_WEAR_LEVELING
+
+/**
+ * \brief Exchanges the erase count in the block metadata with the erase count
+ *        of the scratch data block, after the physical block of the logical
+ *        block has been swapped with the scratch data block.
+ *
+ * \param[in,out] fs_ctx      Filesystem context
+ * \param[in,out] block_meta  Block metadata of the logical block
+ * \param[in]     lblock      Logical block number
+ */
+void its_flash_fs_mblock_swap_erase_count(struct its_flash_fs_ctx_t *fs_ctx,
+                                          struct its_block_meta_t *block_meta,
+                                          uint32_t lblock);
+#endif /* ITS_WEAR_LEVELING */
+
 /**
  * \brief Gets file metadata entry index.
  *
@@ -328,6 +500,86 @@ psa_status_t its_flash_fs_mblock_update_scratch_file_meta(
                                        uint32_t idx,
                                        const struct its_file_meta_t *file_meta);
 
+#ifdef ITS_METADATA_CACHE
+/**
+ * \brief Opens a batch of metadata updates.
+ *
+ * \param[in,out] fs_ctx  Filesystem context
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+psa_status_t its_flash_fs_mblock_batch_begin(struct its_flash_fs_ctx_t *fs_ctx);
+
+/**
+ * \brief Commits the updates of the open batch to flash, with a single
+ *        metadata block swap. The batch stays open.
+ *
+ * \param[in,out] fs_ctx  Filesystem context
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+psa_status_t its_flash_fs_mblock_batch_commit(
+                                             struct its_flash_fs_ctx_t *fs_ctx);
+
+/**
+ * \brief Commits the updates of the open batch to flash and closes it.
+ *
+ * \param[in,out] fs_ctx  Filesystem context
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+psa_status_t its_flash_fs_mblock_batch_end(struct its_flash_fs_ctx_t *fs_ctx);
+
+/**
+ * \brief Checks if a batch of metadata updates is open.
+ *
+ * \param[in] fs_ctx  Filesystem context
+ *
+ * \return true if a batch is open, false otherwise
+ */
+bool its_flash_fs_mblock_batch_is_open(const struct its_flash_fs_ctx_t *fs_ctx);
+
+/**
+ * \brief Checks if data can be written to a logical block as part of the open
+ *        batch, that is, without erasing a block referenced by the active
+ *        metadata block.
+ *
+ * \param[in] fs_ctx  Filesystem context
+ * \param[in] lblock  Logical block number
+ * \param[in] pos     Offset in the block of the data to write
+ *
+ * \return true if the data can be written, false if the batch needs to be
+ *         committed first
+ */
+bool its_flash_fs_mblock_batch_can_write(
+                                        const struct its_flash_fs_ctx_t *fs_ctx,
+                                        uint32_t lblock, size_t pos);
+
+/**
+ * \brief Checks if a logical block has been copied to a scratch block by the
+ *        open batch, in which case further data is programmed in place in that
+ *        copy.
+ *
+ * \param[in] fs_ctx  Filesystem context
+ * \param[in] lblock  Logical block number
+ *
+ * \return true if the logical block has an uncommitted copy, false otherwise
+ */
+bool its_flash_fs_mblock_batch_in_place(const struct its_flash_fs_ctx_t *fs_ctx,
+                                        uint32_t lblock);
+
+/**
+ * \brief Records the end of the programmed area of the uncommitted copy of a
+ *        logical block, after data has been written to it in the open batch.
+ *
+ * \param[in,out] fs_ctx  Filesystem context
+ * \param[in]     lblock  Logical block number
+ * \param[in]     end     Offset of the end of the programmed area
+ */
+void its_flash_fs_mblock_batch_set_written(struct its_flash_fs_ctx_t *fs_ctx,
+                                           uint32_t lblock, size_t end);
+#endif /* ITS_METADATA_CACHE */
+
 #ifdef __cplusplus
 }
 #endif
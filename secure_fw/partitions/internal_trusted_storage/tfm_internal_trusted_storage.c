@@ -29,15 +29,92 @@
 static uint8_t asset_data[ITS_UTILS_ALIGN(ITS_BUF_SIZE,
                                           ITS_FLASH_MAX_ALIGNMENT)];
 
-static uint8_t g_fid[ITS_FILE_ID_SIZE];
-static struct its_file_info_t g_file_info;
+#ifdef ITS_FS_AREA_BLOCKS
+#ifndef ITS_NUM_FS_AREAS
+#error "ITS_NUM_FS_AREAS must be defined along with ITS_FS_AREA_BLOCKS"
+#endif
+/* Number of flash blocks of each ITS area, in flash order */
+static const uint32_t its_fs_area_blocks[ITS_NUM_FS_AREAS] = {
+    ITS_FS_AREA_BLOCKS
+};
+#else
+/* By default, store the files of all ITS clients in one filesystem */
+#define ITS_NUM_FS_AREAS 1
+#endif
 
-static its_flash_fs_ctx_t fs_ctx_its;
+#ifdef ITS_FS_AREA_NUM_ASSETS
+/* Maximum number of assets of each ITS area */
+static const uint32_t its_fs_area_num_assets[ITS_NUM_FS_AREAS] = {
+    ITS_FS_AREA_NUM_ASSETS
+};
+#endif
+
+#ifndef ITS_FS_AREA_DEFAULT
+/* By default, the clients which are not assigned an area use the first one */
+#define ITS_FS_AREA_DEFAULT 0
+#endif
+
+#if (ITS_FS_AREA_DEFAULT >= ITS_NUM_FS_AREAS)
+#error "ITS_FS_AREA_DEFAULT must be the index of one of the ITS areas"
+#endif
+
+#ifdef ITS_FS_AREA_CLIENTS
+/* The ITS area of each client listed by ITS_FS_AREA_CLIENTS */
+static const struct {
+    int32_t client_id;
+    uint32_t area;
+} its_fs_area_clients[] = {
+    ITS_FS_AREA_CLIENTS
+};
+#endif
+
+/*!
+ * \struct its_fs_area_t
+ *
+ * \brief Filesystem instance in one area of the ITS flash device.
+ */
+struct its_fs_area_t {
+    struct its_flash_info_t flash_info; /*!< Flash info of the area */
+    its_flash_fs_ctx_t fs_ctx;          /*!< Filesystem context of the area */
+};
+
+static struct its_fs_area_t its_fs_areas[ITS_NUM_FS_AREAS];
 static its_flash_fs_ctx_t fs_ctx_ps;
 
+/**
+ * \brief Gets the filesystem context that stores the files of a client.
+ *
+ * \details PS has a filesystem of its own. The ITS flash area is divided into
+ *          the areas listed by ITS_FS_AREA_BLOCKS, each holding a separate
+ *          filesystem. The clients listed by ITS_FS_AREA_CLIENTS use the area
+ *          assigned to them, and the other clients use ITS_FS_AREA_DEFAULT.
+ *          Operations on one area, such as a wipe or a block compaction, do
+ *          not touch the metadata or data blocks of the others.
+ *
+ * \param[in] client_id  Identifier of the asset's owner (client)
+ *
+ * \return Pointer to the filesystem context.
+ */
 static its_flash_fs_ctx_t *get_fs_ctx(int32_t client_id)
 {
-    return (client_id == TFM_SP_PS) ? &fs_ctx_ps : &fs_ctx_its;
+#ifdef ITS_FS_AREA_CLIENTS
+    uint32_t i;
+#endif
+
+    if (client_id == TFM_SP_PS) {
+        return &fs_ctx_ps;
+    }
+
+#ifdef ITS_FS_AREA_CLIENTS
+    for (i = 0; i < sizeof(its_fs_area_clients) /
+                    sizeof(its_fs_area_clients[0]); i++) {
+        if (its_fs_area_clients[i].client_id == client_id) {
+            return &its_fs_areas[its_fs_area_clients[i].area].fs_ctx;
+        }
+    }
+#endif
+
+    return &its_fs_areas[ITS_FS_AREA_DEFAULT].fs_ctx;
 }
 
 /**
@@ -58,36 +135,81 @@ static void tfm_its_get_fid(int32_t client_id,
 psa_status_t tfm_its_init(void)
 {
     psa_status_t status;
+    uint32_t area;
+    uint32_t first_block = 0;
+    uint32_t num_blocks;
+    uint32_t max_num_files;
+    struct its_fs_area_t *fs_area;
+    const struct its_flash_info_t *info =
+                                    its_flash_get_info(ITS_FLASH_ID_INTERNAL);
+
+#ifdef ITS_FS_AREA_TOTAL_BLOCKS
+    /* The areas must cover the whole ITS flash area reported by the platform.
+     * This is checked at build time when the target defines
+     * ITS_FLASH_AREA_SIZE, but the platform may report another size.
+     */
+    if (info->num_blocks != ITS_FS_AREA_TOTAL_BLOCKS) {
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+#endif
+
+    /* Initialise the context of each ITS area */
+    for (area = 0; area < ITS_NUM_FS_AREAS; area++) {
+        fs_area = &its_fs_areas[area];
+
+#ifdef ITS_FS_AREA_BLOCKS
+        num_blocks = its_fs_area_blocks[area];
+#else
+        num_blocks = info->num_blocks;
+#endif
+#ifdef ITS_FS_AREA_NUM_ASSETS
+        /* One more file than assets, as in the flash info of the device */
+        max_num_files = its_fs_area_num_assets[area] + 1;
+#else
+        max_num_files = info->max_num_files;
+#endif
+
+        status = its_flash_get_area_info(ITS_FLASH_ID_INTERNAL, first_block,
+                                         num_blocks, max_num_files,
+                                         &fs_area->flash_info);
+        if (status != PSA_SUCCESS) {
+            return status;
+        }
+        first_block += num_blocks;
 
-    /* Initialise the ITS context */
-    status = its_flash_fs_prepare(&fs_ctx_its,
-                                  its_flash_get_info(ITS_FLASH_ID_INTERNAL));
+        status = its_flash_fs_prepare(&fs_area->fs_ctx, &fs_area->flash_info);
 #ifdef ITS_CREATE_FLASH_LAYOUT
-    /* If ITS_CREATE_FLASH_LAYOUT is set, it indicates that it is required to
-     * create a ITS flash layout. ITS service will generate an empty and valid
-     * ITS flash layout to store assets. It will erase all data located in the
-     * assigned ITS memory area before generating the ITS layout.
-     * This flag is required to be set if the ITS memory area is located in
-     * non-persistent memory.
-     * This flag can be set if the ITS memory area is located in persistent
-     * memory without a previous valid ITS flash layout in it. That is the case
-     * when it is the first time in the device life that the ITS service is
-     * executed.
-     */
-     if (status != PSA_SUCCESS) {
-        /* Remove all data in the ITS memory area and create a valid ITS flash
-         * layout in that area.
+        /* If ITS_CREATE_FLASH_LAYOUT is set, it indicates that it is required
+         * to create a ITS flash layout. ITS service will generate an empty and
+         * valid ITS flash layout to store assets. It will erase all data
+         * located in the assigned ITS memory area before generating the ITS
+         * layout.
+         * This flag is required to be set if the ITS memory area is located in
+         * non-persistent memory.
+         * This flag can be set if the ITS memory area is located in persistent
+         * memory without a previous valid ITS flash layout in it. That is the
+         * case when it is the first time in the device life that the ITS
+         * service is executed.
          */
-        status = its_flash_fs_wipe_all(&fs_ctx_its);
         if (status != PSA_SUCCESS) {
-            return status;
+            /* Remove all data in the ITS memory area and create a valid ITS
+             * flash layout in that area.
+             */
+            status = its_flash_fs_wipe_all(&fs_area->fs_ctx);
+            if (status != PSA_SUCCESS) {
+                return status;
+            }
+
+            /* Attempt to initialise again */
+            status = its_flash_fs_prepare(&fs_area->fs_ctx,
+                                          &fs_area->flash_info);
         }
+#endif /* ITS_CREATE_FLASH_LAYOUT */
 
-        /* Attempt to initialise again */
-        status = its_flash_fs_prepare(&fs_ctx_its,
-                                     its_flash_get_info(ITS_FLASH_ID_INTERNAL));
+        if (status != PSA_SUCCESS) {
+            return status;
+        }
     }
-#endif /* ITS_CREATE_FLASH_LAYOUT */
 
 #ifdef TFM_PARTITION_PROTECTED_STORAGE
     /* Initialise the PS context */
@@ -131,9 +253,17 @@ psa_status_t tfm_its_set(int32_t client_id,
                          psa_storage_create_flags_t create_flags)
 {
     psa_status_t status;
+    uint8_t fid[ITS_FILE_ID_SIZE];
+    struct its_file_info_t file_info;
     size_t write_size;
     size_t offset;
     uint32_t flags;
+    const uint8_t *data;
+    its_flash_fs_ctx_t *fs_ctx = get_fs_ctx(client_id);
+#ifdef ITS_METADATA_CACHE
+    psa_status_t batch_status;
+    bool batch = false;
+#endif
 
     /* Check that the UID is valid */
     if (uid == TFM_ITS_INVALID_UID) {
@@ -148,16 +278,15 @@ psa_status_t tfm_its_set(int32_t client_id,
     }
 
     /* Set file id */
-    tfm_its_get_fid(client_id, uid, g_fid);
+    tfm_its_get_fid(client_id, uid, fid);
 
     /* Read file info */
-    status = its_flash_fs_file_get_info(get_fs_ctx(client_id), g_fid,
-                                        &g_file_info);
+    status = its_flash_fs_file_get_info(fs_ctx, fid, &file_info);
     if (status == PSA_SUCCESS) {
         /* If the object exists and has the write once flag set, then it
          * cannot be modified.
          */
-        if (g_file_info.flags & PSA_STORAGE_FLAG_WRITE_ONCE) {
+        if (file_info.flags & PSA_STORAGE_FLAG_WRITE_ONCE) {
             return PSA_ERROR_NOT_PERMITTED;
         }
     } else if (status != PSA_ERROR_DOES_NOT_EXIST) {
@@ -172,21 +301,45 @@ psa_status_t tfm_its_set(int32_t client_id,
             ITS_FLASH_FS_FLAG_CREATE | ITS_FLASH_FS_FLAG_TRUNCATE;
 
     /* Iteratively read data from the caller and write it to the filesystem, in
-     * chunks no larger than the size of the asset_data buffer.
+     * chunks no larger than the size of the asset_data buffer. If the caller's
+     * data can be mapped, it is written directly to the filesystem instead,
+     * except for any final part that is smaller than the flash program unit,
+     * as the filesystem programs whole program units from the buffer.
      */
     do {
-        /* Write as much of the data as will fit in the asset_data buffer */
-        write_size = ITS_UTILS_MIN(data_length, sizeof(asset_data));
+        data = NULL;
+
+        /* Write the data in whole program units directly, if possible */
+        write_size = data_length - (data_length % ITS_FLASH_MAX_ALIGNMENT);
+        if (write_size > 0) {
+            data = its_req_mngr_map_read(write_size);
+        }
+
+        if (data == NULL) {
+            /* Write as much of the data as will fit in the asset_data buffer */
+            write_size = ITS_UTILS_MIN(data_length, sizeof(asset_data));
 
-        /* Read asset data from the caller */
-        (void)its_req_mngr_read(asset_data, write_size);
+            /* Read asset data from the caller */
+            (void)its_req_mngr_read(asset_data, write_size);
+            data = asset_data;
+        }
+
+#ifdef ITS_METADATA_CACHE
+        /* If the data takes more than one write, then commit all the writes
+         * with a single metadata block swap, so that the asset is written
+         * atomically. If the metadata does not fit in the cache, then the
+         * writes are committed one by one, as without the cache.
+         */
+        if (!batch && (write_size < data_length)) {
+            batch = (its_flash_fs_batch_begin(fs_ctx) == PSA_SUCCESS);
+        }
+#endif
 
         /* Write to the file in the file system */
-        status = its_flash_fs_file_write(get_fs_ctx(client_id), g_fid, flags,
-                                         data_length, write_size, offset,
-                                         asset_data);
+        status = its_flash_fs_file_write(fs_ctx, fid, flags, data_length,
+                                         write_size, offset, data);
         if (status != PSA_SUCCESS) {
-            return status;
+            break;
         }
 
         /* Do not create or truncate after the first iteration */
@@ -196,7 +349,19 @@ psa_status_t tfm_its_set(int32_t client_id,
         data_length -= write_size;
     } while (data_length > 0);
 
-    return PSA_SUCCESS;
+#ifdef ITS_METADATA_CACHE
+    if (batch) {
+        /* On failure, the writes that succeeded are committed, as they would
+         * have been without a batch.
+         */
+        batch_status = its_flash_fs_batch_end(fs_ctx);
+        if (status == PSA_SUCCESS) {
+            status = batch_status;
+        }
+    }
+#endif
+
+    return status;
 }
 
 psa_status_t tfm_its_get(int32_t client_id,
@@ -206,7 +371,10 @@ psa_status_t tfm_its_get(int32_t client_id,
                          size_t *p_data_length)
 {
     psa_status_t status;
+    uint8_t fid[ITS_FILE_ID_SIZE];
+    struct its_file_info_t file_info;
     size_t read_size;
+    uint8_t *data;
 
 #ifdef TFM_PARTITION_TEST_PS
     /* The PS test partition can call tfm_its_get() through PS code. Treat it
@@ -223,44 +391,54 @@ psa_status_t tfm_its_get(int32_t client_id,
     }
 
     /* Set file id */
-    tfm_its_get_fid(client_id, uid, g_fid);
+    tfm_its_get_fid(client_id, uid, fid);
 
     /* Read file info */
-    status = its_flash_fs_file_get_info(get_fs_ctx(client_id), g_fid,
-                                        &g_file_info);
+    status = its_flash_fs_file_get_info(get_fs_ctx(client_id), fid,
+                                        &file_info);
     if (status != PSA_SUCCESS) {
         return status;
     }
 
     /* Boundary check the incoming request */
-    if (data_offset > g_file_info.size_current) {
+    if (data_offset > file_info.size_current) {
         return PSA_ERROR_INVALID_ARGUMENT;
     }
 
     /* Copy the object data only from within the file boundary */
     data_size = ITS_UTILS_MIN(data_size,
-                              g_file_info.size_current - data_offset);
+                              file_info.size_current - data_offset);
 
     /* Update the size of the output data */
     *p_data_length = data_size;
 
     /* Iteratively read data from the filesystem and write it to the caller, in
-     * chunks no larger than the size of the asset_data buffer.
+     * chunks no larger than the size of the asset_data buffer. If the caller's
+     * buffer can be mapped, the data is read directly into it instead.
      */
     do {
-        /* Read as much of the data as will fit in the asset_data buffer */
-        read_size = ITS_UTILS_MIN(data_size, sizeof(asset_data));
+        /* Read all the data directly, if possible */
+        read_size = data_size;
+        data = its_req_mngr_map_write(read_size);
+
+        if (data == NULL) {
+            /* Read as much of the data as will fit in the asset_data buffer */
+            read_size = ITS_UTILS_MIN(data_size, sizeof(asset_data));
+            data = asset_data;
+        }
 
         /* Read file data from the filesystem */
-        status = its_flash_fs_file_read(get_fs_ctx(client_id), g_fid, read_size,
-                                        data_offset, asset_data);
+        status = its_flash_fs_file_read(get_fs_ctx(client_id), fid, read_size,
+                                        data_offset, data);
         if (status != PSA_SUCCESS) {
             *p_data_length = 0;
             return status;
         }
 
-        /* Write asset data to the caller */
-        its_req_mngr_write(asset_data, read_size);
+        if (data == asset_data) {
+            /* Write asset data to the caller */
+            its_req_mngr_write(asset_data, read_size);
+        }
 
         data_offset += read_size;
         data_size -= read_size;
@@ -273,6 +451,8 @@ psa_status_t tfm_its_get_info(int32_t client_id, psa_storage_uid_t uid,
                               struct psa_storage_info_t *p_info)
 {
     psa_status_t status;
+    uint8_t fid[ITS_FILE_ID_SIZE];
+    struct its_file_info_t file_info;
 
     /* Check that the UID is valid */
     if (uid == TFM_ITS_INVALID_UID) {
@@ -280,19 +460,19 @@ psa_status_t tfm_its_get_info(int32_t client_id, psa_storage_uid_t uid,
     }
 
     /* Set file id */
-    tfm_its_get_fid(client_id, uid, g_fid);
+    tfm_its_get_fid(client_id, uid, fid);
 
     /* Read file info */
-    status = its_flash_fs_file_get_info(get_fs_ctx(client_id), g_fid,
-                                        &g_file_info);
+    status = its_flash_fs_file_get_info(get_fs_ctx(client_id), fid,
+                                        &file_info);
     if (status != PSA_SUCCESS) {
         return status;
     }
 
     /* Copy file info to the PSA info struct */
-    p_info->capacity = g_file_info.size_current;
-    p_info->size = g_file_info.size_current;
-    p_info->flags = g_file_info.flags;
+    p_info->capacity = file_info.size_current;
+    p_info->size = file_info.size_current;
+    p_info->flags = file_info.flags;
 
     return PSA_SUCCESS;
 }
@@ -300,6 +480,8 @@ psa_status_t tfm_its_get_info(int32_t client_id, psa_storage_uid_t uid,
 psa_status_t tfm_its_remove(int32_t client_id, psa_storage_uid_t uid)
 {
     psa_status_t status;
+    uint8_t fid[ITS_FILE_ID_SIZE];
+    struct its_file_info_t file_info;
 
 #ifdef TFM_PARTITION_TEST_PS
     /* The PS test partition can call tfm_its_remove() through PS code. Treat
@@ -316,10 +498,10 @@ psa_status_t tfm_its_remove(int32_t client_id, psa_storage_uid_t uid)
     }
 
     /* Set file id */
-    tfm_its_get_fid(client_id, uid, g_fid);
+    tfm_its_get_fid(client_id, uid, fid);
 
-    status = its_flash_fs_file_get_info(get_fs_ctx(client_id), g_fid,
-                                        &g_file_info);
+    status = its_flash_fs_file_get_info(get_fs_ctx(client_id), fid,
+                                        &file_info);
     if (status != PSA_SUCCESS) {
         return status;
     }
@@ -327,10 +509,10 @@ psa_status_t tfm_its_remove(int32_t client_id, psa_storage_uid_t uid)
     /* If the object exists and has the write once flag set, then it
      * cannot be deleted.
      */
-    if (g_file_info.flags & PSA_STORAGE_FLAG_WRITE_ONCE) {
+    if (file_info.flags & PSA_STORAGE_FLAG_WRITE_ONCE) {
         return PSA_ERROR_NOT_PERMITTED;
     }
 
     /* Delete old file from the persistent area */
-    return its_flash_fs_file_delete(get_fs_ctx(client_id), g_fid);
+    return its_flash_fs_file_delete(get_fs_ctx(client_id), fid);
 }
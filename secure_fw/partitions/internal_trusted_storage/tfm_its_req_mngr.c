@@ -373,3 +373,31 @@ void its_req_mngr_write(const uint8_t *buf, size_t num_bytes)
     p_data += num_bytes;
 #endif
 }
+
+const uint8_t *its_req_mngr_map_read(size_t num_bytes)
+{
+#ifdef TFM_PSA_API
+    /* The caller's memory is only accessible through psa_read() */
+    (void)num_bytes;
+    return NULL;
+#else
+    const uint8_t *buf = p_data;
+
+    p_data += num_bytes;
+    return buf;
+#endif
+}
+
+uint8_t *its_req_mngr_map_write(size_t num_bytes)
+{
+#ifdef TFM_PSA_API
+    /* The caller's memory is only accessible through psa_write() */
+    (void)num_bytes;
+    return NULL;
+#else
+    uint8_t *buf = p_data;
+
+    p_data += num_bytes;
+    return buf;
+#endif
+}
@@ -98,6 +98,30 @@ size_t its_req_mngr_read(uint8_t *buf, size_t num_bytes);
  */
 void its_req_mngr_write(const uint8_t *buf, size_t num_bytes);
 
+/**
+ * \brief Maps the next part of the caller's asset data, so that it can be
+ *        read without being copied.
+ *
+ * \param[in] num_bytes  Number of bytes to map
+ *
+ * \return Pointer to the caller's data, or NULL if the caller's memory can
+ *         only be accessed by copying it with \ref its_req_mngr_read, in which
+ *         case no data is consumed.
+ */
+const uint8_t *its_req_mngr_map_read(size_t num_bytes);
+
+/**
+ * \brief Maps the next part of the caller's output buffer, so that asset data
+ *        can be written to it without being copied.
+ *
+ * \param[in] num_bytes  Number of bytes to map
+ *
+ * \return Pointer to the caller's buffer, or NULL if the caller's memory can
+ *         only be accessed by copying to it with \ref its_req_mngr_write, in
+ *         which case no data is consumed.
+ */
+uint8_t *its_req_mngr_map_write(size_t num_bytes);
+
 #ifdef __cplusplus
 }
 #endif
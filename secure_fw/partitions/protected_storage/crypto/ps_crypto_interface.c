@@ -114,19 +114,13 @@ void ps_crypto_set_iv(const union ps_crypto_t *crypto)
     (void)tfm_memcpy(ps_crypto_iv_buf, crypto->ref.iv, PS_IV_LEN_BYTES);
 }
 
-void ps_crypto_get_iv(union ps_crypto_t *crypto)
+/**
+ * \brief Increments an IV value by one.
+ *
+ * \param[in,out] iv  Pointer to the IV value to increment
+ */
+static void ps_crypto_iv_increment(uint8_t *iv)
 {
-    /* IV characteristic is algorithm dependent.
-     * For GCM it is essential that it doesn't get repeated.
-     * A simple increment will suffice.
-     * FIXME:
-     * Since IV is predictable in this case,
-     * If there is no rollback protection, an attacker could
-     * try to rollback the storage and encrypt another plaintext
-     * block with same IV/Key pair; this breaks GCM usage rules.
-     * One potential fix would be to generate IV through RNG
-     */
-
     /* Logic:
      * IV is a 12 byte value. Read the old value and increment it by 1.
      * since there is no standard C support for 12 byte integer mathematics,
@@ -141,21 +135,42 @@ void ps_crypto_get_iv(union ps_crypto_t *crypto)
     uint64_t iv_l;
     uint32_t iv_h;
 
-    (void)tfm_memcpy(&iv_l, ps_crypto_iv_buf, sizeof(iv_l));
-    (void)tfm_memcpy(&iv_h, (ps_crypto_iv_buf+sizeof(iv_l)), sizeof(iv_h));
+    (void)tfm_memcpy(&iv_l, iv, sizeof(iv_l));
+    (void)tfm_memcpy(&iv_h, (iv + sizeof(iv_l)), sizeof(iv_h));
     iv_l++;
     /* If overflow, increment the MSBs */
     if (iv_l == 0) {
         iv_h++;
     }
 
+    (void)tfm_memcpy(iv, &iv_l, sizeof(iv_l));
+    (void)tfm_memcpy((iv + sizeof(iv_l)), &iv_h, sizeof(iv_h));
+}
+
+void ps_crypto_get_iv(union ps_crypto_t *crypto)
+{
+    /* IV characteristic is algorithm dependent.
+     * For GCM it is essential that it doesn't get repeated.
+     * A simple increment will suffice.
+     * FIXME:
+     * Since IV is predictable in this case,
+     * If there is no rollback protection, an attacker could
+     * try to rollback the storage and encrypt another plaintext
+     * block with same IV/Key pair; this breaks GCM usage rules.
+     * One potential fix would be to generate IV through RNG
+     */
+
     /* Update the local buffer */
-    (void)tfm_memcpy(ps_crypto_iv_buf, &iv_l, sizeof(iv_l));
-    (void)tfm_memcpy((ps_crypto_iv_buf + sizeof(iv_l)), &iv_h, sizeof(iv_h));
+    ps_crypto_iv_increment(ps_crypto_iv_buf);
     /* Update the caller buffer */
     (void)tfm_memcpy(crypto->ref.iv, ps_crypto_iv_buf, PS_IV_LEN_BYTES);
 }
 
+void ps_crypto_increment_iv(union ps_crypto_t *crypto)
+{
+    ps_crypto_iv_increment(crypto->ref.iv);
+}
+
 psa_status_t ps_crypto_encrypt_and_tag(union ps_crypto_t *crypto,
                                        const uint8_t *add,
                                        size_t add_len,
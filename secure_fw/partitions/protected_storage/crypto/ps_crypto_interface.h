@@ -139,6 +139,18 @@ void ps_crypto_set_iv(const union ps_crypto_t *crypto);
  */
 void ps_crypto_get_iv(union ps_crypto_t *crypto);
 
+/**
+ * \brief Derives the IV value following the one in the crypto union, as
+ *        returned by successive calls to \ref ps_crypto_get_iv.
+ *
+ * \note The derived IV is not reserved. Once it has been used, it must be
+ *       provided to the crypto layer with \ref ps_crypto_set_iv so that it is
+ *       not returned again by \ref ps_crypto_get_iv.
+ *
+ * \param[in,out] crypto  Pointer to the crypto union
+ */
+void ps_crypto_increment_iv(union ps_crypto_t *crypto);
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,17 +21,205 @@
 
 #define PS_OBJECT_START_POSITION  0
 
+#ifdef PS_AEAD_SEGMENT_SIZE
+/* Gets the number of segments of the data to encrypt */
+#define PS_NUM_SEGMENTS(encrypt_size) \
+    (((encrypt_size) + PS_AEAD_SEGMENT_SIZE - 1) / PS_AEAD_SEGMENT_SIZE)
+
+/* Gets the size of the tags stored after the encrypted data */
+#define PS_SEGMENT_TAGS_SIZE(encrypt_size) \
+    ((PS_NUM_SEGMENTS(encrypt_size) - 1) * PS_TAG_LEN_BYTES)
+
+/* Buffer to store one encrypted segment */
+#define PS_CRYPTO_BUF_LEN (PS_AEAD_SEGMENT_SIZE + PS_TAG_LEN_BYTES)
+
+/*!
+ * \struct ps_segment_assoc_data_t
+ *
+ * \brief Associated data of an AEAD segment. The first segment is only
+ *        associated with the File ID, so an object which fits in a single
+ *        segment is stored in the same way as without segments.
+ */
+struct ps_segment_assoc_data_t {
+    uint32_t fid;                       /*!< File ID */
+    uint8_t prev_tag[PS_TAG_LEN_BYTES]; /*!< Tag of the previous segment */
+};
+#else
 /* Buffer to store the maximum encrypted object */
-/* FIXME: Do partial encrypt/decrypt to reduce the size of internal buffer */
 #define PS_MAX_ENCRYPTED_OBJ_SIZE PS_ENCRYPT_SIZE(PS_MAX_OBJECT_DATA_SIZE)
 
 /* FIXME: add the tag length to the crypto buffer size to account for the tag
  * being appended to the ciphertext by the crypto layer.
  */
 #define PS_CRYPTO_BUF_LEN (PS_MAX_ENCRYPTED_OBJ_SIZE + PS_TAG_LEN_BYTES)
+#endif /* PS_AEAD_SEGMENT_SIZE */
 
 static uint8_t ps_crypto_buf[PS_CRYPTO_BUF_LEN];
 
+#ifdef PS_AEAD_SEGMENT_SIZE
+/**
+ * \brief Performs authenticated decryption on object data, segment by
+ *        segment, in place.
+ *
+ * \param[in]     fid       File ID
+ * \param[in]     cur_size  Size of the object data to decrypt
+ * \param[in,out] obj       Pointer to the object structure to authenticate
+ *                          and fill in with the decrypted data. The tags of
+ *                          all segments but the last one follow the encrypted
+ *                          data. The tag of the last segment is the one stored
+ *                          in the object table for the given File ID.
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t ps_object_auth_decrypt(uint32_t fid,
+                                           uint32_t cur_size,
+                                           struct ps_object_t *obj)
+{
+    psa_status_t err;
+    uint8_t *p_obj_data = (uint8_t *)&obj->header.info;
+    const uint8_t *p_seg_tags = p_obj_data + cur_size;
+    struct ps_segment_assoc_data_t assoc_data;
+    union ps_crypto_t seg_crypto;
+    uint32_t seg_offset;
+    uint32_t seg_size;
+    size_t add_len = sizeof(assoc_data.fid);
+    size_t out_len;
+
+    err = ps_crypto_setkey();
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    /* The first segment uses the IV of the object, and each following segment
+     * the next IV value.
+     */
+    (void)tfm_memcpy(&seg_crypto, &obj->header.crypto, sizeof(seg_crypto));
+    assoc_data.fid = fid;
+
+    for (seg_offset = 0; seg_offset < cur_size; seg_offset += seg_size) {
+        seg_size = PS_UTILS_MIN(PS_AEAD_SEGMENT_SIZE, cur_size - seg_offset);
+
+        if (seg_offset != 0) {
+            ps_crypto_increment_iv(&seg_crypto);
+        }
+
+        if ((seg_offset + seg_size) < cur_size) {
+            (void)tfm_memcpy(seg_crypto.ref.tag, p_seg_tags,
+                             PS_TAG_LEN_BYTES);
+            p_seg_tags += PS_TAG_LEN_BYTES;
+        } else {
+            (void)tfm_memcpy(seg_crypto.ref.tag, obj->header.crypto.ref.tag,
+                             PS_TAG_LEN_BYTES);
+        }
+
+        (void)tfm_memcpy(ps_crypto_buf, p_obj_data + seg_offset, seg_size);
+
+        /* Chain each segment to the previous one, so that segments cannot be
+         * reordered, dropped or mixed between objects.
+         */
+        err = ps_crypto_auth_and_decrypt(&seg_crypto,
+                                         (const uint8_t *)&assoc_data,
+                                         add_len,
+                                         ps_crypto_buf,
+                                         seg_size,
+                                         p_obj_data + seg_offset,
+                                         seg_size,
+                                         &out_len);
+        if (err != PSA_SUCCESS || out_len != seg_size) {
+            (void)ps_crypto_destroykey();
+            return PSA_ERROR_GENERIC_ERROR;
+        }
+
+        (void)tfm_memcpy(assoc_data.prev_tag, seg_crypto.ref.tag,
+                         PS_TAG_LEN_BYTES);
+        add_len = sizeof(assoc_data);
+    }
+
+    return ps_crypto_destroykey();
+}
+
+/**
+ * \brief Performs authenticated encryption on object data, segment by
+ *        segment, in place.
+ *
+ * \param[in]  fid       File ID
+ * \param[in]  cur_size  Size of the object data to encrypt
+ * \param[out] obj       Pointer to the object structure to authenticate and
+ *                       fill in with the encrypted data, followed by the tags
+ *                       of all segments but the last one.
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t ps_object_auth_encrypt(uint32_t fid,
+                                           uint32_t cur_size,
+                                           struct ps_object_t *obj)
+{
+    psa_status_t err;
+    uint8_t *p_obj_data = (uint8_t *)&obj->header.info;
+    uint8_t *p_seg_tags = p_obj_data + cur_size;
+    struct ps_segment_assoc_data_t assoc_data;
+    union ps_crypto_t seg_crypto;
+    uint32_t seg_offset;
+    uint32_t seg_size;
+    size_t add_len = sizeof(assoc_data.fid);
+    size_t out_len;
+
+    err = ps_crypto_setkey();
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    /* FIXME: should have an IV per object with key diversification */
+    /* Get a new IV for each encryption */
+    ps_crypto_get_iv(&obj->header.crypto);
+
+    (void)tfm_memcpy(&seg_crypto, &obj->header.crypto, sizeof(seg_crypto));
+    assoc_data.fid = fid;
+
+    for (seg_offset = 0; seg_offset < cur_size; seg_offset += seg_size) {
+        seg_size = PS_UTILS_MIN(PS_AEAD_SEGMENT_SIZE, cur_size - seg_offset);
+
+        if (seg_offset != 0) {
+            ps_crypto_increment_iv(&seg_crypto);
+        }
+
+        err = ps_crypto_encrypt_and_tag(&seg_crypto,
+                                        (const uint8_t *)&assoc_data,
+                                        add_len,
+                                        p_obj_data + seg_offset,
+                                        seg_size,
+                                        ps_crypto_buf,
+                                        sizeof(ps_crypto_buf),
+                                        &out_len);
+        if (err != PSA_SUCCESS || out_len != seg_size) {
+            (void)ps_crypto_destroykey();
+            return PSA_ERROR_GENERIC_ERROR;
+        }
+
+        (void)tfm_memcpy(p_obj_data + seg_offset, ps_crypto_buf, seg_size);
+
+        if ((seg_offset + seg_size) < cur_size) {
+            (void)tfm_memcpy(p_seg_tags, seg_crypto.ref.tag,
+                             PS_TAG_LEN_BYTES);
+            p_seg_tags += PS_TAG_LEN_BYTES;
+        }
+
+        (void)tfm_memcpy(assoc_data.prev_tag, seg_crypto.ref.tag,
+                         PS_TAG_LEN_BYTES);
+        add_len = sizeof(assoc_data);
+    }
+
+    /* The tag of the last segment is stored in the object table */
+    (void)tfm_memcpy(obj->header.crypto.ref.tag, seg_crypto.ref.tag,
+                     PS_TAG_LEN_BYTES);
+
+    /* Make sure the IV values used by the segments are not used again */
+    ps_crypto_set_iv(&seg_crypto);
+
+    return ps_crypto_destroykey();
+}
+#else /* PS_AEAD_SEGMENT_SIZE */
+
 /**
  * \brief Performs authenticated decryption on object data, with the header as
  *        the associated data.
@@ -131,12 +319,16 @@ static psa_status_t ps_object_auth_encrypt(uint32_t fid,
 
     return ps_crypto_destroykey();
 }
+#endif /* PS_AEAD_SEGMENT_SIZE */
 
 psa_status_t ps_encrypted_object_read(uint32_t fid, struct ps_object_t *obj)
 {
     psa_status_t err;
     uint32_t decrypt_size;
     size_t data_length;
+#ifdef PS_AEAD_SEGMENT_SIZE
+    uint32_t seg_tags_size;
+#endif
 
     /* Read the encrypted object from the the persistent area */
     err = psa_its_get(fid, PS_OBJECT_START_POSITION,
@@ -147,9 +339,29 @@ psa_status_t ps_encrypted_object_read(uint32_t fid, struct ps_object_t *obj)
         return err;
     }
 
+#ifdef PS_AEAD_SEGMENT_SIZE
+    if (data_length < sizeof(obj->header.crypto.ref.iv)) {
+        return PSA_ERROR_DATA_CORRUPT;
+    }
+#endif
+
     /* Get the decrypt size */
     decrypt_size = data_length - sizeof(obj->header.crypto.ref.iv);
 
+#ifdef PS_AEAD_SEGMENT_SIZE
+    /* Each segment but the last one is followed by its tag */
+    seg_tags_size = ((decrypt_size + PS_TAG_LEN_BYTES - 1) /
+                     (PS_AEAD_SEGMENT_SIZE + PS_TAG_LEN_BYTES)) *
+                    PS_TAG_LEN_BYTES;
+    if ((decrypt_size <= seg_tags_size) ||
+        ((decrypt_size - seg_tags_size) >
+         PS_ENCRYPT_SIZE(PS_MAX_OBJECT_DATA_SIZE))) {
+        return PSA_ERROR_DATA_CORRUPT;
+    }
+
+    decrypt_size -= seg_tags_size;
+#endif
+
     /* Decrypt the object data */
     err = ps_object_auth_decrypt(fid, decrypt_size, obj);
     if (err != PSA_SUCCESS) {
@@ -172,6 +384,11 @@ psa_status_t ps_encrypted_object_write(uint32_t fid, struct ps_object_t *obj)
         return err;
     }
 
+#ifdef PS_AEAD_SEGMENT_SIZE
+    /* Add the tags stored after the encrypted data */
+    wrt_size += PS_SEGMENT_TAGS_SIZE(wrt_size);
+#endif
+
     wrt_size += sizeof(obj->header.crypto.ref.iv);
 
     /* Write the encrypted object to the persistent area. The tag values is not
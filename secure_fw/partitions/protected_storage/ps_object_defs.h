@@ -46,6 +46,26 @@ struct ps_obj_header_t {
 
 #define PS_MAX_OBJECT_DATA_SIZE  PS_MAX_ASSET_SIZE
 
+#if defined(PS_ENCRYPTION) && defined(PS_AEAD_SEGMENT_SIZE)
+#if (PS_AEAD_SEGMENT_SIZE < 1)
+#error "PS_AEAD_SEGMENT_SIZE must be at least 1"
+#endif
+
+/* Number of AEAD segments of the object information and data of the largest
+ * object.
+ */
+#define PS_MAX_NUM_AEAD_SEGMENTS \
+    ((sizeof(struct ps_object_info_t) + PS_MAX_OBJECT_DATA_SIZE + \
+      PS_AEAD_SEGMENT_SIZE - 1) / PS_AEAD_SEGMENT_SIZE)
+
+/* The tag of the last segment is stored in the object table, and the tags of
+ * the other segments are stored after the encrypted data. The space reserved
+ * for them is rounded up to one tag per segment so that it is never empty.
+ */
+#define PS_AEAD_SEGMENT_TAGS_SIZE \
+    (PS_MAX_NUM_AEAD_SEGMENTS * PS_TAG_LEN_BYTES)
+#endif
+
 /*!
  * \struct ps_object_t
  *
@@ -55,6 +75,12 @@ struct ps_obj_header_t {
 struct ps_object_t {
     struct ps_obj_header_t header;         /*!< Object header */
     uint8_t data[PS_MAX_OBJECT_DATA_SIZE]; /*!< Object data */
+#if defined(PS_ENCRYPTION) && defined(PS_AEAD_SEGMENT_SIZE)
+    uint8_t segment_tags[PS_AEAD_SEGMENT_TAGS_SIZE]; /*!< Space for the
+                                                      *   segment tags of the
+                                                      *   largest object
+                                                      */
+#endif
 };
 
 
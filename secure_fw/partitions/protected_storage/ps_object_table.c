@@ -7,6 +7,7 @@
 
 #include "ps_object_table.h"
 
+#include <stdbool.h>
 #include <stddef.h>
 
 #include "cmsis_compiler.h"
@@ -131,6 +132,51 @@ struct ps_obj_table_ctx_t {
 /* Object table context */
 static struct ps_obj_table_ctx_t ps_obj_table_ctx;
 
+#ifdef PS_OBJECT_TABLE_INDEX
+/* Number of slots of the hash table. Twice the number of table entries keeps
+ * the probe sequences short.
+ */
+#define PS_OBJ_TABLE_INDEX_NUM_SLOTS    (2 * PS_OBJ_TABLE_ENTRIES)
+
+/* Number of words in a bitmap with one bit per object table entry */
+#define PS_OBJ_TABLE_INDEX_BITMAP_WORDS ((PS_OBJ_TABLE_ENTRIES + 31) / 32)
+
+#if PS_OBJ_TABLE_ENTRIES > UINT16_MAX
+#error "PS_NUM_ASSETS is too large for the object table index"
+#endif
+
+#define PS_OBJ_TABLE_INDEX_BIT_IS_SET(bitmap, idx) \
+    (((bitmap)[(idx) / 32] & (1U << ((idx) % 32))) != 0)
+#define PS_OBJ_TABLE_INDEX_SET_BIT(bitmap, idx) \
+    ((bitmap)[(idx) / 32] |= (1U << ((idx) % 32)))
+#define PS_OBJ_TABLE_INDEX_CLEAR_BIT(bitmap, idx) \
+    ((bitmap)[(idx) / 32] &= ~(1U << ((idx) % 32)))
+
+/*!
+ * \struct ps_obj_table_index_t
+ *
+ * \brief Index of the object table entries in RAM, keyed on the object UID
+ *        and client ID.
+ */
+struct ps_obj_table_index_t {
+    uint16_t slots[PS_OBJ_TABLE_INDEX_NUM_SLOTS]; /*!< Open-addressing hash
+                                                   *   table of table entry
+                                                   *   index plus one, or 0 if
+                                                   *   the slot is empty
+                                                   */
+    uint32_t hash[PS_OBJ_TABLE_ENTRIES];          /*!< Key hash of each entry
+                                                   *   in use
+                                                   */
+    uint32_t used[PS_OBJ_TABLE_INDEX_BITMAP_WORDS]; /*!< Entries in use */
+    uint32_t num_free;                            /*!< Number of free
+                                                   *   entries
+                                                   */
+};
+
+/* Object table index */
+static struct ps_obj_table_index_t ps_obj_table_index;
+#endif /* PS_OBJECT_TABLE_INDEX */
+
 /* Object table size */
 #define PS_OBJ_TABLE_SIZE            sizeof(struct ps_obj_table_t)
 
@@ -211,37 +257,75 @@ struct ps_obj_table_init_ctx_t {
 /**
  * \brief Reads object table from persistent memory.
  *
- * \param[out] init_ctx  Pointer to the init object table context
+ * \param[in]     table_idx  Table index in the init context
+ * \param[in,out] init_ctx   Pointer to the init object table context
  *
  */
-__attribute__ ((always_inline))
-__STATIC_INLINE void ps_object_table_fs_read_table(
+static void ps_object_table_fs_read_table(uint8_t table_idx,
                                        struct ps_obj_table_init_ctx_t *init_ctx)
 {
     psa_status_t err;
     size_t data_length;
 
-    /* Read file with the table 0 data */
-
-    err = psa_its_get(PS_TABLE_FS_ID(PS_OBJ_TABLE_IDX_0),
+    err = psa_its_get(PS_TABLE_FS_ID(table_idx),
                       PS_OBJECT_TABLE_OBJECT_OFFSET,
                       PS_OBJ_TABLE_SIZE,
-                      (void *)init_ctx->p_table[PS_OBJ_TABLE_IDX_0],
+                      (void *)init_ctx->p_table[table_idx],
                       &data_length);
     if (err != PSA_SUCCESS) {
-        init_ctx->table_state[PS_OBJ_TABLE_IDX_0] = PS_OBJ_TABLE_INVALID;
+        init_ctx->table_state[table_idx] = PS_OBJ_TABLE_INVALID;
     }
+}
 
-    /* Read file with the table 1 data */
-    err = psa_its_get(PS_TABLE_FS_ID(PS_OBJ_TABLE_IDX_1),
-                      PS_OBJECT_TABLE_OBJECT_OFFSET,
-                      PS_OBJ_TABLE_SIZE,
-                      (void *)init_ctx->p_table[PS_OBJ_TABLE_IDX_1],
-                      &data_length);
-    if (err != PSA_SUCCESS) {
-        init_ctx->table_state[PS_OBJ_TABLE_IDX_1] = PS_OBJ_TABLE_INVALID;
+#ifndef PS_ROLLBACK_PROTECTION
+/**
+ * \brief Gets the latest object table based on the swap count, regardless of
+ *        the validity of the object table data.
+ *
+ * \param[in] init_ctx  Pointer to the init object table context
+ *
+ * \return Returns the index of the latest object table
+ */
+static uint8_t ps_object_table_latest_idx(
+                                const struct ps_obj_table_init_ctx_t *init_ctx)
+{
+    uint8_t table0_swap_count =
+                             init_ctx->p_table[PS_OBJ_TABLE_IDX_0]->swap_count;
+    uint8_t table1_swap_count =
+                             init_ctx->p_table[PS_OBJ_TABLE_IDX_1]->swap_count;
+
+    /* Logic: if the swap count is 0, then it has rolled over. The object table
+     * with a swap count of 0 is the latest one, unless the other block has a
+     * swap count of 1, in which case the roll over occurred in the previous
+     * update. In all other cases, the table with the highest swap count is the
+     * latest one.
+     */
+    if ((table1_swap_count == 0) && (table0_swap_count != 1)) {
+        /* Table 1 swap count has rolled over and table 0 swap count has not,
+         * so table 1 is the latest.
+         */
+        return PS_OBJ_TABLE_IDX_1;
+
+    } else if ((table0_swap_count == 0) && (table1_swap_count != 1)) {
+        /* Table 0 swap count has rolled over and table 1 swap count has not,
+         * so table 0 is the latest.
+         */
+        return PS_OBJ_TABLE_IDX_0;
+
+    } else if (table1_swap_count > table0_swap_count) {
+        /* Neither swap count has just rolled over and table 1 has a
+         * higher swap count, so table 1 is the latest.
+         */
+        return PS_OBJ_TABLE_IDX_1;
+
+    } else {
+        /* Neither swap count has just rolled over and table 0 has a
+         * higher or equal swap count, so table 0 is the latest.
+         */
+        return PS_OBJ_TABLE_IDX_0;
     }
 }
+#endif /* PS_ROLLBACK_PROTECTION */
 
 /**
  * \brief Writes object table in persistent memory.
@@ -349,47 +433,45 @@ __STATIC_INLINE psa_status_t ps_object_table_nvc_generate_auth_tag(
 }
 
 /**
- * \brief Authenticates table of objects.
+ * \brief Authenticates table of objects with a non-volatile counter value.
  *
- * \param[in]     table_idx  Table index in the init context
- * \param[in,out] init_ctx   Pointer to the object table to authenticate
+ * \param[in]     table_idx    Table index in the init context
+ * \param[in]     nv_counter   Non-volatile counter value to authenticate the
+ *                             table with
+ * \param[in]     valid_state  State to set if the table is authenticated
+ * \param[in,out] init_ctx     Pointer to the object table to authenticate
  *
+ * \return Returns true if the table is authenticated and has the current
+ *         version. Otherwise, it returns false.
  */
-static void ps_object_table_authenticate(uint8_t table_idx,
+static bool ps_object_table_authenticate(uint8_t table_idx,
+                                       uint32_t nv_counter,
+                                       enum ps_obj_table_state valid_state,
                                        struct ps_obj_table_init_ctx_t *init_ctx)
 {
     struct ps_crypto_assoc_data_t assoc_data;
     union ps_crypto_t *crypto = &init_ctx->p_table[table_idx]->crypto;
     psa_status_t err;
 
-    /* Init associated data with NVC 1 */
-    assoc_data.nv_counter = init_ctx->nvc_1;
+    if (init_ctx->table_state[table_idx] != PS_OBJ_TABLE_VALID) {
+        /* The table could not be read or is already authenticated */
+        return false;
+    }
+
+    assoc_data.nv_counter = nv_counter;
     (void)tfm_memcpy(assoc_data.obj_table_data,
                      PS_CRYPTO_ASSOCIATED_DATA(crypto),
                      PS_OBJ_TABLE_AUTH_DATA_SIZE);
 
     err = ps_crypto_authenticate(crypto, (const uint8_t *)&assoc_data,
                                  PS_CRYPTO_ASSOCIATED_DATA_LEN);
-    if (err == PSA_SUCCESS) {
-        init_ctx->table_state[table_idx] = PS_OBJ_TABLE_NVC_1_VALID;
-        return;
-    }
-
-    if (init_ctx->nvc_3 == PS_INVALID_NVC_VALUE) {
-        init_ctx->table_state[table_idx] = PS_OBJ_TABLE_INVALID;
-        return;
+    if (err != PSA_SUCCESS) {
+        return false;
     }
 
-    /* Check with NVC 3 */
-    assoc_data.nv_counter = init_ctx->nvc_3;
+    init_ctx->table_state[table_idx] = valid_state;
 
-    err = ps_crypto_authenticate(crypto, (const uint8_t *)&assoc_data,
-                                 PS_CRYPTO_ASSOCIATED_DATA_LEN);
-    if (err != PSA_SUCCESS) {
-        init_ctx->table_state[table_idx] = PS_OBJ_TABLE_INVALID;
-    } else {
-        init_ctx->table_state[table_idx] = PS_OBJ_TABLE_NVC_3_VALID;
-    }
+    return (init_ctx->p_table[table_idx]->version == PS_OBJECT_SYSTEM_VERSION);
 }
 
 /**
@@ -432,14 +514,38 @@ __STATIC_INLINE psa_status_t ps_object_table_nvc_authenticate(
         init_ctx->nvc_3 = PS_INVALID_NVC_VALUE;
     }
 
-    /* Authenticate table 0 if data is valid */
-    if (init_ctx->table_state[PS_OBJ_TABLE_IDX_0] != PS_OBJ_TABLE_INVALID) {
-        ps_object_table_authenticate(PS_OBJ_TABLE_IDX_0, init_ctx);
+    /* NVC 1 is incremented before each table is saved, so at most one table
+     * can be authenticated with the NVC 1 value, and it is the active one.
+     * Each table is read from the file system only when it is needed, and the
+     * NVC 3 value is only tried once no table is authenticated with NVC 1.
+     */
+    ps_object_table_fs_read_table(PS_OBJ_TABLE_IDX_0, init_ctx);
+    if (!ps_object_table_authenticate(PS_OBJ_TABLE_IDX_0, init_ctx->nvc_1,
+                                      PS_OBJ_TABLE_NVC_1_VALID, init_ctx)) {
+        ps_object_table_fs_read_table(PS_OBJ_TABLE_IDX_1, init_ctx);
+        if (!ps_object_table_authenticate(PS_OBJ_TABLE_IDX_1, init_ctx->nvc_1,
+                                          PS_OBJ_TABLE_NVC_1_VALID, init_ctx)
+            && init_ctx->nvc_3 != PS_INVALID_NVC_VALUE) {
+            /* Check with NVC 3 */
+            if (!ps_object_table_authenticate(PS_OBJ_TABLE_IDX_0,
+                                              init_ctx->nvc_3,
+                                              PS_OBJ_TABLE_NVC_3_VALID,
+                                              init_ctx)) {
+                (void)ps_object_table_authenticate(PS_OBJ_TABLE_IDX_1,
+                                                   init_ctx->nvc_3,
+                                                   PS_OBJ_TABLE_NVC_3_VALID,
+                                                   init_ctx);
+            }
+        }
+    }
+
+    /* Tables which have not been read or authenticated are invalid */
+    if (init_ctx->table_state[PS_OBJ_TABLE_IDX_0] == PS_OBJ_TABLE_VALID) {
+        init_ctx->table_state[PS_OBJ_TABLE_IDX_0] = PS_OBJ_TABLE_INVALID;
     }
 
-    /* Authenticate table 1 if data is valid */
-    if (init_ctx->table_state[PS_OBJ_TABLE_IDX_1] != PS_OBJ_TABLE_INVALID) {
-        ps_object_table_authenticate(PS_OBJ_TABLE_IDX_1, init_ctx);
+    if (init_ctx->table_state[PS_OBJ_TABLE_IDX_1] == PS_OBJ_TABLE_VALID) {
+        init_ctx->table_state[PS_OBJ_TABLE_IDX_1] = PS_OBJ_TABLE_INVALID;
     }
 
     return PSA_SUCCESS;
@@ -468,6 +574,36 @@ __STATIC_INLINE psa_status_t ps_object_table_generate_auth_tag(
                                        PS_CRYPTO_ASSOCIATED_DATA_LEN);
 }
 
+/**
+ * \brief Authenticates table of objects.
+ *
+ * \param[in]     table_idx  Table index in the init context
+ * \param[in,out] init_ctx   Pointer to the object table to authenticate
+ *
+ * \return Returns true if the table is authenticated and has the current
+ *         version. Otherwise, it returns false.
+ */
+static bool ps_object_table_authenticate(uint8_t table_idx,
+                                       struct ps_obj_table_init_ctx_t *init_ctx)
+{
+    psa_status_t err;
+    union ps_crypto_t *crypto = &init_ctx->p_table[table_idx]->crypto;
+
+    if (init_ctx->table_state[table_idx] == PS_OBJ_TABLE_INVALID) {
+        return false;
+    }
+
+    err = ps_crypto_authenticate(crypto,
+                                 PS_CRYPTO_ASSOCIATED_DATA(crypto),
+                                 PS_CRYPTO_ASSOCIATED_DATA_LEN);
+    if (err != PSA_SUCCESS) {
+        init_ctx->table_state[table_idx] = PS_OBJ_TABLE_INVALID;
+        return false;
+    }
+
+    return (init_ctx->p_table[table_idx]->version == PS_OBJECT_SYSTEM_VERSION);
+}
+
 /**
  * \brief Authenticates tables of objects.
  *
@@ -478,30 +614,17 @@ __attribute__ ((always_inline))
 __STATIC_INLINE void ps_object_table_authenticate_ctx_tables(
                                       struct ps_obj_table_init_ctx_t *init_ctx)
 {
-    psa_status_t err;
-    union ps_crypto_t *crypto =
-                                &init_ctx->p_table[PS_OBJ_TABLE_IDX_0]->crypto;
-
-    /* Authenticate table 0 if data is valid */
-    if (init_ctx->table_state[PS_OBJ_TABLE_IDX_0] != PS_OBJ_TABLE_INVALID) {
-        err = ps_crypto_authenticate(crypto,
-                                     PS_CRYPTO_ASSOCIATED_DATA(crypto),
-                                     PS_CRYPTO_ASSOCIATED_DATA_LEN);
-        if (err != PSA_SUCCESS) {
-            init_ctx->table_state[PS_OBJ_TABLE_IDX_0] = PS_OBJ_TABLE_INVALID;
-        }
-    }
-
-    /* Authenticate table 1 if data is valid */
-    if (init_ctx->table_state[PS_OBJ_TABLE_IDX_1] != PS_OBJ_TABLE_INVALID) {
-        crypto = &init_ctx->p_table[PS_OBJ_TABLE_IDX_1]->crypto;
+    uint8_t latest_idx = ps_object_table_latest_idx(init_ctx);
+    uint8_t other_idx = (latest_idx == PS_OBJ_TABLE_IDX_0) ?
+                        PS_OBJ_TABLE_IDX_1 : PS_OBJ_TABLE_IDX_0;
 
-        err = ps_crypto_authenticate(crypto,
-                                     PS_CRYPTO_ASSOCIATED_DATA(crypto),
-                                     PS_CRYPTO_ASSOCIATED_DATA_LEN);
-        if (err != PSA_SUCCESS) {
-            init_ctx->table_state[PS_OBJ_TABLE_IDX_1] = PS_OBJ_TABLE_INVALID;
-        }
+    /* The latest table is the active one when it is valid, so the other table
+     * only needs to be authenticated when the latest one is not valid.
+     */
+    if (ps_object_table_authenticate(latest_idx, init_ctx)) {
+        init_ctx->table_state[other_idx] = PS_OBJ_TABLE_INVALID;
+    } else {
+        (void)ps_object_table_authenticate(other_idx, init_ctx);
     }
 }
 #endif /* PS_ROLLBACK_PROTECTION */
@@ -622,13 +745,6 @@ __STATIC_INLINE void ps_object_table_validate_version(
 static psa_status_t ps_set_active_object_table(
                                 const struct ps_obj_table_init_ctx_t *init_ctx)
 {
-#ifndef PS_ROLLBACK_PROTECTION
-    uint8_t table0_swap_count =
-                             init_ctx->p_table[PS_OBJ_TABLE_IDX_0]->swap_count;
-    uint8_t table1_swap_count =
-                             init_ctx->p_table[PS_OBJ_TABLE_IDX_1]->swap_count;
-#endif
-
     /* Check if there is an invalid object table */
     if ((init_ctx->table_state[PS_OBJ_TABLE_IDX_0] == PS_OBJ_TABLE_INVALID)
          && (init_ctx->table_state[PS_OBJ_TABLE_IDX_1] ==
@@ -676,37 +792,10 @@ static psa_status_t ps_set_active_object_table(
         ps_obj_table_ctx.scratch_table = PS_OBJ_TABLE_IDX_1;
     }
 #else
-    /* Logic: if the swap count is 0, then it has rolled over. The object table
-     * with a swap count of 0 is the latest one, unless the other block has a
-     * swap count of 1, in which case the roll over occurred in the previous
-     * update. In all other cases, the table with the highest swap count is the
-     * latest one.
-     */
-    if ((table1_swap_count == 0) && (table0_swap_count != 1)) {
-        /* Table 1 swap count has rolled over and table 0 swap count has not,
-         * so table 1 is the latest.
-         */
-        ps_obj_table_ctx.active_table  = PS_OBJ_TABLE_IDX_1;
-        ps_obj_table_ctx.scratch_table = PS_OBJ_TABLE_IDX_0;
-
-    } else if ((table0_swap_count == 0) && (table1_swap_count != 1)) {
-        /* Table 0 swap count has rolled over and table 1 swap count has not,
-         * so table 0 is the latest.
-         */
-        ps_obj_table_ctx.active_table  = PS_OBJ_TABLE_IDX_0;
-        ps_obj_table_ctx.scratch_table = PS_OBJ_TABLE_IDX_1;
-
-    } else if (table1_swap_count > table0_swap_count) {
-        /* Neither swap count has just rolled over and table 1 has a
-         * higher swap count, so table 1 is the latest.
-         */
+    if (ps_object_table_latest_idx(init_ctx) == PS_OBJ_TABLE_IDX_1) {
         ps_obj_table_ctx.active_table  = PS_OBJ_TABLE_IDX_1;
         ps_obj_table_ctx.scratch_table = PS_OBJ_TABLE_IDX_0;
-
     } else {
-        /* Neither swap count has just rolled over and table 0 has a
-         * higher or equal swap count, so table 0 is the latest.
-         */
         ps_obj_table_ctx.active_table  = PS_OBJ_TABLE_IDX_0;
         ps_obj_table_ctx.scratch_table = PS_OBJ_TABLE_IDX_1;
     }
@@ -724,6 +813,123 @@ static psa_status_t ps_set_active_object_table(
     return PSA_SUCCESS;
 }
 
+#ifdef PS_OBJECT_TABLE_INDEX
+/**
+ * \brief Computes the hash of an object key (32-bit FNV-1a).
+ *
+ * \param[in] uid        Object UID
+ * \param[in] client_id  Client UID
+ *
+ * \return Hash of the object key
+ */
+static uint32_t ps_obj_table_index_hash(psa_storage_uid_t uid,
+                                        int32_t client_id)
+{
+    uint32_t hash = 2166136261U;
+    uint32_t i;
+
+    for (i = 0; i < sizeof(uid); i++) {
+        hash = (hash ^ (uint8_t)(uid >> (8 * i))) * 16777619U;
+    }
+
+    for (i = 0; i < sizeof(client_id); i++) {
+        hash = (hash ^ (uint8_t)((uint32_t)client_id >> (8 * i))) * 16777619U;
+    }
+
+    return hash;
+}
+
+/**
+ * \brief Adds a table entry to the index.
+ *
+ * \param[in] idx  Entry index, with its UID and client ID already set
+ */
+static void ps_obj_table_index_add(uint32_t idx)
+{
+    struct ps_obj_table_index_t *index = &ps_obj_table_index;
+    const struct ps_obj_table_entry_t *entry =
+                                       &ps_obj_table_ctx.obj_table.obj_db[idx];
+    uint32_t slot;
+
+    if (PS_OBJ_TABLE_INDEX_BIT_IS_SET(index->used, idx)) {
+        return;
+    }
+
+    index->hash[idx] = ps_obj_table_index_hash(entry->uid, entry->client_id);
+    slot = index->hash[idx] % PS_OBJ_TABLE_INDEX_NUM_SLOTS;
+
+    /* The table has twice as many slots as entries, so an empty slot is
+     * always found.
+     */
+    while (index->slots[slot] != 0) {
+        slot = (slot + 1) % PS_OBJ_TABLE_INDEX_NUM_SLOTS;
+    }
+
+    index->slots[slot] = (uint16_t)(idx + 1);
+    PS_OBJ_TABLE_INDEX_SET_BIT(index->used, idx);
+    index->num_free--;
+}
+
+/**
+ * \brief Removes a table entry from the index.
+ *
+ * \param[in] idx  Entry index
+ */
+static void ps_obj_table_index_remove(uint32_t idx)
+{
+    struct ps_obj_table_index_t *index = &ps_obj_table_index;
+    uint32_t hole;
+    uint32_t home;
+    uint32_t slot;
+
+    if (!PS_OBJ_TABLE_INDEX_BIT_IS_SET(index->used, idx)) {
+        return;
+    }
+
+    slot = index->hash[idx] % PS_OBJ_TABLE_INDEX_NUM_SLOTS;
+    while (index->slots[slot] != (uint16_t)(idx + 1)) {
+        slot = (slot + 1) % PS_OBJ_TABLE_INDEX_NUM_SLOTS;
+    }
+
+    /* Shift back the following entries of the probe sequence which would not
+     * be reachable anymore from their home slot through the emptied slot.
+     */
+    hole = slot;
+    slot = (slot + 1) % PS_OBJ_TABLE_INDEX_NUM_SLOTS;
+    while (index->slots[slot] != 0) {
+        home = index->hash[index->slots[slot] - 1] %
+               PS_OBJ_TABLE_INDEX_NUM_SLOTS;
+        if ((hole <= slot) ? ((home <= hole) || (home > slot))
+                           : ((home <= hole) && (home > slot))) {
+            index->slots[hole] = index->slots[slot];
+            hole = slot;
+        }
+        slot = (slot + 1) % PS_OBJ_TABLE_INDEX_NUM_SLOTS;
+    }
+
+    index->slots[hole] = 0;
+    PS_OBJ_TABLE_INDEX_CLEAR_BIT(index->used, idx);
+    index->num_free++;
+}
+
+/**
+ * \brief Builds the index from the object table in the context.
+ */
+static void ps_obj_table_index_build(void)
+{
+    uint32_t i;
+
+    (void)tfm_memset(&ps_obj_table_index, 0, sizeof(ps_obj_table_index));
+    ps_obj_table_index.num_free = PS_OBJ_TABLE_ENTRIES;
+
+    for (i = 0; i < PS_OBJ_TABLE_ENTRIES; i++) {
+        if (ps_obj_table_ctx.obj_table.obj_db[i].uid != TFM_PS_INVALID_UID) {
+            ps_obj_table_index_add(i);
+        }
+    }
+}
+#endif /* PS_OBJECT_TABLE_INDEX */
+
 /**
  * \brief Gets table's entry index based on the given object UID and client ID.
  *
@@ -740,7 +946,20 @@ static psa_status_t ps_get_object_entry_idx(psa_storage_uid_t uid,
 {
     uint32_t i;
     struct ps_obj_table_t *p_table = &ps_obj_table_ctx.obj_table;
+#ifdef PS_OBJECT_TABLE_INDEX
+    uint32_t slot = ps_obj_table_index_hash(uid, client_id) %
+                    PS_OBJ_TABLE_INDEX_NUM_SLOTS;
 
+    while (ps_obj_table_index.slots[slot] != 0) {
+        i = ps_obj_table_index.slots[slot] - 1U;
+        if (p_table->obj_db[i].uid == uid
+            && p_table->obj_db[i].client_id == client_id) {
+            *idx = i;
+            return PSA_SUCCESS;
+        }
+        slot = (slot + 1) % PS_OBJ_TABLE_INDEX_NUM_SLOTS;
+    }
+#else
     for (i = 0; i < PS_OBJ_TABLE_ENTRIES; i++) {
         if (p_table->obj_db[i].uid == uid
             && p_table->obj_db[i].client_id == client_id) {
@@ -748,6 +967,7 @@ static psa_status_t ps_get_object_entry_idx(psa_storage_uid_t uid,
             return PSA_SUCCESS;
         }
     }
+#endif /* PS_OBJECT_TABLE_INDEX */
 
     return PSA_ERROR_DOES_NOT_EXIST;
 }
@@ -772,18 +992,38 @@ __STATIC_INLINE psa_status_t ps_table_free_idx(uint32_t idx_num,
 {
     uint32_t i;
     uint32_t last_free = 0;
+#ifdef PS_OBJECT_TABLE_INDEX
+    uint32_t free_bits;
+#else
     struct ps_obj_table_t *p_table = &ps_obj_table_ctx.obj_table;
+#endif
 
     if (idx_num == 0) {
         return PSA_ERROR_INVALID_ARGUMENT;
     }
 
+#ifdef PS_OBJECT_TABLE_INDEX
+    if (idx_num > ps_obj_table_index.num_free) {
+        return PSA_ERROR_INSUFFICIENT_STORAGE;
+    }
+
+    /* Walk the free entries in ascending order, a bitmap word at a time */
+    for (i = 0; i < PS_OBJ_TABLE_INDEX_BITMAP_WORDS && idx_num > 0; i++) {
+        free_bits = ~ps_obj_table_index.used[i];
+        while (free_bits != 0 && idx_num > 0) {
+            last_free = (i * 32) + __CLZ(__RBIT(free_bits));
+            free_bits &= free_bits - 1;
+            idx_num--;
+        }
+    }
+#else
     for (i = 0; i < PS_OBJ_TABLE_ENTRIES && idx_num > 0; i++) {
         if (p_table->obj_db[i].uid == TFM_PS_INVALID_UID) {
             last_free = i;
             idx_num--;
         }
     }
+#endif /* PS_OBJECT_TABLE_INDEX */
 
     if (idx_num != 0) {
         return PSA_ERROR_INSUFFICIENT_STORAGE;
@@ -801,6 +1041,10 @@ __STATIC_INLINE psa_status_t ps_table_free_idx(uint32_t idx_num,
  */
 static void ps_table_delete_entry(uint32_t idx)
 {
+#ifdef PS_OBJECT_TABLE_INDEX
+    ps_obj_table_index_remove(idx);
+#endif
+
     /* Initialise object table entry structure */
     (void)tfm_memset(&ps_obj_table_ctx.obj_table.obj_db[idx],
                      PS_DEFAULT_EMPTY_BUFF_VAL, PS_OBJECTS_TABLE_ENTRY_SIZE);
@@ -822,6 +1066,10 @@ psa_status_t ps_object_table_create(void)
 
     p_table->version = PS_OBJECT_SYSTEM_VERSION;
 
+#ifdef PS_OBJECT_TABLE_INDEX
+    ps_obj_table_index_build();
+#endif
+
     /* Save object table contents */
     return ps_object_table_save_table(p_table);
 }
@@ -840,8 +1088,13 @@ psa_status_t ps_object_table_init(uint8_t *obj_data)
 
     init_ctx.p_table[PS_OBJ_TABLE_IDX_1] = (struct ps_obj_table_t *)obj_data;
 
-    /* Read table from the file system */
-    ps_object_table_fs_read_table(&init_ctx);
+#ifndef PS_ROLLBACK_PROTECTION
+    /* Read tables from the file system. With rollback protection, the tables
+     * are read while they are authenticated.
+     */
+    ps_object_table_fs_read_table(PS_OBJ_TABLE_IDX_0, &init_ctx);
+    ps_object_table_fs_read_table(PS_OBJ_TABLE_IDX_1, &init_ctx);
+#endif
 
 #ifdef PS_ENCRYPTION
     /* Set object table key */
@@ -876,6 +1129,11 @@ psa_status_t ps_object_table_init(uint8_t *obj_data)
         return err;
     }
 
+#ifdef PS_OBJECT_TABLE_INDEX
+    /* Rebuild the index from the active table */
+    ps_obj_table_index_build();
+#endif
+
     /* Remove the old object table file */
     err = psa_its_remove(PS_TABLE_FS_ID(ps_obj_table_ctx.scratch_table));
     if (err != PSA_SUCCESS && err != PSA_ERROR_DOES_NOT_EXIST) {
@@ -978,12 +1236,19 @@ psa_status_t ps_object_table_set_obj_tbl_info(psa_storage_uid_t uid,
     p_table->obj_db[idx].version = obj_tbl_info->version;
 #endif
 
+#ifdef PS_OBJECT_TABLE_INDEX
+    ps_obj_table_index_add(idx);
+#endif
+
     err = ps_object_table_save_table(p_table);
     if (err != PSA_SUCCESS) {
         if (backup_entry.uid != TFM_PS_INVALID_UID) {
             /* Rollback the change in the table */
             (void)tfm_memcpy(&p_table->obj_db[backup_idx], &backup_entry,
                              PS_OBJECTS_TABLE_ENTRY_SIZE);
+#ifdef PS_OBJECT_TABLE_INDEX
+            ps_obj_table_index_add(backup_idx);
+#endif
         }
 
         ps_table_delete_entry(idx);
@@ -1048,6 +1313,9 @@ psa_status_t ps_object_table_delete_object(psa_storage_uid_t uid,
        /* Rollback the change in the table */
        (void)tfm_memcpy(&p_table->obj_db[backup_idx], &backup_entry,
                         PS_OBJECTS_TABLE_ENTRY_SIZE);
+#ifdef PS_OBJECT_TABLE_INDEX
+       ps_obj_table_index_add(backup_idx);
+#endif
     }
 
     return err;
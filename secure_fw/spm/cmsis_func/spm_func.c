@@ -374,16 +374,24 @@ static struct iovec_args_t *get_iovec_args_stack_address(uint32_t partition_idx)
  */
 static uint32_t get_partition_idx(uint32_t partition_id)
 {
-    uint32_t i;
+    uint32_t lo, hi, mid, id;
 
     if (partition_id == INVALID_PARTITION_ID) {
         return SPM_INVALID_PARTITION_IDX;
     }
 
-    for (i = 0; i < g_spm_partition_db.partition_count; ++i) {
-        if (g_spm_partition_db.partitions[i].static_data->partition_id ==
-            partition_id) {
-            return i;
+    /* The generated partition database is sorted by partition ID */
+    lo = 0;
+    hi = g_spm_partition_db.partition_count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        id = g_spm_partition_db.partitions[mid].static_data->partition_id;
+        if (id == partition_id) {
+            return mid;
+        } else if (id < partition_id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
     }
     return SPM_INVALID_PARTITION_IDX;
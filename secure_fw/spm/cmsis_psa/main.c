@@ -11,9 +11,13 @@
 #include "tfm_hal_platform.h"
 #include "tfm_hal_isolation.h"
 #include "tfm_irq_list.h"
+#ifdef TFM_MULTI_CORE_TOPOLOGY
+#include "tfm_multi_core.h"
+#endif
 #include "tfm_nspm.h"
 #include "tfm_spm_hal.h"
 #include "tfm_spm_log.h"
+#include "tfm_spm_trace.h"
 #include "tfm_version.h"
 
 /*
@@ -66,6 +70,13 @@ static int32_t tfm_core_init(void)
         return TFM_ERROR_GENERIC;
     }
 
+#ifdef TFM_MULTI_CORE_TOPOLOGY
+    /* Builds the lookup table used by the memory access checks */
+    if (tfm_mem_region_table_init() != TFM_SUCCESS) {
+        return TFM_ERROR_GENERIC;
+    }
+#endif
+
     /* Performs platform specific initialization */
     hal_status = tfm_hal_platform_init();
     if (hal_status != TFM_HAL_SUCCESS) {
@@ -75,6 +86,8 @@ static int32_t tfm_core_init(void)
     /* Configures architecture-specific coprocessors */
     tfm_arch_configure_coprocessors();
 
+    SPMTRACE_INIT();
+
     SPMLOG_INFMSG("\033[1;34m[Sec Thread] Secure image initializing!\033[0m\r\n");
 
     SPMLOG_DBGMSGVAL("TF-M isolation level is: ", TFM_LVL);
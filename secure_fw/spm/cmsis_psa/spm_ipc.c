@@ -27,6 +27,7 @@
 #include "tfm_list.h"
 #include "tfm_hal_isolation.h"
 #include "tfm_pools.h"
+#include "tfm_spm_trace.h"
 #include "region.h"
 #include "region_defs.h"
 #include "spm_partition_defs.h"
@@ -44,6 +45,10 @@ extern const struct tfm_spm_service_db_t service_db[];
 TFM_POOL_DECLARE(conn_handle_pool, sizeof(struct tfm_conn_handle_t),
                  TFM_CONN_HANDLE_MAX_NUM);
 
+/* Stateless RoT Services, indexed by the index in their stateless handle */
+static struct tfm_spm_service_t
+                        *stateless_services[TFM_STATELESS_SERVICE_TABLE_SIZE];
+
 void tfm_irq_handler(uint32_t partition_id, psa_signal_t signal,
                      IRQn_Type irq_line);
 
@@ -158,6 +163,95 @@ struct tfm_conn_handle_t *tfm_spm_create_conn_handle(
     return p_handle;
 }
 
+struct tfm_spm_service_t *tfm_spm_get_stateless_service(psa_handle_t handle)
+{
+    uint32_t idx;
+
+    if (!TFM_HANDLE_IS_STATELESS(handle)) {
+        return NULL;
+    }
+
+    idx = TFM_STATELESS_HANDLE_IDX(handle);
+    if (idx >= TFM_STATELESS_SERVICE_TABLE_SIZE) {
+        return NULL;
+    }
+
+    return stateless_services[idx];
+}
+
+struct tfm_conn_handle_t *tfm_spm_create_stateless_conn_handle(
+                                        struct tfm_spm_service_t *service,
+                                        int32_t client_id, bool ns_caller)
+{
+    struct partition_t *partition;
+    struct tfm_conn_handle_t *p_handle;
+
+    TFM_CORE_ASSERT(service);
+
+#ifdef TFM_MULTI_CORE_TOPOLOGY
+    /* NSPE requests via RPC do not block, so several can be outstanding */
+    if (ns_caller) {
+        return tfm_spm_create_conn_handle(service, client_id);
+    }
+#else
+    (void)ns_caller;
+#endif
+
+    partition = tfm_spm_get_running_partition();
+    if (!partition) {
+        tfm_core_panic();
+    }
+
+    /*
+     * The caller is blocked until its request is replied to, so the handle
+     * reserved in the caller partition is free unless a previous request is
+     * still referenced. Fall back to the pool in that case.
+     */
+    p_handle = &partition->stateless_conn;
+    if (p_handle->internal_msg.magic == TFM_MSG_MAGIC) {
+        return tfm_spm_create_conn_handle(service, client_id);
+    }
+
+    p_handle->service = service;
+    p_handle->status = TFM_HANDLE_STATUS_IDLE;
+    p_handle->client_id = client_id;
+
+    return p_handle;
+}
+
+psa_handle_t tfm_spm_to_msg_handle(struct tfm_conn_handle_t *conn_handle)
+{
+    struct partition_t *partition;
+    uint32_t idx;
+
+    if (is_valid_chunk_data_in_pool(conn_handle_pool,
+                                    (uint8_t *)conn_handle)) {
+        return tfm_spm_to_user_handle(conn_handle);
+    }
+
+    partition = TFM_GET_CONTAINER_PTR(conn_handle, struct partition_t,
+                                      stateless_conn);
+    idx = (uint32_t)(partition - g_spm_partition_db.partitions);
+
+    return (psa_handle_t)(TFM_STATELESS_HANDLE_BIT | idx);
+}
+
+void tfm_spm_free_stateless_conn_handle(struct tfm_spm_service_t *service,
+                                        struct tfm_conn_handle_t *conn_handle)
+{
+    TFM_CORE_ASSERT(conn_handle != NULL);
+
+    if (is_valid_chunk_data_in_pool(conn_handle_pool,
+                                    (uint8_t *)conn_handle)) {
+        tfm_spm_free_conn_handle(service, conn_handle);
+        return;
+    }
+
+    /* Clear magic as the handler is not used anymore */
+    conn_handle->internal_msg.magic = 0;
+    conn_handle->status = TFM_HANDLE_STATUS_IDLE;
+}
+
 int32_t tfm_spm_validate_conn_handle(
                                     const struct tfm_conn_handle_t *conn_handle,
                                     int32_t client_id)
@@ -234,32 +328,43 @@ struct tfm_msg_body_t *tfm_spm_get_msg_by_signal(struct partition_t *partition,
                                                  psa_signal_t signal)
 {
     struct tfm_list_node_t *node, *head;
-    struct tfm_msg_body_t *tmp_msg, *msg = NULL;
+    struct tfm_spm_service_t *p_service = NULL;
+    struct tfm_msg_body_t *msg;
 
     TFM_CORE_ASSERT(partition);
 
-    head = &partition->msg_list;
+    /* Find the RoT Service of the signal in the partition */
+    TFM_LIST_FOR_EACH(node, &partition->service_list) {
+        p_service = TFM_GET_CONTAINER_PTR(node, struct tfm_spm_service_t, list);
+        if (p_service->service_db->signal == signal) {
+            break;
+        }
+    }
+
+    if (node == &partition->service_list) {
+        return NULL;
+    }
+
+    head = &p_service->msg_list;
 
     if (tfm_list_is_empty(head)) {
+        partition->signals_asserted &= ~signal;
         return NULL;
     }
 
+    /* Messages of an RoT Service are handled in the order they were sent */
+    node = tfm_list_first_node(head);
+    tfm_list_del_node(node);
+    msg = TFM_GET_CONTAINER_PTR(node, struct tfm_msg_body_t, msg_node);
+
     /*
      * There may be multiple messages for this RoT Service signal, do not clear
-     * partition mask until no remaining message. Search may be optimized.
+     * partition mask until no remaining message.
      */
-    TFM_LIST_FOR_EACH(node, head) {
-        tmp_msg = TFM_GET_CONTAINER_PTR(node, struct tfm_msg_body_t, msg_node);
-        if (tmp_msg->service->service_db->signal == signal && msg) {
-            return msg;
-        } else if (tmp_msg->service->service_db->signal == signal) {
-            msg = tmp_msg;
-            tfm_list_del_node(node);
-        }
+    if (tfm_list_is_empty(head)) {
+        partition->signals_asserted &= ~signal;
     }
 
-    partition->signals_asserted &= ~signal;
-
     return msg;
 }
 
@@ -273,16 +378,24 @@ struct tfm_msg_body_t *tfm_spm_get_msg_by_signal(struct partition_t *partition,
  */
 static uint32_t get_partition_idx(uint32_t partition_id)
 {
-    uint32_t i;
+    uint32_t lo, hi, mid, id;
 
     if (partition_id == INVALID_PARTITION_ID) {
         return SPM_INVALID_PARTITION_IDX;
     }
 
-    for (i = 0; i < g_spm_partition_db.partition_count; ++i) {
-        if (g_spm_partition_db.partitions[i].static_data->partition_id ==
-            partition_id) {
-            return i;
+    /* The generated partition database is sorted by partition ID */
+    lo = 0;
+    hi = g_spm_partition_db.partition_count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        id = g_spm_partition_db.partitions[mid].static_data->partition_id;
+        if (id == partition_id) {
+            return mid;
+        } else if (id < partition_id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
     }
     return SPM_INVALID_PARTITION_IDX;
@@ -350,12 +463,19 @@ bool tfm_is_partition_privileged(uint32_t partition_idx)
 
 struct tfm_spm_service_t *tfm_spm_get_service_by_sid(uint32_t sid)
 {
-    uint32_t i, num;
-
-    num = sizeof(service) / sizeof(struct tfm_spm_service_t);
-    for (i = 0; i < num; i++) {
-        if (service[i].service_db->sid == sid) {
-            return &service[i];
+    uint32_t lo, hi, mid;
+
+    /* The generated service database is sorted by SID */
+    lo = 0;
+    hi = sizeof(service) / sizeof(struct tfm_spm_service_t);
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (service_db[mid].sid == sid) {
+            return &service[mid];
+        } else if (service_db[mid].sid < sid) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
     }
 
@@ -459,13 +579,22 @@ struct tfm_msg_body_t *tfm_spm_get_msg_from_handle(psa_handle_t msg_handle)
      * Check the conditions above
      */
     struct tfm_msg_body_t *p_msg;
-    uint32_t partition_id;
-    struct tfm_conn_handle_t *p_conn_handle =
-                                     tfm_spm_to_handle_instance(msg_handle);
-
-    if (is_valid_chunk_data_in_pool(
-        conn_handle_pool, (uint8_t *)p_conn_handle) != 1) {
-        return NULL;
+    uint32_t partition_id, idx;
+    struct tfm_conn_handle_t *p_conn_handle;
+
+    if (TFM_HANDLE_IS_STATELESS(msg_handle)) {
+        /* Message of a stateless request, held by the client partition */
+        idx = TFM_STATELESS_HANDLE_IDX(msg_handle);
+        if (idx >= g_spm_partition_db.partition_count) {
+            return NULL;
+        }
+        p_conn_handle = &g_spm_partition_db.partitions[idx].stateless_conn;
+    } else {
+        p_conn_handle = tfm_spm_to_handle_instance(msg_handle);
+        if (is_valid_chunk_data_in_pool(
+            conn_handle_pool, (uint8_t *)p_conn_handle) != 1) {
+            return NULL;
+        }
     }
 
     p_msg = &p_conn_handle->internal_msg;
@@ -541,10 +670,12 @@ void tfm_spm_fill_msg(struct tfm_msg_body_t *msg,
     /* Use the user connect handle as the message handle */
     msg->msg.handle = handle;
 
-    conn_handle = tfm_spm_to_handle_instance(handle);
     /* For connected handle, set rhandle to every message */
-    if (conn_handle) {
-        msg->msg.rhandle = tfm_spm_get_rhandle(service, conn_handle);
+    if (service->service_db->connection_based) {
+        conn_handle = tfm_spm_to_handle_instance(handle);
+        if (conn_handle) {
+            msg->msg.rhandle = tfm_spm_get_rhandle(service, conn_handle);
+        }
     }
 
     /* Set the private data of NSPE client caller in multi-core topology */
@@ -561,8 +692,8 @@ int32_t tfm_spm_send_event(struct tfm_spm_service_t *service,
     TFM_CORE_ASSERT(service);
     TFM_CORE_ASSERT(msg);
 
-    /* Add message to partition message list tail */
-    tfm_list_add_tail(&partition->msg_list, &msg->msg_node);
+    /* Add message to service message queue tail */
+    tfm_list_add_tail(&service->msg_list, &msg->msg_node);
 
     /* Messages put. Update signals */
     partition->signals_asserted |= service->service_db->signal;
@@ -593,26 +724,11 @@ uint32_t tfm_spm_partition_get_running_partition_id(void)
     }
 }
 
-int32_t tfm_memory_check(const void *buffer, size_t len, bool ns_caller,
-                         enum tfm_memory_access_e access,
-                         uint32_t privileged)
+static uint32_t memory_check_attr(enum tfm_memory_access_e access,
+                                  bool ns_caller, uint32_t privileged)
 {
-    enum tfm_hal_status_t err;
     uint32_t attr = 0;
 
-    /* If len is zero, this indicates an empty buffer and base is ignored */
-    if (len == 0) {
-        return IPC_SUCCESS;
-    }
-
-    if (!buffer) {
-        return IPC_ERROR_BAD_PARAMETERS;
-    }
-
-    if ((uintptr_t)buffer > (UINTPTR_MAX - len)) {
-        return IPC_ERROR_MEMORY_CHECK;
-    }
-
     if (access == TFM_MEMORY_ACCESS_RW) {
         attr |= (TFM_HAL_ACCESS_READABLE | TFM_HAL_ACCESS_WRITABLE);
     } else {
@@ -629,7 +745,42 @@ int32_t tfm_memory_check(const void *buffer, size_t len, bool ns_caller,
         attr |= TFM_HAL_ACCESS_NS;
     }
 
-    err = tfm_hal_memory_has_access((uintptr_t)buffer, len, attr);
+    return attr;
+}
+
+static int32_t memory_check_bounds(const void *buffer, size_t len)
+{
+    if (!buffer) {
+        return IPC_ERROR_BAD_PARAMETERS;
+    }
+
+    if ((uintptr_t)buffer > (UINTPTR_MAX - len)) {
+        return IPC_ERROR_MEMORY_CHECK;
+    }
+
+    return IPC_SUCCESS;
+}
+
+int32_t tfm_memory_check(const void *buffer, size_t len, bool ns_caller,
+                         enum tfm_memory_access_e access,
+                         uint32_t privileged)
+{
+    enum tfm_hal_status_t err;
+    int32_t ret;
+
+    /* If len is zero, this indicates an empty buffer and base is ignored */
+    if (len == 0) {
+        return IPC_SUCCESS;
+    }
+
+    ret = memory_check_bounds(buffer, len);
+    if (ret != IPC_SUCCESS) {
+        return ret;
+    }
+
+    err = tfm_hal_memory_has_access((uintptr_t)buffer, len,
+                                    memory_check_attr(access, ns_caller,
+                                                      privileged));
 
     if (err == TFM_HAL_SUCCESS) {
         return IPC_SUCCESS;
@@ -638,6 +789,153 @@ int32_t tfm_memory_check(const void *buffer, size_t len, bool ns_caller,
     return IPC_ERROR_MEMORY_CHECK;
 }
 
+#ifdef TFM_MULTI_CORE_TOPOLOGY
+/*
+ * On multi-core topology the non-secure memory attributes come from the static
+ * memory region tables of the platform, so a non-secure region which passed the
+ * check stays valid. Single-core checks depend on the non-secure MPU and
+ * privilege state, which change at runtime, and are never cached.
+ *
+ * Non-secure requests are only handled in the RPC context, so the cache needs
+ * no locking.
+ */
+#ifndef TFM_MEM_CHECK_CACHE_NR_CLIENTS
+#define TFM_MEM_CHECK_CACHE_NR_CLIENTS    4
+#endif
+
+#ifndef TFM_MEM_CHECK_CACHE_NR_REGIONS
+#define TFM_MEM_CHECK_CACHE_NR_REGIONS    4
+#endif
+
+#if ((TFM_MEM_CHECK_CACHE_NR_CLIENTS & (TFM_MEM_CHECK_CACHE_NR_CLIENTS - 1)) \
+     != 0)
+#error "TFM_MEM_CHECK_CACHE_NR_CLIENTS should be a power of 2!"
+#endif
+
+struct mem_check_cache_region_t {
+    uintptr_t base;
+    size_t len;                 /* Zero if the entry is unused */
+    uint32_t attr;              /* The attributes the region was checked for */
+};
+
+struct mem_check_cache_t {
+    int32_t client_id;
+    uint32_t victim;            /* The entry replaced next */
+    struct mem_check_cache_region_t regions[TFM_MEM_CHECK_CACHE_NR_REGIONS];
+};
+
+static struct mem_check_cache_t mem_check_cache[TFM_MEM_CHECK_CACHE_NR_CLIENTS];
+
+static struct mem_check_cache_t *mem_check_cache_get(int32_t client_id)
+{
+    struct mem_check_cache_t *cache =
+     &mem_check_cache[(uint32_t)client_id & (TFM_MEM_CHECK_CACHE_NR_CLIENTS - 1)];
+
+    if (cache->client_id != client_id) {
+        spm_memset(cache, 0, sizeof(*cache));
+        cache->client_id = client_id;
+    }
+
+    return cache;
+}
+
+static bool mem_check_cache_lookup(const struct mem_check_cache_t *cache,
+                                   uintptr_t base, size_t len, uint32_t attr)
+{
+    const struct mem_check_cache_region_t *region;
+    uint32_t i;
+
+    for (i = 0; i < TFM_MEM_CHECK_CACHE_NR_REGIONS; i++) {
+        region = &cache->regions[i];
+
+        if ((len > region->len) || (base < region->base) ||
+            (base - region->base > region->len - len)) {
+            continue;
+        }
+
+        /* A read-write region also satisfies a read-only reference */
+        if ((region->attr == attr) ||
+            (region->attr == (attr | TFM_HAL_ACCESS_WRITABLE))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void mem_check_cache_insert(struct mem_check_cache_t *cache,
+                                   uintptr_t base, size_t len, uint32_t attr)
+{
+    struct mem_check_cache_region_t *region = &cache->regions[cache->victim];
+
+    region->base = base;
+    region->len = len;
+    region->attr = attr;
+
+    cache->victim = (cache->victim + 1) % TFM_MEM_CHECK_CACHE_NR_REGIONS;
+}
+#endif /* TFM_MULTI_CORE_TOPOLOGY */
+
+int32_t tfm_memory_check_ranges(const struct tfm_memory_range_t *ranges,
+                                size_t nr_ranges, bool ns_caller,
+                                uint32_t privileged, int32_t client_id)
+{
+    uint32_t ro_attr = memory_check_attr(TFM_MEMORY_ACCESS_RO, ns_caller,
+                                         privileged);
+    uint32_t rw_attr = memory_check_attr(TFM_MEMORY_ACCESS_RW, ns_caller,
+                                         privileged);
+#ifdef TFM_MULTI_CORE_TOPOLOGY
+    struct mem_check_cache_t *cache = NULL;
+#endif
+    uint32_t attr;
+    uintptr_t base;
+    size_t i, len;
+    int32_t ret;
+
+#ifdef TFM_MULTI_CORE_TOPOLOGY
+    if (ns_caller) {
+        cache = mem_check_cache_get(client_id);
+    }
+#else
+    (void)client_id;
+#endif
+
+    for (i = 0; i < nr_ranges; i++) {
+        base = (uintptr_t)ranges[i].base;
+        len = ranges[i].len;
+
+        /* An empty buffer is valid and its base is ignored */
+        if (len == 0) {
+            continue;
+        }
+
+        ret = memory_check_bounds(ranges[i].base, len);
+        if (ret != IPC_SUCCESS) {
+            return ret;
+        }
+
+        attr = (ranges[i].access == TFM_MEMORY_ACCESS_RW) ? rw_attr : ro_attr;
+
+#ifdef TFM_MULTI_CORE_TOPOLOGY
+        if (cache && mem_check_cache_lookup(cache, base, len, attr)) {
+            continue;
+        }
+#endif
+
+        if (tfm_hal_memory_has_access(base, len, attr) != TFM_HAL_SUCCESS) {
+            return IPC_ERROR_MEMORY_CHECK;
+        }
+
+#ifdef TFM_MULTI_CORE_TOPOLOGY
+        if (cache) {
+            mem_check_cache_insert(cache, base, len, attr);
+        }
+#endif
+    }
+
+    return IPC_SUCCESS;
+}
+
 uint32_t tfm_spm_init(void)
 {
     uint32_t i, j, num;
@@ -662,6 +960,9 @@ uint32_t tfm_spm_init(void)
             tfm_core_panic();
         }
 
+        /* Services are added to the list even if the partition is skipped */
+        tfm_list_init(&partition->service_list);
+
         /* Check if the PSA framework version matches. */
         if (partition->static_data->psa_framework_version !=
             PSA_FRAMEWORK_VERSION) {
@@ -695,7 +996,6 @@ uint32_t tfm_spm_init(void)
         }
 
         tfm_event_init(&partition->event);
-        tfm_list_init(&partition->msg_list);
 
         pth = &partition->sp_thread;
         if (!pth) {
@@ -735,6 +1035,17 @@ uint32_t tfm_spm_init(void)
         partition->signals_allowed |= service[i].service_db->signal;
 
         tfm_list_init(&service[i].handle_list);
+        tfm_list_init(&service[i].msg_list);
+        tfm_list_add_tail(&partition->service_list, &service[i].list);
+
+        if (!service[i].service_db->connection_based) {
+            if (service[i].service_db->stateless_index >=
+                TFM_STATELESS_SERVICE_TABLE_SIZE) {
+                tfm_core_panic();
+            }
+            stateless_services[service[i].service_db->stateless_index] =
+                                                                &service[i];
+        }
     }
 
     /*
@@ -753,6 +1064,19 @@ uint32_t tfm_spm_init(void)
     return p_ns_entry_thread->arch_ctx.lr;
 }
 
+#ifdef TFM_SPM_TRACE
+/* Get the ID of the partition which a thread belongs to */
+static int32_t trace_thread_partition_id(struct tfm_core_thread_t *pth)
+{
+    if (!pth) {
+        return 0;
+    }
+
+    return TFM_GET_CONTAINER_PTR(pth, struct partition_t,
+                                 sp_thread)->static_data->partition_id;
+}
+#endif
+
 void tfm_pendsv_do_schedule(struct tfm_arch_ctx_t *p_actx)
 {
 #if TFM_LVL != 1
@@ -794,6 +1118,9 @@ void tfm_pendsv_do_schedule(struct tfm_arch_ctx_t *p_actx)
 #endif /* TFM_LVL == 3 */
 #endif /* TFM_LVL != 1 */
 
+        SPMTRACE(TFM_SPM_TRACE_EVT_SWITCH, trace_thread_partition_id(pth_curr),
+                 trace_thread_partition_id(pth_next));
+
         tfm_core_thrd_switch_context(p_actx, pth_curr, pth_next);
     }
 
@@ -874,6 +1201,8 @@ void notify_with_signal(int32_t partition_id, psa_signal_t signal)
 void tfm_irq_handler(uint32_t partition_id, psa_signal_t signal,
                      IRQn_Type irq_line)
 {
+    SPMTRACE(TFM_SPM_TRACE_EVT_IRQ, partition_id, signal);
+
     tfm_spm_hal_disable_irq(irq_line);
     notify_with_signal(partition_id, signal);
 }
@@ -29,6 +29,18 @@
 
 #define TFM_CONN_HANDLE_MAX_NUM         16
 
+/*
+ * Stateless handles have bit 30 set, which connection user handles never
+ * have, and the index of the stateless RoT Service in the lower bits. Message
+ * handles of stateless requests that do not use the handle pool have the same
+ * form, with the index of the client partition in the lower bits.
+ */
+#define TFM_STATELESS_HANDLE_BIT        (1UL << 30)
+#define TFM_HANDLE_IS_STATELESS(handle)                         \
+    (((handle) > 0) && (((uint32_t)(handle) & TFM_STATELESS_HANDLE_BIT) != 0))
+#define TFM_STATELESS_HANDLE_IDX(handle)                        \
+    ((uint32_t)(handle) & ~TFM_STATELESS_HANDLE_BIT)
+
 #define SPM_INVALID_PARTITION_IDX     (~0U)
 
 /* Privileged definitions for partition thread mode */
@@ -77,6 +89,27 @@ struct tfm_msg_body_t {
     struct tfm_list_node_t msg_node;   /* For list operators             */
 };
 
+/* RoT connection handle list */
+struct tfm_conn_handle_t {
+    void *rhandle;                      /* Reverse handle value              */
+    uint32_t status;                    /*
+                                         * Status of handle, three valid
+                                         * options:
+                                         * TFM_HANDLE_STATUS_ACTIVE,
+                                         * TFM_HANDLE_STATUS_IDLE and
+                                         * TFM_HANDLE_STATUS_CONNECT_ERROR
+                                         */
+    int32_t client_id;                  /*
+                                         * Partition ID of the sender of the
+                                         * message:
+                                         *  - secure partition id;
+                                         *  - non secure client endpoint id.
+                                         */
+    struct tfm_msg_body_t internal_msg; /* Internal message for message queue */
+    struct tfm_spm_service_t *service;  /* RoT service pointer                */
+    struct tfm_list_node_t list;        /* list node                          */
+};
+
 /**
  * Holds the fields of the partition DB used by the SPM code. The values of
  * these fields are calculated at compile time, and set during initialisation
@@ -107,7 +140,8 @@ struct partition_t {
     void *p_metadata;
     struct tfm_core_thread_t sp_thread;
     struct tfm_event_t event;
-    struct tfm_list_node_t msg_list;
+    struct tfm_list_node_t service_list;
+    struct tfm_conn_handle_t stateless_conn;
     uint32_t signals_allowed;
     uint32_t signals_waiting;
     uint32_t signals_asserted;
@@ -131,6 +165,10 @@ struct tfm_spm_service_db_t {
     bool non_secure_client;         /* If can be called by non secure client */
     uint32_t version;               /* Service version                       */
     uint32_t version_policy;        /* Service version policy                */
+    bool connection_based;          /* If the service is connection-based    */
+    uint32_t stateless_index;       /* Index in the stateless handle, if the
+                                     * service is stateless
+                                     */
 };
 
 /* RoT Service data */
@@ -141,28 +179,11 @@ struct tfm_spm_service_t {
                                               * data
                                               */
     struct tfm_list_node_t handle_list;      /* Service handle list          */
-    struct tfm_list_node_t list;             /* For list operation           */
-};
-
-/* RoT connection handle list */
-struct tfm_conn_handle_t {
-    void *rhandle;                      /* Reverse handle value              */
-    uint32_t status;                    /*
-                                         * Status of handle, three valid
-                                         * options:
-                                         * TFM_HANDLE_STATUS_ACTIVE,
-                                         * TFM_HANDLE_STATUS_IDLE and
-                                         * TFM_HANDLE_STATUS_CONNECT_ERROR
-                                         */
-    int32_t client_id;                  /*
-                                         * Partition ID of the sender of the
-                                         * message:
-                                         *  - secure partition id;
-                                         *  - non secure client endpoint id.
-                                         */
-    struct tfm_msg_body_t internal_msg; /* Internal message for message queue */
-    struct tfm_spm_service_t *service;  /* RoT service pointer                */
-    struct tfm_list_node_t list;        /* list node                          */
+    struct tfm_list_node_t msg_list;         /* Pending message queue        */
+    struct tfm_list_node_t list;             /*
+                                              * For partition service list
+                                              * operation
+                                              */
 };
 
 enum tfm_memory_access_e {
@@ -170,6 +191,13 @@ enum tfm_memory_access_e {
     TFM_MEMORY_ACCESS_RW = 2,
 };
 
+/* A memory reference checked by tfm_memory_check_ranges() */
+struct tfm_memory_range_t {
+    const void *base;                   /* Base of the memory reference      */
+    size_t len;                         /* Length in bytes                   */
+    enum tfm_memory_access_e access;    /* Access required by the reference  */
+};
+
 /**
  * \brief Initialize partition database
  *
@@ -228,6 +256,60 @@ int32_t tfm_spm_validate_conn_handle(
                                     const struct tfm_conn_handle_t *conn_handle,
                                     int32_t client_id);
 
+/**
+ * \brief                   Get the stateless RoT Service of a stateless handle.
+ *
+ * \param[in] handle        Handle passed by the client
+ *
+ * \retval NULL             Not a valid stateless handle
+ * \retval "Not NULL"       Target service context pointer,
+ *                          \ref tfm_spm_service_t structures
+ */
+struct tfm_spm_service_t *tfm_spm_get_stateless_service(psa_handle_t handle);
+
+/**
+ * \brief                   Get a connection handle for one stateless request.
+ *
+ * \param[in] service       Target stateless service context pointer
+ * \param[in] client_id     Partition ID of the sender of the message
+ * \param[in] ns_caller     If 'true', call from non-secure client.
+ *                          Or from secure client.
+ *
+ * \note                    The request of a caller that is blocked until the
+ *                          reply uses the connection handle reserved in the
+ *                          caller partition, without allocating from the
+ *                          handle pool. Non-blocking NSPE requests in
+ *                          multi-core topology allocate from the pool.
+ *
+ * \retval NULL             No connection handle available
+ * \retval "Not NULL"       Connection handle for the request
+ */
+struct tfm_conn_handle_t *tfm_spm_create_stateless_conn_handle(
+                                        struct tfm_spm_service_t *service,
+                                        int32_t client_id, bool ns_caller);
+
+/**
+ * \brief                   Get the message handle of a connection handle.
+ *
+ * \param[in] conn_handle   Connection handle created by
+ *                          tfm_spm_create_conn_handle() or
+ *                          tfm_spm_create_stateless_conn_handle()
+ *
+ * \retval                  Message handle passed to the RoT Service
+ */
+psa_handle_t tfm_spm_to_msg_handle(struct tfm_conn_handle_t *conn_handle);
+
+/**
+ * \brief                   Release the connection handle of a stateless
+ *                          request once it has been replied to.
+ *
+ * \param[in] service       Target service context pointer
+ * \param[in] conn_handle   Connection handle created by
+ *                          tfm_spm_create_stateless_conn_handle()
+ */
+void tfm_spm_free_stateless_conn_handle(struct tfm_spm_service_t *service,
+                                        struct tfm_conn_handle_t *conn_handle);
+
 /**
  * \brief                   Free connection handle which not used anymore.
  *
@@ -394,6 +476,32 @@ int32_t tfm_memory_check(const void *buffer, size_t len, bool ns_caller,
                          enum tfm_memory_access_e access,
                          uint32_t privileged);
 
+/**
+ * \brief                      Check a set of memory references in one pass.
+ *
+ * \details                    The checks stop at the first invalid
+ *                             reference. On multi-core topology, the
+ *                             non-secure references validated for a client
+ *                             are cached, and later references within them
+ *                             skip the memory attribute lookup.
+ *
+ * \param[in] ranges           Array of memory references
+ *                             \ref tfm_memory_range_t structures
+ * \param[in] nr_ranges        Number of memory references in ranges
+ * \param[in] ns_caller        From non-secure caller
+ * \param[in] privileged       Privileged mode or unprivileged mode:
+ *                             \ref TFM_PARTITION_UNPRIVILEGED_MODE
+ *                             \ref TFM_PARTITION_PRIVILEGED_MODE
+ * \param[in] client_id        The client which owns the memory references
+ *
+ * \retval IPC_SUCCESS               Success
+ * \retval IPC_ERROR_BAD_PARAMETERS  Bad parameters input
+ * \retval IPC_ERROR_MEMORY_CHECK    Check failed
+ */
+int32_t tfm_memory_check_ranges(const struct tfm_memory_range_t *ranges,
+                                size_t nr_ranges, bool ns_caller,
+                                uint32_t privileged, int32_t client_id);
+
 /*
  * PendSV specified function.
  *
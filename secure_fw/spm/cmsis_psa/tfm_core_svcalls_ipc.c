@@ -78,6 +78,8 @@ static int32_t SVC_Handler_IPC(tfm_svc_number_t svc_num, uint32_t *ctx,
         return tfm_spm_psa_read(ctx);
     case TFM_SVC_PSA_SKIP:
         return tfm_spm_psa_skip(ctx);
+    case TFM_SVC_MAP_INVEC:
+        return (int32_t)tfm_spm_map_invec(ctx);
     case TFM_SVC_PSA_WRITE:
         tfm_spm_psa_write(ctx);
         break;
@@ -9,6 +9,8 @@
 #define __TFM_MULTI_CORE_H__
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 /* Security attributes of target memory region in memory access check. */
 struct security_attr_info_t {
@@ -27,6 +29,45 @@ struct mem_attr_info_t {
     bool is_unpriv_wr_allow;   /* Unprivileged write is allowed or not */
 };
 
+/* Flags of a memory region in the static memory region layout */
+#define TFM_MEM_REGION_SECURE           (1U << 0)
+#define TFM_MEM_REGION_PRIV_RD          (1U << 1)
+#define TFM_MEM_REGION_PRIV_WR          (1U << 2)
+#define TFM_MEM_REGION_UNPRIV_RD        (1U << 3)
+#define TFM_MEM_REGION_UNPRIV_WR        (1U << 4)
+#define TFM_MEM_REGION_XN               (1U << 5)
+
+/*
+ * Description of a memory region in the static memory region layout.
+ *
+ * Regions may nest or overlap. A memory range takes the attributes of the
+ * first region in the layout which contains the whole range. A platform can
+ * describe additional regions, such as shared memory windows, by defining
+ * TFM_PLAT_MEM_REGION_DESC in region_defs.h as a list of initializers of this
+ * structure. They take precedence over the default regions.
+ */
+struct tfm_mem_region_desc_t {
+    uintptr_t base;            /* Start address of the region */
+    uintptr_t limit;           /* Last address of the region */
+    uint32_t flags;            /* TFM_MEM_REGION_* flags */
+};
+
+/**
+ * \brief Build the lookup table of the static memory region layout.
+ *
+ * \details The regions are split at their boundaries into a sorted table of
+ *          disjoint ranges, each of which refers to the region that takes
+ *          precedence in it. A memory range is then looked up with a binary
+ *          search, independently of the number of regions.
+ *
+ * \return TFM_SUCCESS if the table is built,
+ *         TFM_ERROR_GENERIC otherwise.
+ *
+ * \note It must be called before any memory access check. All memory ranges
+ *       are invalid until then.
+ */
+int32_t tfm_mem_region_table_init(void);
+
 /**
  * \brief Retrieve general security isolation configuration information of the
  *        target memory region according to the system memory region layout and
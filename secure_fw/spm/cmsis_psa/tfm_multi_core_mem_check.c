@@ -64,36 +64,6 @@ static enum tfm_status_e check_address_range(const void *p, size_t s,
     }
 }
 
-void tfm_get_mem_region_security_attr(const void *p, size_t s,
-                                      struct security_attr_info_t *p_attr)
-{
-    p_attr->is_valid = true;
-
-    if (check_address_range(p, s, NS_DATA_START,
-                            NS_DATA_LIMIT) == TFM_SUCCESS) {
-        p_attr->is_secure = false;
-        return;
-    }
-
-    if (check_address_range(p, s, NS_CODE_START,
-                            NS_CODE_LIMIT) == TFM_SUCCESS) {
-        p_attr->is_secure = false;
-        return;
-    }
-
-    if (check_address_range(p, s, S_DATA_START, S_DATA_LIMIT) == TFM_SUCCESS) {
-        p_attr->is_secure = true;
-        return;
-    }
-
-    if (check_address_range(p, s, S_CODE_START, S_CODE_LIMIT) == TFM_SUCCESS) {
-        p_attr->is_secure = true;
-        return;
-    }
-
-    p_attr->is_valid = false;
-}
-
 #if TFM_LVL == 2
 REGION_DECLARE(Image$$, TFM_UNPRIV_CODE, $$RO$$Base);
 REGION_DECLARE(Image$$, TFM_UNPRIV_CODE, $$RO$$Limit);
@@ -103,147 +73,310 @@ REGION_DECLARE(Image$$, TFM_APP_CODE_START, $$Base);
 REGION_DECLARE(Image$$, TFM_APP_CODE_END, $$Base);
 REGION_DECLARE(Image$$, TFM_APP_RW_STACK_START, $$Base);
 REGION_DECLARE(Image$$, TFM_APP_RW_STACK_END, $$Base);
+#elif TFM_LVL != 1
+#error "Cannot support current TF-M isolation level"
+#endif
+
+#define MEM_REGION_RW_ALL               (TFM_MEM_REGION_PRIV_RD |   \
+                                         TFM_MEM_REGION_PRIV_WR |   \
+                                         TFM_MEM_REGION_UNPRIV_RD | \
+                                         TFM_MEM_REGION_UNPRIV_WR | \
+                                         TFM_MEM_REGION_XN)
+#define MEM_REGION_RO_ALL               (TFM_MEM_REGION_PRIV_RD |   \
+                                         TFM_MEM_REGION_UNPRIV_RD)
+#define MEM_REGION_RW_PRIV              (TFM_MEM_REGION_PRIV_RD |   \
+                                         TFM_MEM_REGION_PRIV_WR |   \
+                                         TFM_MEM_REGION_XN)
+#define MEM_REGION_RO_PRIV              (TFM_MEM_REGION_PRIV_RD)
+
+#ifdef TFM_PLAT_MEM_REGION_DESC
+static const struct tfm_mem_region_desc_t plat_mem_regions[] = {
+    TFM_PLAT_MEM_REGION_DESC
+};
+
+#define NR_PLAT_MEM_REGIONS             (sizeof(plat_mem_regions) / \
+                                         sizeof(plat_mem_regions[0]))
+#else
+#define NR_PLAT_MEM_REGIONS             0
 #endif
 
-void tfm_get_secure_mem_region_attr(const void *p, size_t s,
-                                    struct mem_attr_info_t *p_attr)
-{
 #if TFM_LVL == 1
-    p_attr->is_mpu_enabled = false;
-    p_attr->is_valid = true;
+#define NR_DEFAULT_MEM_REGIONS          4
+#else
+#define NR_DEFAULT_MEM_REGIONS          8
+#endif
 
-    if (check_address_range(p, s, S_DATA_START, S_DATA_LIMIT) == TFM_SUCCESS) {
-        p_attr->is_priv_rd_allow = true;
-        p_attr->is_priv_wr_allow = true;
-        p_attr->is_unpriv_rd_allow = true;
-        p_attr->is_unpriv_wr_allow = true;
-        p_attr->is_xn = true;
-        return;
-    }
+#define NR_MEM_REGIONS                  (NR_PLAT_MEM_REGIONS + \
+                                         NR_DEFAULT_MEM_REGIONS)
 
-    if (check_address_range(p, s, S_CODE_START, S_CODE_LIMIT) == TFM_SUCCESS) {
-        p_attr->is_priv_rd_allow = true;
-        p_attr->is_priv_wr_allow = false;
-        p_attr->is_unpriv_rd_allow = true;
-        p_attr->is_unpriv_wr_allow = false;
-        p_attr->is_xn = false;
-        return;
-    }
+/* A disjoint range of the lookup table and the region in effect in it */
+struct mem_region_range_t {
+    uintptr_t base;
+    uintptr_t limit;
+    const struct tfm_mem_region_desc_t *region;
+};
 
-    p_attr->is_valid = false;
-#elif TFM_LVL == 2
-    uintptr_t base, limit;
+/* The static memory region layout, in precedence order */
+static struct tfm_mem_region_desc_t mem_regions[NR_MEM_REGIONS];
+static uint32_t nr_mem_regions;
 
-    p_attr->is_mpu_enabled = false;
-    p_attr->is_valid = true;
+/*
+ * The lookup table, sorted by address. N regions have at most 2 * N
+ * boundaries, which split the address space into at most 2 * N - 1 ranges.
+ */
+static struct mem_region_range_t mem_region_table[2 * NR_MEM_REGIONS];
+static uint32_t nr_mem_region_ranges;
 
-    /* TFM Core unprivileged code region */
-    base = (uintptr_t)&REGION_NAME(Image$$, TFM_UNPRIV_CODE, $$RO$$Base);
-    limit = (uintptr_t)&REGION_NAME(Image$$, TFM_UNPRIV_CODE, $$RO$$Limit) - 1;
-    if (check_address_range(p, s, base, limit) == TFM_SUCCESS) {
-        p_attr->is_priv_rd_allow = true;
-        p_attr->is_priv_wr_allow = false;
-        p_attr->is_unpriv_rd_allow = true;
-        p_attr->is_unpriv_wr_allow = false;
-        p_attr->is_xn = false;
-        return;
+static void mem_region_add(uintptr_t base, uintptr_t limit, uint32_t flags)
+{
+    struct tfm_mem_region_desc_t *region = &mem_regions[nr_mem_regions++];
+
+    region->base = base;
+    region->limit = limit;
+    region->flags = flags;
+}
+
+static void mem_region_layout_init(void)
+{
+#ifdef TFM_PLAT_MEM_REGION_DESC
+    uint32_t i;
+#endif
+
+    nr_mem_regions = 0;
+
+#ifdef TFM_PLAT_MEM_REGION_DESC
+    for (i = 0; i < NR_PLAT_MEM_REGIONS; i++) {
+        mem_regions[nr_mem_regions++] = plat_mem_regions[i];
     }
+#endif
+
+    mem_region_add(NS_DATA_START, NS_DATA_LIMIT, MEM_REGION_RW_ALL);
+    mem_region_add(NS_CODE_START, NS_CODE_LIMIT, MEM_REGION_RO_ALL);
+
+#if TFM_LVL == 2
+    /* TFM Core unprivileged code region */
+    mem_region_add(
+        (uintptr_t)&REGION_NAME(Image$$, TFM_UNPRIV_CODE, $$RO$$Base),
+        (uintptr_t)&REGION_NAME(Image$$, TFM_UNPRIV_CODE, $$RO$$Limit) - 1,
+        TFM_MEM_REGION_SECURE | MEM_REGION_RO_ALL);
 
     /* TFM Core unprivileged data region */
-    base = (uintptr_t)&REGION_NAME(Image$$, TFM_UNPRIV_DATA, $$RW$$Base);
-    limit = (uintptr_t)&REGION_NAME(Image$$, TFM_UNPRIV_DATA, $$ZI$$Limit) - 1;
-    if (check_address_range(p, s, base, limit) == TFM_SUCCESS) {
-        p_attr->is_priv_rd_allow = true;
-        p_attr->is_priv_wr_allow = true;
-        p_attr->is_unpriv_rd_allow = true;
-        p_attr->is_unpriv_wr_allow = true;
-        p_attr->is_xn = true;
-        return;
-    }
+    mem_region_add(
+        (uintptr_t)&REGION_NAME(Image$$, TFM_UNPRIV_DATA, $$RW$$Base),
+        (uintptr_t)&REGION_NAME(Image$$, TFM_UNPRIV_DATA, $$ZI$$Limit) - 1,
+        TFM_MEM_REGION_SECURE | MEM_REGION_RW_ALL);
 
     /* APP RoT partition RO region */
-    base = (uintptr_t)&REGION_NAME(Image$$, TFM_APP_CODE_START, $$Base);
-    limit = (uintptr_t)&REGION_NAME(Image$$, TFM_APP_CODE_END, $$Base) - 1;
-    if (check_address_range(p, s, base, limit) == TFM_SUCCESS) {
-        p_attr->is_priv_rd_allow = true;
-        p_attr->is_priv_wr_allow = false;
-        p_attr->is_unpriv_rd_allow = true;
-        p_attr->is_unpriv_wr_allow = false;
-        p_attr->is_xn = false;
-        return;
-    }
+    mem_region_add(
+        (uintptr_t)&REGION_NAME(Image$$, TFM_APP_CODE_START, $$Base),
+        (uintptr_t)&REGION_NAME(Image$$, TFM_APP_CODE_END, $$Base) - 1,
+        TFM_MEM_REGION_SECURE | MEM_REGION_RO_ALL);
 
     /* RW, ZI and stack as one region */
-    base = (uintptr_t)&REGION_NAME(Image$$, TFM_APP_RW_STACK_START, $$Base);
-    limit = (uintptr_t)&REGION_NAME(Image$$, TFM_APP_RW_STACK_END, $$Base) - 1;
-    if (check_address_range(p, s, base, limit) == TFM_SUCCESS) {
-        p_attr->is_priv_rd_allow = true;
-        p_attr->is_priv_wr_allow = true;
-        p_attr->is_unpriv_rd_allow = true;
-        p_attr->is_unpriv_wr_allow = true;
-        p_attr->is_xn = true;
-        return;
-    }
+    mem_region_add(
+        (uintptr_t)&REGION_NAME(Image$$, TFM_APP_RW_STACK_START, $$Base),
+        (uintptr_t)&REGION_NAME(Image$$, TFM_APP_RW_STACK_END, $$Base) - 1,
+        TFM_MEM_REGION_SECURE | MEM_REGION_RW_ALL);
 
     /*
      * Treat the remaining parts in secure data section and secure code section
      * as privileged regions
      */
-    base = (uintptr_t)S_DATA_START;
-    limit = (uintptr_t)S_DATA_LIMIT;
-    if (check_address_range(p, s, base, limit) == TFM_SUCCESS) {
-        p_attr->is_priv_rd_allow = true;
-        p_attr->is_priv_wr_allow = true;
-        p_attr->is_unpriv_rd_allow = false;
-        p_attr->is_unpriv_wr_allow = false;
-        p_attr->is_xn = true;
-        return;
+    mem_region_add(S_DATA_START, S_DATA_LIMIT,
+                   TFM_MEM_REGION_SECURE | MEM_REGION_RW_PRIV);
+    mem_region_add(S_CODE_START, S_CODE_LIMIT,
+                   TFM_MEM_REGION_SECURE | MEM_REGION_RO_PRIV);
+#else
+    /* Privileged/unprivileged is ignored in TFM_LVL == 1 */
+    mem_region_add(S_DATA_START, S_DATA_LIMIT,
+                   TFM_MEM_REGION_SECURE | MEM_REGION_RW_ALL);
+    mem_region_add(S_CODE_START, S_CODE_LIMIT,
+                   TFM_MEM_REGION_SECURE | MEM_REGION_RO_ALL);
+#endif
+}
+
+int32_t tfm_mem_region_table_init(void)
+{
+    uintptr_t bounds[2 * NR_MEM_REGIONS];
+    uint32_t nr_bounds = 0;
+    const struct tfm_mem_region_desc_t *region;
+    struct mem_region_range_t *range;
+    uintptr_t bound;
+    uint32_t i, j, k;
+
+    mem_region_layout_init();
+    nr_mem_region_ranges = 0;
+
+    /* Collect the region boundaries in ascending order, without duplicates */
+    for (i = 0; i < 2 * nr_mem_regions; i++) {
+        region = &mem_regions[i / 2];
+        if (region->limit < region->base) {
+            return (int32_t)TFM_ERROR_GENERIC;
+        }
+
+        if (i % 2 == 0) {
+            bound = region->base;
+        } else if (region->limit != UINTPTR_MAX) {
+            bound = region->limit + 1;
+        } else {
+            continue;
+        }
+
+        for (j = 0; (j < nr_bounds) && (bounds[j] < bound); j++) {
+        }
+        if ((j < nr_bounds) && (bounds[j] == bound)) {
+            continue;
+        }
+
+        for (k = nr_bounds; k > j; k--) {
+            bounds[k] = bounds[k - 1];
+        }
+        bounds[j] = bound;
+        nr_bounds++;
     }
 
-    base = (uintptr_t)S_CODE_START;
-    limit = (uintptr_t)S_CODE_LIMIT;
-    if (check_address_range(p, s, base, limit) == TFM_SUCCESS) {
-        p_attr->is_priv_rd_allow = true;
-        p_attr->is_priv_wr_allow = false;
-        p_attr->is_unpriv_rd_allow = false;
-        p_attr->is_unpriv_wr_allow = false;
-        p_attr->is_xn = false;
-        return;
+    /*
+     * Each pair of adjacent boundaries delimits a range which any region
+     * either contains entirely or not at all. Find the region in effect in each
+     * range and merge the adjacent ranges which share it.
+     */
+    for (i = 0; i < nr_bounds; i++) {
+        region = NULL;
+        for (j = 0; j < nr_mem_regions; j++) {
+            if ((mem_regions[j].base <= bounds[i]) &&
+                (mem_regions[j].limit >= bounds[i])) {
+                region = &mem_regions[j];
+                break;
+            }
+        }
+        if (!region) {
+            continue;
+        }
+
+        bound = (i + 1 < nr_bounds) ? bounds[i + 1] - 1 : UINTPTR_MAX;
+
+        if (nr_mem_region_ranges > 0) {
+            range = &mem_region_table[nr_mem_region_ranges - 1];
+            if ((range->region == region) && (range->limit + 1 == bounds[i])) {
+                range->limit = bound;
+                continue;
+            }
+        }
+
+        range = &mem_region_table[nr_mem_region_ranges++];
+        range->base = bounds[i];
+        range->limit = bound;
+        range->region = region;
     }
 
-    p_attr->is_valid = false;
-#else
-#error "Cannot support current TF-M isolation level"
-#endif
+    return (int32_t)TFM_SUCCESS;
 }
 
-void tfm_get_ns_mem_region_attr(const void *p, size_t s,
-                                struct mem_attr_info_t *p_attr)
+/**
+ * \brief Find the first region in the static memory region layout which
+ *        contains a memory range.
+ *
+ * \param[in] p          The start address of the range
+ * \param[in] s          The size of the range
+ * \param[in] mask       The region flags to match
+ * \param[in] flags      The value of the masked region flags to match
+ *
+ * \return The region, or NULL if no region contains the range.
+ */
+static const struct tfm_mem_region_desc_t *mem_region_lookup(const void *p,
+                                                             size_t s,
+                                                             uint32_t mask,
+                                                             uint32_t flags)
+{
+    const struct mem_region_range_t *range = NULL;
+    uint32_t low = 0, high = nr_mem_region_ranges, mid, i;
+
+    if ((s == 0) || ((uintptr_t)p > UINTPTR_MAX - s)) {
+        /* Left to the full check below */
+        high = 0;
+    }
+
+    /* Find the last range which starts at or below the start address */
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        if (mem_region_table[mid].base <= (uintptr_t)p) {
+            range = &mem_region_table[mid];
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    /*
+     * The region in effect in the range takes precedence over any other
+     * region which contains the memory range.
+     */
+    if (range && ((uintptr_t)p + s - 1 <= range->limit) &&
+        ((range->region->flags & mask) == flags)) {
+        return range->region;
+    }
+
+    /*
+     * The memory range spans several ranges of the table, or the region in
+     * effect does not match the flags. Check the regions one by one.
+     */
+    for (i = 0; i < nr_mem_regions; i++) {
+        if (((mem_regions[i].flags & mask) == flags) &&
+            (check_address_range(p, s, mem_regions[i].base,
+                                 mem_regions[i].limit) == TFM_SUCCESS)) {
+            return &mem_regions[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void mem_region_to_attr(const struct tfm_mem_region_desc_t *region,
+                               struct mem_attr_info_t *p_attr)
 {
     p_attr->is_mpu_enabled = false;
-    p_attr->is_valid = true;
 
-    if (check_address_range(p, s, NS_DATA_START,
-                            NS_DATA_LIMIT) == TFM_SUCCESS) {
-        p_attr->is_priv_rd_allow = true;
-        p_attr->is_priv_wr_allow = true;
-        p_attr->is_unpriv_rd_allow = true;
-        p_attr->is_unpriv_wr_allow = true;
-        p_attr->is_xn = true;
+    if (!region) {
+        p_attr->is_valid = false;
         return;
     }
 
-    if (check_address_range(p, s, NS_CODE_START,
-                            NS_CODE_LIMIT) == TFM_SUCCESS) {
-        p_attr->is_priv_rd_allow = true;
-        p_attr->is_priv_wr_allow = false;
-        p_attr->is_unpriv_rd_allow = true;
-        p_attr->is_unpriv_wr_allow = false;
-        p_attr->is_xn = false;
+    p_attr->is_valid = true;
+    p_attr->is_priv_rd_allow = !!(region->flags & TFM_MEM_REGION_PRIV_RD);
+    p_attr->is_priv_wr_allow = !!(region->flags & TFM_MEM_REGION_PRIV_WR);
+    p_attr->is_unpriv_rd_allow = !!(region->flags & TFM_MEM_REGION_UNPRIV_RD);
+    p_attr->is_unpriv_wr_allow = !!(region->flags & TFM_MEM_REGION_UNPRIV_WR);
+    p_attr->is_xn = !!(region->flags & TFM_MEM_REGION_XN);
+}
+
+void tfm_get_mem_region_security_attr(const void *p, size_t s,
+                                      struct security_attr_info_t *p_attr)
+{
+    const struct tfm_mem_region_desc_t *region;
+
+    region = mem_region_lookup(p, s, 0, 0);
+    if (!region) {
+        p_attr->is_valid = false;
         return;
     }
 
-    p_attr->is_valid = false;
+    p_attr->is_valid = true;
+    p_attr->is_secure = !!(region->flags & TFM_MEM_REGION_SECURE);
+}
+
+void tfm_get_secure_mem_region_attr(const void *p, size_t s,
+                                    struct mem_attr_info_t *p_attr)
+{
+    mem_region_to_attr(mem_region_lookup(p, s, TFM_MEM_REGION_SECURE,
+                                         TFM_MEM_REGION_SECURE),
+                       p_attr);
+}
+
+void tfm_get_ns_mem_region_attr(const void *p, size_t s,
+                                struct mem_attr_info_t *p_attr)
+{
+    mem_region_to_attr(mem_region_lookup(p, s, TFM_MEM_REGION_SECURE, 0),
+                       p_attr);
 }
 
 static void security_attr_init(struct security_attr_info_t *p_attr)
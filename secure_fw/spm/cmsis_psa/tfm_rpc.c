@@ -8,6 +8,8 @@
 #include "spm_ipc.h"
 #include "common/spm_psa_client_call.h"
 #include "tfm_rpc.h"
+#include "tfm_nspm.h"
+#include "tfm_spm_trace.h"
 #include "utilities.h"
 
 static void default_handle_req(void)
@@ -49,20 +51,34 @@ uint32_t tfm_rpc_psa_version(const struct client_call_params_t *params,
 psa_status_t tfm_rpc_psa_connect(const struct client_call_params_t *params,
                                  bool ns_caller)
 {
+    psa_status_t status;
+
     TFM_CORE_ASSERT(params != NULL);
 
-    return tfm_spm_client_psa_connect(params->sid, params->version, ns_caller);
+    SPMTRACE(TFM_SPM_TRACE_EVT_CONNECT_ENTER, params->sid, params->version);
+    status = tfm_spm_client_psa_connect(params->sid, params->version,
+                                        ns_caller);
+    SPMTRACE(TFM_SPM_TRACE_EVT_CONNECT_EXIT, status, 0);
+
+    return status;
 }
 
 psa_status_t tfm_rpc_psa_call(const struct client_call_params_t *params,
                               bool ns_caller)
 {
+    psa_status_t status;
+
     TFM_CORE_ASSERT(params != NULL);
 
-    return tfm_spm_client_psa_call(params->handle, params->type,
-                                   params->in_vec, params->in_len,
-                                   params->out_vec, params->out_len, ns_caller,
-                                   TFM_PARTITION_UNPRIVILEGED_MODE);
+    SPMTRACE(TFM_SPM_TRACE_EVT_CALL_ENTER, params->handle, params->type);
+    status = tfm_spm_client_psa_call(params->handle, params->type,
+                                     params->in_vec, params->in_len,
+                                     params->out_vec, params->out_len,
+                                     ns_caller,
+                                     TFM_PARTITION_UNPRIVILEGED_MODE);
+    SPMTRACE(TFM_SPM_TRACE_EVT_CALL_EXIT, status, 0);
+
+    return status;
 }
 
 void tfm_rpc_psa_close(const struct client_call_params_t *params,
@@ -73,6 +89,31 @@ void tfm_rpc_psa_close(const struct client_call_params_t *params,
     tfm_spm_client_psa_close(params->handle, ns_caller);
 }
 
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+uint32_t tfm_rpc_get_handle_sid(psa_handle_t handle)
+{
+    struct tfm_spm_service_t *service;
+    struct tfm_conn_handle_t *conn_handle;
+
+    service = tfm_spm_get_stateless_service(handle);
+    if (!service) {
+        conn_handle = tfm_spm_to_handle_instance(handle);
+        if (tfm_spm_validate_conn_handle(conn_handle,
+                                         tfm_nspm_get_current_client_id()) !=
+            IPC_SUCCESS) {
+            return 0;
+        }
+        service = conn_handle->service;
+    }
+
+    if (!service) {
+        return 0;
+    }
+
+    return service->service_db->sid;
+}
+#endif
+
 int32_t tfm_rpc_register_ops(const struct tfm_rpc_ops_t *ops_ptr)
 {
     if (!ops_ptr) {
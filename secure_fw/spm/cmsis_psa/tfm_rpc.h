@@ -131,6 +131,19 @@ psa_status_t tfm_rpc_psa_call(const struct client_call_params_t *params,
 void tfm_rpc_psa_close(const struct client_call_params_t *params,
                        bool ns_caller);
 
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+/**
+ * \brief Get the SID of the RoT Service which a handle refers to.
+ *
+ * \param[in] handle            A stateless handle or a connection handle of
+ *                              the current non-secure client
+ *
+ * \retval 0                    The handle is invalid.
+ * \retval Other value          The SID of the RoT Service.
+ */
+uint32_t tfm_rpc_get_handle_sid(psa_handle_t handle);
+#endif
+
 /**
  * \brief Register underlying mailbox communication operations.
  *
@@ -12,11 +12,24 @@
 #include "utilities.h"
 #include "tfm_spe_mailbox.h"
 #include "tfm_rpc.h"
+#include "tfm_spm_trace.h"
+#include "tfm_thread.h"
 
 #define NS_CALLER_FLAG          (true)
 
+#ifdef TFM_MULTI_CORE_NOTIFY_COALESCE
+/* The maximum number of replies batched into a single notification */
+#ifndef MAILBOX_NOTIFY_COALESCE_MAX
+#define MAILBOX_NOTIFY_COALESCE_MAX     (NUM_MAILBOX_QUEUE_SLOT / 2)
+#endif
+#endif
+
 static struct secure_mailbox_queue_t spe_mailbox_queue;
 
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+static struct spe_mailbox_profile_t spe_mailbox_profile;
+#endif
+
 static int32_t tfm_mailbox_dispatch(uint32_t call_type,
                                     const struct psa_client_params_t *params,
                                     int32_t client_id,
@@ -29,6 +42,8 @@ static int32_t tfm_mailbox_dispatch(uint32_t call_type,
 
     (void)client_id;
 
+    SPMTRACE(TFM_SPM_TRACE_EVT_MAILBOX, call_type, client_id);
+
     switch (call_type) {
     case MAILBOX_PSA_FRAMEWORK_VERSION:
         *psa_ret = tfm_rpc_psa_framework_version();
@@ -60,48 +75,83 @@ static int32_t tfm_mailbox_dispatch(uint32_t call_type,
     }
 }
 
-__STATIC_INLINE void set_spe_queue_empty_status(uint8_t idx)
-{
-    if (idx < NUM_MAILBOX_QUEUE_SLOT) {
-        spe_mailbox_queue.empty_slots |= (1 << idx);
-    }
-}
-
-__STATIC_INLINE void clear_spe_queue_empty_status(uint8_t idx)
-{
-    if (idx < NUM_MAILBOX_QUEUE_SLOT) {
-        spe_mailbox_queue.empty_slots &= ~(1 << idx);
-    }
-}
-
 __STATIC_INLINE bool get_spe_queue_empty_status(uint8_t idx)
 {
     if ((idx < NUM_MAILBOX_QUEUE_SLOT) &&
-        (spe_mailbox_queue.empty_slots & (1 << idx))) {
+        (spe_mailbox_queue.queue[idx].msg_handle == MAILBOX_MSG_NULL_HANDLE)) {
         return true;
     }
 
     return false;
 }
 
-__STATIC_INLINE mailbox_queue_status_t get_nspe_queue_pend_status(
-                                    const struct ns_mailbox_queue_t *ns_queue)
+/*
+ * SPE is the only consumer of NSPE pend_ring and the only producer of NSPE
+ * reply_ring. Mailbox handling and replies both run in SPM handler mode and
+ * never preempt each other. SPE keeps its own ring positions in secure memory
+ * so that NSPE cannot alter them.
+ */
+__STATIC_INLINE bool is_nspe_pend_slot_available(
+                                           struct ns_mailbox_queue_t *ns_queue)
 {
-    return ns_queue->pend_slots;
+    uint32_t pos = spe_mailbox_queue.pend_pos;
+
+    return ns_queue->pend_ring.entries[pos & (MAILBOX_RING_SIZE - 1)].seq ==
+           pos + 1;
 }
 
-__STATIC_INLINE void set_nspe_queue_replied_status(
-                                            struct ns_mailbox_queue_t *ns_queue,
-                                            mailbox_queue_status_t mask)
+static bool fetch_nspe_pend_slot(struct ns_mailbox_queue_t *ns_queue,
+                                 uint8_t *ns_slot_idx)
 {
-    ns_queue->replied_slots |= mask;
+    struct mailbox_ring_entry_t *entry;
+    uint32_t pos = spe_mailbox_queue.pend_pos;
+    uint32_t slot_idx;
+
+    if (!is_nspe_pend_slot_available(ns_queue)) {
+        /* No pending request */
+        return false;
+    }
+
+    entry = &ns_queue->pend_ring.entries[pos & (MAILBOX_RING_SIZE - 1)];
+
+    __DMB();
+    slot_idx = entry->slot_idx;
+    /* The slot index must be read before the entry is released */
+    __DMB();
+    entry->seq = pos + MAILBOX_RING_SIZE;
+    spe_mailbox_queue.pend_pos = pos + 1;
+
+    *ns_slot_idx = (uint8_t)slot_idx;
+    if (slot_idx >= NUM_MAILBOX_QUEUE_SLOT) {
+        *ns_slot_idx = NUM_MAILBOX_QUEUE_SLOT;
+    }
+
+    return true;
 }
 
-__STATIC_INLINE void clear_nspe_queue_pend_status(
-                                            struct ns_mailbox_queue_t *ns_queue,
-                                            mailbox_queue_status_t mask)
+static int32_t post_nspe_reply_slot(struct ns_mailbox_queue_t *ns_queue,
+                                    uint8_t ns_slot_idx)
 {
-    ns_queue->pend_slots &= ~mask;
+    struct mailbox_ring_entry_t *entry;
+    uint32_t pos = spe_mailbox_queue.reply_pos;
+
+    entry = &ns_queue->reply_ring.entries[pos & (MAILBOX_RING_SIZE - 1)];
+    if (entry->seq != pos) {
+        /*
+         * The ring holds at most NUM_MAILBOX_QUEUE_SLOT indexes, and NSPE
+         * releases each entry without being preempted. Since the ring has
+         * twice as many entries, it can only be full if NSPE corrupted it.
+         */
+        return MAILBOX_QUEUE_FULL;
+    }
+
+    entry->slot_idx = ns_slot_idx;
+    /* The reply and the slot index must be visible before the entry */
+    __DMB();
+    entry->seq = pos + 1;
+    spe_mailbox_queue.reply_pos = pos + 1;
+
+    return MAILBOX_SUCCESS;
 }
 
 __STATIC_INLINE int32_t get_spe_mailbox_msg_handle(uint8_t idx,
@@ -128,15 +178,128 @@ __STATIC_INLINE int32_t get_spe_mailbox_msg_idx(mailbox_msg_handle_t handle,
     return MAILBOX_SUCCESS;
 }
 
+static bool mailbox_alloc_queue_slot(uint8_t *idx)
+{
+    if (spe_mailbox_queue.nr_free_slots == 0) {
+        return false;
+    }
+
+    spe_mailbox_queue.nr_free_slots--;
+    *idx = spe_mailbox_queue.free_slots[spe_mailbox_queue.nr_free_slots];
+
+    return true;
+}
+
 static void mailbox_clean_queue_slot(uint8_t idx)
 {
-    if (idx >= NUM_MAILBOX_QUEUE_SLOT) {
+    if ((idx >= NUM_MAILBOX_QUEUE_SLOT) || get_spe_queue_empty_status(idx)) {
         return;
     }
 
     spm_memset(&spe_mailbox_queue.queue[idx], 0,
                          sizeof(spe_mailbox_queue.queue[idx]));
-    set_spe_queue_empty_status(idx);
+
+    /* Return the slot to the free stack */
+    spe_mailbox_queue.free_slots[spe_mailbox_queue.nr_free_slots] = idx;
+    spe_mailbox_queue.nr_free_slots++;
+}
+
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+void tfm_mailbox_profile_reset(void)
+{
+    spm_memset(&spe_mailbox_profile, 0, sizeof(spe_mailbox_profile));
+    spe_mailbox_profile.since = tfm_mailbox_hal_get_timestamp();
+}
+
+int32_t tfm_mailbox_profile_get(struct spe_mailbox_profile_t *profile)
+{
+    if (!profile) {
+        return MAILBOX_INVAL_PARAMS;
+    }
+
+    spm_memcpy(profile, &spe_mailbox_profile, sizeof(*profile));
+
+    return MAILBOX_SUCCESS;
+}
+
+static uint32_t mailbox_msg_sid(const struct mailbox_msg_t *msg)
+{
+    switch (msg->call_type) {
+    case MAILBOX_PSA_VERSION:
+        return msg->params.psa_version_params.sid;
+    case MAILBOX_PSA_CONNECT:
+        return msg->params.psa_connect_params.sid;
+    case MAILBOX_PSA_CALL:
+        return tfm_rpc_get_handle_sid(msg->params.psa_call_params.handle);
+    case MAILBOX_PSA_CLOSE:
+        return tfm_rpc_get_handle_sid(msg->params.psa_close_params.handle);
+    default:
+        return 0;
+    }
+}
+
+/* Record that the message in the slot is fetched from NSPE */
+static void mailbox_profile_pickup(uint8_t idx)
+{
+    struct secure_mailbox_slot_t *slot = &spe_mailbox_queue.queue[idx];
+    struct ns_mailbox_slot_t *ns_slot =
+                        &spe_mailbox_queue.ns_queue->queue[slot->ns_slot_idx];
+
+    slot->ts.pickup = tfm_mailbox_hal_get_timestamp();
+    slot->ts.enqueue = ns_slot->ts.enqueue;
+    /* Resolve the SID before the call can release the handle */
+    slot->ts.sid = mailbox_msg_sid(&slot->msg);
+
+    mailbox_latency_hist_add(&spe_mailbox_profile.pickup,
+                             slot->ts.pickup - slot->ts.enqueue);
+}
+
+/* Record that the message in the slot is replied and pass the stages to NSPE */
+static void mailbox_profile_reply(uint8_t idx)
+{
+    struct secure_mailbox_slot_t *slot = &spe_mailbox_queue.queue[idx];
+    struct ns_mailbox_slot_t *ns_slot =
+                        &spe_mailbox_queue.ns_queue->queue[slot->ns_slot_idx];
+
+    slot->ts.reply = tfm_mailbox_hal_get_timestamp();
+
+    mailbox_latency_hist_add(&spe_mailbox_profile.service,
+                             slot->ts.reply - slot->ts.pickup);
+    if (!mailbox_sid_stats_add(spe_mailbox_profile.sids, slot->ts.sid)) {
+        spe_mailbox_profile.nr_other_calls++;
+    }
+
+    spm_memcpy(&ns_slot->ts, &slot->ts, sizeof(ns_slot->ts));
+}
+#endif
+
+/* Send a single notification for all the replies posted so far */
+static void mailbox_flush_notify(void)
+{
+    if (spe_mailbox_queue.nr_unnotified == 0) {
+        return;
+    }
+
+    spe_mailbox_queue.nr_unnotified = 0;
+    tfm_mailbox_hal_notify_peer();
+}
+
+/* Notify NSPE of a reply posted outside of mailbox message handling */
+static void mailbox_notify_reply(void)
+{
+#ifdef TFM_MULTI_CORE_NOTIFY_COALESCE
+    if (spe_mailbox_queue.nr_unnotified < MAILBOX_NOTIFY_COALESCE_MAX) {
+        /*
+         * Defer the notification to the mailbox handling at the end of the
+         * next scheduling, so that replies from other RoT Services in the
+         * meantime share it.
+         */
+        tfm_core_thrd_activate_schedule();
+        return;
+    }
+#endif
+
+    mailbox_flush_notify();
 }
 
 __STATIC_INLINE struct mailbox_reply_t *get_nspe_reply_addr(uint8_t idx)
@@ -152,22 +315,75 @@ __STATIC_INLINE struct mailbox_reply_t *get_nspe_reply_addr(uint8_t idx)
     return &spe_mailbox_queue.ns_queue->queue[ns_slot_idx].reply;
 }
 
-static void mailbox_direct_reply(uint8_t idx, uint32_t result)
+/*
+ * Return the NSPE slot of a replied message to NSPE. The SPE slot is only
+ * released once NSPE can see the reply, so that a failed post can be retried.
+ * The notification to NSPE is left to the caller, so that it can be sent once
+ * for several replies.
+ */
+static int32_t mailbox_post_reply(uint8_t idx)
+{
+    int32_t ret;
+
+    ret = post_nspe_reply_slot(spe_mailbox_queue.ns_queue,
+                               spe_mailbox_queue.queue[idx].ns_slot_idx);
+    if (ret != MAILBOX_SUCCESS) {
+        return ret;
+    }
+
+    spe_mailbox_queue.nr_unposted--;
+    mailbox_clean_queue_slot(idx);
+    spe_mailbox_queue.nr_unnotified++;
+
+    return MAILBOX_SUCCESS;
+}
+
+/* Retry posting the replies which NSPE reply_ring did not accept */
+static void mailbox_post_pending_replies(void)
+{
+    uint8_t idx;
+
+    for (idx = 0; (idx < NUM_MAILBOX_QUEUE_SLOT) &&
+                  (spe_mailbox_queue.nr_unposted > 0); idx++) {
+        if (spe_mailbox_queue.queue[idx].is_replied &&
+            (mailbox_post_reply(idx) != MAILBOX_SUCCESS)) {
+            return;
+        }
+    }
+}
+
+/*
+ * Write the result of a message to NSPE. If NSPE reply_ring does not accept
+ * the slot, it is posted again in the next mailbox handling.
+ */
+static int32_t mailbox_direct_reply(uint8_t idx, uint32_t result)
 {
     struct mailbox_reply_t *reply_ptr;
     uint32_t ret_result = result;
 
+    if (idx >= NUM_MAILBOX_QUEUE_SLOT) {
+        return MAILBOX_INVAL_PARAMS;
+    }
+
+    if (get_spe_queue_empty_status(idx) ||
+        spe_mailbox_queue.queue[idx].is_replied) {
+        /* The message has already been replied */
+        return MAILBOX_NO_PEND_EVENT;
+    }
+
     /* Get reply address */
     reply_ptr = get_nspe_reply_addr(idx);
     spm_memcpy(&reply_ptr->return_val, &ret_result,
                sizeof(reply_ptr->return_val));
 
-    mailbox_clean_queue_slot(idx);
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+    mailbox_profile_reply(idx);
+#endif
 
-    /*
-     * Skip NSPE queue status update after single reply.
-     * Update NSPE queue status after all the mailbox messages are completed
-     */
+    spe_mailbox_queue.queue[idx].is_replied = true;
+    spe_mailbox_queue.nr_unposted++;
+
+    return mailbox_post_reply(idx);
 }
 
 __STATIC_INLINE int32_t check_mailbox_msg(const struct mailbox_msg_t *msg)
@@ -182,54 +398,55 @@ __STATIC_INLINE int32_t check_mailbox_msg(const struct mailbox_msg_t *msg)
 
 int32_t tfm_mailbox_handle_msg(void)
 {
-    uint8_t idx;
+    uint8_t idx, ns_slot_idx;
     int32_t result;
     psa_status_t psa_ret = PSA_ERROR_GENERIC_ERROR;
-    mailbox_queue_status_t mask_bits, pend_slots, reply_slots = 0;
+    bool is_pend = false;
     struct ns_mailbox_queue_t *ns_queue = spe_mailbox_queue.ns_queue;
     struct mailbox_msg_t *msg_ptr;
 
     TFM_CORE_ASSERT(ns_queue != NULL);
 
-    tfm_mailbox_hal_enter_critical();
-
-    /* Check if NSPE mailbox did assert a PSA client call request */
-    if (!ns_queue->pend_slots) {
-        tfm_mailbox_hal_exit_critical();
-        return MAILBOX_NO_PEND_EVENT;
-    }
-
-    pend_slots = get_nspe_queue_pend_status(ns_queue);
+    mailbox_post_pending_replies();
 
-    tfm_mailbox_hal_exit_critical();
+    /*
+     * Handle all the PSA client call requests asserted by NSPE mailbox, as
+     * long as an empty SPE mailbox queue slot is available. The remaining
+     * requests stay in NSPE pend_ring until a slot is freed by a reply.
+     */
+    while ((spe_mailbox_queue.nr_free_slots > 0) &&
+           fetch_nspe_pend_slot(ns_queue, &ns_slot_idx)) {
+        is_pend = true;
 
-    for (idx = 0; idx < NUM_MAILBOX_QUEUE_SLOT; idx++) {
-        mask_bits = (1 << idx);
-        /* Check if current NSPE mailbox queue slot is pending for handling */
-        if (!(pend_slots & mask_bits)) {
+        if (ns_slot_idx >= NUM_MAILBOX_QUEUE_SLOT) {
+            /* Invalid NSPE slot index */
             continue;
         }
 
         /*
-         * TODO
-         * The operations are simplified here. Use the SPE mailbox queue
-         * slot with the same idx as that of the NSPE mailbox queue slot.
-         * A more general implementation should dynamically search and
-         * select an empty SPE mailbox queue slot.
+         * SPE slots are selected independently of NSPE slot indexes, so that
+         * replies can complete in any order.
          */
-        clear_spe_queue_empty_status(idx);
-        spe_mailbox_queue.queue[idx].ns_slot_idx = idx;
+        if (!mailbox_alloc_queue_slot(&idx)) {
+            break;
+        }
+
+        spe_mailbox_queue.queue[idx].ns_slot_idx = ns_slot_idx;
+        get_spe_mailbox_msg_handle(idx,
+                                   &spe_mailbox_queue.queue[idx].msg_handle);
 
         msg_ptr = &spe_mailbox_queue.queue[idx].msg;
-        spm_memcpy(msg_ptr, &ns_queue->queue[idx].msg, sizeof(*msg_ptr));
+        spm_memcpy(msg_ptr, &ns_queue->queue[ns_slot_idx].msg,
+                   sizeof(*msg_ptr));
 
         if (check_mailbox_msg(msg_ptr) != MAILBOX_SUCCESS) {
             mailbox_clean_queue_slot(idx);
             continue;
         }
 
-        get_spe_mailbox_msg_handle(idx,
-                                   &spe_mailbox_queue.queue[idx].msg_handle);
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+        mailbox_profile_pickup(idx);
+#endif
 
         /*
          * Set the current slot index under processing.
@@ -254,9 +471,7 @@ int32_t tfm_mailbox_handle_msg(void)
              * Directly write the result to NSPE for psa_framework_version() and
              * psa_version().
              */
-            reply_slots |= (1 << idx);
-
-            mailbox_direct_reply(idx, (uint32_t)psa_ret);
+            (void)mailbox_direct_reply(idx, (uint32_t)psa_ret);
         } else if ((msg_ptr->call_type == MAILBOX_PSA_CONNECT) ||
                    (msg_ptr->call_type == MAILBOX_PSA_CALL)) {
             /*
@@ -264,8 +479,7 @@ int32_t tfm_mailbox_handle_msg(void)
              * TF-M IPC SPM, the failure result should be returned immediately.
              */
             if (psa_ret != PSA_SUCCESS) {
-                reply_slots |= (1 << idx);
-                mailbox_direct_reply(idx, (uint32_t)psa_ret);
+                (void)mailbox_direct_reply(idx, (uint32_t)psa_ret);
             }
         }
         /*
@@ -274,18 +488,21 @@ int32_t tfm_mailbox_handle_msg(void)
          */
     }
 
-    tfm_mailbox_hal_enter_critical();
-
-    /* Clean the NSPE mailbox pending status. */
-    clear_nspe_queue_pend_status(ns_queue, pend_slots);
-
-    /* Set the NSPE mailbox replied status */
-    set_nspe_queue_replied_status(ns_queue, reply_slots);
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+    if ((spe_mailbox_queue.nr_free_slots == 0) &&
+        is_nspe_pend_slot_available(ns_queue)) {
+        spe_mailbox_profile.nr_slots_full++;
+    }
+#endif
 
-    tfm_mailbox_hal_exit_critical();
+    /*
+     * Notify NSPE once for the replies above and for the replies deferred by
+     * tfm_mailbox_reply_msg().
+     */
+    mailbox_flush_notify();
 
-    if (reply_slots) {
-        tfm_mailbox_hal_notify_peer();
+    if (!is_pend) {
+        return MAILBOX_NO_PEND_EVENT;
     }
 
     return MAILBOX_SUCCESS;
@@ -295,18 +512,26 @@ int32_t tfm_mailbox_reply_msg(mailbox_msg_handle_t handle, int32_t reply)
 {
     uint8_t idx;
     int32_t ret;
+    bool is_full;
     struct ns_mailbox_queue_t *ns_queue = spe_mailbox_queue.ns_queue;
 
     TFM_CORE_ASSERT(ns_queue != NULL);
 
     /*
      * If handle == MAILBOX_MSG_NULL_HANDLE, reply to the mailbox message
-     * in the first slot.
-     * When multiple ongoing PSA client calls from NSPE are supported,
-     * additional check might be necessary to avoid spoofing the first slot.
+     * under processing. Since SPE slots are selected dynamically, it can only
+     * be identified when there is exactly a single one.
      */
     if (handle == MAILBOX_MSG_NULL_HANDLE) {
-        idx = 0;
+        if (spe_mailbox_queue.nr_free_slots != NUM_MAILBOX_QUEUE_SLOT - 1) {
+            return MAILBOX_INVAL_PARAMS;
+        }
+
+        for (idx = 0; idx < NUM_MAILBOX_QUEUE_SLOT; idx++) {
+            if (!get_spe_queue_empty_status(idx)) {
+                break;
+            }
+        }
     } else {
         ret = get_spe_mailbox_msg_idx(handle, &idx);
         if (ret != MAILBOX_SUCCESS) {
@@ -314,20 +539,26 @@ int32_t tfm_mailbox_reply_msg(mailbox_msg_handle_t handle, int32_t reply)
         }
     }
 
-    if (get_spe_queue_empty_status(idx)) {
+    if ((idx >= NUM_MAILBOX_QUEUE_SLOT) || get_spe_queue_empty_status(idx)) {
         return MAILBOX_NO_PEND_EVENT;
     }
 
-    mailbox_direct_reply(idx, (uint32_t)reply);
-
-    tfm_mailbox_hal_enter_critical();
+    is_full = (spe_mailbox_queue.nr_free_slots == 0);
 
-    /* Set the NSPE mailbox replied status */
-    set_nspe_queue_replied_status(ns_queue, (1 << idx));
+    ret = mailbox_direct_reply(idx, (uint32_t)reply);
+    if (ret != MAILBOX_SUCCESS) {
+        return ret;
+    }
 
-    tfm_mailbox_hal_exit_critical();
+    if (is_full) {
+        /*
+         * Requests may have been left in NSPE pend_ring while all the SPE
+         * slots were occupied. Handle them in the next scheduling.
+         */
+        tfm_core_thrd_activate_schedule();
+    }
 
-    tfm_mailbox_hal_notify_peer();
+    mailbox_notify_reply();
 
     return MAILBOX_SUCCESS;
 }
@@ -376,13 +607,17 @@ static const struct tfm_rpc_ops_t mailbox_rpc_ops = {
 int32_t tfm_mailbox_init(void)
 {
     int32_t ret;
+    uint8_t idx;
 
     spm_memset(&spe_mailbox_queue, 0, sizeof(spe_mailbox_queue));
 
-    spe_mailbox_queue.empty_slots =
-            (mailbox_queue_status_t)((1UL << (NUM_MAILBOX_QUEUE_SLOT - 1)) - 1);
-    spe_mailbox_queue.empty_slots +=
-            (mailbox_queue_status_t)(1UL << (NUM_MAILBOX_QUEUE_SLOT - 1));
+    spe_mailbox_queue.cur_proc_slot_idx = NUM_MAILBOX_QUEUE_SLOT;
+
+    /* All the slots are empty. Allocate from the lowest index first. */
+    for (idx = 0; idx < NUM_MAILBOX_QUEUE_SLOT; idx++) {
+        spe_mailbox_queue.free_slots[idx] = NUM_MAILBOX_QUEUE_SLOT - 1 - idx;
+    }
+    spe_mailbox_queue.nr_free_slots = NUM_MAILBOX_QUEUE_SLOT;
 
     /* Register RPC callbacks */
     ret = tfm_rpc_register_ops(&mailbox_rpc_ops);
@@ -402,5 +637,9 @@ int32_t tfm_mailbox_init(void)
         return ret;
     }
 
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+    tfm_mailbox_profile_reset();
+#endif
+
     return MAILBOX_SUCCESS;
 }
@@ -10,26 +10,83 @@
 
 #include "tfm_mailbox.h"
 
-/* A single slot structure in SPE mailbox queue */
+/*
+ * A single slot structure in SPE mailbox queue.
+ * An empty slot has a null message handle. SPE slots are allocated
+ * independently of NSPE slots. ns_slot_idx records the NSPE slot to reply to.
+ */
 struct secure_mailbox_slot_t {
     struct mailbox_msg_t msg;
 
     uint8_t              ns_slot_idx;
     mailbox_msg_handle_t msg_handle;
+    bool                 is_replied;    /*
+                                         * The reply is written to NSPE but
+                                         * the slot is not posted to NSPE
+                                         * reply_ring yet.
+                                         */
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+    struct mailbox_msg_timestamps_t ts;
+#endif
 };
 
 struct secure_mailbox_queue_t {
-    mailbox_queue_status_t       empty_slots;      /* bitmask of empty slots */
-
     struct secure_mailbox_slot_t queue[NUM_MAILBOX_QUEUE_SLOT];
     struct ns_mailbox_queue_t    *ns_queue;
+    uint32_t                     pend_pos;      /*
+                                                 * Next position of NSPE
+                                                 * pend_ring to fetch from.
+                                                 */
+    uint32_t                     reply_pos;     /*
+                                                 * Next position of NSPE
+                                                 * reply_ring to reply to.
+                                                 */
     uint8_t                      cur_proc_slot_idx; /*
                                                      * The index of mailbox
                                                      * queue slot currently
                                                      * under processing.
                                                      */
+    uint8_t                      free_slots[NUM_MAILBOX_QUEUE_SLOT];
+                                                /* Indexes of empty slots */
+    uint8_t                      nr_free_slots; /*
+                                                 * Number of valid entries in
+                                                 * free_slots.
+                                                 */
+    uint8_t                      nr_unposted;   /*
+                                                 * Number of slots replied but
+                                                 * not posted to NSPE
+                                                 * reply_ring yet.
+                                                 */
+    uint8_t                      nr_unnotified; /*
+                                                 * Number of replies posted to
+                                                 * NSPE reply_ring but not
+                                                 * notified yet.
+                                                 */
 };
 
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+/*
+ * The profiling statistics of SPE mailbox.
+ * Latencies are measured in ticks of the time base shared by NSPE and SPE.
+ */
+struct spe_mailbox_profile_t {
+    uint32_t since;                     /* Timestamp when the statistics were
+                                         * last reset
+                                         */
+    struct mailbox_latency_hist_t pickup;   /* From NSPE enqueue to SPE pickup */
+    struct mailbox_latency_hist_t service;  /* From SPE pickup to SPE reply */
+    uint32_t nr_slots_full;             /* The number of times requests were
+                                         * left pending in NSPE mailbox queue
+                                         * as all the SPE mailbox queue slots
+                                         * were occupied.
+                                         */
+    uint32_t nr_other_calls;            /* The number of PSA client calls not
+                                         * counted in sids.
+                                         */
+    struct mailbox_sid_stats_t sids[MAILBOX_PROFILING_NR_SID];
+};
+#endif
+
 /**
  * \brief Handle mailbox message(s) from NSPE.
  *
@@ -58,6 +115,35 @@ int32_t tfm_mailbox_reply_msg(mailbox_msg_handle_t handle, int32_t reply);
  */
 int32_t tfm_mailbox_init(void);
 
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+/**
+ * \brief Clear the profiling statistics of SPE mailbox.
+ */
+void tfm_mailbox_profile_reset(void);
+
+/**
+ * \brief Read the profiling statistics of SPE mailbox.
+ *
+ * \note The statistics are updated in SPM handler mode. The caller should not
+ *       be preempted by mailbox handling to get a consistent copy.
+ *
+ * \param[out] profile          The buffer to be written with
+ *                              \ref spe_mailbox_profile_t.
+ *
+ * \retval MAILBOX_SUCCESS      Operation succeeded.
+ * \retval Other return code    Operation failed with an error code.
+ */
+int32_t tfm_mailbox_profile_get(struct spe_mailbox_profile_t *profile);
+
+/**
+ * \brief Read the current timestamp of the time base shared by NSPE and SPE.
+ *        Implemented by platform specific timer driver.
+ *
+ * \return The current timestamp in ticks.
+ */
+uint32_t tfm_mailbox_hal_get_timestamp(void);
+#endif
+
 /**
  * \brief Platform specific initialization of SPE mailbox.
  *
@@ -12,34 +12,48 @@
 #include "tfm/tfm_core_svc.h"
 #include "tfm_core_utils.h"
 
+/*
+ * Threads in RUNNING state are kept in ready queues, one for each range of
+ * priority values. Bit (31 - n) of the ready bitmap is set while queue n is
+ * not empty, so the highest priority queue is found with one CLZ.
+ */
+#define THRD_RDY_QUEUE_NUM        32
+#define THRD_RDY_QUEUE_SHIFT      3 /* (THRD_PRIOR_MASK + 1) / 32 values */
+
+#define RDY_QUEUE_BIT(idx)        ((1UL << 31) >> (idx))
+
 /* Force ZERO in case ZI(bss) clear is missing */
-static struct tfm_core_thread_t *p_thrd_head = NULL;
-static struct tfm_core_thread_t *p_runn_head = NULL;
+static struct tfm_core_thread_t *p_rdy_queues[THRD_RDY_QUEUE_NUM] = {NULL};
+static uint32_t rdy_bitmap = 0;
 static struct tfm_core_thread_t *p_curr_thrd = NULL;
 
 /* Define Macro to fetch global to support future expansion (PERCPU e.g.) */
-#define LIST_HEAD   p_thrd_head
-#define RUNN_HEAD   p_runn_head
+#define RDY_QUEUES  p_rdy_queues
+#define RDY_BITMAP  rdy_bitmap
 #define CURR_THRD   p_curr_thrd
 
-static struct tfm_core_thread_t *find_next_running_thread(
-                                                struct tfm_core_thread_t *pth)
+/* Non-secure threads are shifted down into the lowest priority queue */
+static uint32_t get_rdy_queue_idx(uint32_t prior)
 {
-    while (pth && pth->state != THRD_STATE_RUNNING) {
-        pth = pth->next;
+    if (prior & THRD_ATTR_NON_SECURE) {
+        return THRD_RDY_QUEUE_NUM - 1;
     }
 
-    return pth;
+    return (prior & THRD_PRIOR_MASK) >> THRD_RDY_QUEUE_SHIFT;
 }
 
 /* To get next running thread for scheduler */
 struct tfm_core_thread_t *tfm_core_thrd_get_next_thread(void)
 {
+    if (RDY_BITMAP == 0) {
+        return NULL;
+    }
+
     /*
-     * First RUNNING thread has highest priority since threads are sorted with
-     * priority.
+     * Head of the first non-empty queue has highest priority since each queue
+     * is sorted with priority.
      */
-    return find_next_running_thread(RUNN_HEAD);
+    return RDY_QUEUES[__CLZ(RDY_BITMAP)];
 }
 
 /* To get current thread for caller */
@@ -48,36 +62,52 @@ struct tfm_core_thread_t *tfm_core_thrd_get_curr_thread(void)
     return CURR_THRD;
 }
 
-/* Insert a new thread into list by descending priority (Highest at head) */
-static void insert_by_prior(struct tfm_core_thread_t **head,
-                            struct tfm_core_thread_t *node)
+/*
+ * Insert a thread into its ready queue by descending priority (Highest at
+ * head), behind the threads of the same priority.
+ */
+static void rdy_queue_insert(struct tfm_core_thread_t *pth)
 {
-    if (*head == NULL || (node->prior <= (*head)->prior)) {
-        node->next = *head;
-        *head = node;
-    } else {
-        struct tfm_core_thread_t *iter = *head;
+    uint32_t idx = get_rdy_queue_idx(pth->prior);
+    struct tfm_core_thread_t **pp = &RDY_QUEUES[idx];
 
-        while (iter->next && (node->prior > iter->next->prior)) {
-            iter = iter->next;
-        }
-        node->next = iter->next;
-        iter->next = node;
+    while (*pp && ((*pp)->prior <= pth->prior)) {
+        pp = &(*pp)->next;
     }
+    pth->next = *pp;
+    *pp = pth;
+
+    RDY_BITMAP |= RDY_QUEUE_BIT(idx);
 }
 
-/*
- * Set first running thread as head to reduce enumerate
- * depth while searching for a first running thread.
- */
-static void update_running_head(struct tfm_core_thread_t **runn,
-                                struct tfm_core_thread_t *node)
+/* Remove a thread from its ready queue */
+static void rdy_queue_remove(struct tfm_core_thread_t *pth)
 {
-    if ((node->state == THRD_STATE_RUNNING) &&
-        (*runn == NULL || (node->prior < (*runn)->prior))) {
-        *runn = node;
+    uint32_t idx = get_rdy_queue_idx(pth->prior);
+    struct tfm_core_thread_t **pp = &RDY_QUEUES[idx];
+
+    while (*pp && (*pp != pth)) {
+        pp = &(*pp)->next;
+    }
+    if (*pp) {
+        *pp = pth->next;
+    }
+    pth->next = NULL;
+
+    if (RDY_QUEUES[idx] == NULL) {
+        RDY_BITMAP &= ~RDY_QUEUE_BIT(idx);
+    }
+}
+
+/* Change the priority value of a thread, moving it if it is queued */
+static void update_prior(struct tfm_core_thread_t *pth, uint32_t prior)
+{
+    if (pth->state == THRD_STATE_RUNNING) {
+        rdy_queue_remove(pth);
+        pth->prior = prior;
+        rdy_queue_insert(pth);
     } else {
-        *runn = LIST_HEAD;
+        pth->prior = prior;
     }
 }
 
@@ -108,10 +138,7 @@ uint32_t tfm_core_thrd_start(struct tfm_core_thread_t *pth)
     tfm_arch_init_context(&pth->arch_ctx, pth->param, (uintptr_t)pth->pfn,
                           pth->stk_btm, pth->stk_top);
 
-    /* Insert a new thread with priority */
-    insert_by_prior(&LIST_HEAD, pth);
-
-    /* Mark it as RUNNING after insertion */
+    /* Mark it as RUNNING, which inserts it into the ready queue */
     tfm_core_thrd_set_state(pth, THRD_STATE_RUNNING);
 
     return THRD_SUCCESS;
@@ -121,8 +148,27 @@ void tfm_core_thrd_set_state(struct tfm_core_thread_t *pth, uint32_t new_state)
 {
     TFM_CORE_ASSERT(pth != NULL && new_state < THRD_STATE_INVALID);
 
+    if ((pth->state == THRD_STATE_RUNNING) &&
+        (new_state != THRD_STATE_RUNNING)) {
+        rdy_queue_remove(pth);
+    } else if ((pth->state != THRD_STATE_RUNNING) &&
+               (new_state == THRD_STATE_RUNNING)) {
+        rdy_queue_insert(pth);
+    }
+
     pth->state = new_state;
-    update_running_head(&RUNN_HEAD, pth);
+}
+
+void tfm_core_thrd_set_priority(struct tfm_core_thread_t *pth, uint32_t prior)
+{
+    update_prior(pth, (pth->prior & ~THRD_PRIOR_MASK) |
+                      (prior & THRD_PRIOR_MASK));
+}
+
+void tfm_core_thrd_set_secure(struct tfm_core_thread_t *pth,
+                              uint32_t attr_secure)
+{
+    update_prior(pth, (pth->prior & ~THRD_ATTR_NON_SECURE) | attr_secure);
 }
 
 /* Scheduling won't happen immediately but after the exception returns */
@@ -47,7 +47,7 @@ struct tfm_core_thread_t {
     uint32_t        state;              /* state                        */
 
     struct tfm_arch_ctx_t    arch_ctx;  /* State context                */
-    struct tfm_core_thread_t *next;     /* next thread in list          */
+    struct tfm_core_thread_t *next;     /* next thread in ready queue   */
 };
 
 /*
@@ -62,7 +62,7 @@ struct tfm_core_thread_t {
  *
  * Notes :
  *  Thread contex rely on caller allocated memory; initialize members in
- *  context. This function does not insert thread into schedulable list.
+ *  context. This function does not insert thread into ready queue.
  */
 void tfm_core_thrd_init(struct tfm_core_thread_t *pth,
                         tfm_core_thrd_entry_t pfn, void *param,
@@ -77,14 +77,11 @@ void tfm_core_thrd_init(struct tfm_core_thread_t *pth,
  *
  * Notes :
  *  Set thread priority. Priority is set to THRD_PRIOR_MEDIUM in
- *  tfm_core_thrd_init().
+ *  tfm_core_thrd_init(). A RUNNING thread is moved to the ready queue of
+ *  the new priority, so the priority can be changed at any time, e.g. to
+ *  let a service thread inherit the priority of its client.
  */
-void __STATIC_INLINE tfm_core_thrd_set_priority(struct tfm_core_thread_t *pth,
-                                                uint32_t prior)
-{
-    pth->prior &= ~THRD_PRIOR_MASK;
-    pth->prior |= prior & THRD_PRIOR_MASK;
-}
+void tfm_core_thrd_set_priority(struct tfm_core_thread_t *pth, uint32_t prior);
 
 /*
  * Set thread security attribute.
@@ -96,12 +93,8 @@ void __STATIC_INLINE tfm_core_thrd_set_priority(struct tfm_core_thread_t *pth,
  * Notes
  *  Reuse prior of thread context to shift down non-secure thread priority.
  */
-void __STATIC_INLINE tfm_core_thrd_set_secure(struct tfm_core_thread_t *pth,
-                                              uint32_t attr_secure)
-{
-    pth->prior &= ~THRD_ATTR_NON_SECURE;
-    pth->prior |= attr_secure;
-}
+void tfm_core_thrd_set_secure(struct tfm_core_thread_t *pth,
+                              uint32_t attr_secure);
 
 /*
  * Set thread state.
@@ -150,7 +143,7 @@ void __STATIC_INLINE tfm_core_thrd_set_retval(struct tfm_core_thread_t *pth,
 }
 
 /*
- * Validate thread context and insert it into schedulable list.
+ * Validate thread context and insert it into ready queue.
  *
  * Parameters :
  *  pth         -     pointer of thread context
@@ -173,10 +166,10 @@ uint32_t tfm_core_thrd_start(struct tfm_core_thread_t *pth);
 struct tfm_core_thread_t *tfm_core_thrd_get_curr_thread(void);
 
 /*
- * Get next running thread in list.
+ * Get the highest priority running thread.
  *
  * Return :
- *  Pointer of next thread to be run.
+ *  Pointer of next thread to be run, or NULL if no thread is running.
  */
 struct tfm_core_thread_t *tfm_core_thrd_get_next_thread(void);
 
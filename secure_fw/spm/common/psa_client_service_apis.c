@@ -18,6 +18,7 @@
 #include "tfm_internal_defines.h"
 #include "tfm_rpc.h"
 #include "tfm_spm_hal.h"
+#include "tfm_spm_trace.h"
 
 /*********************** SPM functions for PSA Client APIs *******************/
 
@@ -49,12 +50,17 @@ psa_status_t tfm_spm_psa_connect(uint32_t *args, bool ns_caller)
 {
     uint32_t sid;
     uint32_t version;
+    psa_status_t status;
 
     TFM_CORE_ASSERT(args != NULL);
     sid = (uint32_t)args[0];
     version = (uint32_t)args[1];
 
-    return tfm_spm_client_psa_connect(sid, version, ns_caller);
+    SPMTRACE(TFM_SPM_TRACE_EVT_CONNECT_ENTER, sid, version);
+    status = tfm_spm_client_psa_connect(sid, version, ns_caller);
+    SPMTRACE(TFM_SPM_TRACE_EVT_CONNECT_EXIT, status, 0);
+
+    return status;
 }
 
 psa_status_t tfm_spm_psa_call(uint32_t *args, bool ns_caller, uint32_t lr)
@@ -67,6 +73,7 @@ psa_status_t tfm_spm_psa_call(uint32_t *args, bool ns_caller, uint32_t lr)
     uint32_t privileged;
     int32_t type;
     struct tfm_control_parameter_t ctrl_param;
+    psa_status_t status;
 
     TFM_CORE_ASSERT(args != NULL);
     handle = (psa_handle_t)args[0];
@@ -101,8 +108,12 @@ psa_status_t tfm_spm_psa_call(uint32_t *args, bool ns_caller, uint32_t lr)
         tfm_core_panic();
     }
 
-    return tfm_spm_client_psa_call(handle, type, inptr, in_num, outptr, out_num,
-                                   ns_caller, privileged);
+    SPMTRACE(TFM_SPM_TRACE_EVT_CALL_ENTER, handle, type);
+    status = tfm_spm_client_psa_call(handle, type, inptr, in_num, outptr,
+                                     out_num, ns_caller, privileged);
+    SPMTRACE(TFM_SPM_TRACE_EVT_CALL_EXIT, status, 0);
+
+    return status;
 }
 
 void tfm_spm_psa_close(uint32_t *args, bool ns_caller)
@@ -254,8 +265,14 @@ void tfm_spm_psa_set_rhandle(uint32_t *args)
         tfm_core_panic();
     }
 
+    /* It is a fatal error to set a reverse handle for a stateless request */
+    if (!msg->service->service_db->connection_based) {
+        tfm_core_panic();
+    }
+
     msg->msg.rhandle = rhandle;
-    conn_handle = tfm_spm_to_handle_instance(msg_handle);
+    conn_handle = TFM_GET_CONTAINER_PTR(msg, struct tfm_conn_handle_t,
+                                        internal_msg);
 
     /* Store reverse handle for following client calls. */
     tfm_spm_set_rhandle(msg->service, conn_handle, rhandle);
@@ -330,6 +347,63 @@ size_t tfm_spm_psa_read(uint32_t *args)
     return bytes;
 }
 
+const void *tfm_spm_map_invec(uint32_t *args)
+{
+    psa_handle_t msg_handle;
+    uint32_t invec_idx;
+    struct tfm_msg_body_t *msg = NULL;
+    uint32_t privileged;
+    struct partition_t *partition = NULL;
+
+    TFM_CORE_ASSERT(args != NULL);
+    msg_handle = (psa_handle_t)args[0];
+    invec_idx = args[1];
+
+    /* It is a fatal error if message handle is invalid */
+    msg = tfm_spm_get_msg_from_handle(msg_handle);
+    if (!msg) {
+        tfm_core_panic();
+    }
+
+    partition = msg->service->partition;
+    privileged = tfm_spm_partition_get_privileged_mode(
+        partition->static_data->partition_flags);
+
+    /*
+     * It is a fatal error if message handle does not refer to a request
+     * message
+     */
+    if (msg->msg.type < PSA_IPC_CALL) {
+        tfm_core_panic();
+    }
+
+    /*
+     * It is a fatal error if invec_idx is equal to or greater than
+     * PSA_MAX_IOVEC
+     */
+    if (invec_idx >= PSA_MAX_IOVEC) {
+        tfm_core_panic();
+    }
+
+    /* There was no remaining data in this input vector */
+    if (msg->msg.in_size[invec_idx] == 0) {
+        return NULL;
+    }
+
+    /*
+     * The client access was checked when the message was created. The data
+     * can only be read in place if the service partition can read it too,
+     * otherwise the service falls back to psa_read().
+     */
+    if (tfm_memory_check(msg->invec[invec_idx].base,
+                         msg->msg.in_size[invec_idx], false,
+                         TFM_MEMORY_ACCESS_RO, privileged) != IPC_SUCCESS) {
+        return NULL;
+    }
+
+    return msg->invec[invec_idx].base;
+}
+
 size_t tfm_spm_psa_skip(uint32_t *args)
 {
     psa_handle_t msg_handle;
@@ -460,11 +534,14 @@ void tfm_spm_psa_reply(uint32_t *args)
     struct tfm_msg_body_t *msg = NULL;
     int32_t ret = PSA_SUCCESS;
     struct tfm_conn_handle_t *conn_handle;
+    bool free_conn = false;
 
     TFM_CORE_ASSERT(args != NULL);
     msg_handle = (psa_handle_t)args[0];
     status = (psa_status_t)args[1];
 
+    SPMTRACE(TFM_SPM_TRACE_EVT_REPLY_ENTER, msg_handle, status);
+
     /* It is a fatal error if message handle is invalid */
     msg = tfm_spm_get_msg_from_handle(msg_handle);
     if (!msg) {
@@ -485,7 +562,8 @@ void tfm_spm_psa_reply(uint32_t *args)
      * Three type of message are passed in this function: CONNECTION, REQUEST,
      * DISCONNECTION. It needs to process differently for each type.
      */
-    conn_handle = tfm_spm_to_handle_instance(msg_handle);
+    conn_handle = TFM_GET_CONTAINER_PTR(msg, struct tfm_conn_handle_t,
+                                        internal_msg);
     switch (msg->msg.type) {
     case PSA_IPC_CONNECT:
         /*
@@ -497,7 +575,7 @@ void tfm_spm_psa_reply(uint32_t *args)
             ret = msg_handle;
         } else if (status == PSA_ERROR_CONNECTION_REFUSED) {
             /* Refuse the client connection, indicating a permanent error. */
-            tfm_spm_free_conn_handle(service, conn_handle);
+            free_conn = true;
             ret = PSA_ERROR_CONNECTION_REFUSED;
         } else if (status == PSA_ERROR_CONNECTION_BUSY) {
             /* Fail the client connection, indicating a transient error. */
@@ -508,7 +586,7 @@ void tfm_spm_psa_reply(uint32_t *args)
         break;
     case PSA_IPC_DISCONNECT:
         /* Service handle is not used anymore */
-        tfm_spm_free_conn_handle(service, conn_handle);
+        free_conn = true;
 
         /*
          * If the message type is PSA_IPC_DISCONNECT, then the status code is
@@ -536,11 +614,16 @@ void tfm_spm_psa_reply(uint32_t *args)
          * If the source of the programmer error is a Secure Partition, the SPM
          * must panic the Secure Partition in response to a PROGRAMMER ERROR.
          */
-        if (TFM_CLIENT_ID_IS_NS(msg->msg.client_id)) {
-            conn_handle->status = TFM_HANDLE_STATUS_CONNECT_ERROR;
-        } else {
+        if (!TFM_CLIENT_ID_IS_NS(msg->msg.client_id)) {
             tfm_core_panic();
         }
+    }
+
+    if (!service->service_db->connection_based) {
+        /* There is no connection to keep after a stateless request */
+        free_conn = true;
+    } else if (ret == PSA_ERROR_PROGRAMMER_ERROR) {
+        conn_handle->status = TFM_HANDLE_STATUS_CONNECT_ERROR;
     } else {
         conn_handle->status = TFM_HANDLE_STATUS_IDLE;
     }
@@ -550,6 +633,20 @@ void tfm_spm_psa_reply(uint32_t *args)
     } else {
         tfm_event_wake(&msg->ack_evnt, ret);
     }
+
+    /*
+     * The message is held in the connection handle, so the handle is freed
+     * only after the reply has been delivered from the message.
+     */
+    if (free_conn) {
+        if (service->service_db->connection_based) {
+            tfm_spm_free_conn_handle(service, conn_handle);
+        } else {
+            tfm_spm_free_stateless_conn_handle(service, conn_handle);
+        }
+    }
+
+    SPMTRACE(TFM_SPM_TRACE_EVT_REPLY_EXIT, msg_handle, 0);
 }
 
 void tfm_spm_psa_notify(uint32_t *args)
@@ -169,6 +169,27 @@ void tfm_spm_psa_set_rhandle(uint32_t *args);
  */
 size_t tfm_spm_psa_read(uint32_t *args);
 
+/**
+ * \brief SVC handler for \ref tfm_map_invec.
+ *
+ * \param[in] args              Include all input arguments:
+ *                              msg_handle, invec_idx.
+ *
+ * \retval !NULL                Address of the remaining data of the input
+ *                              vector.
+ * \retval NULL                 There was no remaining data in this input
+ *                              vector, or the partition of the service cannot
+ *                              read it in place.
+ * \retval "Does not return"    The call is invalid, one or more of the
+ *                              following are true:
+ * \arg                           msg_handle is invalid.
+ * \arg                           msg_handle does not refer to a request
+ *                                message.
+ * \arg                           invec_idx is equal to or greater than
+ *                                \ref PSA_MAX_IOVEC.
+ */
+const void *tfm_spm_map_invec(uint32_t *args);
+
 /**
  * \brief SVC handler for \ref psa_skip.
  *
@@ -73,6 +73,11 @@ psa_status_t tfm_spm_client_psa_connect(uint32_t sid, uint32_t version,
         tfm_core_panic();
     }
 
+    /* It is a fatal error to connect to a stateless RoT Service */
+    if (!service->service_db->connection_based) {
+        tfm_core_panic();
+    }
+
     /*
      * Create connection handle here since it is possible to return the error
      * code to client when creation fails.
@@ -117,11 +122,13 @@ psa_status_t tfm_spm_client_psa_call(psa_handle_t handle, int32_t type,
 {
     psa_invec invecs[PSA_MAX_IOVEC];
     psa_outvec outvecs[PSA_MAX_IOVEC];
+    struct tfm_memory_range_t ranges[PSA_MAX_IOVEC];
     struct tfm_conn_handle_t *conn_handle;
     struct tfm_spm_service_t *service;
     struct tfm_msg_body_t *msg;
     int i, j;
     int32_t client_id;
+    psa_handle_t msg_handle;
 
     /* It is a fatal error if in_len + out_len > PSA_MAX_IOVEC. */
     if ((in_num > PSA_MAX_IOVEC) ||
@@ -136,47 +143,71 @@ psa_status_t tfm_spm_client_psa_call(psa_handle_t handle, int32_t type,
         client_id = tfm_spm_partition_get_running_partition_id();
     }
 
-    conn_handle = tfm_spm_to_handle_instance(handle);
-    /* It is a fatal error if an invalid handle was passed. */
-    if (tfm_spm_validate_conn_handle(conn_handle, client_id) != IPC_SUCCESS) {
-        tfm_core_panic();
-    }
-    service = conn_handle->service;
-    if (!service) {
-        /* FixMe: Need to implement one mechanism to resolve this failure. */
-        tfm_core_panic();
-    }
+    service = tfm_spm_get_stateless_service(handle);
+    if (service) {
+        /*
+         * A stateless handle refers to the RoT Service directly, so there is
+         * no connection to look up. It is a fatal error if the caller is not
+         * authorized to access the RoT Service.
+         */
+        if (tfm_spm_check_authorization(service->service_db->sid, service,
+                                        ns_caller) != IPC_SUCCESS) {
+            tfm_core_panic();
+        }
 
-    /* It is a fatal error if the connection is currently handling a request. */
-    if (conn_handle->status == TFM_HANDLE_STATUS_ACTIVE) {
-        tfm_core_panic();
-    }
+        conn_handle = tfm_spm_create_stateless_conn_handle(service, client_id,
+                                                           ns_caller);
+        if (!conn_handle) {
+            /* FixMe: Need to implement one mechanism to resolve this failure */
+            tfm_core_panic();
+        }
+        msg_handle = tfm_spm_to_msg_handle(conn_handle);
+    } else {
+        conn_handle = tfm_spm_to_handle_instance(handle);
+        /* It is a fatal error if an invalid handle was passed. */
+        if (tfm_spm_validate_conn_handle(conn_handle, client_id) !=
+            IPC_SUCCESS) {
+            tfm_core_panic();
+        }
+        service = conn_handle->service;
+        if (!service) {
+            /* FixMe: Need to implement one mechanism to resolve this failure */
+            tfm_core_panic();
+        }
 
-    /*
-     * Return PSA_ERROR_PROGRAMMER_ERROR immediately for the connection
-     * has been terminated by the RoT Service.
-     */
-    if (conn_handle->status == TFM_HANDLE_STATUS_CONNECT_ERROR) {
-        return PSA_ERROR_PROGRAMMER_ERROR;
-    }
+        /*
+         * It is a fatal error if the connection is currently handling a
+         * request.
+         */
+        if (conn_handle->status == TFM_HANDLE_STATUS_ACTIVE) {
+            tfm_core_panic();
+        }
 
-    /*
-     * Read client invecs from the wrap input vector. It is a fatal error
-     * if the memory reference for the wrap input vector is invalid or not
-     * readable.
-     */
-    if (tfm_memory_check(inptr, in_num * sizeof(psa_invec), ns_caller,
-        TFM_MEMORY_ACCESS_RO, privileged) != IPC_SUCCESS) {
-        tfm_core_panic();
+        /*
+         * Return PSA_ERROR_PROGRAMMER_ERROR immediately for the connection
+         * has been terminated by the RoT Service.
+         */
+        if (conn_handle->status == TFM_HANDLE_STATUS_CONNECT_ERROR) {
+            return PSA_ERROR_PROGRAMMER_ERROR;
+        }
+        msg_handle = handle;
     }
 
     /*
-     * Read client outvecs from the wrap output vector and will update the
-     * actual length later. It is a fatal error if the memory reference for
-     * the wrap output vector is invalid or not read-write.
+     * Read client invecs from the wrap input vector and client outvecs from
+     * the wrap output vector, the actual length of which will be updated
+     * later. It is a fatal error if the memory reference for the wrap input
+     * vector is invalid or not readable, or the one for the wrap output
+     * vector is invalid or not read-write.
      */
-    if (tfm_memory_check(outptr, out_num * sizeof(psa_outvec), ns_caller,
-        TFM_MEMORY_ACCESS_RW, privileged) != IPC_SUCCESS) {
+    ranges[0].base = inptr;
+    ranges[0].len = in_num * sizeof(psa_invec);
+    ranges[0].access = TFM_MEMORY_ACCESS_RO;
+    ranges[1].base = outptr;
+    ranges[1].len = out_num * sizeof(psa_outvec);
+    ranges[1].access = TFM_MEMORY_ACCESS_RW;
+    if (tfm_memory_check_ranges(ranges, 2, ns_caller, privileged,
+                                client_id) != IPC_SUCCESS) {
         tfm_core_panic();
     }
 
@@ -188,20 +219,29 @@ psa_status_t tfm_spm_client_psa_call(psa_handle_t handle, int32_t type,
     spm_memcpy(outvecs, outptr, out_num * sizeof(psa_outvec));
 
     /*
-     * For client input vector, it is a fatal error if the provided payload
-     * memory reference was invalid or not readable.
+     * It is a fatal error if the provided payload memory reference of a
+     * client input vector was invalid or not readable, or the one of a client
+     * output vector was invalid or not read-write.
      */
     for (i = 0; i < in_num; i++) {
-        if (tfm_memory_check(invecs[i].base, invecs[i].len, ns_caller,
-            TFM_MEMORY_ACCESS_RO, privileged) != IPC_SUCCESS) {
-            tfm_core_panic();
-        }
+        ranges[i].base = invecs[i].base;
+        ranges[i].len = invecs[i].len;
+        ranges[i].access = TFM_MEMORY_ACCESS_RO;
+    }
+    for (i = 0; i < out_num; i++) {
+        ranges[in_num + i].base = outvecs[i].base;
+        ranges[in_num + i].len = outvecs[i].len;
+        ranges[in_num + i].access = TFM_MEMORY_ACCESS_RW;
+    }
+    if (tfm_memory_check_ranges(ranges, in_num + out_num, ns_caller,
+                                privileged, client_id) != IPC_SUCCESS) {
+        tfm_core_panic();
     }
 
     /*
      * Clients must never overlap input parameters because of the risk of a
      * double-fetch inconsistency.
-     * Overflow is checked in tfm_memory_check functions.
+     * Overflow is checked in tfm_memory_check_ranges().
      */
     for (i = 0; i + 1 < in_num; i++) {
         for (j = i+1; j < in_num; j++) {
@@ -214,17 +254,6 @@ psa_status_t tfm_spm_client_psa_call(psa_handle_t handle, int32_t type,
         }
     }
 
-    /*
-     * For client output vector, it is a fatal error if the provided payload
-     * memory reference was invalid or not read-write.
-     */
-    for (i = 0; i < out_num; i++) {
-        if (tfm_memory_check(outvecs[i].base, outvecs[i].len,
-            ns_caller, TFM_MEMORY_ACCESS_RW, privileged) != IPC_SUCCESS) {
-            tfm_core_panic();
-        }
-    }
-
     /*
      * FixMe: Need to check if the message is unrecognized by the RoT
      * Service or incorrectly formatted.
@@ -235,7 +264,7 @@ psa_status_t tfm_spm_client_psa_call(psa_handle_t handle, int32_t type,
         tfm_core_panic();
     }
 
-    tfm_spm_fill_msg(msg, service, handle, type, client_id,
+    tfm_spm_fill_msg(msg, service, msg_handle, type, client_id,
                      invecs, in_num, outvecs, out_num, outptr);
 
     /*
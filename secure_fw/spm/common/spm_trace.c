@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include "tfm_hal_device_header.h"
+#include "tfm_spm_trace.h"
+
+struct tfm_spm_trace_buf_t tfm_spm_trace_buf = {
+    .magic       = TFM_SPM_TRACE_MAGIC,
+    .version     = TFM_SPM_TRACE_VERSION,
+    .record_size = sizeof(struct tfm_spm_trace_record_t),
+    .nr_records  = TFM_SPM_TRACE_NR_RECORDS,
+};
+
+/*
+ * Cores without a DWT cycle counter record a zero timestamp. The records are
+ * still ordered by their position.
+ */
+__STATIC_FORCEINLINE uint32_t trace_get_timestamp(void)
+{
+#ifdef DWT_CTRL_CYCCNTENA_Msk
+    return DWT->CYCCNT;
+#else
+    return 0;
+#endif
+}
+
+/*
+ * Claim the next record position. Higher priority SPM handlers can preempt the
+ * claim, so it is made with exclusive access, or by briefly masking interrupts
+ * on cores without exclusive access instructions.
+ */
+__STATIC_FORCEINLINE uint32_t trace_claim_pos(void)
+{
+#if defined(__ARM_FEATURE_LDREX) && (__ARM_FEATURE_LDREX & 0x4)
+    uint32_t pos;
+
+    do {
+        pos = __LDREXW(&tfm_spm_trace_buf.pos);
+    } while (__STREXW(pos + 1, &tfm_spm_trace_buf.pos) != 0U);
+
+    return pos;
+#else
+    uint32_t primask = __get_PRIMASK();
+    uint32_t pos;
+
+    __disable_irq();
+    pos = tfm_spm_trace_buf.pos;
+    tfm_spm_trace_buf.pos = pos + 1;
+    __set_PRIMASK(primask);
+
+    return pos;
+#endif
+}
+
+void tfm_spm_trace_init(void)
+{
+#ifdef DWT_CTRL_CYCCNTENA_Msk
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+void tfm_spm_trace_record(uint16_t event, uint32_t arg0, uint32_t arg1)
+{
+    uint32_t timestamp = trace_get_timestamp();
+    uint32_t pos = trace_claim_pos();
+    struct tfm_spm_trace_record_t *record =
+               &tfm_spm_trace_buf.records[pos & (TFM_SPM_TRACE_NR_RECORDS - 1)];
+
+    /*
+     * Invalidate the record first, so that a record interrupted while being
+     * written is discarded by the decoder.
+     */
+    record->seq = (uint16_t)(pos - 1);
+    record->timestamp = timestamp;
+    record->event = event;
+    record->arg0 = arg0;
+    record->arg1 = arg1;
+    record->seq = (uint16_t)pos;
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_SPM_TRACE_H__
+#define __TFM_SPM_TRACE_H__
+
+#include <stdint.h>
+
+/*
+ * The SPM trace events. The meaning of the two arguments of each event is
+ * listed after the event. Keep in sync with tools/spm_trace_decode.py.
+ */
+#define TFM_SPM_TRACE_EVT_CONNECT_ENTER   1  /* SID, version */
+#define TFM_SPM_TRACE_EVT_CONNECT_EXIT    2  /* Status, 0 */
+#define TFM_SPM_TRACE_EVT_CALL_ENTER      3  /* Handle, type */
+#define TFM_SPM_TRACE_EVT_CALL_EXIT       4  /* Status, 0 */
+#define TFM_SPM_TRACE_EVT_REPLY_ENTER     5  /* Message handle, status */
+#define TFM_SPM_TRACE_EVT_REPLY_EXIT      6  /* Message handle, 0 */
+#define TFM_SPM_TRACE_EVT_SWITCH          7  /* Current and next partition ID */
+#define TFM_SPM_TRACE_EVT_IRQ             8  /* Partition ID, signal */
+#define TFM_SPM_TRACE_EVT_MAILBOX         9  /* Call type, client ID */
+
+/* The magic number at the start of the trace buffer, "TRCE" */
+#define TFM_SPM_TRACE_MAGIC               0x45435254U
+/* The version of the trace buffer layout */
+#define TFM_SPM_TRACE_VERSION             1U
+
+/* The number of records in the trace ring. It must be a power of 2. */
+#ifndef TFM_SPM_TRACE_NR_RECORDS
+#define TFM_SPM_TRACE_NR_RECORDS          512
+#endif
+
+#if ((TFM_SPM_TRACE_NR_RECORDS & (TFM_SPM_TRACE_NR_RECORDS - 1)) != 0)
+#error "TFM_SPM_TRACE_NR_RECORDS should be a power of 2!"
+#endif
+
+/* A single trace record */
+struct tfm_spm_trace_record_t {
+    uint32_t timestamp;           /* Cycle count when the event occurred */
+    uint16_t event;               /* TFM_SPM_TRACE_EVT_* */
+    uint16_t seq;                 /*
+                                   * Low 16 bits of the record position,
+                                   * written last to validate the record
+                                   */
+    uint32_t arg0;
+    uint32_t arg1;
+};
+
+/*
+ * The trace ring in RAM. It is dumped as a whole and parsed on the host by
+ * tools/spm_trace_decode.py.
+ */
+struct tfm_spm_trace_buf_t {
+    uint32_t magic;               /* TFM_SPM_TRACE_MAGIC */
+    uint16_t version;             /* TFM_SPM_TRACE_VERSION */
+    uint16_t record_size;         /* Size of a record in bytes */
+    uint32_t nr_records;          /* Number of records in the ring */
+    volatile uint32_t pos;        /* Number of records claimed so far */
+    struct tfm_spm_trace_record_t records[TFM_SPM_TRACE_NR_RECORDS];
+};
+
+#ifdef TFM_SPM_TRACE
+#define SPMTRACE_INIT()                 tfm_spm_trace_init()
+#define SPMTRACE(event, arg0, arg1)     tfm_spm_trace_record(event,           \
+                                                             (uint32_t)(arg0), \
+                                                             (uint32_t)(arg1))
+#else
+#define SPMTRACE_INIT()
+#define SPMTRACE(event, arg0, arg1)
+#endif
+
+/**
+ * \brief Start the cycle counter used to timestamp the trace records.
+ */
+void tfm_spm_trace_init(void);
+
+/**
+ * \brief Write a record into the SPM trace ring. The oldest record is
+ *        overwritten if the ring is full.
+ *
+ * \note This function can be called from any SPM handler, including while it
+ *       preempts another call of this function.
+ *
+ * \param[in] event             The event, TFM_SPM_TRACE_EVT_*
+ * \param[in] arg0              The first argument of the event
+ * \param[in] arg1              The second argument of the event
+ */
+void tfm_spm_trace_record(uint16_t event, uint32_t arg0, uint32_t arg1);
+
+#endif /* __TFM_SPM_TRACE_H__ */
@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Test of the client quotas, the reclaim of idle contexts by their owner and
+ * the utilization counters of the operation context pools of the crypto
+ * service.
+ *
+ * It is built with 7 contexts, one of them reserved for MAC operations and the
+ * others shared, a quota of 2 contexts for non-secure clients, of 1 context
+ * for CLIENT_LIMITED, no quota for the other secure partitions, a reclaim age
+ * of RECLAIM_AGE calls and the counters logged on allocation failures and
+ * reclaims. The backend abort functions count their calls.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "psa/crypto.h"
+#include "tfm_crypto_api.h"
+#include "tfm_crypto_defs.h"
+
+#define CLIENT_S                    5
+#define CLIENT_LIMITED              7
+#define CLIENT_NS                   (-1)
+
+/* Number of shared contexts, all usable by hash operations */
+#define HASH_OPER_NUM               6
+#define NS_QUOTA                    2
+#define RECLAIM_AGE                 16
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+static int32_t caller_id;
+static unsigned int nr_aborts;
+static unsigned int nr_log_msgs;
+
+psa_status_t tfm_crypto_get_caller_id(int32_t *id)
+{
+    *id = caller_id;
+
+    return PSA_SUCCESS;
+}
+
+void host_log_msg(const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+
+    nr_log_msgs++;
+}
+
+psa_status_t psa_cipher_abort(psa_cipher_operation_t *operation)
+{
+    (void)operation;
+    nr_aborts++;
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_mac_abort(psa_mac_operation_t *operation)
+{
+    (void)operation;
+    nr_aborts++;
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_hash_abort(psa_hash_operation_t *operation)
+{
+    (void)operation;
+    nr_aborts++;
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_key_derivation_abort(
+                                    psa_key_derivation_operation_t *operation)
+{
+    (void)operation;
+    nr_aborts++;
+
+    return PSA_SUCCESS;
+}
+
+static void reset(void)
+{
+    CHECK(tfm_crypto_init_alloc() == PSA_SUCCESS);
+    caller_id = CLIENT_S;
+    nr_aborts = 0;
+    nr_log_msgs = 0;
+}
+
+static psa_status_t alloc_hash(int32_t client_id, uint32_t *handle, void **ctx)
+{
+    caller_id = client_id;
+    *handle = TFM_CRYPTO_INVALID_HANDLE;
+
+    return tfm_crypto_operation_alloc(TFM_CRYPTO_HASH_OPERATION, handle, ctx);
+}
+
+static void get_hash_stats(struct tfm_crypto_operation_stats_t *stats)
+{
+    CHECK(tfm_crypto_operation_get_stats(TFM_CRYPTO_HASH_OPERATION, stats) ==
+          PSA_SUCCESS);
+}
+
+static void test_quotas(void)
+{
+    struct tfm_crypto_operation_stats_t stats;
+    uint32_t handle[HASH_OPER_NUM + 1];
+    uint32_t extra;
+    void *ctx;
+    int i;
+
+    reset();
+
+    /* A non-secure client is limited to NS_QUOTA contexts of each type */
+    for (i = 0; i < NS_QUOTA; i++) {
+        CHECK(alloc_hash(CLIENT_NS, &handle[i], &ctx) == PSA_SUCCESS);
+    }
+    CHECK(alloc_hash(CLIENT_NS, &extra, &ctx) == PSA_ERROR_NOT_PERMITTED);
+    CHECK(nr_log_msgs == 1);
+
+    extra = TFM_CRYPTO_INVALID_HANDLE;
+    CHECK(tfm_crypto_operation_alloc(TFM_CRYPTO_MAC_OPERATION, &extra,
+                                     &ctx) == PSA_SUCCESS);
+
+    /* The quota of a specific client overrides the default one */
+    CHECK(alloc_hash(CLIENT_LIMITED, &handle[i++], &ctx) == PSA_SUCCESS);
+    CHECK(alloc_hash(CLIENT_LIMITED, &extra, &ctx) ==
+          PSA_ERROR_NOT_PERMITTED);
+    CHECK(nr_log_msgs == 2);
+
+    /* Other secure partitions have no quota, up to the size of the pool */
+    for (; i < HASH_OPER_NUM; i++) {
+        CHECK(alloc_hash(CLIENT_S, &handle[i], &ctx) == PSA_SUCCESS);
+    }
+    CHECK(alloc_hash(CLIENT_S, &extra, &ctx) == PSA_ERROR_NOT_PERMITTED);
+    CHECK(nr_log_msgs == 3);
+
+    get_hash_stats(&stats);
+    CHECK(stats.num == HASH_OPER_NUM);
+    CHECK(stats.in_use == HASH_OPER_NUM);
+    CHECK(stats.peak_in_use == HASH_OPER_NUM);
+    CHECK(stats.nr_alloc == HASH_OPER_NUM);
+    CHECK(stats.nr_exhausted == 1);
+    CHECK(stats.nr_over_quota == 2);
+    CHECK(stats.nr_reclaimed == 0);
+    CHECK(nr_aborts == 0);
+}
+
+static void test_reclaim_idle(void)
+{
+    struct tfm_crypto_operation_stats_t stats;
+    uint32_t handle[HASH_OPER_NUM];
+    uint32_t handle_new;
+    void *ctx[HASH_OPER_NUM];
+    void *ctx_new, *found;
+    int i, round;
+
+    reset();
+
+    for (i = 0; i < HASH_OPER_NUM; i++) {
+        CHECK(alloc_hash(CLIENT_S, &handle[i], &ctx[i]) == PSA_SUCCESS);
+    }
+
+    /* No context has been idle for long enough yet */
+    CHECK(alloc_hash(CLIENT_S, &handle_new, &ctx_new) ==
+          PSA_ERROR_NOT_PERMITTED);
+
+    /* Keep using all the contexts but the first one */
+    for (round = 0; round < RECLAIM_AGE; round++) {
+        i = 1 + (round % (HASH_OPER_NUM - 1));
+        CHECK(tfm_crypto_operation_lookup(TFM_CRYPTO_HASH_OPERATION,
+                                          handle[i], &found) == PSA_SUCCESS);
+    }
+
+    /* The idle context is aborted and given to the new operation */
+    CHECK(alloc_hash(CLIENT_S, &handle_new, &ctx_new) == PSA_SUCCESS);
+    CHECK(ctx_new == ctx[0]);
+    CHECK(nr_aborts == 1);
+
+    /* The handle of the previous owner is stale */
+    CHECK(tfm_crypto_operation_lookup(TFM_CRYPTO_HASH_OPERATION, handle[0],
+                                      &found) == PSA_ERROR_BAD_STATE);
+    CHECK(tfm_crypto_operation_release(&handle[0]) ==
+          PSA_ERROR_INVALID_ARGUMENT);
+
+    get_hash_stats(&stats);
+    CHECK(stats.in_use == HASH_OPER_NUM);
+    CHECK(stats.nr_alloc == HASH_OPER_NUM + 1);
+    CHECK(stats.nr_exhausted == 1);
+    CHECK(stats.nr_reclaimed == 1);
+
+    /* One message for the exhausted pool, one for the reclaim */
+    CHECK(nr_log_msgs == 2);
+
+    CHECK(tfm_crypto_operation_release(&handle_new) == PSA_SUCCESS);
+    get_hash_stats(&stats);
+    CHECK(stats.in_use == HASH_OPER_NUM - 1);
+    CHECK(stats.peak_in_use == HASH_OPER_NUM);
+}
+
+static psa_status_t lookup_hash(int32_t client_id, uint32_t handle)
+{
+    void *found;
+
+    caller_id = client_id;
+
+    return tfm_crypto_operation_lookup(TFM_CRYPTO_HASH_OPERATION, handle,
+                                       &found);
+}
+
+/*
+ * A client only reclaims its own idle contexts, even if the contexts of
+ * another client have been idle for longer.
+ */
+static void test_reclaim_other_client(void)
+{
+    struct tfm_crypto_operation_stats_t stats;
+    uint32_t handle[HASH_OPER_NUM];
+    uint32_t handle_new;
+    void *ctx[HASH_OPER_NUM];
+    void *ctx_new;
+    int i, round;
+
+    reset();
+
+    for (i = 0; i < NS_QUOTA; i++) {
+        CHECK(alloc_hash(CLIENT_NS, &handle[i], &ctx[i]) == PSA_SUCCESS);
+    }
+    for (; i < HASH_OPER_NUM; i++) {
+        CHECK(alloc_hash(CLIENT_S, &handle[i], &ctx[i]) == PSA_SUCCESS);
+    }
+
+    /* Only the contexts of the non-secure client become idle */
+    for (round = 0; round < RECLAIM_AGE; round++) {
+        i = NS_QUOTA + (round % (HASH_OPER_NUM - NS_QUOTA));
+        CHECK(lookup_hash(CLIENT_S, handle[i]) == PSA_SUCCESS);
+    }
+
+    CHECK(alloc_hash(CLIENT_S, &handle_new, &ctx_new) ==
+          PSA_ERROR_NOT_PERMITTED);
+    CHECK(nr_aborts == 0);
+    for (i = 0; i < NS_QUOTA; i++) {
+        CHECK(lookup_hash(CLIENT_NS, handle[i]) == PSA_SUCCESS);
+    }
+
+    /* Let a context of the secure client become idle too */
+    for (round = 0; round < RECLAIM_AGE; round++) {
+        i = NS_QUOTA + 1 + (round % (HASH_OPER_NUM - NS_QUOTA - 1));
+        CHECK(lookup_hash(CLIENT_S, handle[i]) == PSA_SUCCESS);
+    }
+
+    /* The idle context of the client is reclaimed, not the older ones */
+    CHECK(alloc_hash(CLIENT_S, &handle_new, &ctx_new) == PSA_SUCCESS);
+    CHECK(ctx_new == ctx[NS_QUOTA]);
+    CHECK(nr_aborts == 1);
+    CHECK(lookup_hash(CLIENT_S, handle[NS_QUOTA]) == PSA_ERROR_BAD_STATE);
+    for (i = 0; i < NS_QUOTA; i++) {
+        CHECK(lookup_hash(CLIENT_NS, handle[i]) == PSA_SUCCESS);
+    }
+
+    get_hash_stats(&stats);
+    CHECK(stats.nr_exhausted == 1);
+    CHECK(stats.nr_reclaimed == 1);
+}
+
+static void test_stats_invalid_type(void)
+{
+    struct tfm_crypto_operation_stats_t stats;
+
+    reset();
+
+    CHECK(tfm_crypto_operation_get_stats(TFM_CRYPTO_OPERATION_NONE,
+                                         &stats) ==
+          PSA_ERROR_INVALID_ARGUMENT);
+    CHECK(tfm_crypto_operation_get_stats(TFM_CRYPTO_HASH_OPERATION, NULL) ==
+          PSA_ERROR_INVALID_ARGUMENT);
+}
+
+int main(void)
+{
+    test_quotas();
+    test_reclaim_idle();
+    test_reclaim_other_client();
+    test_stats_invalid_type();
+
+    printf("PASS\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Test of the operation context pools of the crypto service. It is built once
+ * with the default configuration, where all the contexts are shared, and once
+ * with contexts reserved for some types.
+ *
+ * tfm_crypto_get_caller_id() returns the client set by the test, so that the
+ * ownership checks can be exercised.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "psa/crypto.h"
+#include "tfm_crypto_api.h"
+#include "tfm_crypto_defs.h"
+
+#define CLIENT_A                    5
+#define CLIENT_B                    6
+
+/* The configuration of the pools, as in crypto_alloc.c */
+#ifndef TFM_CRYPTO_CONC_OPER_NUM
+#define TFM_CRYPTO_CONC_OPER_NUM            8
+#endif
+#ifndef TFM_CRYPTO_CIPHER_OPER_NUM
+#define TFM_CRYPTO_CIPHER_OPER_NUM          0
+#endif
+#ifndef TFM_CRYPTO_MAC_OPER_NUM
+#define TFM_CRYPTO_MAC_OPER_NUM             0
+#endif
+#ifndef TFM_CRYPTO_HASH_OPER_NUM
+#define TFM_CRYPTO_HASH_OPER_NUM            0
+#endif
+#ifndef TFM_CRYPTO_KEY_DERIVATION_OPER_NUM
+#define TFM_CRYPTO_KEY_DERIVATION_OPER_NUM  0
+#endif
+
+#define SHARED_OPER_NUM  (TFM_CRYPTO_CONC_OPER_NUM -                        \
+                          TFM_CRYPTO_CIPHER_OPER_NUM -                      \
+                          TFM_CRYPTO_MAC_OPER_NUM -                         \
+                          TFM_CRYPTO_HASH_OPER_NUM -                        \
+                          TFM_CRYPTO_KEY_DERIVATION_OPER_NUM)
+
+/* Number of concurrent hash operations opened by the tests */
+#define HASH_OPER_NUM               3
+
+/* Position of the operation type in a handle */
+#define HANDLE_TYPE_SHIFT           24
+
+#define NR_CHURN_CYCLES             200000
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+static int32_t caller_id;
+
+psa_status_t tfm_crypto_get_caller_id(int32_t *id)
+{
+    *id = caller_id;
+
+    return PSA_SUCCESS;
+}
+
+static void reset(void)
+{
+    CHECK(tfm_crypto_init_alloc() == PSA_SUCCESS);
+    caller_id = CLIENT_A;
+}
+
+static size_t ctx_size(enum tfm_crypto_operation_type type)
+{
+    switch (type) {
+    case TFM_CRYPTO_CIPHER_OPERATION:
+        return sizeof(psa_cipher_operation_t);
+    case TFM_CRYPTO_MAC_OPERATION:
+        return sizeof(psa_mac_operation_t);
+    case TFM_CRYPTO_HASH_OPERATION:
+        return sizeof(psa_hash_operation_t);
+    default:
+        return sizeof(psa_key_derivation_operation_t);
+    }
+}
+
+static uint32_t reserved_num(enum tfm_crypto_operation_type type)
+{
+    switch (type) {
+    case TFM_CRYPTO_CIPHER_OPERATION:
+        return TFM_CRYPTO_CIPHER_OPER_NUM;
+    case TFM_CRYPTO_MAC_OPERATION:
+        return TFM_CRYPTO_MAC_OPER_NUM;
+    case TFM_CRYPTO_HASH_OPERATION:
+        return TFM_CRYPTO_HASH_OPER_NUM;
+    default:
+        return TFM_CRYPTO_KEY_DERIVATION_OPER_NUM;
+    }
+}
+
+static void check_capacity(enum tfm_crypto_operation_type type)
+{
+    struct tfm_crypto_operation_stats_t stats;
+    uint32_t handle[TFM_CRYPTO_CONC_OPER_NUM] = {0};
+    uint32_t num = reserved_num(type) + SHARED_OPER_NUM;
+    uint32_t extra = TFM_CRYPTO_INVALID_HANDLE;
+    void *ctx;
+    uint32_t i;
+
+    reset();
+
+    CHECK(tfm_crypto_operation_get_stats(type, &stats) == PSA_SUCCESS);
+    CHECK(stats.num == num);
+
+    for (i = 0; i < num; i++) {
+        CHECK(tfm_crypto_operation_alloc(type, &handle[i], &ctx) ==
+              PSA_SUCCESS);
+    }
+    CHECK(tfm_crypto_operation_alloc(type, &extra, &ctx) ==
+          PSA_ERROR_NOT_PERMITTED);
+    CHECK(extra == TFM_CRYPTO_INVALID_HANDLE);
+
+    /* The contexts reserved for the type are used before the shared ones */
+    CHECK(tfm_crypto_operation_get_stats(type, &stats) == PSA_SUCCESS);
+    CHECK(stats.in_use == num);
+    CHECK(stats.nr_borrowed == SHARED_OPER_NUM);
+    CHECK(stats.nr_exhausted == 1);
+}
+
+static void test_capacity(void)
+{
+    /* With no other operation in progress, a type can use all its reserved
+     * contexts and all the shared ones.
+     */
+    check_capacity(TFM_CRYPTO_CIPHER_OPERATION);
+    check_capacity(TFM_CRYPTO_MAC_OPERATION);
+    check_capacity(TFM_CRYPTO_HASH_OPERATION);
+    check_capacity(TFM_CRYPTO_KEY_DERIVATION_OPERATION);
+}
+
+static void test_borrow_shared(void)
+{
+    uint32_t handle[TFM_CRYPTO_CONC_OPER_NUM] = {0};
+    uint32_t cipher[TFM_CRYPTO_CONC_OPER_NUM] = {0};
+    uint32_t num = TFM_CRYPTO_HASH_OPER_NUM + SHARED_OPER_NUM;
+    uint32_t cipher_num = TFM_CRYPTO_CIPHER_OPER_NUM;
+    uint32_t i;
+    void *ctx;
+
+    reset();
+
+    /* Hash operations take the shared contexts after their reserved ones */
+    for (i = 0; i < num; i++) {
+        CHECK(tfm_crypto_operation_alloc(TFM_CRYPTO_HASH_OPERATION,
+                                         &handle[i], &ctx) == PSA_SUCCESS);
+    }
+
+    /* Only the contexts reserved for cipher operations are left to them */
+    for (i = 0; i < cipher_num; i++) {
+        CHECK(tfm_crypto_operation_alloc(TFM_CRYPTO_CIPHER_OPERATION,
+                                         &cipher[i], &ctx) == PSA_SUCCESS);
+    }
+    CHECK(tfm_crypto_operation_alloc(TFM_CRYPTO_CIPHER_OPERATION, &cipher[i],
+                                     &ctx) == PSA_ERROR_NOT_PERMITTED);
+
+    /* A shared context given back by a hash operation can be borrowed */
+    CHECK(tfm_crypto_operation_release(&handle[num - 1]) == PSA_SUCCESS);
+    CHECK(tfm_crypto_operation_alloc(TFM_CRYPTO_CIPHER_OPERATION, &cipher[i],
+                                     &ctx) == PSA_SUCCESS);
+    CHECK(tfm_crypto_operation_alloc(TFM_CRYPTO_HASH_OPERATION,
+                                     &handle[num - 1], &ctx) ==
+          PSA_ERROR_NOT_PERMITTED);
+}
+
+static void test_shared_handle_type(void)
+{
+    uint32_t handle[TFM_CRYPTO_CONC_OPER_NUM] = {0};
+    uint32_t num = TFM_CRYPTO_HASH_OPER_NUM + 1;
+    uint32_t forged;
+    void *ctx, *found;
+    uint32_t i;
+
+    reset();
+
+    /* The last context allocated is a shared one */
+    for (i = 0; i < num; i++) {
+        CHECK(tfm_crypto_operation_alloc(TFM_CRYPTO_HASH_OPERATION,
+                                         &handle[i], &ctx) == PSA_SUCCESS);
+    }
+
+    /* A shared context is only found under the type it was allocated for */
+    forged = (handle[num - 1] & ~(0x7Fu << HANDLE_TYPE_SHIFT)) |
+             ((uint32_t)TFM_CRYPTO_MAC_OPERATION << HANDLE_TYPE_SHIFT);
+    CHECK(tfm_crypto_operation_lookup(TFM_CRYPTO_MAC_OPERATION, forged,
+                                      &found) == PSA_ERROR_BAD_STATE);
+    CHECK(tfm_crypto_operation_release(&forged) ==
+          PSA_ERROR_INVALID_ARGUMENT);
+
+    CHECK(tfm_crypto_operation_lookup(TFM_CRYPTO_HASH_OPERATION,
+                                      handle[num - 1], &found) == PSA_SUCCESS);
+    CHECK(found == ctx);
+}
+
+static void test_alloc_lookup_release(void)
+{
+    uint32_t handle[HASH_OPER_NUM] = {0};
+    void *ctx[HASH_OPER_NUM];
+    uint32_t other;
+    void *found;
+    size_t i, j;
+
+    reset();
+
+    for (i = 0; i < HASH_OPER_NUM; i++) {
+        CHECK(tfm_crypto_operation_alloc(TFM_CRYPTO_HASH_OPERATION,
+                                         &handle[i], &ctx[i]) == PSA_SUCCESS);
+        CHECK(handle[i] != TFM_CRYPTO_INVALID_HANDLE);
+        for (j = 0; j < i; j++) {
+            CHECK(handle[i] != handle[j]);
+            CHECK(ctx[i] != ctx[j]);
+        }
+        memset(ctx[i], 0xAA, ctx_size(TFM_CRYPTO_HASH_OPERATION));
+    }
+
+    /* The handle of another type does not take from the hash pool */
+    other = TFM_CRYPTO_INVALID_HANDLE;
+    CHECK(tfm_crypto_operation_alloc(TFM_CRYPTO_MAC_OPERATION, &other,
+                                     &found) == PSA_SUCCESS);
+    CHECK(tfm_crypto_operation_lookup(TFM_CRYPTO_HASH_OPERATION, other,
+                                      &found) == PSA_ERROR_BAD_STATE);
+
+    CHECK(tfm_crypto_operation_lookup(TFM_CRYPTO_HASH_OPERATION, handle[1],
+                                      &found) == PSA_SUCCESS);
+    CHECK(found == ctx[1]);
+    CHECK(tfm_crypto_operation_lookup(TFM_CRYPTO_MAC_OPERATION, handle[1],
+                                      &found) == PSA_ERROR_BAD_STATE);
+
+    /* Another client can neither use nor release the context */
+    caller_id = CLIENT_B;
+    CHECK(tfm_crypto_operation_lookup(TFM_CRYPTO_HASH_OPERATION, handle[1],
+                                      &found) == PSA_ERROR_BAD_STATE);
+    other = handle[1];
+    CHECK(tfm_crypto_operation_release(&other) ==
+          PSA_ERROR_INVALID_ARGUMENT);
+    CHECK(other == handle[1]);
+    caller_id = CLIENT_A;
+
+    /* A released context is cleared */
+    CHECK(tfm_crypto_operation_release(&handle[1]) == PSA_SUCCESS);
+    CHECK(handle[1] == TFM_CRYPTO_INVALID_HANDLE);
+    for (j = 0; j < ctx_size(TFM_CRYPTO_HASH_OPERATION); j++) {
+        CHECK(((uint8_t *)ctx[1])[j] == 0);
+    }
+
+    /* A handle must be invalid before the allocation */
+    other = handle[0];
+    CHECK(tfm_crypto_operation_alloc(TFM_CRYPTO_HASH_OPERATION, &other,
+                                     &found) == PSA_ERROR_BAD_STATE);
+
+    other = TFM_CRYPTO_INVALID_HANDLE;
+    CHECK(tfm_crypto_operation_alloc(TFM_CRYPTO_OPERATION_NONE, &other,
+                                     &found) == PSA_ERROR_NOT_PERMITTED);
+    CHECK(tfm_crypto_operation_lookup(TFM_CRYPTO_HASH_OPERATION,
+                                      TFM_CRYPTO_INVALID_HANDLE,
+                                      &found) == PSA_ERROR_BAD_STATE);
+}
+
+static void test_stale_handle(void)
+{
+    uint32_t handle = TFM_CRYPTO_INVALID_HANDLE;
+    uint32_t stale;
+    void *ctx, *found;
+
+    reset();
+
+    CHECK(tfm_crypto_operation_alloc(TFM_CRYPTO_CIPHER_OPERATION, &handle,
+                                     &ctx) == PSA_SUCCESS);
+    stale = handle;
+    CHECK(tfm_crypto_operation_release(&handle) == PSA_SUCCESS);
+
+    /* The context is allocated again, under a new handle */
+    CHECK(tfm_crypto_operation_alloc(TFM_CRYPTO_CIPHER_OPERATION, &handle,
+                                     &found) == PSA_SUCCESS);
+    CHECK(found == ctx);
+    CHECK(handle != stale);
+
+    CHECK(tfm_crypto_operation_lookup(TFM_CRYPTO_CIPHER_OPERATION, stale,
+                                      &found) == PSA_ERROR_BAD_STATE);
+    CHECK(tfm_crypto_operation_release(&stale) ==
+          PSA_ERROR_INVALID_ARGUMENT);
+    CHECK(tfm_crypto_operation_lookup(TFM_CRYPTO_CIPHER_OPERATION, handle,
+                                      &found) == PSA_SUCCESS);
+}
+
+static void test_churn(void)
+{
+    struct tfm_crypto_operation_stats_t stats;
+    uint32_t handle[HASH_OPER_NUM] = {0};
+    void *ctx;
+    uint32_t i;
+
+    reset();
+
+    for (i = 0; i < HASH_OPER_NUM; i++) {
+        CHECK(tfm_crypto_operation_alloc(TFM_CRYPTO_HASH_OPERATION,
+                                         &handle[i], &ctx) == PSA_SUCCESS);
+    }
+
+    /* Enough cycles for the generation of each context to wrap around */
+    for (i = 0; i < NR_CHURN_CYCLES; i++) {
+        CHECK(tfm_crypto_operation_release(&handle[i % HASH_OPER_NUM]) ==
+              PSA_SUCCESS);
+        CHECK(tfm_crypto_operation_alloc(TFM_CRYPTO_HASH_OPERATION,
+                                         &handle[i % HASH_OPER_NUM],
+                                         &ctx) == PSA_SUCCESS);
+    }
+
+    CHECK(tfm_crypto_operation_get_stats(TFM_CRYPTO_HASH_OPERATION,
+                                         &stats) == PSA_SUCCESS);
+    CHECK(stats.in_use == HASH_OPER_NUM);
+    CHECK(stats.peak_in_use == HASH_OPER_NUM);
+    CHECK(stats.nr_alloc == HASH_OPER_NUM + NR_CHURN_CYCLES);
+    CHECK(stats.nr_exhausted == 0);
+}
+
+int main(void)
+{
+    test_capacity();
+    test_borrow_shared();
+    test_shared_handle_type();
+    test_alloc_lookup_release();
+    test_stale_handle();
+    test_churn();
+
+    printf("PASS\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,364 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Test of psa_batch_update() through the IPC client interface and the batch
+ * handler of the service.
+ *
+ * psa_call() is replaced by a model of tfm_crypto_call_sfn(), which copies
+ * every vector but the first into a scratch buffer of
+ * TFM_CRYPTO_IOVEC_BUFFER_SIZE bytes, and fails the request with
+ * PSA_ERROR_INSUFFICIENT_MEMORY if they do not fit. The single update handlers
+ * record the data of each operation, and cipher updates echo their input.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "psa/client.h"
+#include "psa/crypto.h"
+#include "tfm_crypto_api.h"
+#include "tfm_crypto_defs.h"
+
+#define ALIGN4(x)                   (((x) + 3u) & ~3u)
+
+#define NR_OPERATIONS               24
+#define MAX_OPERATION_DATA          8192
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+/* The data passed to each operation, indexed by operation handle */
+static uint8_t op_data[NR_OPERATIONS][MAX_OPERATION_DATA];
+static size_t op_data_len[NR_OPERATIONS];
+
+/* The update on this operation handle fails */
+static uint32_t failing_handle;
+
+static unsigned int nr_requests;
+static size_t max_scratch_used;
+
+static uint8_t input[16384];
+static uint8_t output[16384];
+
+static psa_status_t stub_update(psa_invec in_vec[], psa_outvec out_vec[],
+                                size_t out_len)
+{
+    const struct tfm_crypto_pack_iovec *iov = in_vec[0].base;
+    uint32_t handle = iov->op_handle;
+    size_t len;
+
+    CHECK((handle > 0) && (handle < NR_OPERATIONS));
+
+    if (handle == failing_handle) {
+        /* The operation is aborted, and its handle released */
+        *(uint32_t *)out_vec[0].base = 0;
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    *(uint32_t *)out_vec[0].base = handle;
+
+    CHECK(op_data_len[handle] + in_vec[1].len <= MAX_OPERATION_DATA);
+    memcpy(&op_data[handle][op_data_len[handle]], in_vec[1].base,
+           in_vec[1].len);
+    op_data_len[handle] += in_vec[1].len;
+
+    if (out_len > 1) {
+        len = (in_vec[1].len < out_vec[1].len) ? in_vec[1].len :
+                                                 out_vec[1].len;
+        memcpy(out_vec[1].base, in_vec[1].base, len);
+        out_vec[1].len = len;
+    }
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t tfm_crypto_hash_update(psa_invec in_vec[], size_t in_len,
+                                    psa_outvec out_vec[], size_t out_len)
+{
+    CHECK((in_len == 2) && (out_len == 1));
+
+    return stub_update(in_vec, out_vec, out_len);
+}
+
+psa_status_t tfm_crypto_mac_update(psa_invec in_vec[], size_t in_len,
+                                   psa_outvec out_vec[], size_t out_len)
+{
+    CHECK((in_len == 2) && (out_len == 1));
+
+    return stub_update(in_vec, out_vec, out_len);
+}
+
+psa_status_t tfm_crypto_cipher_update(psa_invec in_vec[], size_t in_len,
+                                      psa_outvec out_vec[], size_t out_len)
+{
+    CHECK((in_len == 2) && (out_len == 2));
+
+    return stub_update(in_vec, out_vec, out_len);
+}
+
+psa_status_t psa_call(psa_handle_t handle, int32_t type,
+                      const psa_invec *in_vec, size_t in_len,
+                      psa_outvec *out_vec, size_t out_len)
+{
+    static uint8_t scratch[TFM_CRYPTO_IOVEC_BUFFER_SIZE]
+                                            __attribute__((__aligned__(4)));
+    const struct tfm_crypto_pack_iovec *iov = in_vec[0].base;
+    psa_invec in[PSA_MAX_IOVEC];
+    psa_outvec out[PSA_MAX_IOVEC];
+    psa_status_t status;
+    size_t used = 0, i;
+
+    (void)handle;
+    (void)type;
+
+    CHECK(iov->sfn_id == TFM_CRYPTO_BATCH_UPDATE_SID);
+    nr_requests++;
+
+    while ((in_len > 0) && (in_vec[in_len - 1].len == 0)) {
+        in_len--;
+    }
+    while ((out_len > 0) && (out_vec[out_len - 1].len == 0)) {
+        out_len--;
+    }
+
+    /* The packed IOVec is read apart from the scratch */
+    in[0] = in_vec[0];
+    for (i = 1; i < in_len; i++) {
+        if (ALIGN4(in_vec[i].len) > sizeof(scratch) - used) {
+            return PSA_ERROR_INSUFFICIENT_MEMORY;
+        }
+        memcpy(&scratch[used], in_vec[i].base, in_vec[i].len);
+        in[i].base = &scratch[used];
+        in[i].len = in_vec[i].len;
+        used += ALIGN4(in_vec[i].len);
+    }
+    for (i = 0; i < out_len; i++) {
+        if (ALIGN4(out_vec[i].len) > sizeof(scratch) - used) {
+            return PSA_ERROR_INSUFFICIENT_MEMORY;
+        }
+        out[i].base = &scratch[used];
+        out[i].len = out_vec[i].len;
+        used += ALIGN4(out_vec[i].len);
+    }
+    if (used > max_scratch_used) {
+        max_scratch_used = used;
+    }
+
+    status = tfm_crypto_batch_update(in, in_len, out, out_len);
+
+    for (i = 0; i < out_len; i++) {
+        memcpy(out_vec[i].base, out[i].base, out[i].len);
+        out_vec[i].len = out[i].len;
+    }
+
+    return status;
+}
+
+static void reset(void)
+{
+    memset(op_data_len, 0, sizeof(op_data_len));
+    memset(output, 0, sizeof(output));
+    failing_handle = 0;
+    nr_requests = 0;
+}
+
+/* Check that the operation received the given part of the input */
+static void check_op_data(uint32_t handle, size_t offset, size_t len)
+{
+    CHECK(op_data_len[handle] == len);
+    CHECK(memcmp(op_data[handle], &input[offset], len) == 0);
+}
+
+/* Hash updates of 1 KiB each add up to more than the scratch buffer */
+static void test_hash_batch_above_scratch(void)
+{
+    psa_hash_operation_t ops[8];
+    psa_batch_entry_t entries[8];
+    size_t i;
+
+    reset();
+    for (i = 0; i < 8; i++) {
+        ops[i].handle = i + 1;
+        entries[i].type = PSA_BATCH_HASH_UPDATE;
+        entries[i].operation.hash = &ops[i];
+        entries[i].input_length = 1024;
+        entries[i].output_size = 0;
+    }
+
+    CHECK(8 * 1024 > TFM_CRYPTO_IOVEC_BUFFER_SIZE);
+    CHECK(psa_batch_update(entries, 8, input, 8 * 1024, NULL, 0) ==
+          PSA_SUCCESS);
+    CHECK(nr_requests ==
+          (8 * 1024 + TFM_CRYPTO_BATCH_MAX_PAYLOAD - 1) /
+          TFM_CRYPTO_BATCH_MAX_PAYLOAD);
+
+    for (i = 0; i < 8; i++) {
+        CHECK(entries[i].status == PSA_SUCCESS);
+        CHECK(ops[i].handle == i + 1);
+        check_op_data(i + 1, i * 1024, 1024);
+    }
+}
+
+/* Cipher updates count both their input and their output */
+static void test_cipher_batch_above_scratch(void)
+{
+    psa_cipher_operation_t ops[6];
+    psa_batch_entry_t entries[6];
+    size_t i;
+
+    reset();
+    for (i = 0; i < 6; i++) {
+        ops[i].handle = i + 1;
+        entries[i].type = PSA_BATCH_CIPHER_UPDATE;
+        entries[i].operation.cipher = &ops[i];
+        entries[i].input_length = 1024;
+        entries[i].output_size = 1024;
+    }
+
+    CHECK(psa_batch_update(entries, 6, input, 6 * 1024,
+                           output, 6 * 1024) == PSA_SUCCESS);
+    CHECK(nr_requests == 3);
+
+    for (i = 0; i < 6; i++) {
+        CHECK(entries[i].status == PSA_SUCCESS);
+        CHECK(entries[i].output_length == 1024);
+        check_op_data(i + 1, i * 1024, 1024);
+    }
+    CHECK(memcmp(output, input, 6 * 1024) == 0);
+}
+
+/* Small updates are split at TFM_CRYPTO_BATCH_MAX_ENTRIES */
+static void test_entry_count_split(void)
+{
+    psa_mac_operation_t ops[20];
+    psa_batch_entry_t entries[20];
+    size_t i;
+
+    reset();
+    for (i = 0; i < 20; i++) {
+        ops[i].handle = i + 1;
+        entries[i].type = PSA_BATCH_MAC_UPDATE;
+        entries[i].operation.mac = &ops[i];
+        entries[i].input_length = 5;
+        entries[i].output_size = 0;
+    }
+
+    CHECK(psa_batch_update(entries, 20, input, 100, NULL, 0) == PSA_SUCCESS);
+    CHECK(nr_requests ==
+          (20 + TFM_CRYPTO_BATCH_MAX_ENTRIES - 1) /
+          TFM_CRYPTO_BATCH_MAX_ENTRIES);
+
+    for (i = 0; i < 20; i++) {
+        CHECK(entries[i].status == PSA_SUCCESS);
+        check_op_data(i + 1, i * 5, 5);
+    }
+}
+
+/* An entry above the payload limit is sent alone, between the others */
+static void test_large_entry_alone(void)
+{
+    const size_t large = TFM_CRYPTO_BATCH_MAX_PAYLOAD + 256;
+    psa_hash_operation_t ops[3];
+    psa_batch_entry_t entries[3];
+    size_t i;
+
+    reset();
+    for (i = 0; i < 3; i++) {
+        ops[i].handle = i + 1;
+        entries[i].type = PSA_BATCH_HASH_UPDATE;
+        entries[i].operation.hash = &ops[i];
+        entries[i].input_length = (i == 1) ? large : 16;
+        entries[i].output_size = 0;
+    }
+
+    CHECK(psa_batch_update(entries, 3, input, large + 32, NULL, 0) ==
+          PSA_SUCCESS);
+    CHECK(nr_requests == 3);
+
+    check_op_data(1, 0, 16);
+    check_op_data(2, 16, large);
+    check_op_data(3, 16 + large, 16);
+}
+
+/* The whole batch is checked before any entry is run */
+static void test_short_input_rejected(void)
+{
+    psa_hash_operation_t op = {1};
+    psa_batch_entry_t entry = {
+        .type = PSA_BATCH_HASH_UPDATE,
+        .operation.hash = &op,
+        .input_length = 64,
+    };
+
+    reset();
+    CHECK(psa_batch_update(&entry, 1, input, 63, NULL, 0) ==
+          PSA_ERROR_INVALID_ARGUMENT);
+    CHECK(nr_requests == 0);
+}
+
+/* The batch stops at the first failing entry, across groups */
+static void test_failure_stops_batch(void)
+{
+    psa_hash_operation_t ops[12];
+    psa_batch_entry_t entries[12];
+    size_t i;
+
+    reset();
+    for (i = 0; i < 12; i++) {
+        ops[i].handle = i + 1;
+        entries[i].type = PSA_BATCH_HASH_UPDATE;
+        entries[i].operation.hash = &ops[i];
+        entries[i].input_length = 1024;
+        entries[i].output_size = 0;
+    }
+    failing_handle = 6;
+
+    CHECK(psa_batch_update(entries, 12, input, 12 * 1024, NULL, 0) ==
+          PSA_ERROR_INVALID_ARGUMENT);
+    CHECK(nr_requests == 2);
+
+    for (i = 0; i < 5; i++) {
+        CHECK(entries[i].status == PSA_SUCCESS);
+        check_op_data(i + 1, i * 1024, 1024);
+    }
+    CHECK(entries[5].status == PSA_ERROR_INVALID_ARGUMENT);
+    CHECK(ops[5].handle == 0);
+    for (i = 6; i < 12; i++) {
+        CHECK(entries[i].status == PSA_ERROR_BAD_STATE);
+        CHECK(ops[i].handle == i + 1);
+        CHECK(op_data_len[i + 1] == 0);
+    }
+}
+
+int main(void)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(input); i++) {
+        input[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+
+    test_hash_batch_above_scratch();
+    test_cipher_batch_above_scratch();
+    test_entry_count_split();
+    test_large_entry_alone();
+    test_short_input_rejected();
+    test_failure_stops_batch();
+
+    printf("PASS: largest request used %u of %u scratch bytes\n",
+           (unsigned int)max_scratch_used,
+           (unsigned int)TFM_CRYPTO_IOVEC_BUFFER_SIZE);
+
+    return EXIT_SUCCESS;
+}
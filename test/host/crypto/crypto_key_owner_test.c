@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Test of the table of the owners of the key handles of the crypto service.
+ *
+ * It is built with TFM_CRYPTO_MAX_KEY_HANDLES set to MAX_KEY_HANDLES, so that
+ * the table has TABLE_SIZE entries and the home entry of a handle is its
+ * value modulo TABLE_SIZE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "psa/crypto.h"
+#include "tfm_crypto_api.h"
+#include "tfm_crypto_defs.h"
+
+#define MAX_KEY_HANDLES             8
+#define TABLE_SIZE                  (2U * MAX_KEY_HANDLES)
+
+#define CLIENT_A                    5
+#define CLIENT_B                    (-1)
+
+#define CHURN_ROUNDS                20000
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+#if (TFM_CRYPTO_MAX_KEY_HANDLES != MAX_KEY_HANDLES)
+#error "The test must be built with TFM_CRYPTO_MAX_KEY_HANDLES=8"
+#endif
+
+static int32_t caller_id;
+
+psa_status_t tfm_crypto_get_caller_id(int32_t *id)
+{
+    *id = caller_id;
+
+    return PSA_SUCCESS;
+}
+
+static void add_key(int32_t owner, psa_key_handle_t handle)
+{
+    caller_id = owner;
+    CHECK(tfm_crypto_check_key_storage() == PSA_SUCCESS);
+    CHECK(tfm_crypto_set_key_storage(handle) == PSA_SUCCESS);
+}
+
+static psa_status_t find_key(int32_t client, psa_key_handle_t handle,
+                             uint32_t *index)
+{
+    caller_id = client;
+
+    return tfm_crypto_check_handle_owner(handle, index);
+}
+
+static void remove_key(int32_t owner, psa_key_handle_t handle)
+{
+    uint32_t index;
+
+    CHECK(find_key(owner, handle, &index) == PSA_SUCCESS);
+    CHECK(tfm_crypto_release_key_storage(index) == PSA_SUCCESS);
+    CHECK(find_key(owner, handle, &index) == PSA_ERROR_INVALID_HANDLE);
+}
+
+static uint32_t key_index(int32_t owner, psa_key_handle_t handle)
+{
+    uint32_t index;
+
+    CHECK(find_key(owner, handle, &index) == PSA_SUCCESS);
+
+    return index;
+}
+
+static void test_alloc_lookup_release(void)
+{
+    psa_key_handle_t handle;
+    uint32_t index;
+
+    /* Handles of both clients, until the storage is full */
+    for (handle = 1; handle <= MAX_KEY_HANDLES; handle++) {
+        add_key((handle & 1) ? CLIENT_A : CLIENT_B, handle);
+    }
+    CHECK(tfm_crypto_check_key_storage() == PSA_ERROR_INSUFFICIENT_MEMORY);
+
+    /* Each handle is found for its owner only */
+    for (handle = 1; handle <= MAX_KEY_HANDLES; handle++) {
+        CHECK(find_key((handle & 1) ? CLIENT_A : CLIENT_B, handle,
+                       &index) == PSA_SUCCESS);
+        CHECK(find_key((handle & 1) ? CLIENT_B : CLIENT_A, handle,
+                       &index) == PSA_ERROR_NOT_PERMITTED);
+    }
+    CHECK(find_key(CLIENT_A, MAX_KEY_HANDLES + 1, &index) ==
+          PSA_ERROR_INVALID_HANDLE);
+
+    /* A release makes room for another handle */
+    remove_key(CLIENT_B, 2);
+    CHECK(tfm_crypto_check_key_storage() == PSA_SUCCESS);
+
+    /* Free and out of range entries can not be released */
+    CHECK(tfm_crypto_release_key_storage(2) == PSA_ERROR_INVALID_ARGUMENT);
+    CHECK(tfm_crypto_release_key_storage(TABLE_SIZE) ==
+          PSA_ERROR_INVALID_ARGUMENT);
+
+    for (handle = 1; handle <= MAX_KEY_HANDLES; handle++) {
+        if (handle != 2) {
+            remove_key((handle & 1) ? CLIENT_A : CLIENT_B, handle);
+        }
+    }
+}
+
+static void test_stale_handle(void)
+{
+    uint32_t index;
+
+    /* A closed handle is no longer valid */
+    add_key(CLIENT_A, 3);
+    remove_key(CLIENT_A, 3);
+    CHECK(find_key(CLIENT_A, 3, &index) == PSA_ERROR_INVALID_HANDLE);
+
+    /* The backend can give the same handle to another client */
+    add_key(CLIENT_B, 3);
+    CHECK(find_key(CLIENT_A, 3, &index) == PSA_ERROR_NOT_PERMITTED);
+    CHECK(find_key(CLIENT_B, 3, &index) == PSA_SUCCESS);
+
+    remove_key(CLIENT_B, 3);
+}
+
+static void test_remove_shift(void)
+{
+    const uint32_t h = 5;
+
+    /* Three handles with the same home entry, and one with the next home */
+    add_key(CLIENT_A, h);
+    add_key(CLIENT_A, h + TABLE_SIZE);
+    add_key(CLIENT_A, h + 2 * TABLE_SIZE);
+    CHECK(key_index(CLIENT_A, h + 2 * TABLE_SIZE) == h + 2);
+    add_key(CLIENT_A, h + 1);
+    CHECK(key_index(CLIENT_A, h + 1) == h + 3);
+
+    /* The entries of the probe sequence after the removed one move back */
+    remove_key(CLIENT_A, h);
+    CHECK(key_index(CLIENT_A, h + TABLE_SIZE) == h);
+    CHECK(key_index(CLIENT_A, h + 2 * TABLE_SIZE) == h + 1);
+    CHECK(key_index(CLIENT_A, h + 1) == h + 2);
+
+    /* An entry at its home stays there */
+    remove_key(CLIENT_A, h + TABLE_SIZE);
+    remove_key(CLIENT_A, h + 2 * TABLE_SIZE);
+    CHECK(key_index(CLIENT_A, h + 1) == h + 1);
+    add_key(CLIENT_A, h + 2);
+    remove_key(CLIENT_A, h + 1);
+    CHECK(key_index(CLIENT_A, h + 2) == h + 2);
+    remove_key(CLIENT_A, h + 2);
+
+    /* A probe sequence which wraps around the end of the table */
+    add_key(CLIENT_A, TABLE_SIZE - 1);
+    add_key(CLIENT_A, 2 * TABLE_SIZE - 1);
+    add_key(CLIENT_A, TABLE_SIZE);
+    CHECK(key_index(CLIENT_A, 2 * TABLE_SIZE - 1) == 0);
+    CHECK(key_index(CLIENT_A, TABLE_SIZE) == 1);
+
+    remove_key(CLIENT_A, TABLE_SIZE - 1);
+    CHECK(key_index(CLIENT_A, 2 * TABLE_SIZE - 1) == TABLE_SIZE - 1);
+    CHECK(key_index(CLIENT_A, TABLE_SIZE) == 0);
+
+    /* The last entry of the sequence is free again */
+    add_key(CLIENT_A, TABLE_SIZE + 1);
+    CHECK(key_index(CLIENT_A, TABLE_SIZE + 1) == 1);
+
+    remove_key(CLIENT_A, 2 * TABLE_SIZE - 1);
+    remove_key(CLIENT_A, TABLE_SIZE);
+    remove_key(CLIENT_A, TABLE_SIZE + 1);
+    CHECK(tfm_crypto_check_key_storage() == PSA_SUCCESS);
+}
+
+/*
+ * Random opens and closes of handles given in sequence, as by the backend,
+ * checked against a model of the open handles after every operation.
+ */
+static void test_churn(void)
+{
+    psa_key_handle_t handles[MAX_KEY_HANDLES];
+    int32_t owners[MAX_KEY_HANDLES];
+    psa_key_handle_t next_handle = 1;
+    uint32_t num = 0;
+    uint32_t seed = 1;
+    uint32_t round, i, index;
+
+    for (round = 0; round < CHURN_ROUNDS; round++) {
+        seed = seed * 1103515245u + 12345u;
+
+        if ((num < MAX_KEY_HANDLES) && ((num == 0) || (seed & 0x10000))) {
+            owners[num] = (seed & 0x20000) ? CLIENT_A : CLIENT_B;
+            handles[num] = next_handle++;
+            if (next_handle == 0) {
+                next_handle = 1;
+            }
+            add_key(owners[num], handles[num]);
+            num++;
+        } else {
+            i = (seed >> 18) % num;
+            remove_key(owners[i], handles[i]);
+            num--;
+            handles[i] = handles[num];
+            owners[i] = owners[num];
+        }
+
+        for (i = 0; i < num; i++) {
+            CHECK(find_key(owners[i], handles[i], &index) == PSA_SUCCESS);
+            CHECK(find_key(owners[i] == CLIENT_A ? CLIENT_B : CLIENT_A,
+                           handles[i], &index) == PSA_ERROR_NOT_PERMITTED);
+        }
+        CHECK((tfm_crypto_check_key_storage() == PSA_SUCCESS) ==
+              (num < MAX_KEY_HANDLES));
+    }
+
+    while (num > 0) {
+        num--;
+        remove_key(owners[num], handles[num]);
+    }
+}
+
+int main(void)
+{
+    test_alloc_lookup_release();
+    test_stale_handle();
+    test_remove_shift();
+    test_churn();
+
+    printf("PASS\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,15 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/* Host stub of CMSIS compiler abstraction for the crypto host tests */
+
+#ifndef __CMSIS_COMPILER_H__
+#define __CMSIS_COMPILER_H__
+
+#define __STATIC_INLINE                 static inline
+
+#endif /* __CMSIS_COMPILER_H__ */
@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/* Host stub of the TF-M log for the crypto host tests */
+
+#ifndef __TFM_LOG_H__
+#define __TFM_LOG_H__
+
+/* Defined by the test, which records the logged messages */
+void host_log_msg(const char *fmt, ...);
+
+#define LOG_MSG(...) host_log_msg(__VA_ARGS__)
+
+#endif /* __TFM_LOG_H__ */
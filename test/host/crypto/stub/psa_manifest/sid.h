@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __PSA_MANIFEST_SID_H__
+#define __PSA_MANIFEST_SID_H__
+
+#define TFM_CRYPTO_HANDLE               (0x40000100U)
+
+#endif /* __PSA_MANIFEST_SID_H__ */
@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/* Host stub: the crypto host tests do not use Mbed Crypto */
+
+#ifndef __TFM_MBEDCRYPTO_INCLUDE_H__
+#define __TFM_MBEDCRYPTO_INCLUDE_H__
+
+#endif /* __TFM_MBEDCRYPTO_INCLUDE_H__ */
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "its_bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+uint64_t its_bench_now_ns(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+void its_bench_samples_init(struct its_bench_samples_t *samples, size_t size)
+{
+    samples->ns = calloc(size, sizeof(samples->ns[0]));
+    if (samples->ns == NULL) {
+        fprintf(stderr, "Out of memory for %zu samples\n", size);
+        exit(EXIT_FAILURE);
+    }
+    samples->num = 0;
+    samples->size = size;
+}
+
+void its_bench_samples_free(struct its_bench_samples_t *samples)
+{
+    free(samples->ns);
+    samples->ns = NULL;
+    samples->num = 0;
+    samples->size = 0;
+}
+
+void its_bench_samples_add(struct its_bench_samples_t *samples, uint64_t ns)
+{
+    if (samples->num < samples->size) {
+        samples->ns[samples->num++] = ns;
+    }
+}
+
+static int compare_ns(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+uint64_t its_bench_percentile(struct its_bench_samples_t *samples,
+                              uint32_t pct)
+{
+    size_t idx;
+
+    if (samples->num == 0) {
+        return 0;
+    }
+
+    qsort(samples->ns, samples->num, sizeof(samples->ns[0]), compare_ns);
+
+    idx = ((samples->num - 1) * pct + 50) / 100;
+
+    return samples->ns[idx];
+}
+
+uint64_t its_bench_ops_per_sec(const struct its_bench_samples_t *samples)
+{
+    uint64_t total = 0;
+    size_t i;
+
+    for (i = 0; i < samples->num; i++) {
+        total += samples->ns[i];
+    }
+
+    if (total == 0) {
+        return 0;
+    }
+
+    return ((uint64_t)samples->num * 1000000000u) / total;
+}
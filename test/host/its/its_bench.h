@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/* Timing helpers of the ITS host benchmarks */
+
+#ifndef __ITS_BENCH_H__
+#define __ITS_BENCH_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Latency samples of one operation, in nanoseconds.
+ */
+struct its_bench_samples_t {
+    uint64_t *ns;       /*!< Samples */
+    size_t num;         /*!< Number of samples recorded */
+    size_t size;        /*!< Maximum number of samples */
+};
+
+/**
+ * \brief Gets the time of a monotonic clock.
+ *
+ * \return The time in nanoseconds.
+ */
+uint64_t its_bench_now_ns(void);
+
+/**
+ * \brief Allocates the storage of the samples of an operation.
+ *
+ * \param[out] samples  Samples to initialise
+ * \param[in]  size     Maximum number of samples
+ */
+void its_bench_samples_init(struct its_bench_samples_t *samples, size_t size);
+
+/**
+ * \brief Frees the storage of the samples of an operation.
+ *
+ * \param[in,out] samples  Samples to free
+ */
+void its_bench_samples_free(struct its_bench_samples_t *samples);
+
+/**
+ * \brief Records a sample, if there is room for it.
+ *
+ * \param[in,out] samples  Samples of the operation
+ * \param[in]     ns       Latency of the operation in nanoseconds
+ */
+void its_bench_samples_add(struct its_bench_samples_t *samples, uint64_t ns);
+
+/**
+ * \brief Gets a percentile of the samples. The samples are sorted.
+ *
+ * \param[in,out] samples  Samples of the operation
+ * \param[in]     pct      Percentile, from 0 to 100
+ *
+ * \return The percentile in nanoseconds, or 0 if there is no sample.
+ */
+uint64_t its_bench_percentile(struct its_bench_samples_t *samples,
+                              uint32_t pct);
+
+/**
+ * \brief Gets the number of operations per second of the samples.
+ *
+ * \param[in] samples  Samples of the operation
+ *
+ * \return The number of operations per second, or 0 if there is no sample.
+ */
+uint64_t its_bench_ops_per_sec(const struct its_bench_samples_t *samples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ITS_BENCH_H__ */
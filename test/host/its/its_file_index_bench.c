@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Benchmark of the file lookups of the ITS flash filesystem against the size
+ * of its file table (ITS_NUM_ASSETS), with and without the RAM file index
+ * (ITS_FILE_INDEX). It is built once for each table size and setting.
+ *
+ * The file table is filled to each fill level, then files that exist (hits)
+ * and files that do not (misses) are looked up at random. The benchmark
+ * reports the p50 and p99 latencies of each kind of lookup and the bytes read
+ * from flash per lookup.
+ *
+ * Usage: its_file_index_bench [lookups]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flash/its_flash.h"
+#include "flash/its_flash_ram.h"
+#include "flash_fs/its_flash_fs.h"
+#include "its_bench.h"
+
+#define DEFAULT_LOOKUPS             2000
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+static const uint32_t fill_levels[] = {25, 50, 100};
+
+static its_flash_fs_ctx_t fs_ctx;
+static const struct its_flash_info_t *flash_info;
+
+/* The IDs are offset by one, as an all-zero ID marks an unused file entry */
+static void make_fid(uint32_t id, uint8_t *fid)
+{
+    uint32_t fid_val = id + 1;
+
+    memset(fid, 0, ITS_FILE_ID_SIZE);
+    memcpy(fid, &fid_val, sizeof(fid_val));
+}
+
+static void format(void)
+{
+    /* Associates the flash device with the context, whatever its content */
+    (void)its_flash_fs_prepare(&fs_ctx, flash_info);
+    CHECK(its_flash_fs_wipe_all(&fs_ctx) == PSA_SUCCESS);
+    CHECK(its_flash_fs_prepare(&fs_ctx, flash_info) == PSA_SUCCESS);
+}
+
+/* Looks up random files, hits if below num_files, and returns the bytes read
+ * from flash.
+ */
+static uint32_t lookup(uint32_t num_files, int hit, uint32_t lookups,
+                       struct its_bench_samples_t *samples)
+{
+    struct its_flash_ram_stats_t stats;
+    struct its_file_info_t info;
+    uint8_t fid[ITS_FILE_ID_SIZE];
+    psa_status_t expected = hit ? PSA_SUCCESS : PSA_ERROR_DOES_NOT_EXIST;
+    uint32_t seed = 1;
+    uint32_t i, id;
+    uint64_t start;
+    psa_status_t err;
+
+    its_flash_ram_reset_stats(flash_info);
+
+    for (i = 0; i < lookups; i++) {
+        seed = seed * 1103515245u + 12345u;
+        id = (seed >> 16) % num_files;
+        make_fid(hit ? id : ITS_NUM_ASSETS + id, fid);
+
+        start = its_bench_now_ns();
+        err = its_flash_fs_file_get_info(&fs_ctx, fid, &info);
+        its_bench_samples_add(samples, its_bench_now_ns() - start);
+        CHECK(err == expected);
+    }
+
+    CHECK(its_flash_ram_get_stats(flash_info, &stats) == PSA_SUCCESS);
+
+    return stats.read_bytes;
+}
+
+static void run(uint32_t fill, uint32_t lookups)
+{
+    struct its_bench_samples_t hits, misses;
+    uint8_t fid[ITS_FILE_ID_SIZE];
+    uint32_t num_files = (ITS_NUM_ASSETS * fill) / 100;
+    uint32_t hit_bytes, miss_bytes;
+    uint32_t id;
+
+    if (num_files == 0) {
+        num_files = 1;
+    }
+
+    format();
+    for (id = 0; id < num_files; id++) {
+        make_fid(id, fid);
+        CHECK(its_flash_fs_file_write(&fs_ctx, fid, ITS_FLASH_FS_FLAG_CREATE,
+                                      sizeof(id), sizeof(id), 0,
+                                      (const uint8_t *)&id) == PSA_SUCCESS);
+    }
+
+    its_bench_samples_init(&hits, lookups);
+    its_bench_samples_init(&misses, lookups);
+    hit_bytes = lookup(num_files, 1, lookups, &hits);
+    miss_bytes = lookup(num_files, 0, lookups, &misses);
+
+    printf("%4u files  hit  p50 %8.2f us  p99 %8.2f us  %6u B read\n",
+           num_files, its_bench_percentile(&hits, 50) / 1000.0,
+           its_bench_percentile(&hits, 99) / 1000.0, hit_bytes / lookups);
+    printf("%4u files  miss p50 %8.2f us  p99 %8.2f us  %6u B read\n",
+           num_files, its_bench_percentile(&misses, 50) / 1000.0,
+           its_bench_percentile(&misses, 99) / 1000.0, miss_bytes / lookups);
+
+    its_bench_samples_free(&hits);
+    its_bench_samples_free(&misses);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t lookups = DEFAULT_LOOKUPS;
+    size_t f;
+
+    if (argc > 1) {
+        lookups = (uint32_t)strtoul(argv[1], NULL, 0);
+        CHECK(lookups > 0);
+    }
+
+    flash_info = its_flash_get_info(ITS_FLASH_ID_INTERNAL);
+
+#ifdef ITS_FILE_INDEX
+    printf("ITS_NUM_ASSETS %u, file index on, %u lookups per point\n",
+           (unsigned int)ITS_NUM_ASSETS, lookups);
+#else
+    printf("ITS_NUM_ASSETS %u, file index off, %u lookups per point\n",
+           (unsigned int)ITS_NUM_ASSETS, lookups);
+#endif
+
+    for (f = 0; f < sizeof(fill_levels) / sizeof(fill_levels[0]); f++) {
+        run(fill_levels[f], lookups);
+    }
+
+    return EXIT_SUCCESS;
+}
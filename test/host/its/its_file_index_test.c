@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Test of the file lookups of the ITS flash filesystem, built with and
+ * without the RAM file index (ITS_FILE_INDEX).
+ *
+ * With the index, the home slot of a file is the FNV-1a hash of its ID modulo
+ * the number of slots. The test picks IDs by their home slot, to check that
+ * removing a file from a probe sequence moves the following files back
+ * without losing any. It also checks that the index is cleared by a wipe of
+ * the filesystem and rebuilt from flash by its preparation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flash/its_flash.h"
+#include "flash_fs/its_flash_fs.h"
+#include "flash_fs/its_flash_fs_mblock.h"
+
+#ifdef ITS_FILE_INDEX
+#define NUM_SLOTS                   ITS_FILE_INDEX_NUM_SLOTS
+#else
+/* Slots of an index of the same size, to run the same sequences */
+#define NUM_SLOTS                   (2 * (ITS_NUM_ASSETS + 1))
+#endif
+
+/* Maximum number of files held at the same time */
+#define MAX_FILES                   ITS_NUM_ASSETS
+
+#define NUM_CHURN_IDS               (4 * MAX_FILES)
+#define CHURN_ROUNDS                3000
+#define REBOOT_PERIOD               100
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+static its_flash_fs_ctx_t fs_ctx;
+static const struct its_flash_info_t *flash_info;
+
+/* The IDs are offset by one, as an all-zero ID marks an unused file entry */
+static void make_fid(uint32_t id, uint8_t *fid)
+{
+    uint32_t fid_val = id + 1;
+
+    memset(fid, 0, ITS_FILE_ID_SIZE);
+    memcpy(fid, &fid_val, sizeof(fid_val));
+}
+
+/* Home slot of a file ID in the index, with the hash of the index */
+static uint32_t home_slot(uint32_t id)
+{
+    uint8_t fid[ITS_FILE_ID_SIZE];
+    uint32_t hash = 2166136261U;
+    uint32_t i;
+
+    make_fid(id, fid);
+    for (i = 0; i < ITS_FILE_ID_SIZE; i++) {
+        hash = (hash ^ fid[i]) * 16777619U;
+    }
+
+    return hash % NUM_SLOTS;
+}
+
+/* Finds the IDs, from the given one, of the next files with a home slot */
+static void find_ids(uint32_t slot, uint32_t *from, uint32_t num,
+                     uint32_t *ids)
+{
+    uint32_t n = 0;
+
+    while (n < num) {
+        if (home_slot(*from) == slot) {
+            ids[n++] = *from;
+        }
+        (*from)++;
+    }
+}
+
+static void boot(void)
+{
+    CHECK(its_flash_fs_prepare(&fs_ctx, flash_info) == PSA_SUCCESS);
+}
+
+static void format(void)
+{
+    /* Associates the flash device with the context, whatever its content */
+    (void)its_flash_fs_prepare(&fs_ctx, flash_info);
+    CHECK(its_flash_fs_wipe_all(&fs_ctx) == PSA_SUCCESS);
+    boot();
+}
+
+/* Each file holds its ID, to check that a lookup finds the right entry */
+static psa_status_t create_file(uint32_t id)
+{
+    uint8_t fid[ITS_FILE_ID_SIZE];
+
+    make_fid(id, fid);
+
+    return its_flash_fs_file_write(&fs_ctx, fid, ITS_FLASH_FS_FLAG_CREATE,
+                                   sizeof(id), sizeof(id), 0,
+                                   (const uint8_t *)&id);
+}
+
+static void delete_file(uint32_t id)
+{
+    uint8_t fid[ITS_FILE_ID_SIZE];
+
+    make_fid(id, fid);
+    CHECK(its_flash_fs_file_delete(&fs_ctx, fid) == PSA_SUCCESS);
+}
+
+static void check_file(uint32_t id)
+{
+    uint8_t fid[ITS_FILE_ID_SIZE];
+    uint32_t data = 0;
+
+    make_fid(id, fid);
+    CHECK(its_flash_fs_file_read(&fs_ctx, fid, sizeof(data), 0,
+                                 (uint8_t *)&data) == PSA_SUCCESS);
+    CHECK(data == id);
+}
+
+static void check_no_file(uint32_t id)
+{
+    uint8_t fid[ITS_FILE_ID_SIZE];
+
+    make_fid(id, fid);
+    CHECK(its_flash_fs_file_exist(&fs_ctx, fid) == PSA_ERROR_DOES_NOT_EXIST);
+}
+
+static void test_remove_shift(void)
+{
+    const uint32_t home = 7;
+    uint32_t same[3], next[1];
+    uint32_t from = 0;
+
+    format();
+
+    /* Three files in a row from one home slot, then one from the next slot,
+     * which is pushed after them.
+     */
+    find_ids(home, &from, 3, same);
+    find_ids(home + 1, &from, 1, next);
+    CHECK(create_file(same[0]) == PSA_SUCCESS);
+    CHECK(create_file(same[1]) == PSA_SUCCESS);
+    CHECK(create_file(same[2]) == PSA_SUCCESS);
+    CHECK(create_file(next[0]) == PSA_SUCCESS);
+
+    /* The files after a removed one are still found */
+    delete_file(same[0]);
+    check_no_file(same[0]);
+    check_file(same[1]);
+    check_file(same[2]);
+    check_file(next[0]);
+
+    /* Also from the middle of the sequence */
+    delete_file(same[2]);
+    check_no_file(same[2]);
+    check_file(same[1]);
+    check_file(next[0]);
+
+    /* The removed files can be created again */
+    CHECK(create_file(same[0]) == PSA_SUCCESS);
+    CHECK(create_file(same[2]) == PSA_SUCCESS);
+    check_file(same[0]);
+    check_file(same[1]);
+    check_file(same[2]);
+    check_file(next[0]);
+
+    /* The index rebuilt from flash finds the same files */
+    boot();
+    check_file(same[0]);
+    check_file(same[1]);
+    check_file(same[2]);
+    check_file(next[0]);
+}
+
+static void test_remove_shift_wrap(void)
+{
+    uint32_t last[2], first[1];
+    uint32_t from = 0;
+
+    format();
+
+    /* A probe sequence from the last slot, which wraps around to the first */
+    find_ids(NUM_SLOTS - 1, &from, 2, last);
+    find_ids(0, &from, 1, first);
+    CHECK(create_file(last[0]) == PSA_SUCCESS);
+    CHECK(create_file(last[1]) == PSA_SUCCESS);
+    CHECK(create_file(first[0]) == PSA_SUCCESS);
+
+    delete_file(last[0]);
+    check_no_file(last[0]);
+    check_file(last[1]);
+    check_file(first[0]);
+
+    delete_file(last[1]);
+    check_file(first[0]);
+
+    CHECK(create_file(last[0]) == PSA_SUCCESS);
+    check_file(last[0]);
+    check_file(first[0]);
+}
+
+/*
+ * Random creations and deletions, with reboots, checked against a model of
+ * the files after every operation.
+ */
+static void test_churn(void)
+{
+    uint8_t exists[NUM_CHURN_IDS] = {0};
+    uint32_t num = 0;
+    uint32_t seed = 1;
+    uint32_t round, id;
+
+    format();
+
+    for (round = 0; round < CHURN_ROUNDS; round++) {
+        if ((round % REBOOT_PERIOD) == 0) {
+            boot();
+        }
+
+        seed = seed * 1103515245u + 12345u;
+        id = (seed >> 16) % NUM_CHURN_IDS;
+
+        if (exists[id]) {
+            delete_file(id);
+            exists[id] = 0;
+            num--;
+        } else if (num < MAX_FILES) {
+            CHECK(create_file(id) == PSA_SUCCESS);
+            exists[id] = 1;
+            num++;
+        }
+
+        for (id = 0; id < NUM_CHURN_IDS; id++) {
+            if (exists[id]) {
+                check_file(id);
+            } else {
+                check_no_file(id);
+            }
+        }
+    }
+}
+
+static void test_reset_rebuild(void)
+{
+    uint32_t id;
+
+    format();
+
+    /* A full file table */
+    for (id = 0; id < MAX_FILES; id++) {
+        CHECK(create_file(id) == PSA_SUCCESS);
+    }
+
+    /* After a wipe, no file is found and every entry is free */
+    CHECK(its_flash_fs_wipe_all(&fs_ctx) == PSA_SUCCESS);
+    for (id = 0; id < MAX_FILES; id++) {
+        check_no_file(id);
+    }
+    for (id = MAX_FILES; id < 2 * MAX_FILES; id++) {
+        CHECK(create_file(id) == PSA_SUCCESS);
+    }
+    for (id = 0; id < 2 * MAX_FILES; id++) {
+        if (id < MAX_FILES) {
+            check_no_file(id);
+        } else {
+            check_file(id);
+        }
+    }
+
+    /* The index built at boot matches the flash content */
+    boot();
+    for (id = 0; id < 2 * MAX_FILES; id++) {
+        if (id < MAX_FILES) {
+            check_no_file(id);
+        } else {
+            check_file(id);
+        }
+    }
+}
+
+int main(void)
+{
+    flash_info = its_flash_get_info(ITS_FLASH_ID_INTERNAL);
+
+    test_remove_shift();
+    test_remove_shift_wrap();
+    test_churn();
+    test_reset_rebuild();
+
+    printf("PASS\n");
+
+    return EXIT_SUCCESS;
+}
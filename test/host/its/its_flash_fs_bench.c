@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Benchmark of the ITS flash filesystem on the emulated RAM flash device.
+ *
+ * For each asset size and fill level, the filesystem is wiped and filled with
+ * that share of the files it can hold, then a random file is deleted, written
+ * again and read back on each iteration. The benchmark reports, for each
+ * operation, the number of operations per second and the p50 and p99
+ * latencies, along with the block compactions run by the deletes, the bytes
+ * programmed per byte of file data written (write amplification) and the
+ * erases of each block.
+ *
+ * The program and erase latencies of the flash are simulated with the
+ * ITS_RAM_FS_PROGRAM_LATENCY and ITS_RAM_FS_ERASE_LATENCY build options.
+ *
+ * Usage: its_flash_fs_bench [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flash/its_flash.h"
+#include "flash/its_flash_ram.h"
+#include "flash_fs/its_flash_fs.h"
+#include "flash_fs/its_flash_fs_dblock.h"
+#include "its_bench.h"
+
+#define DEFAULT_ITERATIONS          200
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+static const size_t asset_sizes[] = {64, 256, 1024, ITS_MAX_ASSET_SIZE};
+static const uint32_t fill_levels[] = {25, 50, 75, 90};
+
+static its_flash_fs_ctx_t fs_ctx;
+static const struct its_flash_info_t *flash_info;
+static uint8_t data[ITS_MAX_ASSET_SIZE];
+
+/* Samples of the block compactions, taken by the wrapper below */
+static struct its_bench_samples_t compact_samples;
+
+psa_status_t __real_its_flash_fs_dblock_compact_block(
+                                              struct its_flash_fs_ctx_t *fs_ctx,
+                                              uint32_t lblock,
+                                              size_t free_size,
+                                              size_t src_offset,
+                                              size_t dst_offset,
+                                              size_t size);
+
+/* Times the compactions, with the linker option
+ * --wrap=its_flash_fs_dblock_compact_block.
+ */
+psa_status_t __wrap_its_flash_fs_dblock_compact_block(
+                                              struct its_flash_fs_ctx_t *fs_ctx,
+                                              uint32_t lblock,
+                                              size_t free_size,
+                                              size_t src_offset,
+                                              size_t dst_offset,
+                                              size_t size)
+{
+    uint64_t start = its_bench_now_ns();
+    psa_status_t err;
+
+    err = __real_its_flash_fs_dblock_compact_block(fs_ctx, lblock, free_size,
+                                                   src_offset, dst_offset,
+                                                   size);
+    its_bench_samples_add(&compact_samples, its_bench_now_ns() - start);
+
+    return err;
+}
+
+/* The IDs are offset by one, as an all-zero ID marks an unused file entry */
+static void make_fid(uint32_t id, uint8_t *fid)
+{
+    uint32_t fid_val = id + 1;
+
+    memset(fid, 0, ITS_FILE_ID_SIZE);
+    memcpy(fid, &fid_val, sizeof(fid_val));
+}
+
+/* Creates an empty filesystem, as with ITS_CREATE_FLASH_LAYOUT */
+static void format(void)
+{
+    /* Associates the flash device with the context, whatever its content */
+    (void)its_flash_fs_prepare(&fs_ctx, flash_info);
+    CHECK(its_flash_fs_wipe_all(&fs_ctx) == PSA_SUCCESS);
+    CHECK(its_flash_fs_prepare(&fs_ctx, flash_info) == PSA_SUCCESS);
+}
+
+static psa_status_t write_file(uint32_t id, size_t size)
+{
+    uint8_t fid[ITS_FILE_ID_SIZE];
+
+    make_fid(id, fid);
+    memset(data, (int)id, size);
+
+    return its_flash_fs_file_write(&fs_ctx, fid, ITS_FLASH_FS_FLAG_CREATE,
+                                   size, size, 0, data);
+}
+
+/* Number of files of a size that the filesystem can hold */
+static uint32_t probe_capacity(size_t size)
+{
+    uint32_t num = 0;
+
+    format();
+    while (write_file(num, size) == PSA_SUCCESS) {
+        num++;
+    }
+
+    return num;
+}
+
+static void print_samples(const char *name, struct its_bench_samples_t *s)
+{
+    uint64_t ops = its_bench_ops_per_sec(s);
+    uint64_t p50 = its_bench_percentile(s, 50);
+    uint64_t p99 = its_bench_percentile(s, 99);
+
+    printf("  %-8s %6zu ops %9llu ops/s  p50 %8.2f us  p99 %8.2f us\n",
+           name, s->num, (unsigned long long)ops, p50 / 1000.0, p99 / 1000.0);
+}
+
+static void run(size_t size, uint32_t fill, uint32_t capacity,
+                uint32_t iterations)
+{
+    struct its_bench_samples_t write_samples, read_samples, delete_samples;
+    struct its_flash_ram_stats_t stats;
+    uint8_t fid[ITS_FILE_ID_SIZE];
+    uint32_t num_files = (capacity * fill) / 100;
+    uint64_t logical_bytes = 0;
+    uint64_t start;
+    uint32_t seed = 1;
+    uint32_t i, id;
+
+    if (num_files == 0) {
+        num_files = 1;
+    }
+
+    format();
+    for (id = 0; id < num_files; id++) {
+        CHECK(write_file(id, size) == PSA_SUCCESS);
+    }
+
+    its_bench_samples_init(&write_samples, iterations);
+    its_bench_samples_init(&read_samples, iterations);
+    its_bench_samples_init(&delete_samples, iterations);
+    its_bench_samples_init(&compact_samples, iterations);
+    its_flash_ram_reset_stats(flash_info);
+
+    for (i = 0; i < iterations; i++) {
+        seed = seed * 1103515245u + 12345u;
+        id = (seed >> 16) % num_files;
+        make_fid(id, fid);
+
+        start = its_bench_now_ns();
+        CHECK(its_flash_fs_file_delete(&fs_ctx, fid) == PSA_SUCCESS);
+        its_bench_samples_add(&delete_samples, its_bench_now_ns() - start);
+
+        start = its_bench_now_ns();
+        CHECK(write_file(id, size) == PSA_SUCCESS);
+        its_bench_samples_add(&write_samples, its_bench_now_ns() - start);
+        logical_bytes += size;
+
+        start = its_bench_now_ns();
+        CHECK(its_flash_fs_file_read(&fs_ctx, fid, size, 0, data) ==
+              PSA_SUCCESS);
+        its_bench_samples_add(&read_samples, its_bench_now_ns() - start);
+        CHECK(data[0] == (uint8_t)id && data[size - 1] == (uint8_t)id);
+    }
+
+    CHECK(its_flash_ram_get_stats(flash_info, &stats) == PSA_SUCCESS);
+
+    printf("size %zu B, fill %u%% (%u of %u files)\n", size, fill, num_files,
+           capacity);
+    print_samples("write", &write_samples);
+    print_samples("read", &read_samples);
+    print_samples("delete", &delete_samples);
+    print_samples("compact", &compact_samples);
+    printf("  write amplification %.2f (%u B programmed for %llu B written)\n",
+           (double)stats.program_bytes / (double)logical_bytes,
+           stats.program_bytes, (unsigned long long)logical_bytes);
+    printf("  erases per block:");
+    for (i = 0; (i < flash_info->num_blocks) &&
+                (i < ITS_RAM_FS_STATS_MAX_BLOCKS); i++) {
+        printf(" %u", stats.block_erase_count[i]);
+    }
+    printf("\n");
+
+    its_bench_samples_free(&write_samples);
+    its_bench_samples_free(&read_samples);
+    its_bench_samples_free(&delete_samples);
+    its_bench_samples_free(&compact_samples);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t iterations = DEFAULT_ITERATIONS;
+    uint32_t capacity;
+    size_t s, f;
+
+    if (argc > 1) {
+        iterations = (uint32_t)strtoul(argv[1], NULL, 0);
+        CHECK(iterations > 0);
+    }
+
+    flash_info = its_flash_get_info(ITS_FLASH_ID_INTERNAL);
+    CHECK(flash_info->init(flash_info) == PSA_SUCCESS);
+
+    printf("ITS flash filesystem: %u blocks of %u B, up to %u files, "
+           "%u iterations per point\n",
+           flash_info->num_blocks, flash_info->block_size,
+           flash_info->max_num_files, iterations);
+
+    for (s = 0; s < sizeof(asset_sizes) / sizeof(asset_sizes[0]); s++) {
+        capacity = probe_capacity(asset_sizes[s]);
+        CHECK(capacity > 0);
+
+        for (f = 0; f < sizeof(fill_levels) / sizeof(fill_levels[0]); f++) {
+            run(asset_sizes[s], fill_levels[f], capacity, iterations);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
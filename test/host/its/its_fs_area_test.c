@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Test of the assignment of the ITS clients to the filesystem areas.
+ *
+ * The ITS flash area is divided into two areas of 2 blocks, holding up to
+ * AREA0_NUM_ASSETS and AREA1_NUM_ASSETS assets. CLIENT_HEAVY is assigned to
+ * area 1, and the other clients use the default area 0.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tfm_internal_trusted_storage.h"
+#include "its_test_req_mngr.h"
+
+#define AREA0_NUM_ASSETS            2
+#define AREA1_NUM_ASSETS            3
+
+#define CLIENT_HEAVY                8
+#define CLIENT_A                    5
+#define CLIENT_B                    7
+
+#define ASSET_SIZE                  64
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+static psa_status_t set(int32_t client_id, psa_storage_uid_t uid)
+{
+    memset(its_test_req_data, (int)(client_id + uid), ASSET_SIZE);
+    its_test_req_start(0);
+
+    return tfm_its_set(client_id, uid, ASSET_SIZE, PSA_STORAGE_FLAG_NONE);
+}
+
+static void check(int32_t client_id, psa_storage_uid_t uid)
+{
+    size_t data_length = 0;
+    size_t i;
+
+    memset(its_test_req_data, 0, ASSET_SIZE);
+    its_test_req_start(0);
+
+    CHECK(tfm_its_get(client_id, uid, 0, ASSET_SIZE, &data_length) ==
+          PSA_SUCCESS);
+    CHECK(data_length == ASSET_SIZE);
+    for (i = 0; i < ASSET_SIZE; i++) {
+        CHECK(its_test_req_data[i] == (uint8_t)(client_id + uid));
+    }
+}
+
+static void test_default_area(void)
+{
+    psa_storage_uid_t uid;
+
+    /* The clients which are not listed share the default area */
+    for (uid = 1; uid <= AREA0_NUM_ASSETS; uid++) {
+        CHECK(set(CLIENT_A, uid) == PSA_SUCCESS);
+    }
+    CHECK(set(CLIENT_A, uid) == PSA_ERROR_INSUFFICIENT_STORAGE);
+    CHECK(set(CLIENT_B, 1) == PSA_ERROR_INSUFFICIENT_STORAGE);
+}
+
+static void test_assigned_area(void)
+{
+    psa_storage_uid_t uid;
+
+    /* The heavy client has the larger area to itself, whatever its ID */
+    for (uid = 1; uid <= AREA1_NUM_ASSETS; uid++) {
+        CHECK(set(CLIENT_HEAVY, uid) == PSA_SUCCESS);
+    }
+    CHECK(set(CLIENT_HEAVY, uid) == PSA_ERROR_INSUFFICIENT_STORAGE);
+
+    /* Space freed in one area is not available to the clients of the other */
+    CHECK(tfm_its_remove(CLIENT_HEAVY, 1) == PSA_SUCCESS);
+    CHECK(set(CLIENT_B, 1) == PSA_ERROR_INSUFFICIENT_STORAGE);
+    CHECK(set(CLIENT_HEAVY, 1) == PSA_SUCCESS);
+}
+
+static void test_found_after_init(void)
+{
+    psa_storage_uid_t uid;
+
+    CHECK(tfm_its_init() == PSA_SUCCESS);
+
+    for (uid = 1; uid <= AREA0_NUM_ASSETS; uid++) {
+        check(CLIENT_A, uid);
+    }
+    for (uid = 1; uid <= AREA1_NUM_ASSETS; uid++) {
+        check(CLIENT_HEAVY, uid);
+    }
+}
+
+int main(void)
+{
+    CHECK(tfm_its_init() == PSA_SUCCESS);
+
+    test_default_area();
+    test_assigned_area();
+    test_found_after_init();
+
+    printf("PASS\n");
+
+    return EXIT_SUCCESS;
+}
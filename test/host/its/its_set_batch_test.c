@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Test of the ITS set requests written in several chunks, with the metadata
+ * cache enabled, on the RAM filesystem.
+ *
+ * The request manager is replaced by the model of its_test_req_mngr.c. A set
+ * taking several chunks must leave the same data as a set taking one, with as
+ * many block erases.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tfm_internal_trusted_storage.h"
+#include "flash/its_flash.h"
+#include "flash/its_flash_ram.h"
+#include "its_test_req_mngr.h"
+
+#define CLIENT_ID                   5
+#define UID_SMALL                   1
+#define UID_LARGE                   2
+#define UID_MAPPED                  3
+#define UID_MAPPED_TAIL             4
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+static uint32_t erase_count(void)
+{
+    struct its_flash_ram_stats_t stats;
+
+    CHECK(its_flash_ram_get_stats(its_flash_get_info(ITS_FLASH_ID_INTERNAL),
+                                  &stats) == PSA_SUCCESS);
+
+    return stats.erase_count;
+}
+
+static void reset_erase_count(void)
+{
+    its_flash_ram_reset_stats(its_flash_get_info(ITS_FLASH_ID_INTERNAL));
+}
+
+static void fill(uint8_t seed, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        its_test_req_data[i] = (uint8_t)(seed + i * 13 + (i >> 8));
+    }
+}
+
+static uint32_t set(psa_storage_uid_t uid, uint8_t seed, size_t len,
+                    int mappable)
+{
+    fill(seed, len);
+    its_test_req_start(mappable);
+
+    reset_erase_count();
+    CHECK(tfm_its_set(CLIENT_ID, uid, len, PSA_STORAGE_FLAG_NONE) ==
+          PSA_SUCCESS);
+    CHECK(its_test_req_pos == len);
+
+    return erase_count();
+}
+
+static void check(psa_storage_uid_t uid, uint8_t seed, size_t len)
+{
+    struct psa_storage_info_t info;
+    uint8_t expected[ITS_MAX_ASSET_SIZE];
+    size_t data_length = 0;
+
+    fill(seed, len);
+    memcpy(expected, its_test_req_data, len);
+    memset(its_test_req_data, 0, sizeof(its_test_req_data));
+    its_test_req_start(0);
+
+    CHECK(tfm_its_get_info(CLIENT_ID, uid, &info) == PSA_SUCCESS);
+    CHECK(info.size == len);
+    CHECK(tfm_its_get(CLIENT_ID, uid, 0, len, &data_length) == PSA_SUCCESS);
+    CHECK(data_length == len);
+    CHECK(memcmp(its_test_req_data, expected, len) == 0);
+}
+
+static void test_chunked_set_one_update(void)
+{
+    uint32_t single, chunked;
+
+    /* One chunk */
+    single = set(UID_SMALL, 1, ITS_BUF_SIZE, 0);
+    check(UID_SMALL, 1, ITS_BUF_SIZE);
+
+    /* Several chunks of ITS_BUF_SIZE bytes, committed as one update */
+    chunked = set(UID_LARGE, 2, 4 * ITS_BUF_SIZE + 12, 0);
+    check(UID_LARGE, 2, 4 * ITS_BUF_SIZE + 12);
+    CHECK(chunked == single);
+}
+
+static void test_mapped_set_with_tail(void)
+{
+    uint32_t single, chunked;
+
+    /* The mapped data is written in one chunk */
+    single = set(UID_MAPPED, 3, 3 * ITS_BUF_SIZE, 1);
+    check(UID_MAPPED, 3, 3 * ITS_BUF_SIZE);
+
+    /* The part below the program unit is written from the buffer after the
+     * mapped data, in the same update.
+     */
+    chunked = set(UID_MAPPED_TAIL, 4,
+                  3 * ITS_BUF_SIZE + ITS_FLASH_PROGRAM_UNIT - 1, 1);
+    check(UID_MAPPED_TAIL, 4, 3 * ITS_BUF_SIZE + ITS_FLASH_PROGRAM_UNIT - 1);
+    CHECK(chunked == single);
+}
+
+static void test_chunked_overwrite(void)
+{
+    /* Replace the file with one of the same size, then of another size, which
+     * deletes the old file between two batches.
+     */
+    (void)set(UID_LARGE, 5, 4 * ITS_BUF_SIZE + 12, 0);
+    check(UID_LARGE, 5, 4 * ITS_BUF_SIZE + 12);
+
+    (void)set(UID_LARGE, 6, 2 * ITS_BUF_SIZE + 40, 0);
+    check(UID_LARGE, 6, 2 * ITS_BUF_SIZE + 40);
+    check(UID_SMALL, 1, ITS_BUF_SIZE);
+    check(UID_MAPPED_TAIL, 4, 3 * ITS_BUF_SIZE + ITS_FLASH_PROGRAM_UNIT - 1);
+}
+
+static void test_committed_after_init(void)
+{
+    /* The files are found again from the flash metadata */
+    CHECK(tfm_its_init() == PSA_SUCCESS);
+    check(UID_SMALL, 1, ITS_BUF_SIZE);
+    check(UID_LARGE, 6, 2 * ITS_BUF_SIZE + 40);
+    check(UID_MAPPED, 3, 3 * ITS_BUF_SIZE);
+    check(UID_MAPPED_TAIL, 4, 3 * ITS_BUF_SIZE + ITS_FLASH_PROGRAM_UNIT - 1);
+}
+
+int main(void)
+{
+    CHECK(tfm_its_init() == PSA_SUCCESS);
+
+    test_chunked_set_one_update();
+    test_mapped_set_with_tail();
+    test_chunked_overwrite();
+    test_committed_after_init();
+
+    printf("PASS\n");
+
+    return EXIT_SUCCESS;
+}
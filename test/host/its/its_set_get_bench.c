@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Benchmark of the ITS set and get requests on the emulated RAM flash device,
+ * with the caller's data mapped by the request manager, as in the library
+ * model, and copied through the asset_data buffer in chunks of ITS_BUF_SIZE,
+ * as in the IPC model.
+ *
+ * The request manager is replaced by the model of its_test_req_mngr.c. For
+ * each asset size, the same asset is set and read back on each iteration. The
+ * benchmark reports the p50 and p99 latencies of tfm_its_set() and
+ * tfm_its_get() and the bytes copied through asset_data per request.
+ *
+ * The program and erase latencies of the flash are simulated with the
+ * ITS_RAM_FS_PROGRAM_LATENCY and ITS_RAM_FS_ERASE_LATENCY build options.
+ *
+ * Usage: its_set_get_bench [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tfm_internal_trusted_storage.h"
+#include "flash/its_flash.h"
+#include "its_bench.h"
+#include "its_test_req_mngr.h"
+
+#define DEFAULT_ITERATIONS          200
+
+#define CLIENT_ID                   5
+#define UID                         1
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+static const size_t asset_sizes[] = {64, 256, 1024, ITS_MAX_ASSET_SIZE};
+
+static void fill(uint8_t seed, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        its_test_req_data[i] = (uint8_t)(seed + i);
+    }
+}
+
+static void check(uint8_t seed, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        CHECK(its_test_req_data[i] == (uint8_t)(seed + i));
+    }
+}
+
+static void print_samples(const char *name, struct its_bench_samples_t *s,
+                          size_t copied)
+{
+    printf("  %-12s p50 %8.2f us  p99 %8.2f us  %6zu B copied\n", name,
+           its_bench_percentile(s, 50) / 1000.0,
+           its_bench_percentile(s, 99) / 1000.0, copied / s->num);
+}
+
+static void run(size_t size, int mappable, uint32_t iterations)
+{
+    struct its_bench_samples_t set_samples, get_samples;
+    size_t set_copied = 0;
+    size_t get_copied = 0;
+    size_t data_length;
+    uint64_t start;
+    uint32_t i;
+    uint8_t seed;
+
+    its_bench_samples_init(&set_samples, iterations);
+    its_bench_samples_init(&get_samples, iterations);
+
+    for (i = 0; i < iterations; i++) {
+        seed = (uint8_t)i;
+
+        fill(seed, size);
+        its_test_req_start(mappable);
+        its_test_req_copied = 0;
+        start = its_bench_now_ns();
+        CHECK(tfm_its_set(CLIENT_ID, UID, size, PSA_STORAGE_FLAG_NONE) ==
+              PSA_SUCCESS);
+        its_bench_samples_add(&set_samples, its_bench_now_ns() - start);
+        CHECK(its_test_req_pos == size);
+        set_copied += its_test_req_copied;
+
+        memset(its_test_req_data, 0, size);
+        its_test_req_start(mappable);
+        its_test_req_copied = 0;
+        start = its_bench_now_ns();
+        CHECK(tfm_its_get(CLIENT_ID, UID, 0, size, &data_length) ==
+              PSA_SUCCESS);
+        its_bench_samples_add(&get_samples, its_bench_now_ns() - start);
+        CHECK(data_length == size);
+        get_copied += its_test_req_copied;
+        check(seed, size);
+    }
+
+    printf("size %zu B, %s\n", size, mappable ? "mapped" : "copied");
+    print_samples("tfm_its_set", &set_samples, set_copied);
+    print_samples("tfm_its_get", &get_samples, get_copied);
+
+    /* Only a part smaller than the program unit is copied when mapped */
+    if (mappable) {
+        CHECK(set_copied / iterations < ITS_FLASH_MAX_ALIGNMENT);
+        CHECK(get_copied == 0);
+    } else {
+        CHECK(set_copied / iterations == size);
+        CHECK(get_copied / iterations == size);
+    }
+
+    its_bench_samples_free(&set_samples);
+    its_bench_samples_free(&get_samples);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t iterations = DEFAULT_ITERATIONS;
+    size_t s;
+
+    if (argc > 1) {
+        iterations = (uint32_t)strtoul(argv[1], NULL, 0);
+        CHECK(iterations > 0);
+    }
+
+    CHECK(tfm_its_init() == PSA_SUCCESS);
+
+    printf("ITS set and get, ITS_BUF_SIZE %u B, %u iterations per point\n",
+           (unsigned int)ITS_BUF_SIZE, iterations);
+
+    for (s = 0; s < sizeof(asset_sizes) / sizeof(asset_sizes[0]); s++) {
+        run(asset_sizes[s], 0, iterations);
+        run(asset_sizes[s], 1, iterations);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tfm_hal_its.h"
+#include "tfm_hal_ps.h"
+#include "flash/its_flash.h"
+
+/* The PS flash device is not used */
+struct its_flash_info_t its_flash_info_external;
+
+void tfm_hal_its_fs_info(uint32_t *flash_area_addr, size_t *flash_area_size)
+{
+    *flash_area_addr = ITS_FLASH_AREA_ADDR;
+    *flash_area_size = ITS_FLASH_AREA_SIZE;
+}
+
+void tfm_hal_ps_fs_info(uint32_t *flash_area_addr, size_t *flash_area_size)
+{
+    *flash_area_addr = 0;
+    *flash_area_size = 0;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include "its_test_req_mngr.h"
+
+#include <string.h>
+
+
+uint8_t its_test_req_data[ITS_MAX_ASSET_SIZE];
+size_t its_test_req_pos;
+size_t its_test_req_copied;
+
+static int req_mappable;
+
+void its_test_req_start(int mappable)
+{
+    its_test_req_pos = 0;
+    req_mappable = mappable;
+}
+
+size_t its_req_mngr_read(uint8_t *buf, size_t num_bytes)
+{
+    memcpy(buf, &its_test_req_data[its_test_req_pos], num_bytes);
+    its_test_req_pos += num_bytes;
+    its_test_req_copied += num_bytes;
+
+    return num_bytes;
+}
+
+void its_req_mngr_write(const uint8_t *buf, size_t num_bytes)
+{
+    memcpy(&its_test_req_data[its_test_req_pos], buf, num_bytes);
+    its_test_req_pos += num_bytes;
+    its_test_req_copied += num_bytes;
+}
+
+const uint8_t *its_req_mngr_map_read(size_t num_bytes)
+{
+    const uint8_t *data = &its_test_req_data[its_test_req_pos];
+
+    if (!req_mappable) {
+        return NULL;
+    }
+
+    its_test_req_pos += num_bytes;
+
+    return data;
+}
+
+uint8_t *its_req_mngr_map_write(size_t num_bytes)
+{
+    uint8_t *data = &its_test_req_data[its_test_req_pos];
+
+    if (!req_mappable) {
+        return NULL;
+    }
+
+    its_test_req_pos += num_bytes;
+
+    return data;
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Model of the ITS request manager and of the platform hooks for the ITS host
+ * tests. The caller's data of a request is read from or written to a buffer,
+ * which the model can map or not.
+ */
+
+#ifndef __ITS_TEST_REQ_MNGR_H__
+#define __ITS_TEST_REQ_MNGR_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tfm_internal_trusted_storage.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Caller data of the request in progress */
+extern uint8_t its_test_req_data[ITS_MAX_ASSET_SIZE];
+
+/* Position of the request in its_test_req_data */
+extern size_t its_test_req_pos;
+
+/* Bytes copied by its_req_mngr_read() and its_req_mngr_write(), which the
+ * tests may reset.
+ */
+extern size_t its_test_req_copied;
+
+/**
+ * \brief Starts a request on its_test_req_data.
+ *
+ * \param[in] mappable  Whether the request manager maps the caller's data
+ */
+void its_test_req_start(int mappable);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ITS_TEST_REQ_MNGR_H__ */
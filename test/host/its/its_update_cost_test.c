@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Test of the flash cost of the updates of the ITS flash filesystem, built
+ * with ITS_APPEND_IN_PLACE off (the default) and on.
+ *
+ * It reports the bytes programmed and the blocks erased by each kind of
+ * update, and checks that:
+ * - an update which does not use the scratch data block does not erase it;
+ * - an update which uses it erases it, and the scratch data block is always
+ *   erased at initialisation, even if it was programmed before a reboot;
+ * - with ITS_APPEND_IN_PLACE, an append in a dedicated data block only
+ *   programs the new data and the metadata block;
+ * - random updates with reboots keep the file content.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flash/its_flash.h"
+#include "flash/its_flash_ram.h"
+#include "flash_fs/its_flash_fs.h"
+#include "flash_fs/its_flash_fs_mblock.h"
+
+/* A file in logical block 0, and one which does not fit with it */
+#define SMALL_ID                    0
+#define SMALL_SIZE                  (ITS_MAX_ASSET_SIZE / 2)
+#define LARGE_ID                    1
+#define LARGE_SIZE                  ITS_MAX_ASSET_SIZE
+#define APPEND_SIZE                 64U
+
+#define NUM_CHURN_IDS               4
+#define CHURN_ROUNDS                2000
+#define REBOOT_PERIOD               50
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+struct cost_t {
+    uint32_t program_bytes;
+    uint32_t erase_count;
+};
+
+static its_flash_fs_ctx_t fs_ctx;
+static const struct its_flash_info_t *flash_info;
+static uint8_t data[ITS_MAX_ASSET_SIZE];
+static uint8_t read_buf[ITS_MAX_ASSET_SIZE];
+
+/* The IDs are offset by one, as an all-zero ID marks an unused file entry */
+static void make_fid(uint32_t id, uint8_t *fid)
+{
+    uint32_t fid_val = id + 1;
+
+    memset(fid, 0, ITS_FILE_ID_SIZE);
+    memcpy(fid, &fid_val, sizeof(fid_val));
+}
+
+static void boot(void)
+{
+    CHECK(its_flash_fs_prepare(&fs_ctx, flash_info) == PSA_SUCCESS);
+}
+
+static void format(void)
+{
+    /* Associates the flash device with the context, whatever its content */
+    (void)its_flash_fs_prepare(&fs_ctx, flash_info);
+    CHECK(its_flash_fs_wipe_all(&fs_ctx) == PSA_SUCCESS);
+    boot();
+}
+
+static void cost_start(void)
+{
+    its_flash_ram_reset_stats(flash_info);
+}
+
+static struct cost_t cost_end(const char *name)
+{
+    struct its_flash_ram_stats_t stats;
+    struct cost_t cost;
+
+    CHECK(its_flash_ram_get_stats(flash_info, &stats) == PSA_SUCCESS);
+    cost.program_bytes = stats.program_bytes;
+    cost.erase_count = stats.erase_count;
+
+    if (name != NULL) {
+        printf("  %-32s %6u B programmed  %u blocks erased\n", name,
+               cost.program_bytes, cost.erase_count);
+    }
+
+    return cost;
+}
+
+static psa_status_t write_file(uint32_t id, uint32_t flags, size_t max_size,
+                               size_t size, size_t offset, uint8_t val)
+{
+    uint8_t fid[ITS_FILE_ID_SIZE];
+
+    make_fid(id, fid);
+    memset(data, val, size);
+
+    return its_flash_fs_file_write(&fs_ctx, fid, flags, max_size, size, offset,
+                                   data);
+}
+
+static uint32_t file_lblock(uint32_t id)
+{
+    struct its_file_meta_t file_meta;
+    uint8_t fid[ITS_FILE_ID_SIZE];
+    uint32_t idx;
+
+    make_fid(id, fid);
+    CHECK(its_flash_fs_mblock_get_file_idx(&fs_ctx, fid, &idx) ==
+          PSA_SUCCESS);
+    CHECK(its_flash_fs_mblock_read_file_meta(&fs_ctx, idx, &file_meta) ==
+          PSA_SUCCESS);
+
+    return file_meta.lblock;
+}
+
+static void check_file(uint32_t id, const uint8_t *expected, size_t size)
+{
+    uint8_t fid[ITS_FILE_ID_SIZE];
+
+    make_fid(id, fid);
+    CHECK(its_flash_fs_file_read(&fs_ctx, fid, size, 0, read_buf) ==
+          PSA_SUCCESS);
+    CHECK(memcmp(read_buf, expected, size) == 0);
+}
+
+static void test_update_cost(void)
+{
+    struct cost_t cost;
+    size_t large_size = 0;
+    uint32_t i;
+
+#ifdef ITS_APPEND_IN_PLACE
+    printf("Update costs, ITS_APPEND_IN_PLACE on\n");
+#else
+    printf("Update costs, ITS_APPEND_IN_PLACE off\n");
+#endif
+
+    format();
+
+    /* A file in logical block 0, updated with the metadata block only. The
+     * scratch data block is not used, so it is not erased.
+     */
+    cost_start();
+    CHECK(write_file(SMALL_ID, ITS_FLASH_FS_FLAG_CREATE, SMALL_SIZE,
+                     APPEND_SIZE, 0, 1) == PSA_SUCCESS);
+    cost = cost_end("create in logical block 0");
+    CHECK(file_lblock(SMALL_ID) == 0);
+    CHECK(cost.erase_count == 1);
+
+    cost_start();
+    CHECK(write_file(SMALL_ID, 0, SMALL_SIZE, APPEND_SIZE, APPEND_SIZE, 2) ==
+          PSA_SUCCESS);
+    cost = cost_end("append in logical block 0");
+    CHECK(cost.erase_count == 1);
+
+    /* A file in a dedicated data block */
+    cost_start();
+    CHECK(write_file(LARGE_ID, ITS_FLASH_FS_FLAG_CREATE, LARGE_SIZE,
+                     APPEND_SIZE, 0, 3) == PSA_SUCCESS);
+    cost = cost_end("create in a dedicated block");
+    CHECK(file_lblock(LARGE_ID) != 0);
+    large_size = APPEND_SIZE;
+
+    for (i = 0; i < 3; i++) {
+        cost_start();
+        CHECK(write_file(LARGE_ID, 0, LARGE_SIZE, APPEND_SIZE, large_size,
+                         (uint8_t)(4 + i)) == PSA_SUCCESS);
+        cost = cost_end("append in a dedicated block");
+        large_size += APPEND_SIZE;
+#ifdef ITS_APPEND_IN_PLACE
+        /* Only the new data and the metadata block are programmed, and only
+         * the scratch metadata block is erased.
+         */
+        CHECK(cost.erase_count == 1);
+        CHECK(cost.program_bytes <= flash_info->block_size + APPEND_SIZE);
+#else
+        /* The data block is copied to the scratch data block, which is
+         * erased once it has been swapped out.
+         */
+        CHECK(cost.erase_count == 2);
+        CHECK(cost.program_bytes >= large_size);
+#endif
+    }
+
+    /* Rewriting the file content always copies the data block */
+    cost_start();
+    CHECK(write_file(LARGE_ID, 0, LARGE_SIZE, large_size, 0, 7) ==
+          PSA_SUCCESS);
+    cost = cost_end("rewrite in a dedicated block");
+    CHECK(cost.erase_count == 2);
+
+    /* An update of logical block 0 after it does not erase the scratch data
+     * block again.
+     */
+    cost_start();
+    CHECK(write_file(SMALL_ID, 0, SMALL_SIZE, 2 * APPEND_SIZE, 0, 8) ==
+          PSA_SUCCESS);
+    cost = cost_end("rewrite in logical block 0");
+    CHECK(cost.erase_count == 1);
+
+    cost_start();
+    boot();
+    cost = cost_end("initialisation");
+    CHECK(cost.erase_count == 2);
+}
+
+/* Programs the scratch data block, as an update interrupted by a reboot */
+static void dirty_scratch_block(void)
+{
+    uint32_t scratch_id = its_flash_fs_mblock_cur_data_scratch_id(&fs_ctx, 1);
+
+    memset(data, 0x5A, APPEND_SIZE);
+    CHECK(flash_info->write(flash_info, scratch_id, data, 0, APPEND_SIZE) ==
+          PSA_SUCCESS);
+    CHECK(flash_info->flush(flash_info) == PSA_SUCCESS);
+}
+
+static void test_dirty_scratch_at_boot(void)
+{
+    size_t i;
+
+    format();
+    CHECK(write_file(SMALL_ID, ITS_FLASH_FS_FLAG_CREATE, SMALL_SIZE,
+                     SMALL_SIZE, 0, 1) == PSA_SUCCESS);
+    CHECK(write_file(LARGE_ID, ITS_FLASH_FS_FLAG_CREATE, LARGE_SIZE,
+                     APPEND_SIZE, 0, 2) == PSA_SUCCESS);
+    CHECK(file_lblock(LARGE_ID) != 0);
+
+    /* The scratch data block must be erased at boot before it is used */
+    dirty_scratch_block();
+    boot();
+    CHECK(write_file(LARGE_ID, 0, LARGE_SIZE, APPEND_SIZE, 0, 3) ==
+          PSA_SUCCESS);
+
+    memset(data, 3, APPEND_SIZE);
+    check_file(LARGE_ID, data, APPEND_SIZE);
+    for (i = 0; i < SMALL_SIZE; i++) {
+        data[i] = 1;
+    }
+    check_file(SMALL_ID, data, SMALL_SIZE);
+}
+
+/*
+ * Random creations, appends, rewrites and deletes of a few files, with
+ * reboots that leave the scratch data block programmed, checked against a
+ * model of the file content after every update.
+ */
+static void test_churn(void)
+{
+    static uint8_t model[NUM_CHURN_IDS][ITS_MAX_ASSET_SIZE];
+    size_t max_size[NUM_CHURN_IDS] = {0};
+    size_t cur_size[NUM_CHURN_IDS] = {0};
+    uint32_t seed = 1;
+    uint32_t round, id, op;
+    size_t size, offset;
+    uint8_t val;
+    psa_status_t err;
+
+    format();
+
+    for (round = 0; round < CHURN_ROUNDS; round++) {
+        if ((round % REBOOT_PERIOD) == 0) {
+            dirty_scratch_block();
+            boot();
+        }
+
+        seed = seed * 1103515245u + 12345u;
+        id = (seed >> 16) % NUM_CHURN_IDS;
+        op = (seed >> 20) % 4;
+        val = (uint8_t)(round + 1);
+
+        if (max_size[id] == 0) {
+            /* Create the file, with room for appends */
+            size = ((seed >> 8) % (ITS_MAX_ASSET_SIZE / APPEND_SIZE) + 1) *
+                   APPEND_SIZE;
+            err = write_file(id, ITS_FLASH_FS_FLAG_CREATE, size, APPEND_SIZE,
+                             0, val);
+            if (err == PSA_ERROR_INSUFFICIENT_STORAGE) {
+                continue;
+            }
+            CHECK(err == PSA_SUCCESS);
+            max_size[id] = size;
+            cur_size[id] = APPEND_SIZE;
+            memset(model[id], val, APPEND_SIZE);
+        } else if ((op == 0) && (cur_size[id] + APPEND_SIZE <= max_size[id])) {
+            /* Append */
+            CHECK(write_file(id, 0, max_size[id], APPEND_SIZE, cur_size[id],
+                             val) == PSA_SUCCESS);
+            memset(&model[id][cur_size[id]], val, APPEND_SIZE);
+            cur_size[id] += APPEND_SIZE;
+        } else if (op == 1) {
+            /* Rewrite from an aligned offset to the end of the file, as a
+             * write does not keep the file data after the data written.
+             */
+            offset = ((seed >> 4) % (cur_size[id] / APPEND_SIZE)) *
+                     APPEND_SIZE;
+            size = cur_size[id] - offset;
+            CHECK(write_file(id, 0, max_size[id], size, offset, val) ==
+                  PSA_SUCCESS);
+            memset(&model[id][offset], val, size);
+        } else {
+            /* Delete */
+            uint8_t fid[ITS_FILE_ID_SIZE];
+
+            make_fid(id, fid);
+            CHECK(its_flash_fs_file_delete(&fs_ctx, fid) == PSA_SUCCESS);
+            max_size[id] = 0;
+            cur_size[id] = 0;
+        }
+
+        for (id = 0; id < NUM_CHURN_IDS; id++) {
+            if (max_size[id] != 0) {
+                check_file(id, model[id], cur_size[id]);
+            }
+        }
+    }
+}
+
+int main(void)
+{
+    flash_info = its_flash_get_info(ITS_FLASH_ID_INTERNAL);
+
+    test_update_cost();
+    test_dirty_scratch_at_boot();
+    test_churn();
+
+    printf("PASS\n");
+
+    return EXIT_SUCCESS;
+}
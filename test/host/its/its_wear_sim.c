@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Wear replay simulator of the ITS flash filesystem on the emulated RAM flash
+ * device.
+ *
+ * It replays a pseudo-random sequence of set, append and remove operations on
+ * a set of files, with a reboot (new preparation of the filesystem) every
+ * REBOOT_PERIOD operations. It then reports the erase count of each physical
+ * block and the spread (maximum minus minimum) of the erase counts of the
+ * data blocks. The metadata blocks, physical blocks 0 and 1, are erased on
+ * every update by design and are reported separately.
+ *
+ * It is built with and without ITS_WEAR_LEVELING to compare the two
+ * allocators on the same sequence.
+ *
+ * Usage: its_wear_sim [operations] [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flash/its_flash.h"
+#include "flash/its_flash_ram.h"
+#include "flash_fs/its_flash_fs.h"
+#include "flash_fs/its_flash_fs_mblock.h"
+#include "its_utils.h"
+
+#define DEFAULT_OPERATIONS          40000
+#define DEFAULT_SEED                1
+#define REBOOT_PERIOD               1000
+
+/* Files of the workload and their sizes */
+#define NUM_FILES                   (ITS_NUM_ASSETS - 2)
+#define MIN_FILE_SIZE               16
+#define APPEND_SIZE                 32
+
+/* Physical blocks used as metadata blocks */
+#define NUM_METADATA_BLOCKS         2
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+struct sim_file_t {
+    size_t max_size;        /* Maximum size, 0 if the file does not exist */
+    size_t cur_size;        /* Current size */
+};
+
+static its_flash_fs_ctx_t fs_ctx;
+static const struct its_flash_info_t *flash_info;
+static struct sim_file_t files[NUM_FILES];
+static uint8_t data[ITS_MAX_ASSET_SIZE];
+static uint32_t rand_state;
+
+/* Operations done, and refused for lack of space */
+static uint32_t nr_sets, nr_appends, nr_removes, nr_full;
+
+static uint32_t sim_rand(void)
+{
+    rand_state = rand_state * 1103515245u + 12345u;
+
+    return rand_state >> 16;
+}
+
+/* The IDs are offset by one, as an all-zero ID marks an unused file entry */
+static void make_fid(uint32_t id, uint8_t *fid)
+{
+    uint32_t fid_val = id + 1;
+
+    memset(fid, 0, ITS_FILE_ID_SIZE);
+    memcpy(fid, &fid_val, sizeof(fid_val));
+}
+
+/* Prepares the filesystem as at boot, creating it if it is not valid */
+static void boot(void)
+{
+    if (its_flash_fs_prepare(&fs_ctx, flash_info) != PSA_SUCCESS) {
+        CHECK(its_flash_fs_wipe_all(&fs_ctx) == PSA_SUCCESS);
+        CHECK(its_flash_fs_prepare(&fs_ctx, flash_info) == PSA_SUCCESS);
+    }
+}
+
+static void do_set(uint32_t id, const uint8_t *fid)
+{
+    size_t size = MIN_FILE_SIZE +
+                  sim_rand() % (ITS_MAX_ASSET_SIZE - MIN_FILE_SIZE + 1);
+    psa_status_t err;
+
+    memset(data, (int)sim_rand(), size);
+    err = its_flash_fs_file_write(&fs_ctx, fid,
+                                  ITS_FLASH_FS_FLAG_CREATE |
+                                  ITS_FLASH_FS_FLAG_TRUNCATE,
+                                  size, size, 0, data);
+    if (err == PSA_ERROR_INSUFFICIENT_STORAGE) {
+        nr_full++;
+        return;
+    }
+    CHECK(err == PSA_SUCCESS);
+
+    files[id].max_size = size;
+    files[id].cur_size = size;
+    nr_sets++;
+}
+
+/* Appends to a file created with room left. The appended data is a whole
+ * number of program units, as file offsets must be aligned to them.
+ */
+static void do_append(uint32_t id, const uint8_t *fid)
+{
+    size_t size = ITS_UTILS_ALIGN(MIN_FILE_SIZE + sim_rand() % APPEND_SIZE,
+                                  flash_info->program_unit);
+    size_t max_size;
+    psa_status_t err;
+
+    if (files[id].max_size == 0) {
+        /* Create the file with room for appends */
+        max_size = ITS_MAX_ASSET_SIZE / 2 +
+                   sim_rand() % (ITS_MAX_ASSET_SIZE / 2);
+        err = its_flash_fs_file_write(&fs_ctx, fid, ITS_FLASH_FS_FLAG_CREATE,
+                                      max_size, 0, 0, NULL);
+        if (err == PSA_ERROR_INSUFFICIENT_STORAGE) {
+            nr_full++;
+            return;
+        }
+        CHECK(err == PSA_SUCCESS);
+        files[id].max_size = max_size;
+        files[id].cur_size = 0;
+    }
+
+    if (files[id].cur_size + size > files[id].max_size) {
+        /* The file is full, start it again */
+        do_set(id, fid);
+        return;
+    }
+
+    memset(data, (int)sim_rand(), size);
+    CHECK(its_flash_fs_file_write(&fs_ctx, fid, 0, files[id].max_size, size,
+                                  files[id].cur_size, data) == PSA_SUCCESS);
+    files[id].cur_size += size;
+    nr_appends++;
+}
+
+static void do_remove(uint32_t id, const uint8_t *fid)
+{
+    if (files[id].max_size == 0) {
+        return;
+    }
+
+    CHECK(its_flash_fs_file_delete(&fs_ctx, fid) == PSA_SUCCESS);
+    files[id].max_size = 0;
+    files[id].cur_size = 0;
+    nr_removes++;
+}
+
+static void replay(uint32_t operations)
+{
+    uint8_t fid[ITS_FILE_ID_SIZE];
+    uint32_t i, id, op;
+
+    for (i = 0; i < operations; i++) {
+        if ((i % REBOOT_PERIOD) == 0) {
+            boot();
+        }
+
+        id = sim_rand() % NUM_FILES;
+        make_fid(id, fid);
+
+        /* Half sets, a third appends and the rest removes */
+        op = sim_rand() % 6;
+        if (op < 3) {
+            do_set(id, fid);
+        } else if (op < 5) {
+            do_append(id, fid);
+        } else {
+            do_remove(id, fid);
+        }
+    }
+}
+
+static void report(void)
+{
+    struct its_flash_ram_stats_t stats;
+    uint32_t num_blocks = flash_info->num_blocks;
+    uint32_t min = UINT32_MAX;
+    uint32_t max = 0;
+    uint32_t i, count;
+
+    CHECK(its_flash_ram_get_stats(flash_info, &stats) == PSA_SUCCESS);
+
+    printf("metadata block erases:");
+    for (i = 0; i < NUM_METADATA_BLOCKS; i++) {
+        printf(" %u", stats.block_erase_count[i]);
+    }
+    printf("\ndata block erases:");
+    for (i = NUM_METADATA_BLOCKS; i < num_blocks; i++) {
+        count = stats.block_erase_count[i];
+        printf(" %u", count);
+        if (count < min) {
+            min = count;
+        }
+        if (count > max) {
+            max = count;
+        }
+    }
+    printf("\ndata block erase spread: %u (max %u, min %u)\n", max - min, max,
+           min);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t operations = DEFAULT_OPERATIONS;
+
+    rand_state = DEFAULT_SEED;
+    if (argc > 1) {
+        operations = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2) {
+        rand_state = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+
+    flash_info = its_flash_get_info(ITS_FLASH_ID_INTERNAL);
+    CHECK(flash_info->num_blocks <= ITS_RAM_FS_STATS_MAX_BLOCKS);
+
+#ifdef ITS_WEAR_LEVELING
+    printf("ITS wear leveling on, threshold %u erases\n",
+           (unsigned int)ITS_WEAR_LEVELING_THRESHOLD);
+#else
+    printf("ITS wear leveling off\n");
+#endif
+    printf("%u blocks of %u B, %u files, %u operations, reboot every %u\n",
+           flash_info->num_blocks, flash_info->block_size, NUM_FILES,
+           operations, REBOOT_PERIOD);
+
+    /* Start from an erased device and count from the first boot */
+    its_flash_ram_reset_stats(flash_info);
+    replay(operations);
+
+    printf("%u sets, %u appends, %u removes, %u refused for lack of space\n",
+           nr_sets, nr_appends, nr_removes, nr_full);
+    report();
+
+    return EXIT_SUCCESS;
+}
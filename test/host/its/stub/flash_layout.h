@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/* Host stub of the target flash layout for the ITS host tests */
+
+#ifndef __FLASH_LAYOUT_H__
+#define __FLASH_LAYOUT_H__
+
+/* Internal Trusted Storage (ITS) emulated in RAM */
+#define ITS_FLASH_DEV_NAME      Driver_FLASH0
+#define ITS_FLASH_AREA_ADDR     (0x0)
+#ifndef ITS_FLASH_AREA_SIZE
+#define ITS_FLASH_AREA_SIZE     (0x4000)   /* 16 KB */
+#endif
+#define ITS_RAM_FS_SIZE         ITS_FLASH_AREA_SIZE
+#define ITS_SECTOR_SIZE         (0x1000)   /* 4 KB */
+/* Number of ITS_SECTOR_SIZE per block */
+#ifndef ITS_SECTORS_PER_BLOCK
+#define ITS_SECTORS_PER_BLOCK   (0x1)
+#endif
+/* Specifies the smallest flash programmable unit in bytes */
+#define ITS_FLASH_PROGRAM_UNIT  (0x4)
+
+/* Protected Storage (PS), not used by the tests */
+#define PS_FLASH_DEV_NAME       Driver_FLASH0
+#define PS_SECTOR_SIZE          (0x1000)
+#define PS_SECTORS_PER_BLOCK    (0x1)
+#define PS_FLASH_PROGRAM_UNIT   (0x1)
+
+#endif /* __FLASH_LAYOUT_H__ */
@@ -0,0 +1,508 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Stress test of NSPE and SPE mailbox on POSIX threads.
+ *
+ * NSPE mailbox and SPE mailbox run unmodified over a single NSPE mailbox queue,
+ * with the same layout as the shared memory between the cores:
+ * - Several client threads act as non-secure tasks submitting PSA client
+ *   calls.
+ * - With TFM_MULTI_CORE_MULTI_CLIENT_CALL, a thread acts as the non-secure
+ *   reply notification ISR.
+ * - A thread acts as SPE, handling the requests and replying to psa_call()
+ *   in random order, as RoT Services complete them.
+ * The non-secure threads exclude each other while they mask interrupts, as
+ * tasks and ISRs on a single non-secure core would. Memory barriers randomly
+ * yield the CPU to widen the race windows.
+ *
+ * The test fails if a reply is wrong, if the calls stop making progress, or
+ * if any slot is missing from the rings at the end. With
+ * TFM_MULTI_CORE_MAILBOX_PROFILING, the profiling statistics of NSPE and SPE
+ * must also count every call.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmsis_compiler.h"
+#include "tfm_ns_mailbox.h"
+#include "tfm_rpc.h"
+#include "tfm_spe_mailbox.h"
+#include "tfm_thread.h"
+
+#define NR_CLIENTS                  12
+#define NR_CALLS_PER_CLIENT         10000
+#define STALL_TIMEOUT_SEC           10
+
+/* psa_version() returns the SID minus this base, to check the reply */
+#define VERSION_SID_BASE            0x1000
+
+/* The NSPE mailbox queue in the memory shared by the cores */
+static struct ns_mailbox_queue_t ns_queue;
+static struct secure_mailbox_queue_t *spe_queue;
+
+static atomic_bool nspe_notified;
+static atomic_bool spe_notified;
+static atomic_bool spe_schedule;
+static atomic_bool stop;
+static atomic_ulong nr_completed;
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+static atomic_uint ticks;
+#endif
+
+static pthread_mutex_t ns_irq_lock = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local uint32_t ns_primask;
+static _Thread_local uint32_t rand_state;
+
+static void fail(const char *msg)
+{
+    fprintf(stderr, "FAIL: %s\n", msg);
+    exit(EXIT_FAILURE);
+}
+
+static uint32_t rand_next(void)
+{
+    if (rand_state == 0) {
+        rand_state = 0x9E3779B9u ^ (uint32_t)(uintptr_t)&rand_state;
+    }
+
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+
+    return rand_state;
+}
+
+uint32_t __get_PRIMASK(void)
+{
+    return ns_primask;
+}
+
+void __disable_irq(void)
+{
+    if (!ns_primask) {
+        pthread_mutex_lock(&ns_irq_lock);
+        ns_primask = 1;
+    }
+}
+
+void __enable_irq(void)
+{
+    if (ns_primask) {
+        ns_primask = 0;
+        pthread_mutex_unlock(&ns_irq_lock);
+    }
+}
+
+void __set_PRIMASK(uint32_t primask)
+{
+    if (primask) {
+        __disable_irq();
+    } else {
+        __enable_irq();
+    }
+}
+
+void host_dmb(void)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if ((rand_next() & 0x7) == 0) {
+        sched_yield();
+    }
+}
+
+/* NSPE mailbox HAL */
+int32_t tfm_ns_mailbox_hal_init(struct ns_mailbox_queue_t *queue)
+{
+    (void)queue;
+
+    return MAILBOX_SUCCESS;
+}
+
+int32_t tfm_ns_mailbox_hal_notify_peer(void)
+{
+    atomic_store(&nspe_notified, true);
+
+    return MAILBOX_SUCCESS;
+}
+
+#ifdef TFM_MULTI_CORE_MULTI_CLIENT_CALL
+static _Thread_local int task_handle;
+
+const void *tfm_ns_mailbox_get_task_handle(void)
+{
+    return &task_handle;
+}
+
+void tfm_ns_mailbox_hal_wait_reply(mailbox_msg_handle_t handle)
+{
+    (void)handle;
+
+    sched_yield();
+}
+#endif
+
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+/* The time base shared by NSPE and SPE advances on every read */
+uint32_t tfm_ns_mailbox_hal_get_timestamp(void)
+{
+    return atomic_fetch_add(&ticks, 1);
+}
+
+uint32_t tfm_mailbox_hal_get_timestamp(void)
+{
+    return atomic_fetch_add(&ticks, 1);
+}
+#endif
+
+/* SPE mailbox HAL */
+int32_t tfm_mailbox_hal_init(struct secure_mailbox_queue_t *s_queue)
+{
+    s_queue->ns_queue = &ns_queue;
+    spe_queue = s_queue;
+
+    return MAILBOX_SUCCESS;
+}
+
+int32_t tfm_mailbox_hal_notify_peer(void)
+{
+    atomic_store(&spe_notified, true);
+
+    return MAILBOX_SUCCESS;
+}
+
+void tfm_core_thrd_activate_schedule(void)
+{
+    atomic_store(&spe_schedule, true);
+}
+
+/* TF-M RPC, only called by the SPE thread */
+struct pending_call {
+    const void *owner;
+    int32_t    result;
+};
+
+static const struct tfm_rpc_ops_t *rpc_ops;
+static struct pending_call pending_calls[NUM_MAILBOX_QUEUE_SLOT];
+static uint32_t nr_pending_calls;
+
+int32_t tfm_rpc_register_ops(const struct tfm_rpc_ops_t *ops_ptr)
+{
+    rpc_ops = ops_ptr;
+
+    return TFM_RPC_SUCCESS;
+}
+
+void tfm_rpc_unregister_ops(void)
+{
+    rpc_ops = NULL;
+}
+
+uint32_t tfm_rpc_psa_framework_version(void)
+{
+    return PSA_FRAMEWORK_VERSION;
+}
+
+uint32_t tfm_rpc_psa_version(const struct client_call_params_t *params,
+                             bool ns_caller)
+{
+    (void)ns_caller;
+
+    return params->sid - VERSION_SID_BASE;
+}
+
+psa_status_t tfm_rpc_psa_connect(const struct client_call_params_t *params,
+                                 bool ns_caller)
+{
+    (void)params;
+    (void)ns_caller;
+
+    return PSA_ERROR_CONNECTION_REFUSED;
+}
+
+psa_status_t tfm_rpc_psa_call(const struct client_call_params_t *params,
+                              bool ns_caller)
+{
+    (void)ns_caller;
+
+    if (nr_pending_calls >= NUM_MAILBOX_QUEUE_SLOT) {
+        fail("more calls in progress than SPE mailbox slots");
+    }
+
+    /* Reply later, as the RoT Service completes the call */
+    pending_calls[nr_pending_calls].owner = rpc_ops->get_caller_data(0);
+    pending_calls[nr_pending_calls].result = params->type;
+    nr_pending_calls++;
+
+    return PSA_SUCCESS;
+}
+
+void tfm_rpc_psa_close(const struct client_call_params_t *params,
+                       bool ns_caller)
+{
+    (void)params;
+    (void)ns_caller;
+}
+
+uint32_t tfm_rpc_get_handle_sid(psa_handle_t handle)
+{
+    (void)handle;
+
+    return 0;
+}
+
+static void *spe_thread(void *arg)
+{
+    struct pending_call call;
+    uint32_t i;
+
+    (void)arg;
+
+    while (!atomic_load(&stop)) {
+        if (atomic_exchange(&nspe_notified, false) |
+            atomic_exchange(&spe_schedule, false)) {
+            (void)tfm_mailbox_handle_msg();
+        }
+
+        if ((nr_pending_calls == 0) || (rand_next() & 0x1)) {
+            sched_yield();
+            continue;
+        }
+
+        i = rand_next() % nr_pending_calls;
+        call = pending_calls[i];
+        pending_calls[i] = pending_calls[--nr_pending_calls];
+
+        rpc_ops->reply(call.owner, call.result);
+    }
+
+    return NULL;
+}
+
+#ifdef TFM_MULTI_CORE_MULTI_CLIENT_CALL
+static void *nspe_isr_thread(void *arg)
+{
+    (void)arg;
+
+    while (!atomic_load(&stop)) {
+        if (!atomic_exchange(&spe_notified, false)) {
+            sched_yield();
+            continue;
+        }
+
+        /* Tasks cannot run on the non-secure core during the ISR */
+        __disable_irq();
+        while (tfm_ns_mailbox_fetch_reply_msg_isr() !=
+               MAILBOX_MSG_NULL_HANDLE) {
+        }
+        __enable_irq();
+    }
+
+    return NULL;
+}
+#endif
+
+static void *nspe_client_thread(void *arg)
+{
+    int32_t client_id = (int32_t)(uintptr_t)arg;
+    struct psa_client_params_t params;
+    mailbox_msg_handle_t handle;
+    uint32_t call_type, i;
+    int32_t token, reply;
+
+    for (i = 0; i < NR_CALLS_PER_CLIENT; i++) {
+        token = (client_id << 20) | (int32_t)i;
+
+        memset(&params, 0, sizeof(params));
+        if ((i & 0x3) == 0) {
+            call_type = MAILBOX_PSA_VERSION;
+            params.psa_version_params.sid = VERSION_SID_BASE + (uint32_t)token;
+        } else {
+            call_type = MAILBOX_PSA_CALL;
+            params.psa_call_params.type = token;
+        }
+
+        while ((handle = tfm_ns_mailbox_tx_client_req(call_type, &params,
+                                                      client_id)) ==
+               MAILBOX_QUEUE_FULL) {
+            sched_yield();
+        }
+        if (handle <= MAILBOX_MSG_NULL_HANDLE) {
+            fail("tfm_ns_mailbox_tx_client_req()");
+        }
+
+#ifdef TFM_MULTI_CORE_MULTI_CLIENT_CALL
+        if (tfm_ns_mailbox_wait_reply(handle) != MAILBOX_SUCCESS) {
+            fail("tfm_ns_mailbox_wait_reply()");
+        }
+#else
+        while (!tfm_ns_mailbox_is_msg_replied(handle)) {
+            sched_yield();
+        }
+#endif
+
+        if (tfm_ns_mailbox_rx_client_reply(handle, &reply) !=
+            MAILBOX_SUCCESS) {
+            fail("tfm_ns_mailbox_rx_client_reply()");
+        }
+        if (reply != token) {
+            fail("wrong reply");
+        }
+
+        atomic_fetch_add(&nr_completed, 1);
+    }
+
+    return NULL;
+}
+
+/*
+ * The number of slots in each ring. SPE keeps its positions of pend_ring and
+ * reply_ring in its own queue.
+ */
+static uint32_t nr_free(void)
+{
+    return ns_queue.free_ring.enqueue_pos - ns_queue.free_ring.dequeue_pos;
+}
+
+static uint32_t nr_pend(void)
+{
+    return ns_queue.pend_ring.enqueue_pos - spe_queue->pend_pos;
+}
+
+static uint32_t nr_reply(void)
+{
+    return spe_queue->reply_pos - ns_queue.reply_ring.dequeue_pos;
+}
+
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+static unsigned long nr_sid_calls(const struct mailbox_sid_stats_t *sids)
+{
+    unsigned long n = 0;
+    uint32_t i;
+
+    for (i = 0; i < MAILBOX_PROFILING_NR_SID; i++) {
+        n += sids[i].nr_calls;
+    }
+
+    return n;
+}
+
+/* Every call is counted once in each histogram and in the SID statistics */
+static void check_profile(unsigned long nr_total)
+{
+    struct ns_mailbox_profile_t ns_profile;
+    struct spe_mailbox_profile_t spe_profile;
+
+    if ((tfm_ns_mailbox_profile_get(&ns_profile) != MAILBOX_SUCCESS) ||
+        (tfm_mailbox_profile_get(&spe_profile) != MAILBOX_SUCCESS)) {
+        fail("profile_get()");
+    }
+
+    if ((ns_profile.pickup.count != nr_total) ||
+        (ns_profile.service.count != nr_total) ||
+        (ns_profile.wakeup.count != nr_total) ||
+        (ns_profile.total.count != nr_total) ||
+        (nr_sid_calls(ns_profile.sids) + ns_profile.nr_other_calls !=
+         nr_total)) {
+        fail("NSPE mailbox profile");
+    }
+
+    if ((spe_profile.pickup.count != nr_total) ||
+        (spe_profile.service.count != nr_total) ||
+        (nr_sid_calls(spe_profile.sids) + spe_profile.nr_other_calls !=
+         nr_total)) {
+        fail("SPE mailbox profile");
+    }
+
+    /*
+     * The psa_version() calls are to distinct SIDs, which fill the SID
+     * statistics.
+     */
+    if ((ns_profile.sids[MAILBOX_PROFILING_NR_SID - 1].sid == 0) ||
+        (spe_profile.sids[MAILBOX_PROFILING_NR_SID - 1].sid == 0)) {
+        fail("mailbox SID statistics");
+    }
+}
+#endif
+
+int main(void)
+{
+    const unsigned long nr_total = NR_CLIENTS * NR_CALLS_PER_CLIENT;
+    pthread_t clients[NR_CLIENTS], spe;
+#ifdef TFM_MULTI_CORE_MULTI_CLIENT_CALL
+    pthread_t isr;
+#endif
+    unsigned long done, last_done = 0;
+    struct timespec second = {1, 0};
+    uint32_t i, nr_stalled_sec = 0;
+
+    if (tfm_ns_mailbox_init(&ns_queue) != MAILBOX_SUCCESS) {
+        fail("tfm_ns_mailbox_init()");
+    }
+    if (tfm_mailbox_init() != MAILBOX_SUCCESS) {
+        fail("tfm_mailbox_init()");
+    }
+
+    pthread_create(&spe, NULL, spe_thread, NULL);
+#ifdef TFM_MULTI_CORE_MULTI_CLIENT_CALL
+    pthread_create(&isr, NULL, nspe_isr_thread, NULL);
+#endif
+    for (i = 0; i < NR_CLIENTS; i++) {
+        pthread_create(&clients[i], NULL, nspe_client_thread,
+                       (void *)(uintptr_t)(i + 1));
+    }
+
+    while ((done = atomic_load(&nr_completed)) < nr_total) {
+        nanosleep(&second, NULL);
+
+        if (done != last_done) {
+            last_done = done;
+            nr_stalled_sec = 0;
+        } else if (++nr_stalled_sec >= STALL_TIMEOUT_SEC) {
+            fprintf(stderr, "%lu of %lu calls completed\n", done, nr_total);
+            fprintf(stderr, "free %u, pend %u, reply %u, SPE free slots %u\n",
+                    nr_free(), nr_pend(), nr_reply(),
+                    spe_queue->nr_free_slots);
+            fail("no progress");
+        }
+    }
+
+    for (i = 0; i < NR_CLIENTS; i++) {
+        pthread_join(clients[i], NULL);
+    }
+    atomic_store(&stop, true);
+    pthread_join(spe, NULL);
+#ifdef TFM_MULTI_CORE_MULTI_CLIENT_CALL
+    pthread_join(isr, NULL);
+#endif
+
+    /* Every slot must be back in the empty state */
+    if ((nr_free() != NUM_MAILBOX_QUEUE_SLOT) || (nr_pend() != 0) ||
+        (nr_reply() != 0)) {
+        fail("NSPE mailbox slots lost");
+    }
+    if ((spe_queue->nr_free_slots != NUM_MAILBOX_QUEUE_SLOT) ||
+        (spe_queue->nr_unposted != 0)) {
+        fail("SPE mailbox slots lost");
+    }
+
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+    check_profile(nr_total);
+#endif
+
+    printf("PASS: %lu calls over %u slots\n", nr_total,
+           (unsigned int)NUM_MAILBOX_QUEUE_SLOT);
+
+    return EXIT_SUCCESS;
+}
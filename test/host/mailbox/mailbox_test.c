@@ -0,0 +1,560 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Test of the SPE mailbox handling of the PSA client calls in progress.
+ *
+ * The test acts as NSPE directly on the NSPE mailbox queue, so that it
+ * controls which requests are pending in pend_ring, and as the RoT Services,
+ * which complete the psa_call() requests in the order the test chooses.
+ *
+ * With TFM_MULTI_CORE_MAILBOX_PROFILING, the test also checks the profiling
+ * statistics of SPE mailbox, with timestamps the test sets.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cmsis_compiler.h"
+#include "tfm_rpc.h"
+#include "tfm_spe_mailbox.h"
+#include "tfm_thread.h"
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+/* The token of a psa_call() request, returned by the RoT Service */
+#define TOKEN(n)                    ((int32_t)(0x100 + (n)))
+
+/* The NSPE mailbox queue in the memory shared by the cores */
+static struct ns_mailbox_queue_t ns_queue;
+static struct secure_mailbox_queue_t *spe_queue;
+
+static uint32_t nr_notified;
+static bool schedule_activated;
+
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+/* The time base shared by NSPE and SPE */
+static uint32_t now;
+#endif
+
+/* The owners of the psa_call() requests the RoT Services are handling */
+static const void *call_owners[NUM_MAILBOX_QUEUE_SLOT];
+static int32_t call_tokens[NUM_MAILBOX_QUEUE_SLOT];
+static uint32_t nr_calls;
+
+static const struct tfm_rpc_ops_t *rpc_ops;
+
+uint32_t __get_PRIMASK(void)
+{
+    return 0;
+}
+
+void __set_PRIMASK(uint32_t primask)
+{
+    (void)primask;
+}
+
+void __disable_irq(void)
+{
+}
+
+void __enable_irq(void)
+{
+}
+
+void host_dmb(void)
+{
+}
+
+/* SPE mailbox HAL */
+int32_t tfm_mailbox_hal_init(struct secure_mailbox_queue_t *s_queue)
+{
+    s_queue->ns_queue = &ns_queue;
+    spe_queue = s_queue;
+
+    return MAILBOX_SUCCESS;
+}
+
+int32_t tfm_mailbox_hal_notify_peer(void)
+{
+    nr_notified++;
+
+    return MAILBOX_SUCCESS;
+}
+
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+uint32_t tfm_mailbox_hal_get_timestamp(void)
+{
+    return now;
+}
+#endif
+
+void tfm_core_thrd_activate_schedule(void)
+{
+    schedule_activated = true;
+}
+
+/* TF-M RPC */
+int32_t tfm_rpc_register_ops(const struct tfm_rpc_ops_t *ops_ptr)
+{
+    rpc_ops = ops_ptr;
+
+    return TFM_RPC_SUCCESS;
+}
+
+void tfm_rpc_unregister_ops(void)
+{
+    rpc_ops = NULL;
+}
+
+uint32_t tfm_rpc_psa_framework_version(void)
+{
+    return PSA_FRAMEWORK_VERSION;
+}
+
+uint32_t tfm_rpc_psa_version(const struct client_call_params_t *params,
+                             bool ns_caller)
+{
+    (void)ns_caller;
+
+    return params->sid;
+}
+
+psa_status_t tfm_rpc_psa_connect(const struct client_call_params_t *params,
+                                 bool ns_caller)
+{
+    (void)params;
+    (void)ns_caller;
+
+    return PSA_ERROR_CONNECTION_REFUSED;
+}
+
+psa_status_t tfm_rpc_psa_call(const struct client_call_params_t *params,
+                              bool ns_caller)
+{
+    (void)ns_caller;
+
+    CHECK(nr_calls < NUM_MAILBOX_QUEUE_SLOT);
+
+    /* The RoT Service replies when the test completes the call */
+    call_owners[nr_calls] = rpc_ops->get_caller_data(0);
+    call_tokens[nr_calls] = params->type;
+    nr_calls++;
+
+    return PSA_SUCCESS;
+}
+
+void tfm_rpc_psa_close(const struct client_call_params_t *params,
+                       bool ns_caller)
+{
+    (void)params;
+    (void)ns_caller;
+}
+
+/* The handles of the test are the SIDs of the RoT Services */
+uint32_t tfm_rpc_get_handle_sid(psa_handle_t handle)
+{
+    return (uint32_t)handle;
+}
+
+static void ring_init(struct mailbox_ring_t *ring)
+{
+    uint32_t i;
+
+    ring->enqueue_pos = 0;
+    ring->dequeue_pos = 0;
+
+    for (i = 0; i < MAILBOX_RING_SIZE; i++) {
+        ring->entries[i].seq = i;
+    }
+}
+
+static void ns_init(void)
+{
+    memset(&ns_queue, 0, sizeof(ns_queue));
+    ring_init(&ns_queue.pend_ring);
+    ring_init(&ns_queue.reply_ring);
+
+    nr_calls = 0;
+    nr_notified = 0;
+    schedule_activated = false;
+
+    CHECK(tfm_mailbox_init() == MAILBOX_SUCCESS);
+}
+
+/* Submits the message of an NSPE slot, as NSPE does */
+static void ns_submit(uint8_t ns_idx)
+{
+    struct mailbox_ring_t *ring = &ns_queue.pend_ring;
+    struct mailbox_ring_entry_t *entry;
+    uint32_t pos = ring->enqueue_pos;
+
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+    memset(&ns_queue.queue[ns_idx].ts, 0, sizeof(ns_queue.queue[ns_idx].ts));
+    ns_queue.queue[ns_idx].ts.enqueue = now;
+#endif
+
+    entry = &ring->entries[pos & (MAILBOX_RING_SIZE - 1)];
+    CHECK(entry->seq == pos);
+    ring->enqueue_pos = pos + 1;
+    entry->slot_idx = ns_idx;
+    entry->seq = pos + 1;
+}
+
+/* Submits a psa_call() request, which returns the token */
+static void ns_submit_call(uint8_t ns_idx, int32_t token)
+{
+    struct mailbox_msg_t *msg = &ns_queue.queue[ns_idx].msg;
+
+    memset(msg, 0, sizeof(*msg));
+    msg->call_type = MAILBOX_PSA_CALL;
+    msg->params.psa_call_params.type = token;
+
+    ns_submit(ns_idx);
+}
+
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+/* Submits a psa_version() request, which returns the SID */
+static void ns_submit_version(uint8_t ns_idx, uint32_t sid)
+{
+    struct mailbox_msg_t *msg = &ns_queue.queue[ns_idx].msg;
+
+    memset(msg, 0, sizeof(*msg));
+    msg->call_type = MAILBOX_PSA_VERSION;
+    msg->params.psa_version_params.sid = sid;
+
+    ns_submit(ns_idx);
+}
+#endif
+
+/* Returns the number of requests left in pend_ring, at SPE position */
+static uint32_t ns_nr_pend(void)
+{
+    return ns_queue.pend_ring.enqueue_pos - spe_queue->pend_pos;
+}
+
+/* Checks that the next reply of reply_ring is the one of an NSPE slot */
+static void ns_check_reply(uint8_t ns_idx, int32_t token)
+{
+    struct mailbox_ring_t *ring = &ns_queue.reply_ring;
+    struct mailbox_ring_entry_t *entry;
+    uint32_t pos = ring->dequeue_pos;
+
+    entry = &ring->entries[pos & (MAILBOX_RING_SIZE - 1)];
+    CHECK(entry->seq == pos + 1);
+    CHECK(entry->slot_idx == ns_idx);
+    CHECK(ns_queue.queue[ns_idx].reply.return_val == token);
+
+    ring->dequeue_pos = pos + 1;
+    entry->seq = pos + MAILBOX_RING_SIZE;
+}
+
+static bool ns_has_reply(void)
+{
+    uint32_t pos = ns_queue.reply_ring.dequeue_pos;
+
+    return ns_queue.reply_ring.entries[pos & (MAILBOX_RING_SIZE - 1)].seq ==
+           pos + 1;
+}
+
+/* Completes the psa_call() request with a token, as its RoT Service */
+static void complete_call(int32_t token)
+{
+    uint32_t i;
+
+    for (i = 0; i < nr_calls; i++) {
+        if (call_tokens[i] == token) {
+            break;
+        }
+    }
+    CHECK(i < nr_calls);
+
+    rpc_ops->reply(call_owners[i], token);
+
+    nr_calls--;
+    call_owners[i] = call_owners[nr_calls];
+    call_tokens[i] = call_tokens[nr_calls];
+}
+
+/* The calls complete in the opposite order to their submission */
+static void test_out_of_order(void)
+{
+    uint8_t i;
+
+    ns_init();
+
+    for (i = 0; i < NUM_MAILBOX_QUEUE_SLOT; i++) {
+        ns_submit_call(i, TOKEN(i));
+    }
+    CHECK(tfm_mailbox_handle_msg() == MAILBOX_SUCCESS);
+    CHECK(nr_calls == NUM_MAILBOX_QUEUE_SLOT);
+    CHECK(!ns_has_reply());
+
+    /*
+     * Complete the last call, and then the first call. The replies go to the
+     * NSPE slots of the calls.
+     */
+    complete_call(TOKEN(NUM_MAILBOX_QUEUE_SLOT - 1));
+    ns_check_reply(NUM_MAILBOX_QUEUE_SLOT - 1,
+                   TOKEN(NUM_MAILBOX_QUEUE_SLOT - 1));
+    complete_call(TOKEN(0));
+    ns_check_reply(0, TOKEN(0));
+    CHECK(!ns_has_reply());
+
+    /*
+     * A new call in a freed NSPE slot takes a freed SPE slot, while the other
+     * calls are still in progress.
+     */
+    ns_submit_call(0, TOKEN(NUM_MAILBOX_QUEUE_SLOT));
+    CHECK(tfm_mailbox_handle_msg() == MAILBOX_SUCCESS);
+    CHECK(nr_calls == NUM_MAILBOX_QUEUE_SLOT - 1);
+
+    complete_call(TOKEN(NUM_MAILBOX_QUEUE_SLOT));
+    ns_check_reply(0, TOKEN(NUM_MAILBOX_QUEUE_SLOT));
+    for (i = NUM_MAILBOX_QUEUE_SLOT - 1; i > 0; i--) {
+        if (i != NUM_MAILBOX_QUEUE_SLOT - 1) {
+            complete_call(TOKEN(i));
+            ns_check_reply(i, TOKEN(i));
+        }
+    }
+    CHECK(nr_calls == 0);
+    CHECK(!ns_has_reply());
+
+    /* A call cannot be replied twice */
+    CHECK(tfm_mailbox_reply_msg((mailbox_msg_handle_t)1, 0) ==
+          MAILBOX_NO_PEND_EVENT);
+    CHECK(!ns_has_reply());
+}
+
+/*
+ * NSPE is not trusted to submit fewer requests than SPE mailbox slots. The
+ * requests submitted while all the SPE slots are busy stay in pend_ring, until
+ * a reply frees a slot and requests another mailbox handling.
+ */
+static void test_all_slots_busy(void)
+{
+    uint8_t i;
+
+    ns_init();
+
+    for (i = 0; i < NUM_MAILBOX_QUEUE_SLOT; i++) {
+        ns_submit_call(i, TOKEN(i));
+    }
+    CHECK(tfm_mailbox_handle_msg() == MAILBOX_SUCCESS);
+    CHECK(nr_calls == NUM_MAILBOX_QUEUE_SLOT);
+
+    /* Another request, in an NSPE slot whose message SPE has taken */
+    ns_submit_call(0, TOKEN(NUM_MAILBOX_QUEUE_SLOT));
+    CHECK(tfm_mailbox_handle_msg() == MAILBOX_NO_PEND_EVENT);
+    CHECK(ns_nr_pend() == 1);
+    CHECK(nr_calls == NUM_MAILBOX_QUEUE_SLOT);
+    CHECK(!schedule_activated);
+
+    /* A reply frees a slot, and requests the handling of the request */
+    complete_call(TOKEN(1));
+    ns_check_reply(1, TOKEN(1));
+    CHECK(schedule_activated);
+
+    schedule_activated = false;
+    CHECK(tfm_mailbox_handle_msg() == MAILBOX_SUCCESS);
+    CHECK(ns_nr_pend() == 0);
+    CHECK(nr_calls == NUM_MAILBOX_QUEUE_SLOT);
+
+    complete_call(TOKEN(NUM_MAILBOX_QUEUE_SLOT));
+    ns_check_reply(0, TOKEN(NUM_MAILBOX_QUEUE_SLOT));
+    CHECK(schedule_activated);
+
+    /* A reply while a slot is free does not request another handling */
+    schedule_activated = false;
+    complete_call(TOKEN(0));
+    ns_check_reply(0, TOKEN(0));
+    CHECK(!schedule_activated);
+}
+
+/*
+ * A reply without the message handle is only accepted while a single message
+ * is in progress.
+ */
+static void test_null_handle(void)
+{
+    uint32_t notified;
+
+    ns_init();
+
+    ns_submit_call(0, TOKEN(0));
+    ns_submit_call(1, TOKEN(1));
+    CHECK(tfm_mailbox_handle_msg() == MAILBOX_SUCCESS);
+    CHECK(nr_calls == 2);
+
+    notified = nr_notified;
+    CHECK(tfm_mailbox_reply_msg(MAILBOX_MSG_NULL_HANDLE, TOKEN(0)) ==
+          MAILBOX_INVAL_PARAMS);
+    CHECK(!ns_has_reply());
+    CHECK(nr_notified == notified);
+
+    /* Once the other message is replied, it is the message in progress */
+    complete_call(TOKEN(0));
+    ns_check_reply(0, TOKEN(0));
+    CHECK(tfm_mailbox_reply_msg(MAILBOX_MSG_NULL_HANDLE, TOKEN(1)) ==
+          MAILBOX_SUCCESS);
+    ns_check_reply(1, TOKEN(1));
+
+    /* No message is in progress */
+    CHECK(tfm_mailbox_reply_msg(MAILBOX_MSG_NULL_HANDLE, TOKEN(1)) ==
+          MAILBOX_INVAL_PARAMS);
+    CHECK(!ns_has_reply());
+}
+
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+static void check_hist(const struct mailbox_latency_hist_t *hist,
+                       const uint32_t *latencies, uint32_t nr_latencies)
+{
+    uint32_t buckets[MAILBOX_LATENCY_NR_BUCKETS] = {0};
+    uint32_t i, bucket, max = 0;
+    uint64_t total = 0;
+
+    for (i = 0; i < nr_latencies; i++) {
+        for (bucket = MAILBOX_LATENCY_NR_BUCKETS - 1;
+             (bucket > 0) && (latencies[i] < (1UL << bucket)); bucket--) {
+        }
+        buckets[bucket]++;
+        total += latencies[i];
+        if (latencies[i] > max) {
+            max = latencies[i];
+        }
+    }
+
+    CHECK(hist->count == nr_latencies);
+    CHECK(hist->max == max);
+    CHECK(hist->total == total);
+    CHECK(memcmp(hist->buckets, buckets, sizeof(buckets)) == 0);
+}
+
+/*
+ * The latencies of a known sequence of calls, to RoT Services with SIDs
+ * 0x10, 0x20 and an unknown SID, fall in the expected buckets.
+ */
+static void test_profile_latencies(void)
+{
+    static const uint32_t pickups[] = {3, 3, 3, 3};
+    static const uint32_t services[] = {0, 97, 1000, (1UL << 20) - 3};
+    struct spe_mailbox_profile_t profile;
+    const struct mailbox_msg_timestamps_t *ts = &ns_queue.queue[1].ts;
+
+    now = 100;
+    ns_init();
+
+    ns_submit_call(0, TOKEN(0));
+    ns_queue.queue[0].msg.params.psa_call_params.handle = 0x10;
+    ns_submit_call(1, TOKEN(1));
+    ns_queue.queue[1].msg.params.psa_call_params.handle = 0x20;
+    ns_submit_call(2, TOKEN(2));
+    ns_submit_version(3, 0x10);
+
+    /* psa_version() is replied on the pickup */
+    now = 103;
+    CHECK(tfm_mailbox_handle_msg() == MAILBOX_SUCCESS);
+    ns_check_reply(3, 0x10);
+
+    now = 200;
+    complete_call(TOKEN(1));
+    ns_check_reply(1, TOKEN(1));
+    CHECK((ts->enqueue == 100) && (ts->pickup == 103) && (ts->reply == 200) &&
+          (ts->sid == 0x20));
+
+    now = 1103;
+    complete_call(TOKEN(0));
+    ns_check_reply(0, TOKEN(0));
+
+    /* The longest latencies are counted in the last bucket */
+    now = 100 + (1UL << 20);
+    complete_call(TOKEN(2));
+    ns_check_reply(2, TOKEN(2));
+
+    CHECK(tfm_mailbox_profile_get(NULL) == MAILBOX_INVAL_PARAMS);
+    CHECK(tfm_mailbox_profile_get(&profile) == MAILBOX_SUCCESS);
+    CHECK(profile.since == 100);
+    check_hist(&profile.pickup, pickups, 4);
+    check_hist(&profile.service, services, 4);
+    CHECK(profile.pickup.buckets[1] == 4);
+    CHECK((profile.service.buckets[0] == 1) &&
+          (profile.service.buckets[6] == 1) &&
+          (profile.service.buckets[9] == 1) &&
+          (profile.service.buckets[MAILBOX_LATENCY_NR_BUCKETS - 1] == 1));
+    CHECK(profile.nr_slots_full == 0);
+
+    /* The calls are counted by SID, in the order of their first replies */
+    CHECK((profile.sids[0].sid == 0x10) && (profile.sids[0].nr_calls == 2));
+    CHECK((profile.sids[1].sid == 0x20) && (profile.sids[1].nr_calls == 1));
+    CHECK(profile.sids[2].sid == 0);
+    CHECK(profile.nr_other_calls == 1);
+}
+
+/*
+ * Each mailbox handling which leaves requests in pend_ring, as all the SPE
+ * slots are busy, is counted.
+ */
+static void test_profile_slots_full(void)
+{
+    struct spe_mailbox_profile_t profile;
+    uint8_t i;
+
+    now = 0;
+    ns_init();
+
+    for (i = 0; i < NUM_MAILBOX_QUEUE_SLOT; i++) {
+        ns_submit_call(i, TOKEN(i));
+    }
+
+    now = 5000;
+    tfm_mailbox_profile_reset();
+
+    /* All the slots are busy, but no request is left */
+    CHECK(tfm_mailbox_handle_msg() == MAILBOX_SUCCESS);
+    CHECK(tfm_mailbox_profile_get(&profile) == MAILBOX_SUCCESS);
+    CHECK(profile.since == 5000);
+    CHECK(profile.pickup.count == NUM_MAILBOX_QUEUE_SLOT);
+    CHECK(profile.nr_slots_full == 0);
+
+    ns_submit_call(0, TOKEN(NUM_MAILBOX_QUEUE_SLOT));
+    CHECK(tfm_mailbox_handle_msg() == MAILBOX_NO_PEND_EVENT);
+    CHECK(tfm_mailbox_handle_msg() == MAILBOX_NO_PEND_EVENT);
+    CHECK(tfm_mailbox_profile_get(&profile) == MAILBOX_SUCCESS);
+    CHECK(profile.nr_slots_full == 2);
+
+    /* The request left is taken once a reply frees a slot */
+    complete_call(TOKEN(1));
+    CHECK(tfm_mailbox_handle_msg() == MAILBOX_SUCCESS);
+    CHECK(tfm_mailbox_profile_get(&profile) == MAILBOX_SUCCESS);
+    CHECK(profile.nr_slots_full == 2);
+    CHECK(profile.pickup.count == NUM_MAILBOX_QUEUE_SLOT + 1);
+    CHECK(profile.service.count == 1);
+}
+#endif
+
+int main(void)
+{
+    test_out_of_order();
+    test_all_slots_busy();
+    test_null_handle();
+#ifdef TFM_MULTI_CORE_MAILBOX_PROFILING
+    test_profile_latencies();
+    test_profile_slots_full();
+#endif
+
+    printf("PASS\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/* Host stub of CMSIS compiler abstraction for the mailbox stress test */
+
+#ifndef __CMSIS_COMPILER_H__
+#define __CMSIS_COMPILER_H__
+
+#include <stdint.h>
+
+#define __STATIC_INLINE                 static inline
+
+/*
+ * Interrupt masking of the non-secure core. Threads running as non-secure
+ * tasks or ISRs exclude each other while they mask interrupts.
+ */
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t primask);
+void __disable_irq(void);
+void __enable_irq(void);
+
+/* A full barrier, which may also yield to widen the race windows */
+void host_dmb(void);
+#define __DMB()                         host_dmb()
+
+#endif /* __CMSIS_COMPILER_H__ */
@@ -0,0 +1,15 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/* Host stub of the platform device configuration for the mailbox stress test */
+
+#ifndef __DEVICE_CFG_H__
+#define __DEVICE_CFG_H__
+
+/* NUM_MAILBOX_QUEUE_SLOT is set by the build of each test variant */
+
+#endif /* __DEVICE_CFG_H__ */
@@ -0,0 +1,16 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_CORE_UTILS_H__
+#define __TFM_CORE_UTILS_H__
+
+#include <string.h>
+
+#define spm_memcpy(dest, src, n)        memcpy(dest, src, n)
+#define spm_memset(s, c, n)             memset(s, c, n)
+
+#endif /* __TFM_CORE_UTILS_H__ */
@@ -0,0 +1,11 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_PLAT_NS_H__
+#define __TFM_PLAT_NS_H__
+
+#endif /* __TFM_PLAT_NS_H__ */
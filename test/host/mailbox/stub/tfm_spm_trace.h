@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_SPM_TRACE_H__
+#define __TFM_SPM_TRACE_H__
+
+#define SPMTRACE(evt, arg0, arg1)
+
+#endif /* __TFM_SPM_TRACE_H__ */
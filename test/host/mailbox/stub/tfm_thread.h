@@ -0,0 +1,14 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_THREAD_H__
+#define __TFM_THREAD_H__
+
+/* Request SPE mailbox handling again, as at the end of the next scheduling */
+void tfm_core_thrd_activate_schedule(void);
+
+#endif /* __TFM_THREAD_H__ */
@@ -0,0 +1,15 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_UTILS_H__
+#define __TFM_UTILS_H__
+
+#include <assert.h>
+
+#define TFM_CORE_ASSERT(cond)           assert(cond)
+
+#endif /* __TFM_UTILS_H__ */
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Benchmark of the initialisation of the PS object table at boot, with the
+ * table authenticated by AES-GCM from a software library. It is built with
+ * and without PS_ROLLBACK_PROTECTION.
+ *
+ * The services used by PS are replaced by the model of ps_test_services.c.
+ * On each iteration, one object of a table holding PS_NUM_ASSETS - 1 objects
+ * is updated, which leaves both table files in ITS with the other one active,
+ * then the table is initialised as at boot. The benchmark reports, for each
+ * active table, the p50 and p99 latencies of ps_object_table_init() and the
+ * table reads and AEAD operations per boot.
+ *
+ * Usage: ps_boot_bench [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "its_bench.h"
+#include "ps_object_table.h"
+#include "ps_test_services.h"
+#include "crypto/ps_crypto_interface.h"
+
+#define DEFAULT_ITERATIONS          1000
+
+#define CLIENT_ID                   5
+
+/* File IDs of the two object tables */
+#define PS_TEST_TABLE_FS_ID(idx)    ((idx) + 1)
+#define PS_TEST_NUM_TABLES          2
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+struct boot_stats_t {
+    struct its_bench_samples_t samples;
+    uint32_t its_get_count;
+    uint32_t its_get_bytes;
+    uint32_t aead_count;
+};
+
+static uint8_t obj_data[PS_MAX_ASSET_SIZE];
+static uint8_t tag[PS_TAG_LEN_BYTES];
+
+/* Writes an object entry in the table, which saves the table */
+static void set_object(psa_storage_uid_t uid)
+{
+    struct ps_obj_table_info_t info;
+
+    CHECK(ps_object_table_get_free_fid(1, &info.fid) == PSA_SUCCESS);
+    info.tag = tag;
+    tag[0]++;
+    CHECK(ps_object_table_set_obj_tbl_info(uid, CLIENT_ID, &info) ==
+          PSA_SUCCESS);
+}
+
+/* Gets the table left active by the initialisation, which removes the other */
+static uint32_t active_table(void)
+{
+    int exists_0 = ps_test_its_exists(PS_TEST_TABLE_FS_ID(0));
+    int exists_1 = ps_test_its_exists(PS_TEST_TABLE_FS_ID(1));
+
+    CHECK(exists_0 != exists_1);
+
+    return exists_0 ? 0 : 1;
+}
+
+static void print_stats(uint32_t table, struct boot_stats_t *s)
+{
+    size_t num = s->samples.num;
+
+    printf("  active table %u  p50 %8.2f us  p99 %8.2f us  "
+           "%.1f reads (%u B)  %.1f AEAD\n", table,
+           its_bench_percentile(&s->samples, 50) / 1000.0,
+           its_bench_percentile(&s->samples, 99) / 1000.0,
+           (double)s->its_get_count / num,
+           (unsigned int)(s->its_get_bytes / num),
+           (double)s->aead_count / num);
+}
+
+int main(int argc, char *argv[])
+{
+    struct boot_stats_t boot_stats[PS_TEST_NUM_TABLES];
+    struct ps_test_stats_t stats;
+    uint32_t iterations = DEFAULT_ITERATIONS;
+    uint64_t start;
+    uint32_t i, table;
+
+    if (argc > 1) {
+        iterations = (uint32_t)strtoul(argv[1], NULL, 0);
+        CHECK(iterations > 0);
+    }
+
+#ifdef PS_ROLLBACK_PROTECTION
+    printf("PS object table init, rollback protection on, %u objects, "
+           "%u iterations\n", (unsigned int)(PS_NUM_ASSETS - 1), iterations);
+#else
+    printf("PS object table init, rollback protection off, %u objects, "
+           "%u iterations\n", (unsigned int)(PS_NUM_ASSETS - 1), iterations);
+#endif
+
+    memset(boot_stats, 0, sizeof(boot_stats));
+    for (table = 0; table < PS_TEST_NUM_TABLES; table++) {
+        its_bench_samples_init(&boot_stats[table].samples, iterations);
+    }
+
+    ps_test_services_reset();
+    CHECK(ps_object_table_create() == PSA_SUCCESS);
+    for (i = 1; i < PS_NUM_ASSETS; i++) {
+        set_object(i);
+    }
+
+    for (i = 0; i < iterations; i++) {
+        set_object(1 + (i % (PS_NUM_ASSETS - 1)));
+
+        ps_test_reset_stats();
+        start = its_bench_now_ns();
+        CHECK(ps_object_table_init(obj_data) == PSA_SUCCESS);
+        table = active_table();
+        its_bench_samples_add(&boot_stats[table].samples,
+                              its_bench_now_ns() - start);
+
+        ps_test_get_stats(&stats);
+        boot_stats[table].its_get_count += stats.its_get_count;
+        boot_stats[table].its_get_bytes += stats.its_get_bytes;
+        boot_stats[table].aead_count += stats.aead_count;
+
+        /* Only the active table is authenticated. With rollback protection,
+         * table 1 is only read once table 0 fails to authenticate with NV
+         * counter 1. Without it, both tables are read to compare their swap
+         * counts.
+         */
+#ifdef PS_ROLLBACK_PROTECTION
+        CHECK(stats.its_get_count == table + 1);
+        CHECK(stats.aead_count == table + 1);
+#else
+        CHECK(stats.its_get_count == 2);
+        CHECK(stats.aead_count == 1);
+#endif
+
+        CHECK(ps_object_table_obj_exist(1, CLIENT_ID) == PSA_SUCCESS);
+    }
+
+    for (table = 0; table < PS_TEST_NUM_TABLES; table++) {
+        CHECK(boot_stats[table].samples.num > 0);
+        print_stats(table, &boot_stats[table]);
+        its_bench_samples_free(&boot_stats[table].samples);
+    }
+
+#ifndef PS_ROLLBACK_PROTECTION
+    /* When the latest table does not authenticate, the other one is
+     * authenticated and becomes active.
+     */
+    table = active_table();
+    set_object(1);
+    ps_test_its_corrupt(PS_TEST_TABLE_FS_ID(1 - table), 0);
+    ps_test_reset_stats();
+    CHECK(ps_object_table_init(obj_data) == PSA_SUCCESS);
+    CHECK(active_table() == table);
+    ps_test_get_stats(&stats);
+    CHECK(stats.aead_count == 2);
+#endif
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,365 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Test of the object lookups and free entry searches of the PS object table,
+ * built with and without the hash index (PS_OBJECT_TABLE_INDEX).
+ *
+ * With the index, the home slot of an object is the FNV-1a hash of its UID
+ * and client ID modulo the number of slots. The test picks UIDs by their home
+ * slot, to check that removing an object from a probe sequence moves the
+ * following objects back without losing any. It also checks that free
+ * entries are found in ascending order, that a failed table save leaves the
+ * table as it was, and that the index is rebuilt from the table at boot.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ps_object_table.h"
+#include "ps_test_services.h"
+
+/* Number of entries of the table, and of slots of an index of that size */
+#define NUM_ENTRIES                 (PS_NUM_ASSETS + 1)
+#define NUM_SLOTS                   (2 * NUM_ENTRIES)
+
+/* File ID of the object in a table entry */
+#define ENTRY_FID(idx)              ((idx) + 3)
+
+#define CLIENT_A                    5
+#define CLIENT_B                    (-1)
+
+#define NUM_CHURN_UIDS              (2 * PS_NUM_ASSETS)
+#define CHURN_ROUNDS                3000
+#define REBOOT_PERIOD               100
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+static uint8_t obj_data[PS_MAX_ASSET_SIZE];
+
+/* Home slot of an object in the index, with the hash of the index */
+static uint32_t home_slot(psa_storage_uid_t uid, int32_t client_id)
+{
+    uint32_t hash = 2166136261U;
+    uint32_t i;
+
+    for (i = 0; i < sizeof(uid); i++) {
+        hash = (hash ^ (uint8_t)(uid >> (8 * i))) * 16777619U;
+    }
+
+    for (i = 0; i < sizeof(client_id); i++) {
+        hash = (hash ^ (uint8_t)((uint32_t)client_id >> (8 * i))) * 16777619U;
+    }
+
+    return hash % NUM_SLOTS;
+}
+
+/* Finds the UIDs, from the given one, of the next objects with a home slot */
+static void find_uids(uint32_t slot, int32_t client_id,
+                      psa_storage_uid_t *from, uint32_t num,
+                      psa_storage_uid_t *uids)
+{
+    uint32_t n = 0;
+
+    while (n < num) {
+        if (home_slot(*from, client_id) == slot) {
+            uids[n++] = *from;
+        }
+        (*from)++;
+    }
+}
+
+static void boot(void)
+{
+    CHECK(ps_object_table_init(obj_data) == PSA_SUCCESS);
+}
+
+static void format(void)
+{
+    ps_test_services_reset();
+    CHECK(ps_object_table_create() == PSA_SUCCESS);
+    boot();
+}
+
+/* Each object has the UID as version, to check that a lookup finds the right
+ * entry.
+ */
+static psa_status_t set_object(psa_storage_uid_t uid, int32_t client_id)
+{
+    struct ps_obj_table_info_t info;
+    psa_status_t err;
+
+    err = ps_object_table_get_free_fid(1, &info.fid);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+    info.version = (uint32_t)uid;
+
+    return ps_object_table_set_obj_tbl_info(uid, client_id, &info);
+}
+
+static void delete_object(psa_storage_uid_t uid, int32_t client_id)
+{
+    CHECK(ps_object_table_delete_object(uid, client_id) == PSA_SUCCESS);
+}
+
+static uint32_t check_object(psa_storage_uid_t uid, int32_t client_id)
+{
+    struct ps_obj_table_info_t info;
+
+    CHECK(ps_object_table_obj_exist(uid, client_id) == PSA_SUCCESS);
+    CHECK(ps_object_table_get_obj_tbl_info(uid, client_id, &info) ==
+          PSA_SUCCESS);
+    CHECK(info.version == (uint32_t)uid);
+
+    return info.fid;
+}
+
+static void check_no_object(psa_storage_uid_t uid, int32_t client_id)
+{
+    CHECK(ps_object_table_obj_exist(uid, client_id) ==
+          PSA_ERROR_DOES_NOT_EXIST);
+}
+
+static void test_remove_shift(void)
+{
+    const uint32_t home = 7;
+    psa_storage_uid_t same[3], next[1];
+    psa_storage_uid_t from = 1;
+
+    format();
+
+    /* Three objects in a row from one home slot, then one from the next slot,
+     * which is pushed after them.
+     */
+    find_uids(home, CLIENT_A, &from, 3, same);
+    find_uids(home + 1, CLIENT_A, &from, 1, next);
+    CHECK(set_object(same[0], CLIENT_A) == PSA_SUCCESS);
+    CHECK(set_object(same[1], CLIENT_A) == PSA_SUCCESS);
+    CHECK(set_object(same[2], CLIENT_A) == PSA_SUCCESS);
+    CHECK(set_object(next[0], CLIENT_A) == PSA_SUCCESS);
+
+    /* The objects after a removed one are still found */
+    delete_object(same[0], CLIENT_A);
+    check_no_object(same[0], CLIENT_A);
+    (void)check_object(same[1], CLIENT_A);
+    (void)check_object(same[2], CLIENT_A);
+    (void)check_object(next[0], CLIENT_A);
+
+    /* Also from the middle of the sequence */
+    delete_object(same[2], CLIENT_A);
+    check_no_object(same[2], CLIENT_A);
+    (void)check_object(same[1], CLIENT_A);
+    (void)check_object(next[0], CLIENT_A);
+
+    /* An updated object stays found */
+    CHECK(set_object(same[1], CLIENT_A) == PSA_SUCCESS);
+    (void)check_object(same[1], CLIENT_A);
+    (void)check_object(next[0], CLIENT_A);
+
+    /* The index rebuilt at boot finds the same objects */
+    boot();
+    check_no_object(same[0], CLIENT_A);
+    (void)check_object(same[1], CLIENT_A);
+    check_no_object(same[2], CLIENT_A);
+    (void)check_object(next[0], CLIENT_A);
+}
+
+static void test_remove_shift_wrap(void)
+{
+    psa_storage_uid_t last[2], first[1];
+    psa_storage_uid_t from = 1;
+
+    format();
+
+    /* A probe sequence from the last slot, which wraps around to the first */
+    find_uids(NUM_SLOTS - 1, CLIENT_A, &from, 2, last);
+    find_uids(0, CLIENT_A, &from, 1, first);
+    CHECK(set_object(last[0], CLIENT_A) == PSA_SUCCESS);
+    CHECK(set_object(last[1], CLIENT_A) == PSA_SUCCESS);
+    CHECK(set_object(first[0], CLIENT_A) == PSA_SUCCESS);
+
+    delete_object(last[0], CLIENT_A);
+    check_no_object(last[0], CLIENT_A);
+    (void)check_object(last[1], CLIENT_A);
+    (void)check_object(first[0], CLIENT_A);
+
+    delete_object(last[1], CLIENT_A);
+    (void)check_object(first[0], CLIENT_A);
+
+    CHECK(set_object(last[0], CLIENT_A) == PSA_SUCCESS);
+    (void)check_object(last[0], CLIENT_A);
+    (void)check_object(first[0], CLIENT_A);
+}
+
+static void test_client_ids(void)
+{
+    format();
+
+    /* The same UID of two clients are two objects */
+    CHECK(set_object(1, CLIENT_A) == PSA_SUCCESS);
+    check_no_object(1, CLIENT_B);
+    CHECK(set_object(1, CLIENT_B) == PSA_SUCCESS);
+    CHECK(check_object(1, CLIENT_A) != check_object(1, CLIENT_B));
+
+    delete_object(1, CLIENT_A);
+    check_no_object(1, CLIENT_A);
+    (void)check_object(1, CLIENT_B);
+    CHECK(ps_object_table_delete_object(1, CLIENT_A) ==
+          PSA_ERROR_DOES_NOT_EXIST);
+}
+
+static void test_free_entries(void)
+{
+    psa_storage_uid_t uid;
+    uint32_t fid;
+
+    format();
+
+    /* A full table, up to the entry kept for the update of an object */
+    for (uid = 1; uid <= PS_NUM_ASSETS; uid++) {
+        CHECK(set_object(uid, CLIENT_A) == PSA_SUCCESS);
+    }
+    CHECK(ps_object_table_get_free_fid(1, &fid) == PSA_SUCCESS);
+    CHECK(fid == ENTRY_FID(PS_NUM_ASSETS));
+    CHECK(ps_object_table_get_free_fid(2, &fid) ==
+          PSA_ERROR_INSUFFICIENT_STORAGE);
+    CHECK(ps_object_table_get_free_fid(0, &fid) == PSA_ERROR_INVALID_ARGUMENT);
+
+    /* The free entries are found in ascending order, across the words of the
+     * bitmap of the index.
+     */
+    delete_object(PS_NUM_ASSETS, CLIENT_A);
+    delete_object(33, CLIENT_A);
+    delete_object(2, CLIENT_A);
+    CHECK(ps_object_table_get_free_fid(1, &fid) == PSA_SUCCESS);
+    CHECK(fid == ENTRY_FID(1));
+    CHECK(ps_object_table_get_free_fid(2, &fid) == PSA_SUCCESS);
+    CHECK(fid == ENTRY_FID(32));
+    CHECK(ps_object_table_get_free_fid(3, &fid) == PSA_SUCCESS);
+    CHECK(fid == ENTRY_FID(PS_NUM_ASSETS - 1));
+    CHECK(ps_object_table_get_free_fid(4, &fid) == PSA_SUCCESS);
+    CHECK(fid == ENTRY_FID(PS_NUM_ASSETS));
+    CHECK(ps_object_table_get_free_fid(5, &fid) ==
+          PSA_ERROR_INSUFFICIENT_STORAGE);
+
+    /* The same free entries after the index is rebuilt at boot */
+    boot();
+    CHECK(ps_object_table_get_free_fid(1, &fid) == PSA_SUCCESS);
+    CHECK(fid == ENTRY_FID(1));
+    CHECK(ps_object_table_get_free_fid(4, &fid) == PSA_SUCCESS);
+    CHECK(fid == ENTRY_FID(PS_NUM_ASSETS));
+    CHECK(ps_object_table_get_free_fid(5, &fid) ==
+          PSA_ERROR_INSUFFICIENT_STORAGE);
+}
+
+static void test_failed_save(void)
+{
+    uint32_t fid, new_fid;
+
+    format();
+    CHECK(set_object(1, CLIENT_A) == PSA_SUCCESS);
+    CHECK(set_object(2, CLIENT_A) == PSA_SUCCESS);
+    fid = check_object(1, CLIENT_A);
+
+    /* A failed update keeps the old entry, and frees the new one */
+    ps_test_its_fail_next_set();
+    CHECK(set_object(1, CLIENT_A) == PSA_ERROR_STORAGE_FAILURE);
+    CHECK(check_object(1, CLIENT_A) == fid);
+    CHECK(ps_object_table_get_free_fid(1, &new_fid) == PSA_SUCCESS);
+    CHECK(new_fid == ENTRY_FID(2));
+
+    /* A failed creation leaves no entry */
+    ps_test_its_fail_next_set();
+    CHECK(set_object(3, CLIENT_A) == PSA_ERROR_STORAGE_FAILURE);
+    check_no_object(3, CLIENT_A);
+
+    /* A failed deletion keeps the entry */
+    ps_test_its_fail_next_set();
+    CHECK(ps_object_table_delete_object(2, CLIENT_A) ==
+          PSA_ERROR_STORAGE_FAILURE);
+    (void)check_object(2, CLIENT_A);
+
+    CHECK(ps_object_table_get_free_fid(1, &new_fid) == PSA_SUCCESS);
+    CHECK(new_fid == ENTRY_FID(2));
+    delete_object(2, CLIENT_A);
+    check_no_object(2, CLIENT_A);
+    (void)check_object(1, CLIENT_A);
+}
+
+/*
+ * Random creations, updates and deletions of objects of two clients, with
+ * reboots, checked against a model of the objects after every operation.
+ */
+static void test_churn(void)
+{
+    uint8_t exists[2][NUM_CHURN_UIDS] = {{0}};
+    const int32_t clients[2] = {CLIENT_A, CLIENT_B};
+    uint32_t num = 0;
+    uint32_t seed = 1;
+    uint32_t round, c, i;
+    uint32_t fid;
+
+    format();
+
+    for (round = 0; round < CHURN_ROUNDS; round++) {
+        if ((round % REBOOT_PERIOD) == 0) {
+            boot();
+        }
+
+        seed = seed * 1103515245u + 12345u;
+        c = (seed >> 24) & 1;
+        i = (seed >> 16) % NUM_CHURN_UIDS;
+
+        if (exists[c][i] && (seed & 0x100)) {
+            delete_object(i + 1, clients[c]);
+            exists[c][i] = 0;
+            num--;
+        } else if (exists[c][i]) {
+            CHECK(set_object(i + 1, clients[c]) == PSA_SUCCESS);
+        } else if (num < PS_NUM_ASSETS) {
+            CHECK(set_object(i + 1, clients[c]) == PSA_SUCCESS);
+            exists[c][i] = 1;
+            num++;
+        } else {
+            /* Only the entry kept for the update of an object is free */
+            CHECK(ps_object_table_get_free_fid(2, &fid) ==
+                  PSA_ERROR_INSUFFICIENT_STORAGE);
+        }
+
+        for (c = 0; c < 2; c++) {
+            for (i = 0; i < NUM_CHURN_UIDS; i++) {
+                if (exists[c][i]) {
+                    (void)check_object(i + 1, clients[c]);
+                } else {
+                    check_no_object(i + 1, clients[c]);
+                }
+            }
+        }
+    }
+}
+
+int main(void)
+{
+    test_remove_shift();
+    test_remove_shift_wrap();
+    test_client_ids();
+    test_free_entries();
+    test_failed_save();
+    test_churn();
+
+    printf("PASS\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Benchmark of the object table operations of PS against the number of
+ * entries of the table. It is built for several values of PS_NUM_ASSETS, with
+ * and without the hash index (PS_OBJECT_TABLE_INDEX).
+ *
+ * The services used by PS are replaced by the model of ps_test_services.c.
+ * The table is filled with PS_NUM_ASSETS objects, less one, then the benchmark
+ * reports the p50 and p99 latencies of a lookup of an object in the table, of
+ * a lookup of an object not in the table, of the search of a free entry and of
+ * the update of an object, which also writes the table to ITS.
+ *
+ * Usage: ps_table_bench [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "its_bench.h"
+#include "ps_object_table.h"
+#include "ps_test_services.h"
+
+#define DEFAULT_ITERATIONS          1000
+
+#define CLIENT_ID                   5
+#define NUM_OBJECTS                 (PS_NUM_ASSETS - 1)
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+static uint8_t obj_data[PS_MAX_ASSET_SIZE];
+
+static void set_object(psa_storage_uid_t uid)
+{
+    struct ps_obj_table_info_t info;
+
+    CHECK(ps_object_table_get_free_fid(1, &info.fid) == PSA_SUCCESS);
+    info.version = (uint32_t)uid;
+    CHECK(ps_object_table_set_obj_tbl_info(uid, CLIENT_ID, &info) ==
+          PSA_SUCCESS);
+}
+
+static void print_samples(const char *name, struct its_bench_samples_t *s)
+{
+    printf("  %-16s p50 %8.3f us  p99 %8.3f us\n", name,
+           its_bench_percentile(s, 50) / 1000.0,
+           its_bench_percentile(s, 99) / 1000.0);
+}
+
+int main(int argc, char *argv[])
+{
+    struct its_bench_samples_t hit_samples, miss_samples;
+    struct its_bench_samples_t free_samples, update_samples;
+    uint32_t iterations = DEFAULT_ITERATIONS;
+    psa_storage_uid_t uid;
+    uint64_t start;
+    uint32_t fid;
+    uint32_t i;
+
+    if (argc > 1) {
+        iterations = (uint32_t)strtoul(argv[1], NULL, 0);
+        CHECK(iterations > 0);
+    }
+
+#ifdef PS_OBJECT_TABLE_INDEX
+    printf("PS object table, index on, %u objects, %u iterations\n",
+           (unsigned int)NUM_OBJECTS, iterations);
+#else
+    printf("PS object table, index off, %u objects, %u iterations\n",
+           (unsigned int)NUM_OBJECTS, iterations);
+#endif
+
+    its_bench_samples_init(&hit_samples, iterations);
+    its_bench_samples_init(&miss_samples, iterations);
+    its_bench_samples_init(&free_samples, iterations);
+    its_bench_samples_init(&update_samples, iterations);
+
+    ps_test_services_reset();
+    CHECK(ps_object_table_create() == PSA_SUCCESS);
+    CHECK(ps_object_table_init(obj_data) == PSA_SUCCESS);
+    for (uid = 1; uid <= NUM_OBJECTS; uid++) {
+        set_object(uid);
+    }
+
+    for (i = 0; i < iterations; i++) {
+        uid = 1 + (i % NUM_OBJECTS);
+
+        start = its_bench_now_ns();
+        CHECK(ps_object_table_obj_exist(uid, CLIENT_ID) == PSA_SUCCESS);
+        its_bench_samples_add(&hit_samples, its_bench_now_ns() - start);
+
+        start = its_bench_now_ns();
+        CHECK(ps_object_table_obj_exist(NUM_OBJECTS + uid, CLIENT_ID) ==
+              PSA_ERROR_DOES_NOT_EXIST);
+        its_bench_samples_add(&miss_samples, its_bench_now_ns() - start);
+
+        /* The last free entries, as the table fills up */
+        start = its_bench_now_ns();
+        CHECK(ps_object_table_get_free_fid(2, &fid) == PSA_SUCCESS);
+        its_bench_samples_add(&free_samples, its_bench_now_ns() - start);
+
+        start = its_bench_now_ns();
+        set_object(uid);
+        its_bench_samples_add(&update_samples, its_bench_now_ns() - start);
+    }
+
+    print_samples("lookup hit", &hit_samples);
+    print_samples("lookup miss", &miss_samples);
+    print_samples("free entry", &free_samples);
+    print_samples("update", &update_samples);
+
+    its_bench_samples_free(&hit_samples);
+    its_bench_samples_free(&miss_samples);
+    its_bench_samples_free(&free_samples);
+    its_bench_samples_free(&update_samples);
+
+    return EXIT_SUCCESS;
+}
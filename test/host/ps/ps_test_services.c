@@ -0,0 +1,411 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include "ps_test_services.h"
+
+#include <string.h>
+
+#include "psa/internal_trusted_storage.h"
+#include "tfm_platform_api.h"
+#include "tfm_plat_nv_counters.h"
+
+#ifdef PS_ENCRYPTION
+#include <openssl/evp.h>
+
+#include "psa/crypto.h"
+#endif
+
+/* Number of ITS files held by the model, and their maximum size */
+#define PS_TEST_ITS_NUM_FILES       4
+#define PS_TEST_ITS_FILE_SIZE       PS_MAX_ASSET_SIZE
+
+/* Number of PS NV counters */
+#define PS_TEST_NUM_NV_COUNTERS     3
+
+struct ps_test_file_t {
+    psa_storage_uid_t uid;      /* File UID, 0 if the entry is free */
+    size_t size;                /* File size */
+    uint8_t data[PS_TEST_ITS_FILE_SIZE];
+};
+
+static struct ps_test_file_t files[PS_TEST_ITS_NUM_FILES];
+static uint32_t nv_counters[PS_TEST_NUM_NV_COUNTERS];
+static struct ps_test_stats_t test_stats;
+static int fail_next_set;
+
+#ifdef PS_ENCRYPTION
+/* The key derived for the key handle in use, if any */
+#define PS_TEST_KEY_HANDLE          1
+#define PS_TEST_KEY_MAX_SIZE        32
+
+static uint8_t key[PS_TEST_KEY_MAX_SIZE];
+static size_t key_size;
+static const uint8_t *key_label;
+static size_t key_label_size;
+#endif
+
+void ps_test_services_reset(void)
+{
+    memset(files, 0, sizeof(files));
+    memset(nv_counters, 0, sizeof(nv_counters));
+    fail_next_set = 0;
+}
+
+void ps_test_reset_stats(void)
+{
+    memset(&test_stats, 0, sizeof(test_stats));
+}
+
+void ps_test_get_stats(struct ps_test_stats_t *stats)
+{
+    *stats = test_stats;
+}
+
+static struct ps_test_file_t *find_file(psa_storage_uid_t uid)
+{
+    uint32_t i;
+
+    for (i = 0; i < PS_TEST_ITS_NUM_FILES; i++) {
+        if (files[i].uid == uid) {
+            return &files[i];
+        }
+    }
+
+    return NULL;
+}
+
+int ps_test_its_exists(psa_storage_uid_t uid)
+{
+    return find_file(uid) != NULL;
+}
+
+void ps_test_its_corrupt(psa_storage_uid_t uid, size_t offset)
+{
+    struct ps_test_file_t *file = find_file(uid);
+
+    if ((file != NULL) && (offset < file->size)) {
+        file->data[offset] ^= 0xFFU;
+    }
+}
+
+void ps_test_its_fail_next_set(void)
+{
+    fail_next_set = 1;
+}
+
+psa_status_t psa_its_set(psa_storage_uid_t uid,
+                         size_t data_length,
+                         const void *p_data,
+                         psa_storage_create_flags_t create_flags)
+{
+    struct ps_test_file_t *file = find_file(uid);
+
+    (void)create_flags;
+
+    if (uid == 0 || data_length > PS_TEST_ITS_FILE_SIZE) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (fail_next_set) {
+        fail_next_set = 0;
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+
+    if (file == NULL) {
+        file = find_file(0);
+        if (file == NULL) {
+            return PSA_ERROR_INSUFFICIENT_STORAGE;
+        }
+    }
+
+    file->uid = uid;
+    file->size = data_length;
+    memcpy(file->data, p_data, data_length);
+    test_stats.its_set_count++;
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_its_get(psa_storage_uid_t uid,
+                         size_t data_offset,
+                         size_t data_size,
+                         void *p_data,
+                         size_t *p_data_length)
+{
+    struct ps_test_file_t *file = find_file(uid);
+
+    if (uid == 0 || file == NULL) {
+        return PSA_ERROR_DOES_NOT_EXIST;
+    }
+
+    if (data_offset > file->size) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (data_size > file->size - data_offset) {
+        data_size = file->size - data_offset;
+    }
+
+    memcpy(p_data, &file->data[data_offset], data_size);
+    *p_data_length = data_size;
+    test_stats.its_get_count++;
+    test_stats.its_get_bytes += (uint32_t)data_size;
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_its_get_info(psa_storage_uid_t uid,
+                              struct psa_storage_info_t *p_info)
+{
+    struct ps_test_file_t *file = find_file(uid);
+
+    if (uid == 0 || file == NULL) {
+        return PSA_ERROR_DOES_NOT_EXIST;
+    }
+
+    p_info->capacity = file->size;
+    p_info->size = file->size;
+    p_info->flags = PSA_STORAGE_FLAG_NONE;
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_its_remove(psa_storage_uid_t uid)
+{
+    struct ps_test_file_t *file = find_file(uid);
+
+    if (uid == 0 || file == NULL) {
+        return PSA_ERROR_DOES_NOT_EXIST;
+    }
+
+    memset(file, 0, sizeof(*file));
+
+    return PSA_SUCCESS;
+}
+
+enum tfm_platform_err_t
+tfm_platform_nv_counter_increment(uint32_t counter_id)
+{
+    if (counter_id >= PS_TEST_NUM_NV_COUNTERS) {
+        return TFM_PLATFORM_ERR_INVALID_PARAM;
+    }
+
+    nv_counters[counter_id]++;
+
+    return TFM_PLATFORM_ERR_SUCCESS;
+}
+
+enum tfm_platform_err_t
+tfm_platform_nv_counter_read(uint32_t counter_id,
+                             uint32_t size, uint8_t *val)
+{
+    if (counter_id >= PS_TEST_NUM_NV_COUNTERS ||
+        size != sizeof(nv_counters[0])) {
+        return TFM_PLATFORM_ERR_INVALID_PARAM;
+    }
+
+    memcpy(val, &nv_counters[counter_id], size);
+
+    return TFM_PLATFORM_ERR_SUCCESS;
+}
+
+#ifdef PS_ENCRYPTION
+psa_status_t psa_key_derivation_setup(psa_key_derivation_operation_t *operation,
+                                      psa_algorithm_t alg)
+{
+    (void)operation;
+    (void)alg;
+
+    key_label = NULL;
+    key_label_size = 0;
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_key_derivation_input_bytes(
+                                      psa_key_derivation_operation_t *operation,
+                                      psa_key_derivation_step_t step,
+                                      const uint8_t *data,
+                                      size_t data_length)
+{
+    (void)operation;
+    (void)step;
+
+    key_label = data;
+    key_label_size = data_length;
+
+    return PSA_SUCCESS;
+}
+
+/* The key is the start of the SHA-256 hash of the label, in place of the
+ * derivation from the hardware unique key.
+ */
+psa_status_t psa_key_derivation_output_key(
+                                      const psa_key_attributes_t *attributes,
+                                      psa_key_derivation_operation_t *operation,
+                                      psa_key_handle_t *handle)
+{
+    uint8_t digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_size;
+
+    (void)operation;
+
+    if (key_label == NULL ||
+        PSA_BITS_TO_BYTES(psa_get_key_bits(attributes)) != 16) {
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+
+    if (!EVP_Digest(key_label, key_label_size, digest, &digest_size,
+                    EVP_sha256(), NULL)) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    key_size = 16;
+    memcpy(key, digest, key_size);
+    *handle = PS_TEST_KEY_HANDLE;
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_key_derivation_abort(psa_key_derivation_operation_t *operation)
+{
+    (void)operation;
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_destroy_key(psa_key_handle_t handle)
+{
+    if (handle != PS_TEST_KEY_HANDLE || key_size == 0) {
+        return PSA_ERROR_INVALID_HANDLE;
+    }
+
+    memset(key, 0, sizeof(key));
+    key_size = 0;
+
+    return PSA_SUCCESS;
+}
+
+/* Runs AES-128-GCM over the data, with the tag after the ciphertext */
+static psa_status_t aead(int encrypt, psa_key_handle_t handle,
+                         psa_algorithm_t alg, const uint8_t *nonce,
+                         size_t nonce_length, const uint8_t *additional_data,
+                         size_t additional_data_length, const uint8_t *input,
+                         size_t input_length, uint8_t *output,
+                         size_t output_size, size_t *output_length)
+{
+    size_t tag_length = PSA_AEAD_TAG_LENGTH(alg);
+    uint8_t final_block[EVP_MAX_BLOCK_LENGTH];
+    size_t data_length;
+    EVP_CIPHER_CTX *ctx;
+    psa_status_t status = PSA_ERROR_GENERIC_ERROR;
+    int len;
+
+    if (handle != PS_TEST_KEY_HANDLE || key_size == 0) {
+        return PSA_ERROR_INVALID_HANDLE;
+    }
+
+    if (encrypt) {
+        data_length = input_length;
+        if (output_size < data_length + tag_length) {
+            return PSA_ERROR_BUFFER_TOO_SMALL;
+        }
+    } else {
+        if (input_length < tag_length) {
+            return PSA_ERROR_INVALID_SIGNATURE;
+        }
+        data_length = input_length - tag_length;
+        if (output_size < data_length) {
+            return PSA_ERROR_BUFFER_TOO_SMALL;
+        }
+    }
+
+    test_stats.aead_count++;
+
+    ctx = EVP_CIPHER_CTX_new();
+    if (ctx == NULL) {
+        return PSA_ERROR_INSUFFICIENT_MEMORY;
+    }
+
+    if (!EVP_CipherInit_ex(ctx, EVP_aes_128_gcm(), NULL, NULL, NULL,
+                           encrypt) ||
+        !EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, (int)nonce_length,
+                             NULL) ||
+        !EVP_CipherInit_ex(ctx, NULL, NULL, key, nonce, encrypt)) {
+        goto out;
+    }
+
+    if (additional_data_length > 0 &&
+        !EVP_CipherUpdate(ctx, NULL, &len, additional_data,
+                          (int)additional_data_length)) {
+        goto out;
+    }
+
+    if (data_length > 0 &&
+        !EVP_CipherUpdate(ctx, output, &len, input, (int)data_length)) {
+        goto out;
+    }
+
+    if (encrypt) {
+        if (!EVP_CipherFinal_ex(ctx, final_block, &len) ||
+            !EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, (int)tag_length,
+                                 output + data_length)) {
+            goto out;
+        }
+        *output_length = data_length + tag_length;
+    } else {
+        if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, (int)tag_length,
+                                 (void *)(input + data_length)) ||
+            !EVP_CipherFinal_ex(ctx, final_block, &len)) {
+            status = PSA_ERROR_INVALID_SIGNATURE;
+            goto out;
+        }
+        *output_length = data_length;
+    }
+
+    status = PSA_SUCCESS;
+
+out:
+    EVP_CIPHER_CTX_free(ctx);
+
+    return status;
+}
+
+psa_status_t psa_aead_encrypt(psa_key_handle_t handle,
+                              psa_algorithm_t alg,
+                              const uint8_t *nonce,
+                              size_t nonce_length,
+                              const uint8_t *additional_data,
+                              size_t additional_data_length,
+                              const uint8_t *plaintext,
+                              size_t plaintext_length,
+                              uint8_t *ciphertext,
+                              size_t ciphertext_size,
+                              size_t *ciphertext_length)
+{
+    return aead(1, handle, alg, nonce, nonce_length, additional_data,
+                additional_data_length, plaintext, plaintext_length,
+                ciphertext, ciphertext_size, ciphertext_length);
+}
+
+psa_status_t psa_aead_decrypt(psa_key_handle_t handle,
+                              psa_algorithm_t alg,
+                              const uint8_t *nonce,
+                              size_t nonce_length,
+                              const uint8_t *additional_data,
+                              size_t additional_data_length,
+                              const uint8_t *ciphertext,
+                              size_t ciphertext_length,
+                              uint8_t *plaintext,
+                              size_t plaintext_size,
+                              size_t *plaintext_length)
+{
+    return aead(0, handle, alg, nonce, nonce_length, additional_data,
+                additional_data_length, ciphertext, ciphertext_length,
+                plaintext, plaintext_size, plaintext_length);
+}
+#endif /* PS_ENCRYPTION */
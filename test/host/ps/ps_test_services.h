@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Model of the services used by PS for the PS host tests: the ITS service,
+ * with the files held in RAM, the platform NV counters and, with
+ * PS_ENCRYPTION, the AEAD and key derivation of the crypto service, with
+ * AES-GCM from the OpenSSL software library.
+ */
+
+#ifndef __PS_TEST_SERVICES_H__
+#define __PS_TEST_SERVICES_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "psa/storage_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Calls made to the model since the last reset.
+ */
+struct ps_test_stats_t {
+    uint32_t its_get_count;     /*!< Calls to psa_its_get() */
+    uint32_t its_get_bytes;     /*!< Bytes read by psa_its_get() */
+    uint32_t its_set_count;     /*!< Calls to psa_its_set() */
+    uint32_t aead_count;        /*!< AEAD encryptions and decryptions */
+};
+
+/**
+ * \brief Removes all the files and sets the NV counters to 0.
+ */
+void ps_test_services_reset(void);
+
+/**
+ * \brief Resets the call counts.
+ */
+void ps_test_reset_stats(void);
+
+/**
+ * \brief Gets the call counts.
+ *
+ * \param[out] stats  Call counts since the last reset
+ */
+void ps_test_get_stats(struct ps_test_stats_t *stats);
+
+/**
+ * \brief Checks whether an ITS file exists.
+ *
+ * \param[in] uid  UID of the file
+ *
+ * \return 1 if the file exists, 0 otherwise.
+ */
+int ps_test_its_exists(psa_storage_uid_t uid);
+
+/**
+ * \brief Flips the bits of a byte of an ITS file, as a corruption of the
+ *        storage.
+ *
+ * \param[in] uid     UID of the file
+ * \param[in] offset  Offset of the byte in the file
+ */
+void ps_test_its_corrupt(psa_storage_uid_t uid, size_t offset);
+
+/**
+ * \brief Makes the next call to psa_its_set() fail, as a storage failure.
+ */
+void ps_test_its_fail_next_set(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PS_TEST_SERVICES_H__ */
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/* Host stub of CMSIS compiler abstraction for the PS host tests */
+
+#ifndef __CMSIS_COMPILER_H__
+#define __CMSIS_COMPILER_H__
+
+#include <stdint.h>
+
+#define __STATIC_INLINE                 static inline
+
+static inline uint32_t __CLZ(uint32_t value)
+{
+    return (value == 0U) ? 32U : (uint32_t)__builtin_clz(value);
+}
+
+static inline uint32_t __RBIT(uint32_t value)
+{
+    uint32_t result = 0U;
+    uint32_t i;
+
+    for (i = 0U; i < 32U; i++) {
+        result = (result << 1) | ((value >> i) & 1U);
+    }
+
+    return result;
+}
+
+#endif /* __CMSIS_COMPILER_H__ */
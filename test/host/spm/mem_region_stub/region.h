@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Host stub of the linker symbol macros for the memory region test. The
+ * region symbols are variables which hold the addresses the test gives to the
+ * regions, so that the regions can be placed anywhere in the address space.
+ */
+
+#ifndef __REGION_H__
+#define __REGION_H__
+
+#include <stdint.h>
+
+#define REGION_NAME(a, b, c)            (*(uint8_t *)(a##b##c))
+#define REGION_DECLARE(a, b, c)         extern const uintptr_t a##b##c
+
+#endif /* __REGION_H__ */
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Memory layout of the memory region test. The non-secure code and data are
+ * adjacent to the secure ones, and the platform windows overlap, nest in and
+ * straddle the default regions, and reach the top of the address space.
+ */
+
+#ifndef __REGION_DEFS_H__
+#define __REGION_DEFS_H__
+
+#include <stdint.h>
+
+#define S_CODE_START                    (0x10000000UL)
+#define S_CODE_LIMIT                    (0x1007FFFFUL)
+#define NS_CODE_START                   (0x10080000UL)
+#define NS_CODE_LIMIT                   (0x100FFFFFUL)
+
+#define S_DATA_START                    (0x30000000UL)
+#define S_DATA_LIMIT                    (0x3003FFFFUL)
+#define NS_DATA_START                   (0x30040000UL)
+#define NS_DATA_LIMIT                   (0x3007FFFFUL)
+
+#define TFM_PLAT_MEM_REGION_DESC                                            \
+    /* Shared window across the secure and non-secure data */             \
+    {0x3003F000UL, 0x30040FFFUL,                                            \
+     TFM_MEM_REGION_PRIV_RD | TFM_MEM_REGION_PRIV_WR |                     \
+     TFM_MEM_REGION_UNPRIV_RD | TFM_MEM_REGION_UNPRIV_WR |                 \
+     TFM_MEM_REGION_XN},                                                    \
+    /* Secure window in the non-secure data */                              \
+    {0x30050000UL, 0x30050FFFUL,                                            \
+     TFM_MEM_REGION_SECURE | TFM_MEM_REGION_PRIV_RD |                       \
+     TFM_MEM_REGION_PRIV_WR | TFM_MEM_REGION_XN},                           \
+    /* Read-only window in the non-secure data, and a window it shadows */ \
+    {0x30060000UL, 0x30061FFFUL,                                            \
+     TFM_MEM_REGION_PRIV_RD | TFM_MEM_REGION_UNPRIV_RD},                    \
+    {0x30060800UL, 0x30060FFFUL,                                            \
+     TFM_MEM_REGION_PRIV_RD | TFM_MEM_REGION_PRIV_WR | TFM_MEM_REGION_XN}, \
+    /* Window out of the default regions, up to the end of the memory */   \
+    {UINTPTR_MAX - 0xFFFUL, UINTPTR_MAX,                                    \
+     TFM_MEM_REGION_PRIV_RD | TFM_MEM_REGION_PRIV_WR | TFM_MEM_REGION_XN}
+
+#endif /* __REGION_DEFS_H__ */
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Test of the lookups of partitions by partition ID and of RoT Services by
+ * SID, which are binary searches of the generated tables. The tables are
+ * generated from a manifest list which is not in partition ID order, and the
+ * test is built with all the partitions and with a part of them, to check
+ * that the generator sorts the tables and that the conditional entries keep
+ * them sorted.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "psa/service.h"
+#include "common/psa_client_service_apis.h"
+#include "spm_test_platform.h"
+#include "tfm_list.h"
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+extern struct tfm_spm_service_t service[];
+extern const struct tfm_spm_service_db_t service_db[];
+
+static uint32_t partition_id(uint32_t idx)
+{
+    return g_spm_partition_db.partitions[idx].static_data->partition_id;
+}
+
+/* Notifies a partition, which looks up the partition by ID */
+static int notify(uint32_t id)
+{
+    uint32_t args[1] = {id};
+    int panicked;
+
+    SPM_TEST_PANICS(panicked, tfm_spm_psa_notify(args));
+
+    return !panicked;
+}
+
+static int partition_exists(uint32_t id)
+{
+    uint32_t i;
+
+    for (i = 0; i < g_spm_partition_db.partition_count; i++) {
+        if (partition_id(i) == id) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void check_no_partition(uint32_t id)
+{
+    if (!partition_exists(id)) {
+        CHECK(!notify(id));
+    }
+}
+
+static void test_partitions(void)
+{
+    struct partition_t *partition;
+    uint32_t count = g_spm_partition_db.partition_count;
+    uint32_t i, j;
+
+    /* The non-secure partition, then at least one secure partition */
+    CHECK(count >= 2);
+    CHECK(partition_id(0) == TFM_SP_NON_SECURE_ID);
+    for (i = 1; i < count; i++) {
+        CHECK(partition_id(i - 1) < partition_id(i));
+    }
+
+    /* Each partition is found, the first and the last ones included */
+    for (i = 1; i < count; i++) {
+        partition = &g_spm_partition_db.partitions[i];
+
+        CHECK(notify(partition_id(i)));
+        CHECK(partition->signals_asserted & PSA_DOORBELL);
+        for (j = 1; j < count; j++) {
+            if (j != i) {
+                CHECK(!(g_spm_partition_db.partitions[j].signals_asserted &
+                        PSA_DOORBELL));
+            }
+        }
+        partition->signals_asserted &= ~PSA_DOORBELL;
+    }
+
+    /* The IDs around and between the partitions are not found */
+    check_no_partition(partition_id(1) - 1);
+    for (i = 1; i < count; i++) {
+        check_no_partition(partition_id(i) + 1);
+    }
+    check_no_partition(0x7FFFFFFF);
+}
+
+static void test_services(void)
+{
+    struct tfm_list_node_t *node;
+    struct tfm_spm_service_t *p_service;
+    struct partition_t *partition;
+    uint32_t count = 0;
+    uint32_t i;
+
+    /* Each service is in the list of its partition */
+    for (i = 0; i < g_spm_partition_db.partition_count; i++) {
+        partition = &g_spm_partition_db.partitions[i];
+        TFM_LIST_FOR_EACH(node, &partition->service_list) {
+            p_service = TFM_GET_CONTAINER_PTR(node, struct tfm_spm_service_t,
+                                              list);
+            CHECK(p_service->partition == partition);
+            CHECK(p_service->service_db->partition_id == partition_id(i));
+            count++;
+        }
+    }
+    CHECK(count > 0);
+
+    for (i = 1; i < count; i++) {
+        CHECK(service_db[i - 1].sid < service_db[i].sid);
+    }
+
+    /* Each service is found, the first and the last ones included */
+    for (i = 0; i < count; i++) {
+        CHECK(service[i].service_db == &service_db[i]);
+        CHECK(tfm_spm_get_service_by_sid(service_db[i].sid) == &service[i]);
+    }
+
+    /* The SIDs around and between the services are not found */
+    CHECK(tfm_spm_get_service_by_sid(0) == NULL);
+    CHECK(tfm_spm_get_service_by_sid(service_db[0].sid - 1) == NULL);
+    for (i = 0; i < count; i++) {
+        if (i + 1 == count || service_db[i].sid + 1 != service_db[i + 1].sid) {
+            CHECK(tfm_spm_get_service_by_sid(service_db[i].sid + 1) == NULL);
+        }
+    }
+    CHECK(tfm_spm_get_service_by_sid(0xFFFFFFFF) == NULL);
+}
+
+int main(void)
+{
+    spm_test_init();
+
+    test_partitions();
+    test_services();
+
+    printf("PASS\n");
+
+    return EXIT_SUCCESS;
+}
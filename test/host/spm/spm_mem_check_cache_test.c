@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Test of the cache of the non-secure memory references validated by
+ * tfm_memory_check_ranges() on multi-core topology. The memory access HAL is
+ * replaced by a model which counts its lookups, so that the test checks which
+ * references hit the cache.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "psa_manifest/pid.h"
+#include "spm_test_platform.h"
+#include "tfm_hal_isolation.h"
+#include "tfm_internal_defines.h"
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+/* The default size of the cache of spm_ipc.c */
+#define CACHE_NR_CLIENTS            4
+#define CACHE_NR_REGIONS            4
+
+#define REGION_BASE                 0x28000000UL
+#define REGION_SIZE                 0x1000UL
+#define REGION(n)                   (REGION_BASE + (n) * REGION_SIZE)
+
+/* Memory the model denies access to */
+#define DENIED_BASE                 0x30000000UL
+
+static uint32_t hal_lookups;
+
+static enum tfm_hal_status_t memory_has_access(uintptr_t base, size_t size,
+                                               uint32_t attr)
+{
+    (void)size;
+    (void)attr;
+
+    hal_lookups++;
+
+    return (base >= DENIED_BASE) ? TFM_HAL_ERROR_MEM_FAULT : TFM_HAL_SUCCESS;
+}
+
+static int32_t check_range(uintptr_t base, size_t len,
+                           enum tfm_memory_access_e access, bool ns_caller,
+                           uint32_t privileged, int32_t client_id)
+{
+    struct tfm_memory_range_t range;
+
+    range.base = (const void *)base;
+    range.len = len;
+    range.access = access;
+
+    return tfm_memory_check_ranges(&range, 1, ns_caller, privileged,
+                                   client_id);
+}
+
+/* Returns the number of HAL lookups of a valid non-secure reference */
+static uint32_t ns_lookups(int32_t client_id, uintptr_t base, size_t len,
+                           enum tfm_memory_access_e access)
+{
+    uint32_t before = hal_lookups;
+
+    CHECK(check_range(base, len, access, true, TFM_PARTITION_PRIVILEGED_MODE,
+                      client_id) == IPC_SUCCESS);
+
+    return hal_lookups - before;
+}
+
+static void test_sub_ranges(void)
+{
+    const int32_t client = -1;
+
+    CHECK(ns_lookups(client, REGION(0), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RW) == 1);
+
+    /* The whole region, its first and last bytes, and a range inside */
+    CHECK(ns_lookups(client, REGION(0), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RW) == 0);
+    CHECK(ns_lookups(client, REGION(0), 1, TFM_MEMORY_ACCESS_RW) == 0);
+    CHECK(ns_lookups(client, REGION(0) + REGION_SIZE - 1, 1,
+                     TFM_MEMORY_ACCESS_RW) == 0);
+    CHECK(ns_lookups(client, REGION(0) + 0x10, 0x20,
+                     TFM_MEMORY_ACCESS_RW) == 0);
+
+    /* Ranges which cross either end are looked up */
+    CHECK(ns_lookups(client, REGION(0) - 1, 2, TFM_MEMORY_ACCESS_RW) == 1);
+    CHECK(ns_lookups(client, REGION(0) + REGION_SIZE - 1, 2,
+                     TFM_MEMORY_ACCESS_RW) == 1);
+}
+
+static void test_access(void)
+{
+    const int32_t client = -2;
+    uint32_t before;
+
+    /* A read-write entry also covers the read-only references */
+    CHECK(ns_lookups(client, REGION(0), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RW) == 1);
+    CHECK(ns_lookups(client, REGION(0), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RO) == 0);
+    CHECK(ns_lookups(client, REGION(0) + 0x100, 0x10,
+                     TFM_MEMORY_ACCESS_RO) == 0);
+
+    /* A read-only entry does not cover the read-write references */
+    CHECK(ns_lookups(client, REGION(1), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RO) == 1);
+    CHECK(ns_lookups(client, REGION(1), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RO) == 0);
+    CHECK(ns_lookups(client, REGION(1), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RW) == 1);
+
+    /* A privileged entry does not cover the unprivileged references */
+    before = hal_lookups;
+    CHECK(check_range(REGION(0), REGION_SIZE, TFM_MEMORY_ACCESS_RO, true,
+                      TFM_PARTITION_UNPRIVILEGED_MODE, client) == IPC_SUCCESS);
+    CHECK(hal_lookups - before == 1);
+}
+
+static void test_replacement(void)
+{
+    const int32_t client = -3;
+    uint32_t i;
+
+    /* Fill the entries of the client, and hit all of them */
+    for (i = 0; i < CACHE_NR_REGIONS; i++) {
+        CHECK(ns_lookups(client, REGION(i), REGION_SIZE,
+                         TFM_MEMORY_ACCESS_RW) == 1);
+    }
+    for (i = 0; i < CACHE_NR_REGIONS; i++) {
+        CHECK(ns_lookups(client, REGION(i), REGION_SIZE,
+                         TFM_MEMORY_ACCESS_RW) == 0);
+    }
+
+    /* The next region replaces the oldest entry, the others are kept */
+    CHECK(ns_lookups(client, REGION(CACHE_NR_REGIONS), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RW) == 1);
+    for (i = 1; i <= CACHE_NR_REGIONS; i++) {
+        CHECK(ns_lookups(client, REGION(i), REGION_SIZE,
+                         TFM_MEMORY_ACCESS_RW) == 0);
+    }
+
+    /*
+     * The replaced region is inserted again in place of the next oldest
+     * entry, regardless of the hits on that entry.
+     */
+    CHECK(ns_lookups(client, REGION(0), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RW) == 1);
+    CHECK(ns_lookups(client, REGION(1), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RW) == 1);
+    for (i = 0; i <= CACHE_NR_REGIONS; i++) {
+        if (i != 2) {
+            CHECK(ns_lookups(client, REGION(i), REGION_SIZE,
+                             TFM_MEMORY_ACCESS_RW) == 0);
+        }
+    }
+    CHECK(ns_lookups(client, REGION(2), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RW) == 1);
+}
+
+static void test_client_slots(void)
+{
+    /*
+     * A client, a client whose ID shares its cache slot, and a client in
+     * another slot
+     */
+    const int32_t client = -4;
+    const int32_t colliding = client - CACHE_NR_CLIENTS;
+    const int32_t other = client - 3;
+
+    CHECK(ns_lookups(client, REGION(0), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RW) == 1);
+    CHECK(ns_lookups(other, REGION(1), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RW) == 1);
+
+    /* The entries of a client are not used for the other clients */
+    CHECK(ns_lookups(other, REGION(0), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RW) == 1);
+    CHECK(ns_lookups(colliding, REGION(0), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RW) == 1);
+    CHECK(ns_lookups(colliding, REGION(0), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RW) == 0);
+
+    /*
+     * The colliding client took the slot over and cleared its entries, and
+     * the client in another slot kept them.
+     */
+    CHECK(ns_lookups(client, REGION(0), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RW) == 1);
+    CHECK(ns_lookups(other, REGION(1), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RW) == 0);
+}
+
+static void test_not_cached(void)
+{
+    const int32_t client = -5;
+    struct tfm_memory_range_t ranges[3];
+    uint32_t before;
+    int i;
+
+    /* Secure references are always looked up */
+    for (i = 0; i < 2; i++) {
+        before = hal_lookups;
+        CHECK(check_range(REGION(0), REGION_SIZE, TFM_MEMORY_ACCESS_RW, false,
+                          TFM_PARTITION_PRIVILEGED_MODE,
+                          TFM_SP_PS) == IPC_SUCCESS);
+        CHECK(hal_lookups - before == 1);
+    }
+
+    /* A reference which failed the check is not cached */
+    for (i = 0; i < 2; i++) {
+        before = hal_lookups;
+        CHECK(check_range(DENIED_BASE, REGION_SIZE, TFM_MEMORY_ACCESS_RO,
+                          true, TFM_PARTITION_PRIVILEGED_MODE, client) ==
+              IPC_ERROR_MEMORY_CHECK);
+        CHECK(hal_lookups - before == 1);
+    }
+
+    /* The checks stop at the first invalid reference */
+    ranges[0].base = (const void *)REGION(0);
+    ranges[0].len = REGION_SIZE;
+    ranges[0].access = TFM_MEMORY_ACCESS_RO;
+    ranges[1].base = (const void *)DENIED_BASE;
+    ranges[1].len = REGION_SIZE;
+    ranges[1].access = TFM_MEMORY_ACCESS_RO;
+    ranges[2].base = (const void *)REGION(1);
+    ranges[2].len = REGION_SIZE;
+    ranges[2].access = TFM_MEMORY_ACCESS_RO;
+    CHECK(tfm_memory_check_ranges(ranges, 3, true,
+                                  TFM_PARTITION_PRIVILEGED_MODE, client) ==
+          IPC_ERROR_MEMORY_CHECK);
+    CHECK(ns_lookups(client, REGION(0), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RO) == 0);
+    CHECK(ns_lookups(client, REGION(1), REGION_SIZE,
+                     TFM_MEMORY_ACCESS_RO) == 1);
+}
+
+int main(void)
+{
+    spm_test_set_memory_access(memory_has_access);
+
+    test_sub_ranges();
+    test_access();
+    test_replacement();
+    test_client_slots();
+    test_not_cached();
+
+    printf("PASS\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Test of the lookup of the memory region attributes of multi-core topology.
+ * The binary search of the region table is compared with an ordered linear
+ * scan of the region layout, which is how the attributes were looked up
+ * before the table: the first region of the layout which contains the whole
+ * memory range gives its attributes. The memory ranges compared start and end
+ * around each region boundary, and at random addresses.
+ *
+ * The test is built at isolation levels 1 and 2, with the layout of
+ * mem_region_stub/region_defs.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "region_defs.h"
+#include "tfm_hal_isolation.h"
+#include "tfm_multi_core.h"
+#include "tfm_spm_hal.h"
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+#define RANDOM_RANGES               1000000
+
+#define RW_ALL                      (TFM_MEM_REGION_PRIV_RD |   \
+                                     TFM_MEM_REGION_PRIV_WR |   \
+                                     TFM_MEM_REGION_UNPRIV_RD | \
+                                     TFM_MEM_REGION_UNPRIV_WR | \
+                                     TFM_MEM_REGION_XN)
+#define RO_ALL                      (TFM_MEM_REGION_PRIV_RD |   \
+                                     TFM_MEM_REGION_UNPRIV_RD)
+#define RW_PRIV                     (TFM_MEM_REGION_PRIV_RD |   \
+                                     TFM_MEM_REGION_PRIV_WR |   \
+                                     TFM_MEM_REGION_XN)
+#define RO_PRIV                     (TFM_MEM_REGION_PRIV_RD)
+
+/* The isolation level 2 regions, in the secure code and data */
+const uintptr_t Image$$TFM_UNPRIV_CODE$$RO$$Base = 0x10010000UL;
+const uintptr_t Image$$TFM_UNPRIV_CODE$$RO$$Limit = 0x10018000UL;
+const uintptr_t Image$$TFM_UNPRIV_DATA$$RW$$Base = 0x30001000UL;
+const uintptr_t Image$$TFM_UNPRIV_DATA$$ZI$$Limit = 0x30002000UL;
+const uintptr_t Image$$TFM_APP_CODE_START$$Base = 0x10040000UL;
+const uintptr_t Image$$TFM_APP_CODE_END$$Base = 0x10060000UL;
+const uintptr_t Image$$TFM_APP_RW_STACK_START$$Base = 0x30010000UL;
+const uintptr_t Image$$TFM_APP_RW_STACK_END$$Base = 0x3003F800UL;
+
+/* The layout in precedence order, as documented in tfm_multi_core.h */
+static const struct tfm_mem_region_desc_t layout[] = {
+    TFM_PLAT_MEM_REGION_DESC,
+    {NS_DATA_START, NS_DATA_LIMIT, RW_ALL},
+    {NS_CODE_START, NS_CODE_LIMIT, RO_ALL},
+#if TFM_LVL == 2
+    {0x10010000UL, 0x10017FFFUL, TFM_MEM_REGION_SECURE | RO_ALL},
+    {0x30001000UL, 0x30001FFFUL, TFM_MEM_REGION_SECURE | RW_ALL},
+    {0x10040000UL, 0x1005FFFFUL, TFM_MEM_REGION_SECURE | RO_ALL},
+    {0x30010000UL, 0x3003F7FFUL, TFM_MEM_REGION_SECURE | RW_ALL},
+    {S_DATA_START, S_DATA_LIMIT, TFM_MEM_REGION_SECURE | RW_PRIV},
+    {S_CODE_START, S_CODE_LIMIT, TFM_MEM_REGION_SECURE | RO_PRIV},
+#else
+    {S_DATA_START, S_DATA_LIMIT, TFM_MEM_REGION_SECURE | RW_ALL},
+    {S_CODE_START, S_CODE_LIMIT, TFM_MEM_REGION_SECURE | RO_ALL},
+#endif
+};
+
+#define NR_LAYOUT                   (sizeof(layout) / sizeof(layout[0]))
+
+void tfm_core_panic(void)
+{
+    fprintf(stderr, "FAIL: unexpected panic\n");
+    exit(EXIT_FAILURE);
+}
+
+/* The platform HAL of multi-core topology uses the static layout */
+void tfm_spm_hal_get_mem_security_attr(const void *p, size_t s,
+                                       struct security_attr_info_t *p_attr)
+{
+    tfm_get_mem_region_security_attr(p, s, p_attr);
+}
+
+void tfm_spm_hal_get_secure_access_attr(const void *p, size_t s,
+                                        struct mem_attr_info_t *p_attr)
+{
+    tfm_get_secure_mem_region_attr(p, s, p_attr);
+}
+
+void tfm_spm_hal_get_ns_access_attr(const void *p, size_t s,
+                                    struct mem_attr_info_t *p_attr)
+{
+    tfm_get_ns_mem_region_attr(p, s, p_attr);
+}
+
+/* The first region of the layout which matches and contains the range */
+static const struct tfm_mem_region_desc_t *linear_lookup(uintptr_t p, size_t s,
+                                                         uint32_t mask,
+                                                         uint32_t flags)
+{
+    uint32_t i;
+
+    if (p > UINTPTR_MAX - s) {
+        return NULL;
+    }
+
+    for (i = 0; i < NR_LAYOUT; i++) {
+        if (((layout[i].flags & mask) == flags) && (p >= layout[i].base) &&
+            (p + s - 1 <= layout[i].limit)) {
+            return &layout[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void check_mem_attr(const struct mem_attr_info_t *attr,
+                           const struct tfm_mem_region_desc_t *region)
+{
+    CHECK(attr->is_valid == (region != NULL));
+    if (!region) {
+        return;
+    }
+
+    CHECK(attr->is_priv_rd_allow == !!(region->flags & TFM_MEM_REGION_PRIV_RD));
+    CHECK(attr->is_priv_wr_allow == !!(region->flags & TFM_MEM_REGION_PRIV_WR));
+    CHECK(attr->is_unpriv_rd_allow ==
+          !!(region->flags & TFM_MEM_REGION_UNPRIV_RD));
+    CHECK(attr->is_unpriv_wr_allow ==
+          !!(region->flags & TFM_MEM_REGION_UNPRIV_WR));
+    CHECK(attr->is_xn == !!(region->flags & TFM_MEM_REGION_XN));
+}
+
+/* Compares the lookups of a range with the linear scan */
+static void compare(uintptr_t p, size_t s)
+{
+    const struct tfm_mem_region_desc_t *region;
+    struct security_attr_info_t security_attr;
+    struct mem_attr_info_t mem_attr;
+
+    region = linear_lookup(p, s, 0, 0);
+    tfm_get_mem_region_security_attr((const void *)p, s, &security_attr);
+    CHECK(security_attr.is_valid == (region != NULL));
+    if (region) {
+        CHECK(security_attr.is_secure ==
+              !!(region->flags & TFM_MEM_REGION_SECURE));
+    }
+
+    tfm_get_secure_mem_region_attr((const void *)p, s, &mem_attr);
+    check_mem_attr(&mem_attr, linear_lookup(p, s, TFM_MEM_REGION_SECURE,
+                                            TFM_MEM_REGION_SECURE));
+
+    tfm_get_ns_mem_region_attr((const void *)p, s, &mem_attr);
+    check_mem_attr(&mem_attr, linear_lookup(p, s, TFM_MEM_REGION_SECURE, 0));
+}
+
+static uint32_t collect_bounds(uintptr_t *bounds)
+{
+    uint32_t i, n = 0;
+
+    for (i = 0; i < NR_LAYOUT; i++) {
+        bounds[n++] = layout[i].base;
+        bounds[n++] = layout[i].limit + 1;
+    }
+
+    return n;
+}
+
+static void test_examples(void)
+{
+    struct security_attr_info_t security_attr;
+    struct mem_attr_info_t mem_attr;
+
+    /* The shared window takes precedence over the secure data */
+    tfm_get_mem_region_security_attr((const void *)0x3003F000UL, 0x2000,
+                                     &security_attr);
+    CHECK(security_attr.is_valid && !security_attr.is_secure);
+
+    /* The secure window in the non-secure data */
+    tfm_get_mem_region_security_attr((const void *)0x30050100UL, 0x100,
+                                     &security_attr);
+    CHECK(security_attr.is_valid && security_attr.is_secure);
+    tfm_get_ns_mem_region_attr((const void *)0x30050100UL, 0x100, &mem_attr);
+    CHECK(mem_attr.is_valid && mem_attr.is_unpriv_wr_allow);
+
+    /* The shadowed window gives way to the window listed before it */
+    tfm_get_ns_mem_region_attr((const void *)0x30060800UL, 0x10, &mem_attr);
+    CHECK(mem_attr.is_valid && !mem_attr.is_priv_wr_allow);
+
+    /* A range across the secure and the non-secure code is in no region */
+    tfm_get_mem_region_security_attr((const void *)(S_CODE_LIMIT - 1), 4,
+                                     &security_attr);
+    CHECK(!security_attr.is_valid);
+
+    /*
+     * The window at the end of the memory. As in check_address_range(), a
+     * range which reaches the last address is rejected as an overflow.
+     */
+    tfm_get_ns_mem_region_attr((const void *)(UINTPTR_MAX - 0xFFF), 0xFFF,
+                               &mem_attr);
+    CHECK(mem_attr.is_valid);
+    tfm_get_ns_mem_region_attr((const void *)(UINTPTR_MAX - 0xFFF), 0x1000,
+                               &mem_attr);
+    CHECK(!mem_attr.is_valid);
+
+    /* The full access check of a non-secure read-write reference */
+    CHECK(tfm_has_access_to_region((const void *)0x30040000UL, 0x100,
+                                   TFM_HAL_ACCESS_READABLE |
+                                   TFM_HAL_ACCESS_WRITABLE |
+                                   TFM_HAL_ACCESS_NS) == TFM_SUCCESS);
+    CHECK(tfm_has_access_to_region((const void *)NS_CODE_START, 0x100,
+                                   TFM_HAL_ACCESS_READABLE |
+                                   TFM_HAL_ACCESS_WRITABLE |
+                                   TFM_HAL_ACCESS_NS) != TFM_SUCCESS);
+}
+
+/* Ranges which start and end around the region boundaries */
+static void test_bounds(void)
+{
+    static const size_t sizes[] = {0, 1, 2, 3, 0x10, 0x800, 0x1000, 0x1001};
+    uintptr_t bounds[2 * NR_LAYOUT];
+    uint32_t nr_bounds = collect_bounds(bounds);
+    uint32_t i, j, k;
+    intptr_t d;
+    uintptr_t p;
+
+    for (i = 0; i < nr_bounds; i++) {
+        for (d = -2; d <= 2; d++) {
+            p = bounds[i] + d;
+
+            for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+                compare(p, sizes[k]);
+            }
+
+            /* Up to and across each other boundary */
+            for (j = 0; j < nr_bounds; j++) {
+                if (bounds[j] > p) {
+                    compare(p, bounds[j] - p);
+                    compare(p, bounds[j] - p + 1);
+                }
+            }
+        }
+    }
+}
+
+static void test_random(void)
+{
+    uintptr_t bounds[2 * NR_LAYOUT];
+    uint32_t nr_bounds = collect_bounds(bounds);
+    uint64_t seed = 1;
+    uint32_t i, r;
+    uintptr_t p;
+    size_t s;
+
+    for (i = 0; i < RANDOM_RANGES; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        r = (uint32_t)(seed >> 32);
+
+        if (r & 1) {
+            /* Near a boundary */
+            p = bounds[(r >> 1) % nr_bounds] + ((r >> 8) & 0x3FFF) - 0x2000;
+        } else {
+            p = (uintptr_t)(seed >> 16) & 0x3FFFFFFFUL;
+        }
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        s = (size_t)((seed >> 33) % ((r & 2) ? 0x100 : 0x90000)) + 1;
+
+        compare(p, s);
+    }
+}
+
+int main(void)
+{
+    CHECK(tfm_mem_region_table_init() == TFM_SUCCESS);
+
+    test_examples();
+    test_bounds();
+    test_random();
+
+    printf("PASS\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Test of the stateless handles and of the handling of the connection
+ * handles on psa_reply(). A client partition sends requests through the SPM,
+ * and the RoT Service partition gets them and replies to them.
+ *
+ * The test is linked with tfm_pool_free() wrapped to fill the freed handles,
+ * which holds the message, with a poison value: a read of the message after
+ * the handle was freed fails the checks of the message.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "psa/service.h"
+#include "psa_manifest/pid.h"
+#include "psa_manifest/sid.h"
+#include "common/psa_client_service_apis.h"
+#include "common/spm_psa_client_call.h"
+#include "spm_test_platform.h"
+#include "tfm_list.h"
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+#define POOL_POISON                 0xA5
+
+#define NS_CLIENT_ID                (-1)
+
+#define REPLY_STATUS                ((psa_status_t)7)
+
+void __real_tfm_pool_free(void *ptr);
+
+void __wrap_tfm_pool_free(void *ptr)
+{
+    memset(ptr, POOL_POISON, sizeof(struct tfm_conn_handle_t));
+    __real_tfm_pool_free(ptr);
+}
+
+/*
+ * The SPM passes the addresses in the SVC arguments as 32-bit values, so the
+ * buffers of the test are static, which are linked at low addresses.
+ */
+static uint8_t in_buf[8];
+static uint8_t out_buf[2][8];
+static psa_invec in_vec = {in_buf, sizeof(in_buf)};
+static psa_outvec out_vec[2] = {
+    {out_buf[0], sizeof(out_buf[0])},
+    {out_buf[1], sizeof(out_buf[1])},
+};
+static psa_msg_t msg;
+
+static uint32_t partition_index(const struct partition_t *partition)
+{
+    return (uint32_t)(partition - g_spm_partition_db.partitions);
+}
+
+/* Gets the next message of an RoT Service, as its partition */
+static psa_handle_t get(uint32_t sid)
+{
+    struct tfm_spm_service_t *service = tfm_spm_get_service_by_sid(sid);
+    uint32_t args[2];
+
+    CHECK(service != NULL);
+    spm_test_set_running_partition(service->service_db->partition_id);
+
+    args[0] = service->service_db->signal;
+    args[1] = (uint32_t)(uintptr_t)&msg;
+    CHECK(tfm_spm_psa_get(args) == PSA_SUCCESS);
+
+    return msg.handle;
+}
+
+/* Replies to a message, as the partition of its RoT Service */
+static void reply(psa_handle_t handle, psa_status_t status)
+{
+    uint32_t args[2] = {(uint32_t)handle, (uint32_t)status};
+
+    tfm_spm_psa_reply(args);
+}
+
+static void call(int32_t client_partition_id, psa_handle_t handle,
+                 uint32_t out_idx)
+{
+    bool ns_caller = (client_partition_id == TFM_SP_NON_SECURE_ID);
+
+    spm_test_set_running_partition(client_partition_id);
+    CHECK(tfm_spm_client_psa_call(handle, PSA_IPC_CALL, &in_vec, 1,
+                                  &out_vec[out_idx], 1, ns_caller, 1) ==
+          PSA_SUCCESS);
+}
+
+/* Checks that a client was woken with the given return value */
+static void check_woken(int32_t client_partition_id, int32_t ret)
+{
+    struct partition_t *client = spm_test_get_partition(client_partition_id);
+
+    CHECK(client->sp_thread.state == THRD_STATE_RUNNING);
+    CHECK((int32_t)client->sp_thread.arch_ctx.retval == ret);
+}
+
+static void check_blocked(int32_t client_partition_id)
+{
+    struct partition_t *client = spm_test_get_partition(client_partition_id);
+
+    CHECK(client->sp_thread.state == THRD_STATE_BLOCK);
+}
+
+static void test_stateless_handles(void)
+{
+    static const struct {
+        psa_handle_t handle;
+        uint32_t sid;
+    } handles[] = {
+        {TFM_ITS_SET_HANDLE, TFM_ITS_SET_SID},
+        {TFM_ITS_GET_HANDLE, TFM_ITS_GET_SID},
+        {TFM_ITS_GET_INFO_HANDLE, TFM_ITS_GET_INFO_SID},
+        {TFM_ITS_REMOVE_HANDLE, TFM_ITS_REMOVE_SID},
+        {TFM_CRYPTO_HANDLE, TFM_CRYPTO_SID},
+    };
+    struct tfm_spm_service_t *service;
+    uint32_t i;
+
+    /* A stateless handle refers to its RoT Service by its index */
+    for (i = 0; i < sizeof(handles) / sizeof(handles[0]); i++) {
+        CHECK(TFM_HANDLE_IS_STATELESS(handles[i].handle));
+        service = tfm_spm_get_stateless_service(handles[i].handle);
+        CHECK(service == tfm_spm_get_service_by_sid(handles[i].sid));
+        CHECK(!service->service_db->connection_based);
+        CHECK(service->service_db->stateless_index ==
+              TFM_STATELESS_HANDLE_IDX(handles[i].handle));
+    }
+
+    /* Other handles are not stateless handles, nor the ones past the last */
+    CHECK(tfm_spm_get_stateless_service(PSA_NULL_HANDLE) == NULL);
+    CHECK(tfm_spm_get_stateless_service((psa_handle_t)32) == NULL);
+    CHECK(tfm_spm_get_stateless_service((psa_handle_t)-1) == NULL);
+    CHECK(tfm_spm_get_stateless_service(TFM_CRYPTO_HANDLE + 1) == NULL);
+
+    /* A stateless message handle out of the partitions is not a message */
+    spm_test_set_running_partition(TFM_SP_ITS);
+    CHECK(tfm_spm_get_msg_from_handle((psa_handle_t)
+                                      (TFM_STATELESS_HANDLE_BIT |
+                                       g_spm_partition_db.partition_count)) ==
+          NULL);
+}
+
+/*
+ * A stateless request uses the handle reserved in the client partition, and
+ * its message handle is the index of the client partition.
+ */
+static void test_stateless_call(int32_t client_partition_id,
+                                psa_handle_t handle, uint32_t sid)
+{
+    struct partition_t *client = spm_test_get_partition(client_partition_id);
+    struct tfm_spm_service_t *service = tfm_spm_get_service_by_sid(sid);
+    psa_handle_t msg_handle;
+    int panicked;
+
+    call(client_partition_id, handle, 0);
+    check_blocked(client_partition_id);
+    CHECK(client->stateless_conn.internal_msg.magic == TFM_MSG_MAGIC);
+
+    msg_handle = get(sid);
+    CHECK(msg_handle == (psa_handle_t)(TFM_STATELESS_HANDLE_BIT |
+                                       partition_index(client)));
+    CHECK(msg.type == PSA_IPC_CALL);
+    CHECK(msg.in_size[0] == sizeof(in_buf));
+    CHECK(tfm_spm_get_msg_from_handle(msg_handle) ==
+          &client->stateless_conn.internal_msg);
+
+    /* Only the partition of the RoT Service owns the message */
+    spm_test_set_running_partition(TFM_SP_PLATFORM);
+    CHECK(tfm_spm_get_msg_from_handle(msg_handle) == NULL);
+    spm_test_set_running_partition(service->service_db->partition_id);
+
+    /* The client is woken, and the reserved handle is free again */
+    reply(msg_handle, REPLY_STATUS);
+    check_woken(client_partition_id, REPLY_STATUS);
+    CHECK(client->stateless_conn.internal_msg.magic != TFM_MSG_MAGIC);
+    CHECK(tfm_list_is_empty(&service->handle_list));
+    CHECK(tfm_spm_get_msg_from_handle(msg_handle) == NULL);
+
+    /* It is a fatal error to reply to it again */
+    SPM_TEST_PANICS(panicked, reply(msg_handle, REPLY_STATUS));
+    CHECK(panicked);
+}
+
+/*
+ * A stateless request of a client whose reserved handle is still in use takes
+ * a handle from the pool, which is freed on the reply.
+ */
+static void test_stateless_pool_fallback(void)
+{
+    struct partition_t *client = spm_test_get_partition(TFM_SP_NON_SECURE_ID);
+    struct tfm_spm_service_t *service =
+                                tfm_spm_get_service_by_sid(TFM_ITS_GET_SID);
+    psa_handle_t reserved_handle, pool_handle;
+
+    call(TFM_SP_NON_SECURE_ID, TFM_ITS_SET_HANDLE, 0);
+    call(TFM_SP_NON_SECURE_ID, TFM_ITS_GET_HANDLE, 1);
+    CHECK(!tfm_list_is_empty(&service->handle_list));
+
+    reserved_handle = get(TFM_ITS_SET_SID);
+    CHECK(TFM_HANDLE_IS_STATELESS(reserved_handle));
+    pool_handle = get(TFM_ITS_GET_SID);
+    CHECK(!TFM_HANDLE_IS_STATELESS(pool_handle));
+
+    /* The pool handle is freed, after the client was given the reply */
+    out_vec[1].len = 0xFF;
+    reply(pool_handle, REPLY_STATUS);
+    check_woken(TFM_SP_NON_SECURE_ID, REPLY_STATUS);
+    CHECK(out_vec[1].len == 0);
+    CHECK(tfm_list_is_empty(&service->handle_list));
+    CHECK(client->stateless_conn.internal_msg.magic == TFM_MSG_MAGIC);
+
+    /* The client is blocked again for the request still in progress */
+    tfm_core_thrd_set_state(&client->sp_thread, THRD_STATE_BLOCK);
+    reply(reserved_handle, PSA_SUCCESS);
+    check_woken(TFM_SP_NON_SECURE_ID, PSA_SUCCESS);
+    CHECK(client->stateless_conn.internal_msg.magic != TFM_MSG_MAGIC);
+}
+
+/*
+ * A refused connection and a closed connection free the handle, after the
+ * client was given the reply.
+ */
+static void test_connection_free(void)
+{
+    struct tfm_spm_service_t *service =
+                    tfm_spm_get_service_by_sid(TFM_SP_PLATFORM_IOCTL_SID);
+    psa_handle_t handle;
+
+    spm_test_set_running_partition(TFM_SP_NON_SECURE_ID);
+    CHECK(tfm_spm_client_psa_connect(TFM_SP_PLATFORM_IOCTL_SID, 1, true) ==
+          PSA_SUCCESS);
+    handle = get(TFM_SP_PLATFORM_IOCTL_SID);
+    CHECK(msg.type == PSA_IPC_CONNECT);
+    reply(handle, PSA_ERROR_CONNECTION_REFUSED);
+    check_woken(TFM_SP_NON_SECURE_ID, PSA_ERROR_CONNECTION_REFUSED);
+    CHECK(tfm_list_is_empty(&service->handle_list));
+
+    spm_test_set_running_partition(TFM_SP_NON_SECURE_ID);
+    CHECK(tfm_spm_client_psa_connect(TFM_SP_PLATFORM_IOCTL_SID, 1, true) ==
+          PSA_SUCCESS);
+    handle = get(TFM_SP_PLATFORM_IOCTL_SID);
+    reply(handle, PSA_SUCCESS);
+    check_woken(TFM_SP_NON_SECURE_ID, handle);
+    CHECK(!tfm_list_is_empty(&service->handle_list));
+
+    spm_test_set_running_partition(TFM_SP_NON_SECURE_ID);
+    tfm_spm_client_psa_close(handle, true);
+    CHECK(get(TFM_SP_PLATFORM_IOCTL_SID) == handle);
+    CHECK(msg.type == PSA_IPC_DISCONNECT);
+    reply(handle, PSA_SUCCESS);
+    check_woken(TFM_SP_NON_SECURE_ID, PSA_SUCCESS);
+    CHECK(tfm_list_is_empty(&service->handle_list));
+}
+
+int main(void)
+{
+    spm_test_init();
+    spm_test_set_ns_client_id(NS_CLIENT_ID);
+
+    test_stateless_handles();
+    test_stateless_call(TFM_SP_NON_SECURE_ID, TFM_ITS_GET_HANDLE,
+                        TFM_ITS_GET_SID);
+    test_stateless_call(TFM_SP_PS, TFM_CRYPTO_HANDLE, TFM_CRYPTO_SID);
+    test_stateless_call(TFM_SP_PS, TFM_ITS_REMOVE_HANDLE, TFM_ITS_REMOVE_SID);
+    test_stateless_pool_fallback();
+    test_connection_free();
+
+    printf("PASS\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "spm_test_platform.h"
+#include "tfm_hal_isolation.h"
+#include "tfm_hal_platform.h"
+#include "tfm_nspm.h"
+#include "tfm_spm_hal.h"
+#include "tfm_thread.h"
+
+jmp_buf spm_test_panic_jmp;
+int spm_test_panic_armed;
+
+uint32_t tfm_test_pendsv_count;
+
+static spm_test_memory_access_t memory_access;
+static int32_t ns_client_id = -1;
+
+/* The partition entry points of the generated partition database */
+void tfm_nspm_thread_entry(void)
+{
+}
+
+void tfm_ps_req_mngr_init(void)
+{
+}
+
+void tfm_its_req_mngr_init(void)
+{
+}
+
+void tfm_crypto_init(void)
+{
+}
+
+void platform_sp_init(void)
+{
+}
+
+void attest_partition_init(void)
+{
+}
+
+/* A panic of the SPM resets the system */
+void tfm_hal_system_reset(void)
+{
+    if (spm_test_panic_armed) {
+        longjmp(spm_test_panic_jmp, 1);
+    }
+
+    fprintf(stderr, "FAIL: unexpected SPM panic\n");
+    exit(EXIT_FAILURE);
+}
+
+enum tfm_hal_status_t tfm_hal_memory_has_access(uintptr_t base,
+                                                size_t size,
+                                                uint32_t attr)
+{
+    if (memory_access) {
+        return memory_access(base, size, attr);
+    }
+
+    return TFM_HAL_SUCCESS;
+}
+
+enum tfm_plat_err_t tfm_spm_hal_configure_default_isolation(
+                 uint32_t partition_idx,
+                 const struct tfm_spm_partition_platform_data_t *platform_data)
+{
+    (void)partition_idx;
+    (void)platform_data;
+
+    return TFM_PLAT_ERR_SUCCESS;
+}
+
+uint32_t tfm_spm_hal_get_ns_entry_point(void)
+{
+    return 0;
+}
+
+void tfm_spm_hal_clear_pending_irq(IRQn_Type irq_line)
+{
+    (void)irq_line;
+}
+
+void tfm_spm_hal_enable_irq(IRQn_Type irq_line)
+{
+    (void)irq_line;
+}
+
+void tfm_spm_hal_disable_irq(IRQn_Type irq_line)
+{
+    (void)irq_line;
+}
+
+int32_t tfm_nspm_get_current_client_id(void)
+{
+    return ns_client_id;
+}
+
+void spm_test_init(void)
+{
+    if (tfm_spm_db_init() != SPM_ERR_OK) {
+        fprintf(stderr, "FAIL: partition database init\n");
+        exit(EXIT_FAILURE);
+    }
+
+    (void)tfm_spm_init();
+}
+
+struct partition_t *spm_test_get_partition(int32_t partition_id)
+{
+    uint32_t i;
+
+    for (i = 0; i < g_spm_partition_db.partition_count; i++) {
+        if (g_spm_partition_db.partitions[i].static_data->partition_id ==
+            (uint32_t)partition_id) {
+            return &g_spm_partition_db.partitions[i];
+        }
+    }
+
+    return NULL;
+}
+
+void spm_test_set_running_partition(int32_t partition_id)
+{
+    struct partition_t *partition = spm_test_get_partition(partition_id);
+    struct tfm_arch_ctx_t ctx = {0};
+
+    if (!partition) {
+        fprintf(stderr, "FAIL: no partition %d\n", (int)partition_id);
+        exit(EXIT_FAILURE);
+    }
+
+    tfm_core_thrd_switch_context(&ctx, tfm_core_thrd_get_curr_thread(),
+                                 &partition->sp_thread);
+}
+
+void spm_test_set_ns_client_id(int32_t client_id)
+{
+    ns_client_id = client_id;
+}
+
+void spm_test_set_memory_access(spm_test_memory_access_t fn)
+{
+    memory_access = fn;
+}
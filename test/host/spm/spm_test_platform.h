@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Model of the platform and the partitions for the SPM host tests, built with
+ * the SPM of the IPC model and the partition and service tables generated
+ * from tfm_host_manifest_list.yaml. The partitions do not run: a test makes a
+ * partition the running one and calls the SPM functions of the SVC handlers
+ * as that partition would.
+ */
+
+#ifndef __SPM_TEST_PLATFORM_H__
+#define __SPM_TEST_PLATFORM_H__
+
+#include <setjmp.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "spm_ipc.h"
+#include "tfm_hal_defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Checks of memory access by the isolation HAL.
+ *
+ * \param[in] base  Base address of the memory
+ * \param[in] size  Size of the memory
+ * \param[in] attr  Access attributes, TFM_HAL_ACCESS_*
+ *
+ * \return TFM_HAL_SUCCESS if the access is permitted.
+ */
+typedef enum tfm_hal_status_t (*spm_test_memory_access_t)(uintptr_t base,
+                                                          size_t size,
+                                                          uint32_t attr);
+
+/* The generated partition database */
+extern struct spm_partition_db_t g_spm_partition_db;
+
+extern jmp_buf spm_test_panic_jmp;
+extern int spm_test_panic_armed;
+
+/**
+ * \brief Runs a statement which is expected to panic the SPM. The SPM state
+ *        is left as it was when it panicked.
+ *
+ * \param[out] panicked  Set to 1 if the statement panicked, 0 otherwise
+ * \param[in]  stmt      Statement to run
+ */
+#define SPM_TEST_PANICS(panicked, stmt)                                     \
+    do {                                                                    \
+        spm_test_panic_armed = 1;                                           \
+        if (setjmp(spm_test_panic_jmp) == 0) {                              \
+            stmt;                                                           \
+            (panicked) = 0;                                                 \
+        } else {                                                            \
+            (panicked) = 1;                                                 \
+        }                                                                   \
+        spm_test_panic_armed = 0;                                           \
+    } while (0)
+
+/**
+ * \brief Initialises the partition database and the SPM, as at boot. The
+ *        non-secure partition is the running one.
+ */
+void spm_test_init(void);
+
+/**
+ * \brief Gets a partition of the database.
+ *
+ * \param[in] partition_id  Partition ID
+ *
+ * \return The partition, or NULL if there is none with the ID.
+ */
+struct partition_t *spm_test_get_partition(int32_t partition_id);
+
+/**
+ * \brief Makes a partition the running one.
+ *
+ * \param[in] partition_id  Partition ID
+ */
+void spm_test_set_running_partition(int32_t partition_id);
+
+/**
+ * \brief Sets the client ID of the running non-secure client.
+ *
+ * \param[in] client_id  Non-secure client ID, negative
+ */
+void spm_test_set_ns_client_id(int32_t client_id);
+
+/**
+ * \brief Sets the check of memory access of the isolation HAL.
+ *
+ * \param[in] fn  Check of memory access, or NULL to permit all accesses
+ */
+void spm_test_set_memory_access(spm_test_memory_access_t fn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SPM_TEST_PLATFORM_H__ */
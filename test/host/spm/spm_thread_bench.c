@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Benchmark of the thread ready queues of the SPM against the number of
+ * threads.
+ *
+ * For each number of threads, the threads are started with priorities spread
+ * over the priority range, one in five of them non-secure. On each iteration,
+ * one thread is blocked and woken again, as on a psa_wait() and the message
+ * which ends it, and the priority of a RUNNING thread is changed. The
+ * benchmark reports the p50 and p99 latencies of the selection of the next
+ * thread, of the block and wake pair and of the priority change.
+ *
+ * Usage: spm_thread_bench [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "its_bench.h"
+#include "tfm_thread.h"
+
+#define DEFAULT_ITERATIONS          10000
+
+#define MAX_THREADS                 64
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+uint32_t tfm_test_pendsv_count;
+
+static const uint32_t thread_nums[] = {4, 16, MAX_THREADS};
+
+static struct tfm_core_thread_t threads[MAX_THREADS];
+
+static void *thread_entry(void *param)
+{
+    return param;
+}
+
+static void print_samples(const char *name, struct its_bench_samples_t *s)
+{
+    printf("  %-16s p50 %8.3f us  p99 %8.3f us\n", name,
+           its_bench_percentile(s, 50) / 1000.0,
+           its_bench_percentile(s, 99) / 1000.0);
+}
+
+static void run(uint32_t num, uint32_t iterations)
+{
+    struct its_bench_samples_t next_samples, block_samples, prior_samples;
+    struct tfm_core_thread_t *pth;
+    uint64_t start;
+    uint32_t i;
+
+    its_bench_samples_init(&next_samples, iterations);
+    its_bench_samples_init(&block_samples, iterations);
+    its_bench_samples_init(&prior_samples, iterations);
+
+    for (i = 0; i < num; i++) {
+        pth = &threads[i];
+        memset(pth, 0, sizeof(*pth));
+        tfm_core_thrd_init(pth, thread_entry, NULL, 0x2000, 0x1000);
+        tfm_core_thrd_set_priority(pth, (i * (THRD_PRIOR_MASK + 1)) / num);
+        tfm_core_thrd_set_secure(pth, (i % 5) ? THRD_ATTR_SECURE :
+                                                THRD_ATTR_NON_SECURE);
+        CHECK(tfm_core_thrd_start(pth) == THRD_SUCCESS);
+    }
+
+    for (i = 0; i < iterations; i++) {
+        pth = &threads[i % num];
+
+        start = its_bench_now_ns();
+        tfm_core_thrd_set_state(pth, THRD_STATE_BLOCK);
+        tfm_core_thrd_set_state(pth, THRD_STATE_RUNNING);
+        its_bench_samples_add(&block_samples, its_bench_now_ns() - start);
+
+        start = its_bench_now_ns();
+        CHECK(tfm_core_thrd_get_next_thread() != NULL);
+        its_bench_samples_add(&next_samples, its_bench_now_ns() - start);
+
+        start = its_bench_now_ns();
+        tfm_core_thrd_set_priority(pth, (pth->prior + 1) & THRD_PRIOR_MASK);
+        its_bench_samples_add(&prior_samples, its_bench_now_ns() - start);
+    }
+
+    printf("%u threads\n", num);
+    print_samples("get next", &next_samples);
+    print_samples("block and wake", &block_samples);
+    print_samples("set priority", &prior_samples);
+
+    for (i = 0; i < num; i++) {
+        tfm_core_thrd_set_state(&threads[i], THRD_STATE_BLOCK);
+    }
+    CHECK(tfm_core_thrd_get_next_thread() == NULL);
+
+    its_bench_samples_free(&next_samples);
+    its_bench_samples_free(&block_samples);
+    its_bench_samples_free(&prior_samples);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t iterations = DEFAULT_ITERATIONS;
+    size_t n;
+
+    if (argc > 1) {
+        iterations = (uint32_t)strtoul(argv[1], NULL, 0);
+        CHECK(iterations > 0);
+    }
+
+    printf("SPM thread ready queues, %u iterations per point\n", iterations);
+
+    for (n = 0; n < sizeof(thread_nums) / sizeof(thread_nums[0]); n++) {
+        run(thread_nums[n], iterations);
+    }
+
+    return EXIT_SUCCESS;
+}
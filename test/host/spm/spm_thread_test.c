@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Test of the thread ready queues of the SPM. The test starts threads, blocks
+ * and wakes them and changes their priorities, and checks after each step
+ * that tfm_core_thrd_get_next_thread() selects the thread a full priority
+ * sort of the RUNNING threads would select.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tfm_thread.h"
+
+#define NUM_THREADS                 16
+#define RANDOM_ROUNDS               20000
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+uint32_t tfm_test_pendsv_count;
+
+static struct tfm_core_thread_t threads[NUM_THREADS];
+/* Order in which the threads were last made RUNNING, FIFO among equals */
+static uint32_t run_seq[NUM_THREADS];
+static uint32_t next_seq;
+
+static void *thread_entry(void *param)
+{
+    return param;
+}
+
+static void start(uint32_t i, uint32_t prior, uint32_t attr_secure)
+{
+    struct tfm_core_thread_t *pth = &threads[i];
+
+    memset(pth, 0, sizeof(*pth));
+    tfm_core_thrd_init(pth, thread_entry, NULL, 0x2000, 0x1000);
+    tfm_core_thrd_set_priority(pth, prior);
+    tfm_core_thrd_set_secure(pth, attr_secure);
+    CHECK(tfm_core_thrd_start(pth) == THRD_SUCCESS);
+    run_seq[i] = next_seq++;
+}
+
+static void block(uint32_t i)
+{
+    tfm_core_thrd_set_state(&threads[i], THRD_STATE_BLOCK);
+}
+
+static void wake(uint32_t i)
+{
+    tfm_core_thrd_set_state(&threads[i], THRD_STATE_RUNNING);
+    run_seq[i] = next_seq++;
+}
+
+static void set_priority(uint32_t i, uint32_t prior)
+{
+    tfm_core_thrd_set_priority(&threads[i], prior);
+    if (threads[i].state == THRD_STATE_RUNNING) {
+        run_seq[i] = next_seq++;
+    }
+}
+
+/* The thread to run: the RUNNING thread of highest priority, secure threads
+ * first, and the first one made RUNNING among threads of the same priority.
+ */
+static struct tfm_core_thread_t *expected_next(uint32_t num)
+{
+    struct tfm_core_thread_t *best = NULL;
+    uint32_t best_seq = 0;
+    uint32_t i;
+
+    for (i = 0; i < num; i++) {
+        if (threads[i].state != THRD_STATE_RUNNING) {
+            continue;
+        }
+        if (best == NULL || threads[i].prior < best->prior ||
+            (threads[i].prior == best->prior && run_seq[i] < best_seq)) {
+            best = &threads[i];
+            best_seq = run_seq[i];
+        }
+    }
+
+    return best;
+}
+
+static void check_next(uint32_t num)
+{
+    CHECK(tfm_core_thrd_get_next_thread() == expected_next(num));
+}
+
+static void check_next_is(uint32_t i)
+{
+    CHECK(tfm_core_thrd_get_next_thread() == &threads[i]);
+}
+
+/* Blocks all the threads, which leaves the ready queues empty */
+static void reset(uint32_t num)
+{
+    uint32_t i;
+
+    for (i = 0; i < num; i++) {
+        if (threads[i].state == THRD_STATE_RUNNING) {
+            block(i);
+        }
+    }
+    CHECK(tfm_core_thrd_get_next_thread() == NULL);
+}
+
+static void test_order(void)
+{
+    /* Across queues, then by full priority value within a queue */
+    start(0, 0x40, THRD_ATTR_SECURE);
+    start(1, 0x42, THRD_ATTR_SECURE);
+    start(2, 0x41, THRD_ATTR_SECURE);
+    start(3, 0x10, THRD_ATTR_SECURE);
+    check_next_is(3);
+    block(3);
+    check_next_is(0);
+    block(0);
+    check_next_is(2);
+    block(2);
+    check_next_is(1);
+
+    /* A woken thread goes behind the threads of the same priority */
+    wake(0);
+    start(4, 0x40, THRD_ATTR_SECURE);
+    check_next_is(0);
+    block(0);
+    wake(0);
+    check_next_is(4);
+
+    reset(5);
+}
+
+static void test_priority_change(void)
+{
+    start(0, THRD_PRIOR_MEDIUM, THRD_ATTR_SECURE);
+    start(1, THRD_PRIOR_MEDIUM, THRD_ATTR_SECURE);
+    start(2, 0x20, THRD_ATTR_SECURE);
+    check_next_is(2);
+
+    /* A queued thread raised above the others moves to the new queue */
+    set_priority(1, 0x10);
+    check_next_is(1);
+
+    /* And is removed from the old one */
+    block(2);
+    block(1);
+    check_next_is(0);
+    block(0);
+    CHECK(tfm_core_thrd_get_next_thread() == NULL);
+
+    /* A queued thread lowered within its queue goes behind the others */
+    wake(0);
+    wake(1);
+    set_priority(1, THRD_PRIOR_MEDIUM);
+    check_next_is(0);
+    set_priority(0, THRD_PRIOR_MEDIUM + 1);
+    check_next_is(1);
+
+    /* A blocked thread is not queued by a priority change, and is queued
+     * with the new priority when woken.
+     */
+    set_priority(2, THRD_PRIOR_HIGHEST);
+    check_next_is(1);
+    wake(2);
+    check_next_is(2);
+
+    reset(3);
+}
+
+static void test_non_secure(void)
+{
+    /* Non-secure threads share the lowest priority queue with the secure
+     * threads of lowest priority, and go after them.
+     */
+    start(0, THRD_PRIOR_HIGHEST, THRD_ATTR_NON_SECURE);
+    check_next_is(0);
+    start(1, THRD_PRIOR_LOWEST, THRD_ATTR_SECURE);
+    check_next_is(1);
+    block(1);
+    check_next_is(0);
+
+    /* A priority change keeps a non-secure thread after the secure ones */
+    wake(1);
+    set_priority(0, THRD_PRIOR_HIGHEST);
+    check_next_is(1);
+    block(1);
+    check_next_is(0);
+
+    /* Made secure, it moves to the queue of its priority */
+    wake(1);
+    tfm_core_thrd_set_secure(&threads[0], THRD_ATTR_SECURE);
+    run_seq[0] = next_seq++;
+    check_next_is(0);
+    tfm_core_thrd_set_secure(&threads[0], THRD_ATTR_NON_SECURE);
+    run_seq[0] = next_seq++;
+    check_next_is(1);
+
+    reset(2);
+}
+
+/*
+ * Random wakes, blocks and priority changes of secure and non-secure
+ * threads, checked against a full sort after every step.
+ */
+static void test_random(void)
+{
+    uint32_t seed = 1;
+    uint32_t round, i;
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        start(i, i * 16, (i % 5) ? THRD_ATTR_SECURE : THRD_ATTR_NON_SECURE);
+    }
+    check_next(NUM_THREADS);
+
+    for (round = 0; round < RANDOM_ROUNDS; round++) {
+        seed = seed * 1103515245u + 12345u;
+        i = (seed >> 16) % NUM_THREADS;
+
+        switch ((seed >> 8) & 3) {
+        case 0:
+            if (threads[i].state == THRD_STATE_RUNNING) {
+                block(i);
+            } else {
+                wake(i);
+            }
+            break;
+        case 1:
+            set_priority(i, (seed >> 20) & THRD_PRIOR_MASK);
+            break;
+        case 2:
+            /* Few priority values, so that many threads share one */
+            set_priority(i, ((seed >> 20) & 3) * 0x40);
+            break;
+        default:
+            if (threads[i].state != THRD_STATE_RUNNING) {
+                wake(i);
+            }
+            break;
+        }
+
+        check_next(NUM_THREADS);
+    }
+
+    reset(NUM_THREADS);
+}
+
+int main(void)
+{
+    test_order();
+    test_priority_change();
+    test_non_secure();
+    test_random();
+
+    printf("PASS\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/* Host stub, the CMSE intrinsics are not used by the SPM host tests */
+
+#ifndef __ARM_CMSE_H__
+#define __ARM_CMSE_H__
+
+#endif /* __ARM_CMSE_H__ */
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/* Host stub of the CMSIS device header for the SPM host tests */
+
+#ifndef __CMSIS_H__
+#define __CMSIS_H__
+
+#include <stdint.h>
+
+#include "cmsis_compiler.h"
+
+typedef int32_t IRQn_Type;
+
+typedef union {
+    struct {
+        uint32_t nPRIV:1;
+        uint32_t SPSEL:1;
+        uint32_t FPCA:1;
+        uint32_t SFPA:1;
+        uint32_t _reserved1:28;
+    } b;
+    uint32_t w;
+} CONTROL_Type;
+
+/* The SPM runs in Handler mode, on the SVC exception */
+__STATIC_INLINE uint32_t __get_IPSR(void)
+{
+    return 11U;
+}
+
+#endif /* __CMSIS_H__ */
@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Host stub of the linker symbol macros for the SPM host tests. The partition
+ * stacks and data regions are not used on the host, and the 32-bit addresses
+ * of the partition database could not hold the host addresses of the
+ * symbols, so all the regions are at one dummy address, which the SPM only
+ * checks to be set.
+ */
+
+#ifndef __REGION_H__
+#define __REGION_H__
+
+#include <stdint.h>
+
+#define REGION_NAME(a, b, c)            (*(uint32_t *)0x1000)
+#define REGION_DECLARE(a, b, c)         extern uint32_t host_region_unused
+#define REGION_DECLARE_T(a, b, c, t)    extern uint32_t host_region_unused
+
+#endif /* __REGION_H__ */
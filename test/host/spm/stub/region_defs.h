@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/* Host stub, the SPM host tests have no memory map */
+
+#ifndef __REGION_DEFS_H__
+#define __REGION_DEFS_H__
+
+#endif /* __REGION_DEFS_H__ */
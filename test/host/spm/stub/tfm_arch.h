@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/* Host stub of the architecture layer for the SPM host tests */
+
+#ifndef __TFM_ARCH_H__
+#define __TFM_ARCH_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cmsis.h"
+
+struct tfm_arch_ctx_t {
+    uint32_t    sp;
+    uint32_t    lr;
+    uint32_t    retval;
+};
+
+/* General core state context */
+struct tfm_state_context_t {
+    uint32_t    r0;
+    uint32_t    r1;
+    uint32_t    r2;
+    uint32_t    r3;
+    uint32_t    r12;
+    uint32_t    lr;
+    uint32_t    ra;
+    uint32_t    xpsr;
+};
+
+/* The return value is held in the context, the stacks are not simulated */
+#define TFM_STATE_RET_VAL(ctx)          ((ctx)->retval)
+
+/* Number of PendSV requests, the scheduling runs are not simulated */
+extern uint32_t tfm_test_pendsv_count;
+
+__STATIC_INLINE void tfm_arch_trigger_pendsv(void)
+{
+    tfm_test_pendsv_count++;
+}
+
+__STATIC_INLINE void tfm_arch_init_context(struct tfm_arch_ctx_t *p_actx,
+                                           void *param, uintptr_t pfn,
+                                           uintptr_t sp_limit, uintptr_t sp)
+{
+    (void)param;
+    (void)pfn;
+    (void)sp_limit;
+
+    p_actx->sp = (uint32_t)sp;
+    p_actx->retval = 0;
+}
+
+__STATIC_INLINE bool is_stack_alloc_fp_space(uint32_t lr)
+{
+    (void)lr;
+
+    return false;
+}
+
+__STATIC_INLINE void tfm_arch_update_ctx(struct tfm_arch_ctx_t *p_actx)
+{
+    (void)p_actx;
+}
+
+#endif /* __TFM_ARCH_H__ */
@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_MEMORY_UTILS_H__
+#define __TFM_MEMORY_UTILS_H__
+
+#include <string.h>
+
+#define tfm_memcpy(dest, src, n)        memcpy(dest, src, n)
+#define tfm_memset(s, c, n)             memset(s, c, n)
+#define tfm_memcmp(s1, s2, n)           memcmp(s1, s2, n)
+
+#endif /* __TFM_MEMORY_UTILS_H__ */
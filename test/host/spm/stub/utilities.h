@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/* Host stub of the core utilities, with the assertions checked */
+
+#ifndef __TFM_UTILS_H__
+#define __TFM_UTILS_H__
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+void tfm_core_panic(void);
+
+#define TFM_CORE_ASSERT(cond)           assert(cond)
+
+/* Get container structure start address from member */
+#define TFM_GET_CONTAINER_PTR(ptr, type, member) \
+    (type *)((unsigned long)(ptr) - offsetof(type, member))
+
+#define ERROR_MSG(msg)
+
+bool tfm_is_one_bit_set(uint32_t n);
+
+#endif /* __TFM_UTILS_H__ */
@@ -0,0 +1,216 @@
+#-------------------------------------------------------------------------------
+# Copyright (c) 2020, Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+#-------------------------------------------------------------------------------
+
+"""
+Decode a memory dump of the SPM trace ring buffer (tfm_spm_trace_buf) into the
+Chrome trace event JSON format, which can be opened in chrome://tracing or
+https://ui.perfetto.dev.
+
+The dump can be taken with a debugger, for example:
+    (gdb) dump binary value trace.bin tfm_spm_trace_buf
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+# Keep in sync with secure_fw/spm/include/tfm_spm_trace.h
+TRACE_MAGIC = 0x45435254
+TRACE_VERSION = 1
+
+HEADER_FORMAT = "<IHHII"
+RECORD_FORMAT = "<IHHII"
+
+EVT_CONNECT_ENTER = 1
+EVT_CONNECT_EXIT = 2
+EVT_CALL_ENTER = 3
+EVT_CALL_EXIT = 4
+EVT_REPLY_ENTER = 5
+EVT_REPLY_EXIT = 6
+EVT_SWITCH = 7
+EVT_IRQ = 8
+EVT_MAILBOX = 9
+
+# Duration events: enter event -> (name, exit event, argument names)
+DURATION_EVENTS = {
+    EVT_CONNECT_ENTER: ("psa_connect", EVT_CONNECT_EXIT, ("sid", "version")),
+    EVT_CALL_ENTER:    ("psa_call", EVT_CALL_EXIT, ("handle", "type")),
+    EVT_REPLY_ENTER:   ("psa_reply", EVT_REPLY_EXIT, ("msg_handle", "status")),
+}
+
+EXIT_EVENTS = {
+    EVT_CONNECT_EXIT: "psa_connect",
+    EVT_CALL_EXIT:    "psa_call",
+    EVT_REPLY_EXIT:   "psa_reply",
+}
+
+MAILBOX_CALL_TYPES = {
+    1: "psa_framework_version",
+    2: "psa_version",
+    3: "psa_connect",
+    4: "psa_call",
+    5: "psa_close",
+}
+
+
+def to_signed(value):
+    return value - (1 << 32) if value & (1 << 31) else value
+
+
+def parse_dump(data, offset):
+    header_size = struct.calcsize(HEADER_FORMAT)
+    magic, version, record_size, nr_records, pos = \
+        struct.unpack_from(HEADER_FORMAT, data, offset)
+
+    if magic != TRACE_MAGIC:
+        sys.exit("Invalid trace magic 0x{:08x} at offset {}".format(magic,
+                                                                   offset))
+    if version != TRACE_VERSION:
+        sys.exit("Unsupported trace version {}".format(version))
+    if record_size != struct.calcsize(RECORD_FORMAT):
+        sys.exit("Unsupported trace record size {}".format(record_size))
+    if len(data) < offset + header_size + nr_records * record_size:
+        sys.exit("The dump is shorter than the trace buffer")
+
+    records = []
+    dropped = 0
+    for p in range(max(0, pos - nr_records), pos):
+        record_offset = offset + header_size + \
+                        (p % nr_records) * record_size
+        timestamp, event, seq, arg0, arg1 = \
+            struct.unpack_from(RECORD_FORMAT, data, record_offset)
+        if seq != p & 0xFFFF:
+            # The record was being written when the dump was taken
+            dropped += 1
+            continue
+        records.append((timestamp, event, arg0, arg1))
+
+    return records, dropped
+
+
+def unwrap_timestamps(records):
+    """
+    Convert the 32-bit cycle counts into monotonic ones. Records can be
+    slightly out of order when a handler preempts another one while it is
+    tracing, so only a large backwards step is treated as a wrap.
+    """
+    if all(r[0] == 0 for r in records):
+        # No cycle counter on this core. Order the records by position.
+        return [(i,) + r[1:] for i, r in enumerate(records)]
+
+    result = []
+    base = 0
+    prev = None
+    for timestamp, event, arg0, arg1 in records:
+        if prev is not None and timestamp < prev and \
+           prev - timestamp > (1 << 31):
+            base += 1 << 32
+        prev = timestamp
+        result.append((base + timestamp, event, arg0, arg1))
+
+    return result
+
+
+def to_chrome_events(records, cycles_per_us):
+    events = []
+    current = 0
+    start = records[0][0] if records else 0
+
+    def add(phase, name, tid, timestamp, args=None, scope=None):
+        event = {
+            "name": name,
+            "ph": phase,
+            "pid": 0,
+            "tid": tid,
+            "ts": (timestamp - start) / cycles_per_us,
+        }
+        if args:
+            event["args"] = args
+        if scope:
+            event["s"] = scope
+        events.append(event)
+
+    for timestamp, event, arg0, arg1 in records:
+        if event in DURATION_EVENTS:
+            name, _, arg_names = DURATION_EVENTS[event]
+            add("B", name, current, timestamp,
+                {arg_names[0]: hex(arg0), arg_names[1]: to_signed(arg1)})
+        elif event in EXIT_EVENTS:
+            args = None
+            if event != EVT_REPLY_EXIT:
+                args = {"status": to_signed(arg0)}
+            add("E", EXIT_EVENTS[event], current, timestamp, args)
+        elif event == EVT_SWITCH:
+            if current:
+                add("E", "running", current, timestamp)
+            current = to_signed(arg1)
+            add("B", "running", current, timestamp,
+                {"from": to_signed(arg0)})
+        elif event == EVT_IRQ:
+            add("i", "irq", to_signed(arg0), timestamp,
+                {"signal": hex(arg1)}, "t")
+        elif event == EVT_MAILBOX:
+            add("i", "mailbox " + MAILBOX_CALL_TYPES.get(arg0, str(arg0)),
+                current, timestamp, {"client_id": to_signed(arg1)}, "t")
+        else:
+            add("i", "event {}".format(event), current, timestamp,
+                {"arg0": hex(arg0), "arg1": hex(arg1)}, "t")
+
+    # Name the threads after the partition IDs
+    for tid in sorted(set(e["tid"] for e in events)):
+        events.append({
+            "name": "thread_name",
+            "ph": "M",
+            "pid": 0,
+            "tid": tid,
+            "args": {"name": "Partition {}".format(tid) if tid else "SPM"},
+        })
+
+    return events
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description="Convert a SPM trace buffer dump into Chrome trace JSON")
+    parser.add_argument("dump", help="Binary dump of tfm_spm_trace_buf")
+    parser.add_argument("-o", "--output", default="-",
+                        help="Output JSON file. Defaults to stdout")
+    parser.add_argument("--offset", type=lambda x: int(x, 0), default=0,
+                        help="Offset of the trace buffer in the dump")
+    parser.add_argument("--cpu-freq", type=float, default=1.0,
+                        help="CPU frequency in MHz, to convert cycles into "
+                             "microseconds")
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+
+    with open(args.dump, "rb") as f:
+        data = f.read()
+
+    records, dropped = parse_dump(data, args.offset)
+    if dropped:
+        print("Dropped {} incomplete record(s)".format(dropped),
+              file=sys.stderr)
+
+    trace = {
+        "traceEvents": to_chrome_events(unwrap_timestamps(records),
+                                        args.cpu_freq),
+        "displayTimeUnit": "ns",
+    }
+
+    if args.output == "-":
+        json.dump(trace, sys.stdout, indent=1)
+    else:
+        with open(args.output, "w") as f:
+            json.dump(trace, f, indent=1)
+
+
+if __name__ == "__main__":
+    main()
@@ -125,6 +125,61 @@ def process_manifest(manifest_list_files):
 
     return manifest_header_list, db
 
+def sort_manifest_db(db):
+    """
+    Sort the partitions by partition ID and list the RoT Services of the IPC
+    partitions sorted by SID.
+
+    Parameters
+    ----------
+    db:
+        The data base returned by process_manifest.
+
+    Returns
+    -------
+    The sorted data base and the sorted service list. Each service list
+    entry holds the service and the data base entry of its partition. The
+    stateless services get a 'stateless_index' attribute.
+    """
+
+    db = sorted(db, key=lambda item: item['attr']['pid'])
+
+    for prev, item in zip(db, db[1:]):
+        if prev['attr']['pid'] == item['attr']['pid']:
+            raise Exception("Partitions '{}' and '{}' have the same ID {}"
+                            .format(prev['manifest']['name'],
+                                    item['manifest']['name'],
+                                    item['attr']['pid']))
+
+    services = []
+    for item in db:
+        if item['attr'].get('tfm_partition_ipc') and \
+           item['manifest'].get('services'):
+            for service in item['manifest']['services']:
+                services.append({"service": service, "manifest": item})
+
+    services.sort(key=lambda entry: int(str(entry['service']['sid']), 0))
+
+    for prev, entry in zip(services, services[1:]):
+        if int(str(prev['service']['sid']), 0) == \
+           int(str(entry['service']['sid']), 0):
+            raise Exception("RoT Services '{}' and '{}' have the same SID {}"
+                            .format(prev['service']['name'],
+                                    entry['service']['name'],
+                                    entry['service']['sid']))
+
+    """
+    Stateless RoT Services are numbered in SID order. The number is encoded
+    in the stateless handle the clients use to call the service.
+    """
+    stateless_index = 0
+    for entry in services:
+        if entry['service'].get('connection_based', True) is False:
+            entry['service']['stateless_index'] = stateless_index
+            stateless_index += 1
+
+    return db, services
+
 def gen_files(context, gen_file_lists):
     """
     Generate files according to the gen_file_list
@@ -238,6 +293,13 @@ def main():
 
     manifest_header_list, db = process_manifest(manifest_list)
 
+    """
+    The SPM looks up partitions by ID and RoT Services by SID with a binary
+    search, so the generated partition and service tables must be sorted.
+    Entries removed by a conditional keep the remaining ones sorted.
+    """
+    db, services = sort_manifest_db(db)
+
     utilities = {}
     context = {}
 
@@ -245,6 +307,7 @@ def main():
     utilities['manifest_header_list']=manifest_header_list
 
     context['manifests'] = db
+    context['services'] = services
     context['utilities'] = utilities
 
     gen_files(context, gen_file_list)